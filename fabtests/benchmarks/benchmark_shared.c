@@ -115,6 +115,8 @@ static int pingpong_pre_posted_rx(size_t inject_size)
 			ret = ft_rx(ep, opts.transfer_size);
 			if (ret)
 				return ret;
+
+			ft_lat_sample(2);
 		}
 	} else {
 		for (i = 0; i < opts.iterations + opts.warmup_iterations; i++) {
@@ -133,6 +135,8 @@ static int pingpong_pre_posted_rx(size_t inject_size)
 					    opts.transfer_size, &tx_ctx);
 			if (ret)
 				return ret;
+
+			ft_lat_sample(2);
 		}
 	}
 	ft_stop();
@@ -166,6 +170,8 @@ static int pingpong_no_pre_posted_rx(size_t inject_size)
 			ret = ft_get_rx_comp(rx_seq);
 			if (ret)
 				return ret;
+
+			ft_lat_sample(2);
 		}
 	} else {
 		for (i = 0; i < opts.iterations + opts.warmup_iterations; i++) {
@@ -195,6 +201,8 @@ static int pingpong_no_pre_posted_rx(size_t inject_size)
 					    opts.transfer_size, &tx_ctx);
 			if (ret)
 				return ret;
+
+			ft_lat_sample(2);
 		}
 	}
 	ft_stop();
@@ -346,6 +354,8 @@ int pingpong_rma(enum ft_rma_opcodes rma_op, struct fi_rma_iov *remote)
 			ret = ft_rx_rma(i, rma_op, ep, opts.transfer_size);
 			if (ret)
 				return ret;
+
+			ft_lat_sample(2);
 		}
 	} else {
 		for (i = 0; i < opts.iterations + opts.warmup_iterations; i++) {
@@ -368,6 +378,8 @@ int pingpong_rma(enum ft_rma_opcodes rma_op, struct fi_rma_iov *remote)
 						opts.transfer_size, &tx_ctx);
 			if (ret)
 				return ret;
+
+			ft_lat_sample(2);
 		}
 	}
 	ft_stop();
@@ -422,6 +434,8 @@ int rma_tx_completion(enum ft_rma_opcodes rma_op, struct fi_rma_iov *remote)
 						opts.transfer_size, &tx_ctx);
 			if (ret)
 				return ret;
+
+			ft_lat_sample(1);
 		}
 
 		ft_stop();
@@ -498,6 +512,15 @@ static int rma_bw_rx_comp()
 	return ft_tx(ep, remote_fi_addr, FT_RMA_SYNC_MSG_BYTES, &tx_ctx);
 }
 
+/*
+ * Sample the time taken by a window that ended with transfer i, counting
+ * only the transfers that fell inside the timed loop.
+ */
+static void bw_lat_sample(int i, int window)
+{
+	ft_lat_sample(MIN(window, i + 1 - opts.warmup_iterations));
+}
+
 static uint64_t set_fi_more_flag(int i, int j, uint64_t flags)
 {
 	if (j < opts.window_size - 1 && i >= opts.warmup_iterations &&
@@ -574,12 +597,14 @@ int bandwidth(void)
 				ret = bw_tx_comp();
 				if (ret)
 					return ret;
+				bw_lat_sample(i, j);
 				j = 0;
 			}
 		}
 		ret = bw_tx_comp();
 		if (ret)
 			return ret;
+		bw_lat_sample(i - 1, j);
 	} else {
 		for (i = j = 0; i < opts.iterations + opts.warmup_iterations; i++) {
 			if (i == opts.warmup_iterations)
@@ -606,12 +631,14 @@ int bandwidth(void)
 				ret = bw_rx_comp(j);
 				if (ret)
 					return ret;
+				bw_lat_sample(i, j);
 				j = 0;
 			}
 		}
 		ret = bw_rx_comp(j);
 		if (ret)
 			return ret;
+		bw_lat_sample(i - 1, j);
 	}
 	ft_stop();
 
@@ -764,6 +791,7 @@ int bandwidth_rma(enum ft_rma_opcodes rma_op, struct fi_rma_iov *remote)
 			ret = bw_rma_comp(rma_op, j);
 			if (ret)
 				return ret;
+			bw_lat_sample(i, j);
 			j = 0;
 		}
 		offset += opts.transfer_size;
@@ -771,6 +799,7 @@ int bandwidth_rma(enum ft_rma_opcodes rma_op, struct fi_rma_iov *remote)
 	ret = bw_rma_comp(rma_op, j);
 	if (ret)
 		return ret;
+	bw_lat_sample(i - 1, j);
 	ft_stop();
 
 	if (opts.machr)
@@ -780,3 +809,103 @@ int bandwidth_rma(enum ft_rma_opcodes rma_op, struct fi_rma_iov *remote)
 		show_perf(NULL, opts.transfer_size, opts.iterations, &start, &end, 1);
 	return 0;
 }
+
+int ft_bench_ep_open(struct ft_bench_ep *bep, size_t cq_size,
+		     size_t av_count)
+{
+	struct fi_cq_attr cq_attr = {0};
+	struct fi_av_attr av_attr = {0};
+	int ret;
+
+	ret = fi_domain(fabric, fi, &bep->domain, NULL);
+	if (ret) {
+		printf("fi_domain failed ep[%d]: %d\n", bep->id, ret);
+		return ret;
+	}
+
+	ret = fi_endpoint(bep->domain, fi, &bep->ep, NULL);
+	if (ret) {
+		printf("fi_endpoint failed: %d\n", ret);
+		return ret;
+	}
+
+	cq_attr.size = cq_size;
+	cq_attr.format = FI_CQ_FORMAT_CONTEXT;
+	ret = fi_cq_open(bep->domain, &cq_attr, &bep->cq, NULL);
+	if (ret) {
+		printf("fi_cq_open failed: %d\n", ret);
+		return ret;
+	}
+
+	av_attr.type = FI_AV_UNSPEC;
+	av_attr.count = av_count;
+	ret = fi_av_open(bep->domain, &av_attr, &bep->av, NULL);
+	if (ret) {
+		printf("fi_av_open failed: %d\n", ret);
+		return ret;
+	}
+
+	ret = fi_ep_bind(bep->ep, &bep->av->fid, 0);
+	if (ret) {
+		printf("fi_ep_bind av failed: %d\n", ret);
+		return ret;
+	}
+
+	ret = fi_ep_bind(bep->ep, &bep->cq->fid, FI_TRANSMIT | FI_RECV);
+	if (ret) {
+		printf("fi_ep_bind cq failed: %d\n", ret);
+		return ret;
+	}
+
+	ret = fi_enable(bep->ep);
+	if (ret)
+		printf("fi_enable failed: %d\n", ret);
+	return ret;
+}
+
+void ft_bench_ep_close(struct ft_bench_ep *bep)
+{
+	int ret;
+
+	if (bep->ep) {
+		ret = fi_close(&bep->ep->fid);
+		if (ret)
+			printf("fi_close(ep[%d]) failed: %d\n", bep->id, ret);
+	}
+	if (bep->cq) {
+		ret = fi_close(&bep->cq->fid);
+		if (ret)
+			printf("fi_close(cq[%d]) failed: %d\n", bep->id, ret);
+	}
+	if (bep->av) {
+		ret = fi_close(&bep->av->fid);
+		if (ret)
+			printf("fi_close(av[%d]) failed: %d\n", bep->id, ret);
+	}
+	if (bep->domain) {
+		ret = fi_close(&bep->domain->fid);
+		if (ret)
+			printf("fi_close(domain[%d]) failed: %d\n", bep->id,
+			       ret);
+	}
+	bep->ep = NULL;
+	bep->cq = NULL;
+	bep->av = NULL;
+	bep->domain = NULL;
+}
+
+/* Returns the number of completions read, 0 if there are none */
+ssize_t ft_bench_ep_read_cq(struct ft_bench_ep *bep, struct fi_cq_entry *comp,
+			    size_t count)
+{
+	ssize_t ret;
+
+	ret = fi_cq_read(bep->cq, comp, count);
+	if (ret == -FI_EAGAIN)
+		return 0;
+	if (ret == -FI_EAVAIL)
+		return ft_cq_readerr(bep->cq);
+	if (ret < 0)
+		printf("fi_cq_read ep[%d] failed: %zd\n", bep->id, ret);
+	return ret;
+}
@@ -52,6 +52,21 @@ int pingpong_rma(enum ft_rma_opcodes rma_op, struct fi_rma_iov *remote);
 int bandwidth_rma(enum ft_rma_opcodes op, struct fi_rma_iov *remote);
 int rma_tx_completion(enum ft_rma_opcodes rma_op, struct fi_rma_iov *remote);
 
+/* An endpoint in a domain of its own, for tests that drive several */
+struct ft_bench_ep {
+	struct fid_domain *domain;
+	struct fid_ep *ep;
+	struct fid_cq *cq;
+	struct fid_av *av;
+	int id;
+};
+
+int ft_bench_ep_open(struct ft_bench_ep *bep, size_t cq_size,
+		     size_t av_count);
+void ft_bench_ep_close(struct ft_bench_ep *bep);
+ssize_t ft_bench_ep_read_cq(struct ft_bench_ep *bep, struct fi_cq_entry *comp,
+			    size_t count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,510 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * rdm_conn_storm.c
+ * Connection setup storm benchmark: the client and the server each open -n
+ * endpoints, every endpoint on its own domain, and every client endpoint
+ * sends a hello to every server endpoint at once, which the server endpoint
+ * acks.  For connection-oriented providers this sets up n x n connections
+ * simultaneously.  The client reports the time until every hello has been
+ * acked, which is the time to have all peers connected, and the resulting
+ * connection rate.
+ *
+ * A single thread drives all endpoints and never blocks on one peer: sends
+ * that return -FI_EAGAIN, e.g. while the connection is being set up, are
+ * retried on a later pass over the peers.  Each of the -I rounds opens a new
+ * set of endpoints, so every round starts without any connections.
+ */
+
+#include <rdma/fi_cm.h>
+
+#include "shared.h"
+#include "benchmark_shared.h"
+
+#define BUFFER_SIZE 1024
+#define STORM_MSG_SIZE sizeof(uint32_t)
+
+struct storm_ep {
+	struct ft_bench_ep bep;
+	struct fid_mr *mr;
+	void *desc;
+	fi_addr_t *fiaddr;
+	bool *sent;
+	char *buf;
+	size_t buf_size;
+	struct fi_context2 *rx_ctx;
+	struct fi_context2 *tx_ctx;
+	size_t tx_posted;
+	size_t rx_done;
+	size_t tx_done;
+};
+
+static char oob_buffer[BUFFER_SIZE];
+static size_t num_eps = 8;
+static bool show_rounds;
+static struct storm_ep *seps;
+
+static void close_eps(void)
+{
+	int ret;
+	int i;
+
+	for (i = 0; seps && i < num_eps; i++) {
+		if (seps[i].mr) {
+			ret = fi_close(&seps[i].mr->fid);
+			if (ret)
+				printf("fi_close(mr[%d]) failed: %d\n", i, ret);
+		}
+		ft_bench_ep_close(&seps[i].bep);
+		free(seps[i].buf);
+		free(seps[i].fiaddr);
+		free(seps[i].sent);
+		free(seps[i].rx_ctx);
+		free(seps[i].tx_ctx);
+	}
+	free(seps);
+	seps = NULL;
+}
+
+static void cleanup_ofi(void)
+{
+	close_eps();
+	ft_free_res();
+}
+
+static int init_sep(struct storm_ep *sep)
+{
+	int ret;
+
+	sep->rx_ctx = calloc(num_eps, sizeof(*sep->rx_ctx));
+	sep->tx_ctx = calloc(num_eps, sizeof(*sep->tx_ctx));
+	sep->fiaddr = calloc(num_eps, sizeof(*sep->fiaddr));
+	sep->sent = calloc(num_eps, sizeof(*sep->sent));
+	/* one receive slot per peer, followed by our own id */
+	sep->buf_size = (num_eps + 1) * STORM_MSG_SIZE;
+	sep->buf = calloc(1, sep->buf_size);
+	if (!sep->rx_ctx || !sep->tx_ctx || !sep->fiaddr || !sep->sent ||
+	    !sep->buf)
+		return -FI_ENOMEM;
+
+	ret = ft_bench_ep_open(&sep->bep, MAX(num_eps * 2, 128), num_eps);
+	if (ret)
+		return ret;
+
+	ret = ft_reg_mr_ep(fi, sep->bep.domain, sep->bep.ep, sep->buf,
+			   sep->buf_size, FI_SEND | FI_RECV, sep->bep.id,
+			   FI_HMEM_SYSTEM, 0, &sep->mr, &sep->desc);
+	if (ret)
+		printf("buffer registration ep[%d] failed: %d\n",
+		       sep->bep.id, ret);
+	return ret;
+}
+
+static int open_eps(void)
+{
+	int ret, i;
+
+	seps = calloc(num_eps, sizeof(*seps));
+	if (!seps)
+		return -FI_ENOMEM;
+
+	for (i = 0; i < num_eps; i++) {
+		seps[i].bep.id = i;
+		ret = init_sep(&seps[i]);
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+static int send_names(void)
+{
+	size_t len;
+	int ret, i;
+
+	for (i = 0; i < num_eps; i++) {
+		len = BUFFER_SIZE;
+		ret = fi_getname(&seps[i].bep.ep->fid, oob_buffer, &len);
+		if (ret)
+			return ret;
+
+		ret = ft_sock_send(oob_sock, oob_buffer, BUFFER_SIZE);
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+/* Every local endpoint inserts all peer endpoints in the same order. */
+static int recv_names(void)
+{
+	int ret, i, j;
+
+	for (i = 0; i < num_eps; i++) {
+		ret = ft_sock_recv(oob_sock, oob_buffer, BUFFER_SIZE);
+		if (ret)
+			return ret;
+
+		for (j = 0; j < num_eps; j++) {
+			ret = fi_av_insert(seps[j].bep.av, oob_buffer, 1,
+					   &seps[j].fiaddr[i], 0, NULL);
+			if (ret != 1)
+				return -FI_EINVAL;
+		}
+	}
+	return 0;
+}
+
+static int init_av(void)
+{
+	int ret;
+
+	if (opts.dst_addr) {
+		ret = send_names();
+		return ret ? ret : recv_names();
+	}
+
+	ret = recv_names();
+	return ret ? ret : send_names();
+}
+
+static char *id_buf(struct storm_ep *sep)
+{
+	return sep->buf + num_eps * STORM_MSG_SIZE;
+}
+
+static int poll_cq(struct storm_ep *sep,
+		   int (*rx_handler)(struct storm_ep *sep, size_t idx))
+{
+	struct fi_cq_entry comp[16];
+	struct fi_context2 *ctx;
+	ssize_t ret, i;
+	int err;
+
+	ret = ft_bench_ep_read_cq(&sep->bep, comp, ARRAY_SIZE(comp));
+	if (ret < 0)
+		return (int) ret;
+
+	for (i = 0; i < ret; i++) {
+		ctx = comp[i].op_context;
+		if (ctx >= sep->tx_ctx && ctx < sep->tx_ctx + num_eps) {
+			sep->tx_done++;
+			continue;
+		}
+
+		sep->rx_done++;
+		if (rx_handler) {
+			err = rx_handler(sep, ctx - sep->rx_ctx);
+			if (err)
+				return err;
+		}
+	}
+	return 0;
+}
+
+static int post_recvs(void)
+{
+	struct storm_ep *sep;
+	ssize_t ret;
+	int i, j;
+
+	for (i = 0; i < num_eps; i++) {
+		sep = &seps[i];
+		*(uint32_t *) id_buf(sep) = sep->bep.id;
+		for (j = 0; j < num_eps; j++) {
+			do {
+				ret = fi_recv(sep->bep.ep,
+					      sep->buf + j * STORM_MSG_SIZE,
+					      STORM_MSG_SIZE, sep->desc,
+					      FI_ADDR_UNSPEC, &sep->rx_ctx[j]);
+				if (ret == -FI_EAGAIN && poll_cq(sep, NULL))
+					ret = -FI_EOTHER;
+			} while (ret == -FI_EAGAIN);
+			if (ret) {
+				printf("fi_recv ep[%d] failed: %zd\n", i, ret);
+				return (int) ret;
+			}
+		}
+	}
+	return 0;
+}
+
+/* Ack a hello on the connection it arrived on. */
+static int server_ack(struct storm_ep *sep, size_t idx)
+{
+	uint32_t peer = *(uint32_t *) (sep->buf + idx * STORM_MSG_SIZE);
+	ssize_t ret;
+
+	if (peer >= num_eps) {
+		printf("ep[%d] received invalid hello: %u\n", sep->bep.id, peer);
+		return -FI_EIO;
+	}
+
+	do {
+		ret = fi_send(sep->bep.ep, id_buf(sep), STORM_MSG_SIZE, sep->desc,
+			      sep->fiaddr[peer], &sep->tx_ctx[peer]);
+		if (ret == -FI_EAGAIN && poll_cq(sep, server_ack))
+			ret = -FI_EOTHER;
+	} while (ret == -FI_EAGAIN);
+	if (ret)
+		printf("fi_send ep[%d] failed: %zd\n", sep->bep.id, ret);
+	return (int) ret;
+}
+
+static int server_storm(void)
+{
+	size_t done;
+	int ret, i;
+
+	do {
+		for (i = 0, done = 0; i < num_eps; i++) {
+			ret = poll_cq(&seps[i], server_ack);
+			if (ret)
+				return ret;
+			if (seps[i].rx_done == num_eps &&
+			    seps[i].tx_done == num_eps)
+				done++;
+		}
+	} while (done < num_eps);
+	return 0;
+}
+
+/*
+ * Post the hellos that have not been accepted yet, moving on to the next
+ * peer whenever the provider is not ready for this one.
+ */
+static int client_send(struct storm_ep *sep)
+{
+	ssize_t ret;
+	int i;
+
+	for (i = 0; i < num_eps && sep->tx_posted < num_eps; i++) {
+		if (sep->sent[i])
+			continue;
+
+		ret = fi_send(sep->bep.ep, id_buf(sep), STORM_MSG_SIZE, sep->desc,
+			      sep->fiaddr[i], &sep->tx_ctx[i]);
+		if (ret == -FI_EAGAIN)
+			continue;
+		if (ret) {
+			printf("fi_send ep[%d] failed: %zd\n", sep->bep.id, ret);
+			return (int) ret;
+		}
+
+		sep->sent[i] = true;
+		sep->tx_posted++;
+	}
+	return 0;
+}
+
+static int client_storm(void)
+{
+	size_t done;
+	int ret, i;
+
+	do {
+		for (i = 0, done = 0; i < num_eps; i++) {
+			ret = client_send(&seps[i]);
+			if (ret)
+				return ret;
+
+			ret = poll_cq(&seps[i], NULL);
+			if (ret)
+				return ret;
+			if (seps[i].rx_done == num_eps &&
+			    seps[i].tx_done == num_eps)
+				done++;
+		}
+	} while (done < num_eps);
+	return 0;
+}
+
+static int run_round(uint64_t *elapsed)
+{
+	uint64_t start;
+	int ret;
+
+	ret = open_eps();
+	if (ret)
+		return ret;
+
+	ret = init_av();
+	if (ret) {
+		printf("init_av failed: %d\n", ret);
+		return ret;
+	}
+
+	ret = post_recvs();
+	if (ret)
+		return ret;
+
+	ret = ft_sock_sync(oob_sock, 0);
+	if (ret)
+		return ret;
+
+	start = ft_gettime_ns();
+	ret = opts.dst_addr ? client_storm() : server_storm();
+	*elapsed = ft_gettime_ns() - start;
+	if (ret)
+		return ret;
+
+	/* keep the connections up until both sides are done */
+	ret = ft_sock_sync(oob_sock, 0);
+	close_eps();
+	return ret;
+}
+
+static int run_test(void)
+{
+	uint64_t elapsed, min = UINT64_MAX, max = 0, sum = 0;
+	size_t conns = num_eps * num_eps;
+	int i, ret;
+
+	for (i = 0; i < opts.iterations; i++) {
+		ret = run_round(&elapsed);
+		if (ret)
+			return ret;
+
+		if (show_rounds)
+			printf("round %d: %.3f ms\n", i, elapsed / 1e6);
+		min = MIN(min, elapsed);
+		max = MAX(max, elapsed);
+		sum += elapsed;
+	}
+
+	if (!opts.dst_addr)
+		return 0;
+
+	printf("%-6s%-8s%-8s%12s%12s%12s%14s\n", "eps", "conns", "rounds",
+	       "min msec", "avg msec", "max msec", "conns/sec");
+	printf("%-6zu%-8zu%-8d%12.3f%12.3f%12.3f%14.0f\n", num_eps, conns,
+	       opts.iterations, min / 1e6, sum / 1e6 / opts.iterations,
+	       max / 1e6, conns * 1e9 * opts.iterations / sum);
+	return 0;
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "\nrdm_conn_storm test options:\n");
+	FT_PRINT_OPTS_USAGE("-n <num eps>",
+			    "number of endpoints on each side (default 8)");
+	FT_PRINT_OPTS_USAGE("-I <rounds>",
+			    "number of connection storms (default 10)");
+	FT_PRINT_OPTS_USAGE("-L", "print the time of every round");
+	fprintf(stderr, "Notice to user: Not all fabtests options are supported"
+		" by this test. If something isn't working check if the option"
+		" is supported before reporting a bug.\n");
+}
+
+int main(int argc, char **argv)
+{
+	int ret, op;
+
+	opts = INIT_OPTS;
+	opts.options |= FT_OPT_OOB_CTRL;
+	opts.iterations = 10;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return EXIT_FAILURE;
+
+	while ((op = getopt_long(argc, argv, "n:Lh" CS_OPTS INFO_OPTS
+		BENCHMARK_OPTS, long_opts, &lopt_idx)) != -1) {
+		switch (op) {
+		default:
+			if (!ft_parse_long_opts(op, optarg))
+				continue;
+			ft_parse_benchmark_opts(op, optarg);
+			ft_parseinfo(op, optarg, hints, &opts);
+			ft_parsecsopts(op, optarg, &opts);
+			break;
+		case 'n':
+			num_eps = atoi(optarg);
+			break;
+		case 'L':
+			show_rounds = true;
+			break;
+		case '?':
+		case 'h':
+			ft_csusage(argv[0], "Connection setup storm benchmark "
+				   "for RDM endpoints.");
+			ft_benchmark_usage();
+			ft_longopts_usage();
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind < argc)
+		opts.dst_addr = argv[optind];
+
+	if (!num_eps || opts.iterations < 1) {
+		fprintf(stderr, "number of endpoints and rounds must be "
+			"positive\n");
+		return EXIT_FAILURE;
+	}
+
+	hints->ep_attr->type = FI_EP_RDM;
+	hints->domain_attr->resource_mgmt = FI_RM_ENABLED;
+	hints->domain_attr->threading = FI_THREAD_DOMAIN;
+	hints->caps = FI_MSG;
+	hints->mode |= FI_CONTEXT | FI_CONTEXT2;
+	hints->domain_attr->mr_mode = opts.mr_mode;
+	hints->addr_format = opts.address_format;
+
+	ret = ft_init_oob();
+	if (ret)
+		goto out;
+
+	ret = fi_getinfo(FT_FIVERSION, NULL, NULL, 0, hints, &fi);
+	if (ret) {
+		printf("fi_getinfo() failed: %d\n", ret);
+		goto out;
+	}
+
+	ret = fi_fabric(fi->fabric_attr, &fabric, NULL);
+	if (ret) {
+		printf("fi_fabric failed: %d\n", ret);
+		goto out;
+	}
+
+	ret = ft_sock_sync(oob_sock, 0);
+	if (ret)
+		goto out;
+
+	ret = run_test();
+out:
+	cleanup_ofi();
+	ft_close_oob();
+	return ft_exit_code(ret);
+}
@@ -0,0 +1,784 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * rdm_incast.c
+ * Fan-in (incast) benchmark: -n sender endpoints, each on its own thread and
+ * domain in the client process, converge on a single target endpoint in the
+ * server process.
+ *
+ * The test first measures connection establishment: all senders start at
+ * once and send a hello that the target acks immediately, so each sender
+ * reports the time to its first round trip, which includes any connection
+ * setup.  Then, for each message size, every sender streams -I messages in
+ * windows of -W sends while the target keeps only -W receives posted.  The
+ * target reports its receive throughput and, when the provider exposes
+ * FI_VAR_UNEXP_MSG_CNT through fi_profile, samples the unexpected message
+ * queue depth every -T microseconds (-L prints every sample).
+ */
+
+#include <pthread.h>
+#include <rdma/fi_cm.h>
+#include <rdma/fi_tagged.h>
+
+#include "shared.h"
+#include "benchmark_shared.h"
+
+/* fi_profile.h relies on the container_of defined in shared.h */
+#include <rdma/fi_profile.h>
+
+#define BUFFER_SIZE 1024
+#define INCAST_MSG_SIZE sizeof(uint32_t)
+#define INCAST_MAX_SAMPLES 4096
+
+struct incast_ep {
+	struct ft_bench_ep bep;
+	pthread_t thread;
+	struct fid_mr *mr;
+	void *desc;
+	fi_addr_t *fiaddr;
+	char *buf;
+	size_t buf_size;
+	struct fi_context2 *rx_ctx;
+	struct fi_context2 *tx_ctx;
+	size_t rx_ctx_cnt;
+	size_t tx_ctx_cnt;
+	size_t rx_done;
+	size_t tx_done;
+	uint64_t start;
+	uint64_t end;
+	int ret;
+};
+
+static char oob_buffer[BUFFER_SIZE];
+static size_t num_senders = 1;
+static size_t xfer_size;
+static size_t max_size;
+static uint64_t sample_interval_ns = 1000000;
+static bool show_samples;
+static bool tagged;
+static pthread_barrier_t barrier;
+
+/* One target endpoint on the server, num_senders endpoints on the client */
+static struct incast_ep *ieps;
+static size_t num_ieps;
+static struct fid_profile *prof;
+
+static struct {
+	uint64_t time;
+	uint64_t depth;
+} samples[INCAST_MAX_SAMPLES];
+static size_t sample_cnt;
+
+static void cleanup_ofi(void)
+{
+	int ret;
+	int i;
+
+	/* profiles have no close op; they live as long as the target ep */
+	for (i = 0; ieps && i < num_ieps; i++) {
+		if (ieps[i].mr) {
+			ret = fi_close(&ieps[i].mr->fid);
+			if (ret)
+				printf("fi_close(mr[%d]) failed: %d\n", i, ret);
+		}
+		ft_bench_ep_close(&ieps[i].bep);
+		free(ieps[i].buf);
+		free(ieps[i].fiaddr);
+		free(ieps[i].rx_ctx);
+		free(ieps[i].tx_ctx);
+	}
+	free(ieps);
+	ft_free_res();
+}
+
+static int init_iep(struct incast_ep *iep, size_t av_cnt)
+{
+	int ret;
+
+	iep->rx_ctx_cnt = opts.dst_addr ? 1 :
+			  MAX((size_t) opts.window_size, num_senders);
+	iep->tx_ctx_cnt = opts.dst_addr ? opts.window_size + 1 : num_senders;
+	iep->rx_ctx = calloc(iep->rx_ctx_cnt, sizeof(*iep->rx_ctx));
+	iep->tx_ctx = calloc(iep->tx_ctx_cnt, sizeof(*iep->tx_ctx));
+	iep->fiaddr = calloc(av_cnt, sizeof(*iep->fiaddr));
+	/* data, or one hello slot per sender, followed by the ack */
+	iep->buf_size = MAX(max_size, num_senders * INCAST_MSG_SIZE) +
+			INCAST_MSG_SIZE;
+	iep->buf = calloc(1, iep->buf_size);
+	if (!iep->rx_ctx || !iep->tx_ctx || !iep->fiaddr || !iep->buf)
+		return -FI_ENOMEM;
+
+	ret = ft_bench_ep_open(&iep->bep,
+			       MAX(iep->rx_ctx_cnt + iep->tx_ctx_cnt, 128),
+			       av_cnt);
+	if (ret)
+		return ret;
+
+	ret = ft_reg_mr_ep(fi, iep->bep.domain, iep->bep.ep, iep->buf,
+			   iep->buf_size, FI_SEND | FI_RECV, iep->bep.id,
+			   FI_HMEM_SYSTEM, 0, &iep->mr, &iep->desc);
+	if (ret)
+		printf("buffer registration ep[%d] failed: %d\n",
+		       iep->bep.id, ret);
+	return ret;
+}
+
+static int init_ofi(void)
+{
+	int ret, i;
+
+	ret = fi_fabric(fi->fabric_attr, &fabric, NULL);
+	if (ret) {
+		printf("fi_fabric failed: %d\n", ret);
+		return ret;
+	}
+
+	num_ieps = opts.dst_addr ? num_senders : 1;
+	ieps = calloc(num_ieps, sizeof(*ieps));
+	if (!ieps)
+		return -FI_ENOMEM;
+
+	for (i = 0; i < num_ieps; i++) {
+		ieps[i].bep.id = i;
+		ret = init_iep(&ieps[i], opts.dst_addr ? 1 : num_senders);
+		if (ret)
+			return ret;
+	}
+
+	if (!opts.dst_addr) {
+		ret = fi_profile_open(&ieps[0].bep.ep->fid, 0, &prof, NULL);
+		if (ret) {
+			prof = NULL;
+			printf("unexpected queue depth not available from "
+			       "provider (%d)\n", ret);
+		}
+	}
+	return 0;
+}
+
+/* The client sends every sender address, the server returns its own. */
+static int init_av(void)
+{
+	size_t len;
+	int ret, i;
+
+	for (i = 0; i < num_senders; i++) {
+		if (opts.dst_addr) {
+			len = BUFFER_SIZE;
+			ret = fi_getname(&ieps[i].bep.ep->fid, oob_buffer, &len);
+			if (ret)
+				return ret;
+
+			ret = ft_sock_send(oob_sock, oob_buffer, BUFFER_SIZE);
+		} else {
+			ret = ft_sock_recv(oob_sock, oob_buffer, BUFFER_SIZE);
+			if (ret)
+				return ret;
+
+			ret = fi_av_insert(ieps[0].bep.av, oob_buffer, 1,
+					   &ieps[0].fiaddr[i], 0, NULL);
+			ret = (ret == 1) ? 0 : -FI_EINVAL;
+		}
+		if (ret)
+			return ret;
+	}
+
+	if (!opts.dst_addr) {
+		len = BUFFER_SIZE;
+		ret = fi_getname(&ieps[0].bep.ep->fid, oob_buffer, &len);
+		if (ret)
+			return ret;
+
+		return ft_sock_send(oob_sock, oob_buffer, BUFFER_SIZE);
+	}
+
+	ret = ft_sock_recv(oob_sock, oob_buffer, BUFFER_SIZE);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < num_senders; i++) {
+		ret = fi_av_insert(ieps[i].bep.av, oob_buffer, 1,
+				   &ieps[i].fiaddr[0], 0, NULL);
+		if (ret != 1)
+			return -FI_EINVAL;
+	}
+	return 0;
+}
+
+/*
+ * Reap completions, passing the index of each completed receive to the
+ * handler, if any.  Transmit completions are only counted.
+ */
+static int poll_cq(struct incast_ep *iep,
+		   int (*rx_handler)(struct incast_ep *iep, size_t idx))
+{
+	struct fi_cq_entry comp[16];
+	struct fi_context2 *ctx;
+	ssize_t ret, i;
+	int err;
+
+	ret = ft_bench_ep_read_cq(&iep->bep, comp, ARRAY_SIZE(comp));
+	if (ret < 0)
+		return (int) ret;
+
+	for (i = 0; i < ret; i++) {
+		ctx = comp[i].op_context;
+		if (ctx >= iep->tx_ctx && ctx < iep->tx_ctx + iep->tx_ctx_cnt) {
+			iep->tx_done++;
+			continue;
+		}
+
+		iep->rx_done++;
+		if (rx_handler) {
+			err = rx_handler(iep, ctx - iep->rx_ctx);
+			if (err)
+				return err;
+		}
+	}
+	return 0;
+}
+
+#define INCAST_POST(iep, handler, call)					\
+	do {								\
+		ssize_t _ret;						\
+		while ((_ret = (call))) {				\
+			if (_ret != -FI_EAGAIN) {			\
+				printf("%s ep[%d] failed: %zd\n",	\
+				       #call, (iep)->bep.id, _ret);	\
+				return (int) _ret;			\
+			}						\
+			_ret = poll_cq(iep, handler);			\
+			if (_ret)					\
+				return (int) _ret;			\
+		}							\
+	} while (0)
+
+static int wait_cq(struct incast_ep *iep, size_t tx, size_t rx)
+{
+	int ret;
+
+	while (iep->tx_done < tx || iep->rx_done < rx) {
+		ret = poll_cq(iep, NULL);
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+/*
+ * Some providers, such as tcp, only queue unexpected tagged messages and
+ * leave untagged ones in the transport, so -o tagged exercises that queue.
+ */
+static ssize_t data_send(struct incast_ep *iep, void *ctx)
+{
+	if (tagged)
+		return fi_tsend(iep->bep.ep, iep->buf, xfer_size, iep->desc,
+				iep->fiaddr[0], 0, ctx);
+	return fi_send(iep->bep.ep, iep->buf, xfer_size, iep->desc,
+		       iep->fiaddr[0], ctx);
+}
+
+static ssize_t data_recv(struct incast_ep *iep, void *ctx)
+{
+	if (tagged)
+		return fi_trecv(iep->bep.ep, iep->buf, xfer_size, iep->desc,
+				FI_ADDR_UNSPEC, 0, 0, ctx);
+	return fi_recv(iep->bep.ep, iep->buf, xfer_size, iep->desc,
+		       FI_ADDR_UNSPEC, ctx);
+}
+
+static char *ack_buf(struct incast_ep *iep)
+{
+	return iep->buf + iep->buf_size - INCAST_MSG_SIZE;
+}
+
+static int post_ack_recv(struct incast_ep *iep)
+{
+	INCAST_POST(iep, NULL, fi_recv(iep->bep.ep, ack_buf(iep), INCAST_MSG_SIZE,
+				       iep->desc, iep->fiaddr[0],
+				       &iep->rx_ctx[0]));
+	return 0;
+}
+
+/* Receives reaped while the ack waits for room are passed to the handler. */
+static int server_ack(struct incast_ep *iep, size_t sender,
+		      int (*handler)(struct incast_ep *iep, size_t idx))
+{
+	INCAST_POST(iep, handler, fi_send(iep->bep.ep, ack_buf(iep),
+					  INCAST_MSG_SIZE, iep->desc,
+					  iep->fiaddr[sender],
+					  &iep->tx_ctx[sender]));
+	return 0;
+}
+
+/* Connection phase: ack every hello as soon as it arrives. */
+static int server_hello(struct incast_ep *iep, size_t idx)
+{
+	uint32_t sender = *(uint32_t *) (iep->buf + idx * INCAST_MSG_SIZE);
+
+	if (sender >= num_senders) {
+		printf("ep[%d] received invalid hello: %u\n", iep->bep.id,
+		       sender);
+		return -FI_EIO;
+	}
+	return server_ack(iep, sender, server_hello);
+}
+
+static int server_connect(void)
+{
+	struct incast_ep *iep = &ieps[0];
+	uint64_t start;
+	size_t i;
+	int ret;
+
+	iep->rx_done = iep->tx_done = 0;
+	for (i = 0; i < num_senders; i++) {
+		INCAST_POST(iep, NULL, fi_recv(iep->bep.ep,
+				iep->buf + i * INCAST_MSG_SIZE,
+				INCAST_MSG_SIZE, iep->desc, FI_ADDR_UNSPEC,
+				&iep->rx_ctx[i]));
+	}
+
+	ret = ft_sock_sync(oob_sock, 0);
+	if (ret)
+		return ret;
+
+	start = ft_gettime_ns();
+	while (iep->rx_done < num_senders) {
+		ret = poll_cq(iep, server_hello);
+		if (ret)
+			return ret;
+	}
+
+	ret = wait_cq(iep, num_senders, 0);
+	if (ret)
+		return ret;
+
+	printf("%zu senders connected in %.2f ms\n", num_senders,
+	       (ft_gettime_ns() - start) / 1e6);
+	return 0;
+}
+
+static void *sender_connect(void *context)
+{
+	struct incast_ep *iep = context;
+	uint32_t *hello = (uint32_t *) iep->buf;
+	int ret;
+
+	iep->rx_done = iep->tx_done = 0;
+	*hello = iep->bep.id;
+	ret = post_ack_recv(iep);
+
+	pthread_barrier_wait(&barrier);
+	iep->start = ft_gettime_ns();
+	if (!ret)
+		ret = fi_send(iep->bep.ep, hello, INCAST_MSG_SIZE, iep->desc,
+			      iep->fiaddr[0], &iep->tx_ctx[0]);
+	while (ret == -FI_EAGAIN) {
+		ret = poll_cq(iep, NULL);
+		if (!ret)
+			ret = fi_send(iep->bep.ep, hello, INCAST_MSG_SIZE,
+				      iep->desc, iep->fiaddr[0],
+				      &iep->tx_ctx[0]);
+	}
+	if (!ret)
+		ret = wait_cq(iep, 1, 1);
+	iep->end = ft_gettime_ns();
+
+	iep->ret = ret;
+	return NULL;
+}
+
+static int run_threads(void *(*func)(void *))
+{
+	int i, ret = 0;
+
+	for (i = 0; i < num_senders; i++) {
+		ieps[i].ret = 0;
+		ret = pthread_create(&ieps[i].thread, NULL, func, &ieps[i]);
+		if (ret) {
+			printf("pthread_create failed: %d\n", ret);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	for (i = 0; i < num_senders; i++) {
+		pthread_join(ieps[i].thread, NULL);
+		if (ieps[i].ret && !ret)
+			ret = ieps[i].ret;
+	}
+	return ret;
+}
+
+static int client_connect(void)
+{
+	uint64_t first = UINT64_MAX, last = 0, sum = 0, min = UINT64_MAX;
+	uint64_t max = 0, elapsed;
+	int i, ret;
+
+	ret = ft_sock_sync(oob_sock, 0);
+	if (ret)
+		return ret;
+
+	ret = run_threads(sender_connect);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < num_senders; i++) {
+		elapsed = ieps[i].end - ieps[i].start;
+		min = MIN(min, elapsed);
+		max = MAX(max, elapsed);
+		sum += elapsed;
+		first = MIN(first, ieps[i].start);
+		last = MAX(last, ieps[i].end);
+	}
+
+	printf("%-8s%14s%14s%14s%16s\n", "senders", "min usec",
+	       "avg usec", "max usec", "all conn msec");
+	printf("%-8zu%14.2f%14.2f%14.2f%16.2f\n", num_senders, min / 1e3,
+	       sum / 1e3 / num_senders, max / 1e3, (last - first) / 1e6);
+	return 0;
+}
+
+static void *sender_stream(void *context)
+{
+	struct incast_ep *iep = context;
+	size_t posted = 0, slot;
+	int ret;
+
+	iep->rx_done = iep->tx_done = 0;
+	ret = post_ack_recv(iep);
+
+	pthread_barrier_wait(&barrier);
+	while (!ret && posted < opts.iterations) {
+		for (slot = 0; slot < opts.window_size &&
+		     posted < opts.iterations; slot++, posted++) {
+			do {
+				ret = data_send(iep, &iep->tx_ctx[slot + 1]);
+				if (ret == -FI_EAGAIN && poll_cq(iep, NULL))
+					ret = -FI_EOTHER;
+			} while (ret == -FI_EAGAIN);
+			if (ret)
+				break;
+		}
+		if (!ret)
+			ret = wait_cq(iep, posted, 0);
+	}
+
+	/* the target acks once it has received every sender's messages */
+	if (!ret)
+		ret = wait_cq(iep, posted, 1);
+	if (ret)
+		printf("sender %d failed: %d\n", iep->bep.id, ret);
+
+	iep->ret = ret;
+	return NULL;
+}
+
+static void sample_depth(uint64_t now, uint64_t start)
+{
+	uint64_t depth;
+
+	if (fi_profile_read_u64(prof, FI_VAR_UNEXP_MSG_CNT, &depth))
+		return;
+
+	if (sample_cnt < INCAST_MAX_SAMPLES) {
+		samples[sample_cnt].time = now - start;
+		samples[sample_cnt].depth = depth;
+	}
+	sample_cnt++;
+}
+
+static size_t data_posted, data_total;
+
+static int server_repost(struct incast_ep *iep, size_t idx)
+{
+	if (data_posted >= data_total)
+		return 0;
+
+	data_posted++;
+	INCAST_POST(iep, server_repost, data_recv(iep, &iep->rx_ctx[idx]));
+	return 0;
+}
+
+static int server_stream(void)
+{
+	struct incast_ep *iep = &ieps[0];
+	uint64_t start, now, next, sum = 0, max = 0;
+	size_t i, cnt;
+	int ret;
+
+	iep->rx_done = iep->tx_done = 0;
+	data_total = num_senders * opts.iterations;
+	data_posted = 0;
+	sample_cnt = 0;
+
+	for (i = 0; i < opts.window_size && data_posted < data_total; i++) {
+		ret = server_repost(iep, i);
+		if (ret)
+			return ret;
+	}
+
+	ret = ft_sock_sync(oob_sock, 0);
+	if (ret)
+		return ret;
+
+	start = ft_gettime_ns();
+	next = start;
+	while (iep->rx_done < data_total) {
+		ret = poll_cq(iep, server_repost);
+		if (ret)
+			return ret;
+
+		if (prof) {
+			now = ft_gettime_ns();
+			if (now >= next) {
+				sample_depth(now, start);
+				next = now + sample_interval_ns;
+			}
+		}
+	}
+	now = ft_gettime_ns();
+
+	for (i = 0; i < num_senders; i++) {
+		ret = server_ack(iep, i, NULL);
+		if (ret)
+			return ret;
+	}
+	ret = wait_cq(iep, num_senders, 0);
+	if (ret)
+		return ret;
+
+	cnt = MIN(sample_cnt, INCAST_MAX_SAMPLES);
+	for (i = 0; i < cnt; i++) {
+		sum += samples[i].depth;
+		max = MAX(max, samples[i].depth);
+	}
+
+	printf("%-8zu%-8zu%-10zu%8.2fs%14.0f%10.2f", xfer_size, num_senders,
+	       data_total, (now - start) / 1e9,
+	       data_total * 1e9 / (now - start),
+	       (double) data_total * xfer_size * 1e3 / (now - start));
+	if (cnt)
+		printf("%12.1f%12" PRIu64 "\n", (double) sum / cnt, max);
+	else
+		printf("%12s%12s\n", "n/a", "n/a");
+
+	for (i = 0; show_samples && i < cnt; i++)
+		printf("  %10.3f ms  unexp %" PRIu64 "\n",
+		       samples[i].time / 1e6, samples[i].depth);
+	return 0;
+}
+
+static int run_size(void)
+{
+	int ret;
+
+	if (!opts.dst_addr)
+		return server_stream();
+
+	ret = ft_sock_sync(oob_sock, 0);
+	if (ret)
+		return ret;
+
+	return run_threads(sender_stream);
+}
+
+static int run_test(void)
+{
+	int i, ret;
+
+	ret = opts.dst_addr ? client_connect() : server_connect();
+	if (ret)
+		return ret;
+
+	if (!opts.dst_addr)
+		printf("%-8s%-8s%-10s%9s%14s%10s%12s%12s\n", "bytes",
+		       "senders", "msgs", "time", "msgs/sec", "MB/sec",
+		       "unexp avg", "unexp max");
+
+	if (opts.options & FT_OPT_SIZE) {
+		xfer_size = opts.transfer_size;
+		return run_size();
+	}
+
+	for (i = 0; i < TEST_CNT; i++) {
+		if (!ft_use_size(i, opts.sizes_enabled))
+			continue;
+		xfer_size = test_size[i].size;
+		ret = run_size();
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+static void set_max_size(void)
+{
+	int i;
+
+	if (opts.options & FT_OPT_SIZE) {
+		max_size = opts.transfer_size;
+		return;
+	}
+
+	for (i = 0; i < TEST_CNT; i++) {
+		if (ft_use_size(i, opts.sizes_enabled))
+			max_size = MAX(max_size, test_size[i].size);
+	}
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "\nrdm_incast test options:\n");
+	FT_PRINT_OPTS_USAGE("-n <num senders>",
+			    "number of sender endpoints (threads) on the client");
+	FT_PRINT_OPTS_USAGE("-T <usec>",
+			    "unexpected queue sampling interval (default 1000)");
+	FT_PRINT_OPTS_USAGE("-L", "print every unexpected queue depth sample");
+	FT_PRINT_OPTS_USAGE("-o <op>", "data transfer op: msg (default), tagged");
+	FT_PRINT_OPTS_USAGE("-U", "enable FI_DELIVERY_COMPLETE");
+	fprintf(stderr, "Notice to user: Not all fabtests options are supported"
+		" by this test. If something isn't working check if the option"
+		" is supported before reporting a bug.\n");
+}
+
+int main(int argc, char **argv)
+{
+	int ret, op;
+
+	opts = INIT_OPTS;
+	opts.options |= FT_OPT_OOB_CTRL;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return EXIT_FAILURE;
+
+	while ((op = getopt_long(argc, argv, "n:T:o:LUh" CS_OPTS INFO_OPTS
+		BENCHMARK_OPTS, long_opts, &lopt_idx)) != -1) {
+		switch (op) {
+		default:
+			if (!ft_parse_long_opts(op, optarg))
+				continue;
+			ft_parse_benchmark_opts(op, optarg);
+			ft_parseinfo(op, optarg, hints, &opts);
+			ft_parsecsopts(op, optarg, &opts);
+			break;
+		case 'n':
+			num_senders = atoi(optarg);
+			break;
+		case 'T':
+			sample_interval_ns = strtoull(optarg, NULL, 0) * 1000;
+			break;
+		case 'L':
+			show_samples = true;
+			break;
+		case 'o':
+			if (!strcasecmp(optarg, "tagged")) {
+				tagged = true;
+			} else if (strcasecmp(optarg, "msg")) {
+				fprintf(stderr, "unknown op: %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'U':
+			hints->tx_attr->op_flags |= FI_DELIVERY_COMPLETE;
+			break;
+		case '?':
+		case 'h':
+			ft_csusage(argv[0], "Many-to-one (incast) benchmark "
+				   "for RDM endpoints.");
+			ft_benchmark_usage();
+			ft_longopts_usage();
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind < argc)
+		opts.dst_addr = argv[optind];
+
+	if (!num_senders || opts.window_size < 1) {
+		fprintf(stderr, "number of senders and window size must be "
+			"positive\n");
+		return EXIT_FAILURE;
+	}
+
+	hints->ep_attr->type = FI_EP_RDM;
+	hints->domain_attr->resource_mgmt = FI_RM_ENABLED;
+	hints->domain_attr->threading = FI_THREAD_DOMAIN;
+	hints->caps = FI_MSG | (tagged ? FI_TAGGED : 0);
+	hints->mode |= FI_CONTEXT | FI_CONTEXT2;
+	hints->domain_attr->mr_mode = opts.mr_mode;
+	hints->addr_format = opts.address_format;
+
+	ret = ft_init_oob();
+	if (ret)
+		goto out;
+
+	ret = fi_getinfo(FT_FIVERSION, NULL, NULL, 0, hints, &fi);
+	if (ret) {
+		printf("fi_getinfo() failed: %d\n", ret);
+		goto out;
+	}
+
+	set_max_size();
+
+	ret = init_ofi();
+	if (ret) {
+		printf("init ofi failed\n");
+		goto out;
+	}
+
+	ret = ft_sock_sync(oob_sock, 0);
+	if (ret)
+		goto out;
+
+	ret = init_av();
+	if (ret) {
+		printf("init_av failed: %d\n", ret);
+		goto out;
+	}
+
+	ret = pthread_barrier_init(&barrier, NULL, num_senders);
+	if (ret)
+		goto out;
+
+	ret = run_test();
+
+	pthread_barrier_destroy(&barrier);
+out:
+	cleanup_ofi();
+	ft_close_oob();
+	return ft_exit_code(ret);
+}
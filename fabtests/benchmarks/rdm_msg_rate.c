@@ -0,0 +1,700 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * rdm_msg_rate.c
+ * Multi-pair message rate test, modeled after OSU mbw_mr.
+ *
+ * Each of the -n threads on the client is paired with a thread on the
+ * server.  Like rdm_bw_mt, every pair owns its domain, ep, cq, av and
+ * buffers, so pairs only share the fabric.  Per iteration, the client posts
+ * a window of sends (fi_send, fi_inject, fi_tsend or fi_tinject) and the
+ * server returns a 1 byte ack once the whole window has been received.  The
+ * server re-posts its receives for the next window before sending the ack,
+ * so the measured rate does not include unexpected message handling.
+ *
+ * Rates are reported per pair (min/avg/max, or every pair with -A) and in
+ * aggregate over the time all pairs on this side spent in the timed loop.
+ * Process pairs can be measured by starting several client/server instances
+ * with distinct ports.
+ */
+
+#include <pthread.h>
+#include <rdma/fi_cm.h>
+#include <rdma/fi_tagged.h>
+
+#include "shared.h"
+#include "benchmark_shared.h"
+#include "hmem.h"
+
+#define BUFFER_SIZE 1024
+#define MSG_RATE_TAG 0x5eed
+#define ACK_SIZE 1
+
+enum msg_rate_op {
+	MSG_RATE_SEND,
+	MSG_RATE_INJECT,
+	MSG_RATE_TSEND,
+	MSG_RATE_TINJECT,
+};
+
+static const char *msg_rate_op_str[] = {
+	[MSG_RATE_SEND] = "send",
+	[MSG_RATE_INJECT] = "inject",
+	[MSG_RATE_TSEND] = "tagged",
+	[MSG_RATE_TINJECT] = "tinject",
+};
+
+static char oob_buffer[BUFFER_SIZE];
+
+static size_t num_pairs = 1;
+static size_t xfer_size = 1;
+static enum msg_rate_op rate_op = MSG_RATE_SEND;
+static bool show_all_pairs;
+static uint64_t agg_start, agg_end;
+static pthread_barrier_t barrier;
+
+struct pair_args {
+	struct ft_bench_ep bep;
+	pthread_t thread;
+	fi_addr_t fiaddr;
+	struct fid_mr *tx_mr;
+	struct fid_mr *rx_mr;
+	void *tx_mr_desc;
+	void *rx_mr_desc;
+	struct fi_context2 *ctx;
+	struct fi_context2 ack_ctx;
+	char *tx_buf;
+	char *rx_buf;
+	size_t buf_size;
+	size_t data_done;
+	size_t ack_done;
+	uint64_t start;
+	uint64_t end;
+	int ret;
+};
+
+static struct pair_args *pargs;
+
+static bool is_tagged(void)
+{
+	return rate_op == MSG_RATE_TSEND || rate_op == MSG_RATE_TINJECT;
+}
+
+static bool is_inject(void)
+{
+	return rate_op == MSG_RATE_INJECT || rate_op == MSG_RATE_TINJECT;
+}
+
+static void cleanup_ofi(void)
+{
+	int i;
+
+	for (i = 0; pargs && i < num_pairs; i++) {
+		ft_bench_ep_close(&pargs[i].bep);
+		free(pargs[i].ctx);
+	}
+	free(pargs);
+	ft_free_res();
+}
+
+static int init_av(struct pair_args *pair)
+{
+	size_t len = BUFFER_SIZE;
+	int ret;
+
+	ret = fi_getname(&pair->bep.ep->fid, oob_buffer, &len);
+	if (ret) {
+		printf("fi_getname failed: %d\n", ret);
+		return ret;
+	}
+
+	ret = ft_sock_send(oob_sock, oob_buffer, BUFFER_SIZE);
+	if (ret) {
+		printf("ft_sock_send failed: %d\n", ret);
+		return ret;
+	}
+
+	ret = ft_sock_recv(oob_sock, oob_buffer, BUFFER_SIZE);
+	if (ret) {
+		printf("ft_sock_recv failed: %d\n", ret);
+		return ret;
+	}
+
+	ret = fi_av_insert(pair->bep.av, oob_buffer, 1, &pair->fiaddr, 0, NULL);
+	if (ret != 1) {
+		printf("fi_av_insert failed: %d\n", ret);
+		return ret ? ret : -FI_EINVAL;
+	}
+
+	return 0;
+}
+
+static int init_ofi(void)
+{
+	int ret, i;
+
+	ret = fi_fabric(fi->fabric_attr, &fabric, NULL);
+	if (ret) {
+		printf("fi_fabric failed: %d\n", ret);
+		return ret;
+	}
+
+	pargs = calloc(num_pairs, sizeof(*pargs));
+	if (!pargs) {
+		printf("pair_args calloc failed\n");
+		return -FI_ENOMEM;
+	}
+
+	for (i = 0; i < num_pairs; i++) {
+		pargs[i].bep.id = i;
+		pargs[i].ctx = calloc(opts.window_size, sizeof(*pargs[i].ctx));
+		if (!pargs[i].ctx) {
+			printf("context calloc failed\n");
+			return -FI_ENOMEM;
+		}
+
+		/* room for a full window plus the ack in both directions */
+		ret = ft_bench_ep_open(&pargs[i].bep,
+				       MAX(opts.window_size + 1, 128), 1);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int alloc_bufs(struct pair_args *pair)
+{
+	int ret;
+
+	/* the ack travels in the opposite direction using the same buffers */
+	pair->buf_size = MAX(xfer_size, ACK_SIZE);
+	ret = ft_hmem_alloc(opts.iface, opts.device, (void **) &pair->tx_buf,
+			    pair->buf_size);
+	if (ret) {
+		printf("ft_hmem_alloc tx %d failed: %d\n", pair->bep.id, ret);
+		return ret;
+	}
+
+	ret = ft_hmem_alloc(opts.iface, opts.device, (void **) &pair->rx_buf,
+			    pair->buf_size);
+	if (ret) {
+		printf("ft_hmem_alloc rx %d failed: %d\n", pair->bep.id, ret);
+		return ret;
+	}
+
+	ret = ft_reg_mr_ep(fi, pair->bep.domain, pair->bep.ep, pair->tx_buf,
+			   pair->buf_size, FI_SEND, pair->bep.id, opts.iface,
+			   opts.device, &pair->tx_mr, &pair->tx_mr_desc);
+	if (ret) {
+		printf("fi_mr_reg tx %d failed: %d\n", pair->bep.id, ret);
+		return ret;
+	}
+
+	ret = ft_reg_mr_ep(fi, pair->bep.domain, pair->bep.ep, pair->rx_buf,
+			   pair->buf_size, FI_RECV, pair->bep.id + 0xDAD,
+			   opts.iface, opts.device, &pair->rx_mr,
+			   &pair->rx_mr_desc);
+	if (ret)
+		printf("fi_mr_reg rx %d failed: %d\n", pair->bep.id, ret);
+
+	return ret;
+}
+
+static void free_bufs(struct pair_args *pair)
+{
+	int ret;
+
+	if (pair->tx_mr) {
+		ret = fi_close(&pair->tx_mr->fid);
+		if (ret)
+			printf("fi_close(tx_mr[%d]) failed: %d\n", pair->bep.id, ret);
+	}
+	if (pair->rx_mr) {
+		ret = fi_close(&pair->rx_mr->fid);
+		if (ret)
+			printf("fi_close(rx_mr[%d]) failed: %d\n", pair->bep.id, ret);
+	}
+	if (pair->tx_buf) {
+		ret = ft_hmem_free(opts.iface, pair->tx_buf);
+		if (ret)
+			printf("ft_hmem_free tx %d failed: %d\n", pair->bep.id, ret);
+	}
+	if (pair->rx_buf) {
+		ret = ft_hmem_free(opts.iface, pair->rx_buf);
+		if (ret)
+			printf("ft_hmem_free rx %d failed: %d\n", pair->bep.id, ret);
+	}
+
+	pair->tx_mr = pair->rx_mr = NULL;
+	pair->tx_mr_desc = pair->rx_mr_desc = NULL;
+	pair->tx_buf = pair->rx_buf = NULL;
+}
+
+/* Reap completions, counting data transfers and acks separately. */
+static int poll_cq(struct pair_args *pair)
+{
+	struct fi_cq_entry comp[16];
+	ssize_t ret, i;
+
+	ret = ft_bench_ep_read_cq(&pair->bep, comp, ARRAY_SIZE(comp));
+	if (ret < 0)
+		return (int) ret;
+
+	for (i = 0; i < ret; i++) {
+		if (comp[i].op_context == &pair->ack_ctx)
+			pair->ack_done++;
+		else
+			pair->data_done++;
+	}
+	return 0;
+}
+
+static ssize_t post_data(struct pair_args *pair, size_t i)
+{
+	switch (rate_op) {
+	case MSG_RATE_INJECT:
+		return fi_inject(pair->bep.ep, pair->tx_buf, xfer_size,
+				 pair->fiaddr);
+	case MSG_RATE_TINJECT:
+		return fi_tinject(pair->bep.ep, pair->tx_buf, xfer_size,
+				  pair->fiaddr, MSG_RATE_TAG);
+	case MSG_RATE_TSEND:
+		return fi_tsend(pair->bep.ep, pair->tx_buf, xfer_size,
+				pair->tx_mr_desc, pair->fiaddr, MSG_RATE_TAG,
+				&pair->ctx[i]);
+	default:
+		return fi_send(pair->bep.ep, pair->tx_buf, xfer_size,
+			       pair->tx_mr_desc, pair->fiaddr, &pair->ctx[i]);
+	}
+}
+
+static ssize_t post_recv(struct pair_args *pair, size_t len, void *context)
+{
+	if (is_tagged())
+		return fi_trecv(pair->bep.ep, pair->rx_buf, len, pair->rx_mr_desc,
+				pair->fiaddr, MSG_RATE_TAG, 0, context);
+
+	return fi_recv(pair->bep.ep, pair->rx_buf, len, pair->rx_mr_desc,
+		       pair->fiaddr, context);
+}
+
+static ssize_t post_ack(struct pair_args *pair)
+{
+	if (is_tagged())
+		return fi_tsend(pair->bep.ep, pair->tx_buf, ACK_SIZE,
+				pair->tx_mr_desc, pair->fiaddr, MSG_RATE_TAG,
+				&pair->ack_ctx);
+
+	return fi_send(pair->bep.ep, pair->tx_buf, ACK_SIZE, pair->tx_mr_desc,
+		       pair->fiaddr, &pair->ack_ctx);
+}
+
+#define MSG_RATE_POST(pair, post_fn, ...)				\
+	do {								\
+		ssize_t _ret;						\
+		while ((_ret = post_fn(pair, ##__VA_ARGS__))) {		\
+			if (_ret != -FI_EAGAIN) {			\
+				printf("%s pair[%d] failed: %zd\n",	\
+				       #post_fn, (pair)->bep.id, _ret);\
+				return (int) _ret;			\
+			}						\
+			_ret = poll_cq(pair);				\
+			if (_ret)					\
+				return (int) _ret;			\
+		}							\
+	} while (0)
+
+static int wait_cq(struct pair_args *pair, size_t data, size_t acks)
+{
+	int ret;
+
+	while (pair->data_done < data || pair->ack_done < acks) {
+		ret = poll_cq(pair);
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+static int post_recv_window(struct pair_args *pair)
+{
+	size_t i;
+
+	for (i = 0; i < opts.window_size; i++)
+		MSG_RATE_POST(pair, post_recv, xfer_size, &pair->ctx[i]);
+	return 0;
+}
+
+static int send_window(struct pair_args *pair)
+{
+	size_t i;
+	int ret;
+
+	pair->data_done = pair->ack_done = 0;
+	MSG_RATE_POST(pair, post_recv, ACK_SIZE, &pair->ack_ctx);
+
+	for (i = 0; i < opts.window_size; i++)
+		MSG_RATE_POST(pair, post_data, i);
+
+	ret = wait_cq(pair, is_inject() ? 0 : opts.window_size, 1);
+	if (ret)
+		printf("send window pair[%d] failed: %d\n", pair->bep.id, ret);
+	return ret;
+}
+
+static int recv_window(struct pair_args *pair, bool last)
+{
+	int ret;
+
+	ret = wait_cq(pair, opts.window_size, 0);
+	if (ret)
+		goto out;
+
+	pair->data_done = pair->ack_done = 0;
+	if (!last) {
+		ret = post_recv_window(pair);
+		if (ret)
+			goto out;
+	}
+
+	MSG_RATE_POST(pair, post_ack);
+	ret = wait_cq(pair, 0, 1);
+	pair->ack_done = 0;
+out:
+	if (ret)
+		printf("recv window pair[%d] failed: %d\n", pair->bep.id, ret);
+	return ret;
+}
+
+static int run_windows(struct pair_args *pair, int start, int cnt, int total)
+{
+	int i, ret;
+
+	for (i = start; i < start + cnt; i++) {
+		ret = opts.dst_addr ? send_window(pair) :
+				      recv_window(pair, i == total - 1);
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+static void *msg_rate_thread(void *context)
+{
+	struct pair_args *pair = context;
+	int total = opts.warmup_iterations + opts.iterations;
+	int ret = 0;
+
+	pair->data_done = pair->ack_done = 0;
+	if (!opts.dst_addr)
+		ret = post_recv_window(pair);
+
+	pthread_barrier_wait(&barrier);
+	if (!ret)
+		ret = run_windows(pair, 0, opts.warmup_iterations, total);
+
+	pthread_barrier_wait(&barrier);
+	if (pair->bep.id == 0)
+		agg_start = ft_gettime_ns();
+	pair->start = ft_gettime_ns();
+	if (!ret)
+		ret = run_windows(pair, opts.warmup_iterations,
+				  opts.iterations, total);
+	pair->end = ft_gettime_ns();
+
+	pthread_barrier_wait(&barrier);
+	if (pair->bep.id == 0)
+		agg_end = ft_gettime_ns();
+
+	pair->ret = ret;
+	return NULL;
+}
+
+static double msgs_per_sec(uint64_t start, uint64_t end, size_t pairs)
+{
+	double msgs = (double) pairs * opts.iterations * opts.window_size;
+
+	return end > start ? msgs * 1e9 / (end - start) : 0;
+}
+
+static void show_rate(void)
+{
+	static int header = 1;
+	char str[FT_STR_LEN];
+	double rate, min = 0, max = 0, sum = 0, agg;
+	int i;
+
+	if (header) {
+		printf("%-8s%-8s%-8s%-8s%8s %14s%14s%14s%14s%10s\n",
+		       "bytes", "window", "pairs", "iters", "time",
+		       "msgs/sec", "min/pair", "avg/pair", "max/pair",
+		       "MB/sec");
+		header = 0;
+	}
+
+	for (i = 0; i < num_pairs; i++) {
+		rate = msgs_per_sec(pargs[i].start, pargs[i].end, 1);
+		min = i ? MIN(min, rate) : rate;
+		max = MAX(max, rate);
+		sum += rate;
+	}
+	agg = msgs_per_sec(agg_start, agg_end, num_pairs);
+
+	printf("%-8s", size_str(str, xfer_size));
+	printf("%-8d", opts.window_size);
+	printf("%-8zu", num_pairs);
+	printf("%-8s", cnt_str(str, opts.iterations));
+	printf("%8.2fs %14.0f%14.0f%14.0f%14.0f%10.2f\n",
+	       (agg_end - agg_start) / 1e9, agg, min, sum / num_pairs, max,
+	       agg * xfer_size / 1e6);
+
+	for (i = 0; show_all_pairs && i < num_pairs; i++) {
+		printf("  pair %-4d %14.0f msgs/sec\n", i,
+		       msgs_per_sec(pargs[i].start, pargs[i].end, 1));
+	}
+}
+
+static int run_size(void)
+{
+	int i, ret = 0;
+
+	for (i = 0; i < num_pairs; i++) {
+		pargs[i].ret = 0;
+		ret = alloc_bufs(&pargs[i]);
+		if (ret)
+			goto out;
+	}
+
+	for (i = 0; i < num_pairs; i++) {
+		ret = pthread_create(&pargs[i].thread, NULL, msg_rate_thread,
+				     &pargs[i]);
+		if (ret) {
+			printf("pthread_create failed: %d\n", ret);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	for (i = 0; i < num_pairs; i++) {
+		pthread_join(pargs[i].thread, NULL);
+		if (pargs[i].ret && !ret)
+			ret = pargs[i].ret;
+	}
+
+	if (!ret)
+		show_rate();
+out:
+	for (i = 0; i < num_pairs; i++)
+		free_bufs(&pargs[i]);
+	return ret;
+}
+
+static int run_test(void)
+{
+	int i, ret;
+
+	if (opts.options & FT_OPT_SIZE) {
+		xfer_size = opts.transfer_size;
+		if (is_inject() && xfer_size > fi->tx_attr->inject_size) {
+			printf("size %zu exceeds inject size %zu\n",
+			       xfer_size, fi->tx_attr->inject_size);
+			return -FI_EINVAL;
+		}
+		return run_size();
+	}
+
+	for (i = 0; i < TEST_CNT; i++) {
+		if (!ft_use_size(i, opts.sizes_enabled))
+			continue;
+		xfer_size = test_size[i].size;
+		if (is_inject() && xfer_size > fi->tx_attr->inject_size)
+			continue;
+		ret = run_size();
+		if (ret)
+			return ret;
+	}
+
+	return FI_SUCCESS;
+}
+
+static int parse_op(const char *arg)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(msg_rate_op_str); i++) {
+		if (!strcasecmp(arg, msg_rate_op_str[i])) {
+			rate_op = i;
+			return 0;
+		}
+	}
+	return -FI_EINVAL;
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "\nrdm_msg_rate test options:\n");
+	FT_PRINT_OPTS_USAGE("-n <num pairs>",
+			    "number of endpoint pairs (threads) to use");
+	FT_PRINT_OPTS_USAGE("-o <op>",
+			    "send|inject|tagged|tinject (default: send)");
+	FT_PRINT_OPTS_USAGE("-A", "report the message rate of every pair");
+	FT_PRINT_OPTS_USAGE("-U", "enable FI_DELIVERY_COMPLETE");
+	fprintf(stderr, "Notice to user: Not all fabtests options are supported"
+		" by this test. If something isn't working check if the option"
+		" is supported before reporting a bug.\n");
+}
+
+int main(int argc, char **argv)
+{
+	int ret, op, i;
+
+	opts = INIT_OPTS;
+	opts.options |= FT_OPT_OOB_CTRL;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return EXIT_FAILURE;
+
+	while ((op = getopt_long(argc, argv, "n:o:AUh" CS_OPTS INFO_OPTS
+		BENCHMARK_OPTS, long_opts, &lopt_idx)) != -1) {
+		switch (op) {
+		default:
+			if (!ft_parse_long_opts(op, optarg))
+				continue;
+			ft_parse_benchmark_opts(op, optarg);
+			ft_parseinfo(op, optarg, hints, &opts);
+			ft_parsecsopts(op, optarg, &opts);
+			break;
+		case 'n':
+			num_pairs = atoi(optarg);
+			break;
+		case 'o':
+			if (parse_op(optarg)) {
+				fprintf(stderr, "Invalid operation type: "
+					"\"%s\"\n", optarg);
+				usage();
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'A':
+			show_all_pairs = true;
+			break;
+		case 'U':
+			hints->tx_attr->op_flags |= FI_DELIVERY_COMPLETE;
+			break;
+		case '?':
+		case 'h':
+			ft_csusage(argv[0], "Multi-pair message rate test for "
+				   "RDM endpoints.");
+			ft_benchmark_usage();
+			ft_longopts_usage();
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind < argc)
+		opts.dst_addr = argv[optind];
+
+	if (!num_pairs || opts.window_size < 1) {
+		fprintf(stderr, "number of pairs and window size must be "
+			"positive\n");
+		return EXIT_FAILURE;
+	}
+
+	hints->ep_attr->type = FI_EP_RDM;
+	hints->domain_attr->resource_mgmt = FI_RM_ENABLED;
+	hints->domain_attr->threading = FI_THREAD_DOMAIN;
+	hints->caps = is_tagged() ? FI_TAGGED : FI_MSG;
+	hints->mode |= FI_CONTEXT | FI_CONTEXT2;
+	hints->domain_attr->mr_mode = opts.mr_mode;
+	hints->addr_format = opts.address_format;
+
+	if (opts.options & FT_OPT_ENABLE_HMEM) {
+		hints->caps |= FI_HMEM;
+		hints->domain_attr->mr_mode |= FI_MR_HMEM;
+	}
+
+	ret = ft_init_oob();
+	if (ret)
+		goto out;
+
+	if (oob_sock >= 0 && opts.dst_addr) {
+		ret = ft_sock_sync(oob_sock, 0);
+		if (ret)
+			goto out;
+	}
+
+	ret = ft_hmem_init(opts.iface);
+	if (ret)
+		FT_PRINTERR("ft_hmem_init", ret);
+
+	ret = fi_getinfo(FT_FIVERSION, NULL, NULL, 0, hints, &fi);
+	if (ret) {
+		printf("fi_getinfo() failed: %d\n", ret);
+		goto out;
+	}
+
+	ret = init_ofi();
+	if (ret) {
+		printf("init ofi failed\n");
+		goto out;
+	}
+
+	if (oob_sock >= 0 && !opts.dst_addr) {
+		ret = ft_sock_sync(oob_sock, 0);
+		if (ret)
+			goto out;
+	}
+
+	for (i = 0; i < num_pairs; i++) {
+		ret = init_av(&pargs[i]);
+		if (ret) {
+			printf("init_av[%d] failed\n", i);
+			goto out;
+		}
+	}
+
+	ret = pthread_barrier_init(&barrier, NULL, num_pairs);
+	if (ret)
+		goto out;
+
+	printf("op: %s\n", msg_rate_op_str[rate_op]);
+	ret = run_test();
+
+	pthread_barrier_destroy(&barrier);
+out:
+	cleanup_ofi();
+	ft_close_oob();
+	return ft_exit_code(ret);
+}
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * rdm_trigger_chain.c
+ * Latency of a chain of dependent sends, driven by the host or by
+ * triggered operations.
+ *
+ * The client sends a chain of -n messages to the server, each of which may
+ * only start once the previous one completed, and the server replies once
+ * it received the whole chain.  In host mode, the client waits for each
+ * send completion before posting the next send.  In triggered mode, the
+ * client posts the whole chain up front on its endpoint: the first send
+ * directly, and each following send with a threshold on the tx counter,
+ * then only waits for the reply.  The reported time per iteration is the
+ * time from the first send until the reply arrived.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include <rdma/fi_errno.h>
+#include <rdma/fi_trigger.h>
+
+#include <shared.h>
+
+static int chain_len = 8;
+static struct fi_triggered_context *trigger_ctx;
+
+static int post_triggered(size_t size, uint64_t threshold,
+			  struct fi_triggered_context *ctx)
+{
+	struct iovec iov = {
+		.iov_base = tx_buf,
+		.iov_len = size,
+	};
+	struct fi_msg msg = {
+		.msg_iov = &iov,
+		.desc = &mr_desc,
+		.iov_count = 1,
+		.addr = remote_fi_addr,
+		.context = ctx,
+	};
+	int ret;
+
+	ctx->event_type = FI_TRIGGER_THRESHOLD;
+	ctx->trigger.threshold.cntr = txcntr;
+	ctx->trigger.threshold.threshold = threshold;
+
+	ret = fi_sendmsg(ep, &msg, FI_TRIGGER);
+	if (ret) {
+		FT_PRINTERR("fi_sendmsg", ret);
+		return ret;
+	}
+	tx_seq++;
+	return 0;
+}
+
+static int host_chain(void)
+{
+	int i, ret;
+
+	for (i = 0; i < chain_len; i++) {
+		ret = ft_tx(ep, remote_fi_addr, opts.transfer_size, &tx_ctx);
+		if (ret)
+			return ret;
+	}
+	return ft_rx(ep, opts.transfer_size);
+}
+
+/* Reading the rx CQ for the reply is what starts the triggered sends */
+static int triggered_chain(void)
+{
+	uint64_t start;
+	int i, ret;
+
+	start = fi_cntr_read(txcntr);
+	for (i = 1; i < chain_len; i++) {
+		ret = post_triggered(opts.transfer_size, start + i,
+				     &trigger_ctx[i]);
+		if (ret)
+			return ret;
+	}
+
+	ret = ft_post_tx(ep, remote_fi_addr, opts.transfer_size, NO_CQ_DATA,
+			 &tx_ctx);
+	if (ret)
+		return ret;
+
+	ret = ft_rx(ep, opts.transfer_size);
+	if (ret)
+		return ret;
+
+	return ft_get_tx_comp(tx_seq);
+}
+
+static int server_chain(void)
+{
+	int i, ret;
+
+	for (i = 0; i < chain_len; i++) {
+		ret = ft_rx(ep, opts.transfer_size);
+		if (ret)
+			return ret;
+	}
+	return ft_tx(ep, remote_fi_addr, opts.transfer_size, &tx_ctx);
+}
+
+static int run_chain(char *name, int (*chain)(void))
+{
+	int i, ret;
+
+	ret = ft_sync();
+	if (ret)
+		return ret;
+
+	if (!opts.dst_addr)
+		chain = server_chain;
+
+	for (i = 0; i < opts.iterations + opts.warmup_iterations; i++) {
+		if (i == opts.warmup_iterations)
+			ft_start();
+
+		ret = chain();
+		if (ret)
+			return ret;
+	}
+	ft_stop();
+
+	if (opts.dst_addr)
+		show_perf(name, opts.transfer_size, opts.iterations, &start,
+			  &end, 1);
+	return 0;
+}
+
+static int run_size(void)
+{
+	char name[FT_STR_LEN];
+	int ret;
+
+	snprintf(name, sizeof(name), "host chain of %d", chain_len);
+	ret = run_chain(name, host_chain);
+	if (ret)
+		return ret;
+
+	snprintf(name, sizeof(name), "triggered chain of %d", chain_len);
+	return run_chain(name, triggered_chain);
+}
+
+static int run(void)
+{
+	int i, ret;
+
+	trigger_ctx = calloc(chain_len, sizeof(*trigger_ctx));
+	if (!trigger_ctx)
+		return -FI_ENOMEM;
+
+	ret = ft_init_fabric();
+	if (ret)
+		goto out;
+
+	if (!(opts.options & FT_OPT_SIZE)) {
+		for (i = 0; i < TEST_CNT; i++) {
+			if (!ft_use_size(i, opts.sizes_enabled) ||
+			    test_size[i].size > fi->ep_attr->max_msg_size)
+				continue;
+			opts.transfer_size = test_size[i].size;
+			ret = run_size();
+			if (ret)
+				goto out;
+		}
+	} else {
+		ret = run_size();
+		if (ret)
+			goto out;
+	}
+
+	ft_finalize();
+out:
+	free(trigger_ctx);
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	int op, ret;
+
+	opts = INIT_OPTS;
+	opts.options = FT_OPT_RX_CQ | FT_OPT_TX_CNTR;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return EXIT_FAILURE;
+
+	while ((op = getopt_long(argc, argv, "n:h" CS_OPTS INFO_OPTS,
+				 long_opts, &lopt_idx)) != -1) {
+		switch (op) {
+		default:
+			if (!ft_parse_long_opts(op, optarg))
+				continue;
+			ft_parseinfo(op, optarg, hints, &opts);
+			ft_parsecsopts(op, optarg, &opts);
+			break;
+		case 'n':
+			chain_len = atoi(optarg);
+			if (chain_len < 1) {
+				fprintf(stderr, "chain length must be at "
+					"least 1\n");
+				return EXIT_FAILURE;
+			}
+			break;
+		case '?':
+		case 'h':
+			ft_csusage(argv[0], "Latency of host driven and "
+				   "triggered send chains.");
+			FT_PRINT_OPTS_USAGE("-n <length>", "number of sends "
+					    "in a chain (default: 8)");
+			ft_longopts_usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind < argc)
+		opts.dst_addr = argv[optind];
+
+	hints->ep_attr->type = FI_EP_RDM;
+	hints->caps = FI_MSG | FI_TRIGGER;
+	hints->domain_attr->mr_mode = opts.mr_mode;
+	hints->domain_attr->threading = FI_THREAD_DOMAIN;
+	hints->tx_attr->tclass = FI_TC_LOW_LATENCY;
+	hints->addr_format = opts.address_format;
+
+	ret = run();
+
+	ft_free_res();
+	return ft_exit_code(ret);
+}
@@ -104,6 +104,7 @@ const char *greeting = "Hello from Client!";
 char test_name[50] = "custom";
 int timeout = -1;
 struct timespec start, end;
+struct ft_hist lat_hist;
 
 int listen_sock = -1;
 int sock = -1;
@@ -442,6 +443,16 @@ int ft_get_dmabuf_from_iov(struct fi_mr_dmabuf *dmabuf,
 int ft_reg_mr(struct fi_info *fi, void *buf, size_t size, uint64_t access,
 	      uint64_t key, enum fi_hmem_iface iface, uint64_t device,
 	      struct fid_mr **mr, void **desc)
+{
+	return ft_reg_mr_ep(fi, domain, ep, buf, size, access, key, iface,
+			    device, mr, desc);
+}
+
+/* Registers buf with the given domain, binding it to ep if required */
+int ft_reg_mr_ep(struct fi_info *fi, struct fid_domain *dom,
+		 struct fid_ep *endpoint, void *buf, size_t size,
+		 uint64_t access, uint64_t key, enum fi_hmem_iface iface,
+		 uint64_t device, struct fid_mr **mr, void **desc)
 {
 	struct fi_mr_attr attr = {0};
 	struct iovec iov = {0};
@@ -473,7 +484,7 @@ int ft_reg_mr(struct fi_info *fi, void *buf, size_t size, uint64_t access,
 	}
 
 	ft_fill_mr_attr(&iov, &dmabuf, 1, access, key, iface, device, &attr, flags);
-	ret = fi_mr_regattr(domain, &attr, flags, mr);
+	ret = fi_mr_regattr(dom, &attr, flags, mr);
 	if (opts.options & FT_OPT_REG_DMABUF_MR)
 		ft_hmem_put_dmabuf_fd(iface, dmabuf_fd);
 	if (ret)
@@ -483,7 +494,7 @@ int ft_reg_mr(struct fi_info *fi, void *buf, size_t size, uint64_t access,
 		*desc = fi_mr_desc(*mr);
 
         if (fi->domain_attr->mr_mode & FI_MR_ENDPOINT) {
-		ret = fi_mr_bind(*mr, &ep->fid, 0);
+		ret = fi_mr_bind(*mr, &endpoint->fid, 0);
 		if (ret)
 			return ret;
 
@@ -3274,6 +3285,169 @@ int64_t get_elapsed(const struct timespec *b, const struct timespec *a,
 	return elapsed / p;
 }
 
+void ft_hist_reset(struct ft_hist *hist)
+{
+	memset(hist, 0, sizeof(*hist));
+	hist->min = UINT64_MAX;
+}
+
+static int ft_hist_index(uint64_t val)
+{
+	int shift = -FT_HIST_SUB_BITS;
+	uint64_t top;
+
+	if (val < FT_HIST_SUB_CNT)
+		return (int) val;
+
+	for (top = val; top > 1; top >>= 1)
+		shift++;
+
+	return (shift + 1) * FT_HIST_SUB_CNT +
+	       (int) ((val >> shift) - FT_HIST_SUB_CNT);
+}
+
+/* Midpoint of the range of values counted by a bucket */
+static uint64_t ft_hist_value(int index)
+{
+	int shift;
+
+	if (index < FT_HIST_SUB_CNT)
+		return index;
+
+	shift = index / FT_HIST_SUB_CNT - 1;
+	return ((uint64_t) (index % FT_HIST_SUB_CNT + FT_HIST_SUB_CNT) << shift) +
+	       ((1ULL << shift) >> 1);
+}
+
+void ft_hist_record(struct ft_hist *hist, uint64_t val)
+{
+	hist->bucket[ft_hist_index(val)]++;
+	hist->count++;
+	if (val < hist->min)
+		hist->min = val;
+	if (val > hist->max)
+		hist->max = val;
+}
+
+/* Smallest recorded value that at least pct percent of samples are <= to */
+uint64_t ft_hist_percentile(const struct ft_hist *hist, double pct)
+{
+	uint64_t rank, seen = 0;
+	double exact;
+	int i;
+
+	if (!hist->count)
+		return 0;
+
+	exact = pct * hist->count / 100;
+	rank = (uint64_t) exact;
+	if (rank < exact || !rank)
+		rank++;
+
+	for (i = 0; i < FT_HIST_BUCKETS; i++) {
+		seen += hist->bucket[i];
+		if (seen >= rank)
+			return MIN(MAX(ft_hist_value(i), hist->min), hist->max);
+	}
+	return hist->max;
+}
+
+static const struct {
+	const char *name;
+	double pct;
+} ft_lat_pcts[] = {
+	{ "p50", 50 },
+	{ "p90", 90 },
+	{ "p99", 99 },
+	{ "p99.9", 99.9 },
+};
+
+static const char *ft_prog_name(void)
+{
+	const char *name;
+
+	if (!opts.argv || !opts.argv[0])
+		return "";
+
+	name = strrchr(opts.argv[0], '/');
+	return name ? name + 1 : opts.argv[0];
+}
+
+static void show_perf_json(char *name, size_t tsize, int iters,
+			   int64_t elapsed, long long bytes,
+			   float usec_per_xfer)
+{
+	int i;
+
+	printf("{\"test\": \"%s\", ", ft_prog_name());
+	if (name)
+		printf("\"name\": \"%s\", ", name);
+	printf("\"bytes\": %zu, \"iterations\": %d, \"total_bytes\": %lld, "
+	       "\"time_sec\": %f, \"mb_per_sec\": %f, \"usec_per_xfer\": %f, "
+	       "\"mxfers_per_sec\": %f", tsize, iters, bytes,
+	       elapsed / 1000000.0, bytes / (1.0 * elapsed), usec_per_xfer,
+	       1.0 / usec_per_xfer);
+
+	if (lat_hist.count) {
+		printf(", \"latency_usec\": {\"count\": %" PRIu64
+		       ", \"min\": %.3f", lat_hist.count, lat_hist.min / 1000.0);
+		for (i = 0; i < ARRAY_SIZE(ft_lat_pcts); i++)
+			printf(", \"%s\": %.3f", ft_lat_pcts[i].name,
+			       ft_hist_percentile(&lat_hist,
+						  ft_lat_pcts[i].pct) / 1000.0);
+		printf(", \"max\": %.3f}", lat_hist.max / 1000.0);
+	}
+	printf("}\n");
+}
+
+static void show_perf_csv(char *name, size_t tsize, int iters,
+			  int64_t elapsed, long long bytes,
+			  float usec_per_xfer)
+{
+	static int header = 1;
+	int i;
+
+	if (header) {
+		printf("test,name,bytes,iterations,total_bytes,time_sec,"
+		       "mb_per_sec,usec_per_xfer,mxfers_per_sec,lat_count,"
+		       "lat_min_usec");
+		for (i = 0; i < ARRAY_SIZE(ft_lat_pcts); i++)
+			printf(",lat_%s_usec", ft_lat_pcts[i].name);
+		printf(",lat_max_usec\n");
+		header = 0;
+	}
+
+	printf("%s,%s,%zu,%d,%lld,%f,%f,%f,%f", ft_prog_name(),
+	       name ? name : "", tsize, iters, bytes, elapsed / 1000000.0,
+	       bytes / (1.0 * elapsed), usec_per_xfer, 1.0 / usec_per_xfer);
+
+	if (lat_hist.count) {
+		printf(",%" PRIu64 ",%.3f", lat_hist.count,
+		       lat_hist.min / 1000.0);
+		for (i = 0; i < ARRAY_SIZE(ft_lat_pcts); i++)
+			printf(",%.3f", ft_hist_percentile(&lat_hist,
+					ft_lat_pcts[i].pct) / 1000.0);
+		printf(",%.3f\n", lat_hist.max / 1000.0);
+	} else {
+		printf(",0");
+		for (i = 0; i < ARRAY_SIZE(ft_lat_pcts) + 2; i++)
+			printf(",");
+		printf("\n");
+	}
+}
+
+static void show_lat_hist(void)
+{
+	int i;
+
+	printf("%8s usec/xfer min %.2f", "", lat_hist.min / 1000.0);
+	for (i = 0; i < ARRAY_SIZE(ft_lat_pcts); i++)
+		printf(" %s %.2f", ft_lat_pcts[i].name,
+		       ft_hist_percentile(&lat_hist, ft_lat_pcts[i].pct) /
+		       1000.0);
+	printf(" max %.2f\n", lat_hist.max / 1000.0);
+}
+
 void show_perf(char *name, size_t tsize, int iters, struct timespec *start,
 		struct timespec *end, int xfers_per_iter)
 {
@@ -3283,6 +3457,18 @@ void show_perf(char *name, size_t tsize, int iters, struct timespec *start,
 	long long bytes = (long long) iters * tsize * xfers_per_iter;
 	float usec_per_xfer;
 
+	usec_per_xfer = ((float)elapsed / iters / xfers_per_iter);
+
+	if (opts.output_fmt == FT_OUTPUT_JSON) {
+		show_perf_json(name, tsize, iters, elapsed, bytes,
+			       usec_per_xfer);
+		return;
+	} else if (opts.output_fmt == FT_OUTPUT_CSV) {
+		show_perf_csv(name, tsize, iters, elapsed, bytes,
+			      usec_per_xfer);
+		return;
+	}
+
 	if (name) {
 		if (header) {
 			printf("%-50s%-8s%-8s%-8s%8s %10s%13s%13s\n",
@@ -3309,10 +3495,12 @@ void show_perf(char *name, size_t tsize, int iters, struct timespec *start,
 
 	printf("%-8s", size_str(str, bytes));
 
-	usec_per_xfer = ((float)elapsed / iters / xfers_per_iter);
 	printf("%8.2fs%10.2f%11.2f%11.2f\n",
 		elapsed / 1000000.0, bytes / (1.0 * elapsed),
 		usec_per_xfer, 1.0/usec_per_xfer);
+
+	if (lat_hist.count)
+		show_lat_hist();
 }
 
 void show_perf_mr(size_t tsize, int iters, struct timespec *start,
@@ -3324,6 +3512,11 @@ void show_perf_mr(size_t tsize, int iters, struct timespec *start,
 	int i;
 	float usec_per_xfer;
 
+	if (opts.output_fmt != FT_OUTPUT_TEXT) {
+		show_perf(NULL, tsize, iters, start, end, xfers_per_iter);
+		return;
+	}
+
 	if (header) {
 		printf("---\n");
 
@@ -3344,6 +3537,14 @@ void show_perf_mr(size_t tsize, int iters, struct timespec *start,
 	printf("MB/sec: %f, ", (total) / (1.0 * elapsed));
 	printf("usec/xfer: %f, ", usec_per_xfer);
 	printf("Mxfers/sec: %f", 1.0/usec_per_xfer);
+	if (lat_hist.count) {
+		printf(", lat_min_usec: %f", lat_hist.min / 1000.0);
+		for (i = 0; i < ARRAY_SIZE(ft_lat_pcts); i++)
+			printf(", lat_%s_usec: %f", ft_lat_pcts[i].name,
+			       ft_hist_percentile(&lat_hist,
+						  ft_lat_pcts[i].pct) / 1000.0);
+		printf(", lat_max_usec: %f", lat_hist.max / 1000.0);
+	}
 	printf(" }\n");
 }
 
@@ -4503,6 +4704,8 @@ void ft_longopts_usage()
 		"Run tests with FI_MORE");
 	FT_PRINT_OPTS_USAGE("--threading",
 		"threading model: safe|completion|domain (default:domain)");
+	FT_PRINT_OPTS_USAGE("--output <format>",
+		"benchmark result format: text|json|csv (default:text)");
 }
 
 int debug_assert;
@@ -4517,6 +4720,7 @@ struct option long_opts[] = {
 	{"max-msg-size", required_argument, NULL, LONG_OPT_MAX_MSG_SIZE},
 	{"use-fi-more", no_argument, NULL, LONG_OPT_USE_FI_MORE},
 	{"threading", required_argument, NULL, LONG_OPT_THREADING},
+	{"output", required_argument, NULL, LONG_OPT_OUTPUT},
 	{NULL, 0, NULL, 0},
 };
 
@@ -4577,6 +4781,16 @@ int ft_parse_long_opts(int op, char *optarg)
 	case LONG_OPT_THREADING:
 		opts.threading = ft_parse_threading_string(optarg);
 		return 0;
+	case LONG_OPT_OUTPUT:
+		if (!strcasecmp(optarg, "text"))
+			opts.output_fmt = FT_OUTPUT_TEXT;
+		else if (!strcasecmp(optarg, "json"))
+			opts.output_fmt = FT_OUTPUT_JSON;
+		else if (!strcasecmp(optarg, "csv"))
+			opts.output_fmt = FT_OUTPUT_CSV;
+		else
+			return EXIT_FAILURE;
+		return 0;
 	default:
 		return EXIT_FAILURE;
 	}
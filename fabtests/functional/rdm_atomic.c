@@ -48,6 +48,7 @@ static struct fi_context2 fi_ctx_atomic;
 
 static enum fi_datatype datatype;
 static int run_all_ops = 1, run_all_datatypes = 1;
+static size_t atomic_count = 1;
 
 static enum fi_op get_fi_op(char *op)
 {
@@ -148,6 +149,8 @@ static void print_opts_usage(char *name)
 	FT_PRINT_OPTS_USAGE("", "int32|uint32|int64|uint64|int128|uint128|"
 			    "float|double|float_complex|double_complex|");
 	FT_PRINT_OPTS_USAGE("", "long_double|long_double_complex (default: all)");
+	FT_PRINT_OPTS_USAGE("-n <count>", "number of elements per atomic op "
+			    "(default: 1)");
 	FT_PRINT_OPTS_USAGE("-v", "enables data_integrity checks");
 }
 
@@ -201,22 +204,22 @@ static int fill_data(enum ft_atomic_opcodes opcode)
 
 	switch (opcode) {
 	case FT_ATOMIC_COMPARE:
-		ft_fill_atomic(compare, 1, datatype);
+		ft_fill_atomic(compare, atomic_count, datatype);
 		/* fall through */
 	case FT_ATOMIC_FETCH:
 		ft_hmem_memset(opts.iface, opts.device, result, 0,
-			       datatype_to_size(datatype));
+			       opts.transfer_size);
 		/* fall through */
 	case FT_ATOMIC_BASE:
-		ft_fill_atomic(tx_buf, 1, datatype);
-		ft_fill_atomic(rx_buf, 1, datatype);
+		ft_fill_atomic(tx_buf, atomic_count, datatype);
+		ft_fill_atomic(rx_buf, atomic_count, datatype);
 		break;
 	default:
 		break;
 	}
 
 	ret = ft_hmem_copy_from(opts.iface, opts.device, cpy_dst,
-				rx_buf, datatype_to_size(datatype));
+				rx_buf, opts.transfer_size);
 	if (ret)
 		return ret;
 
@@ -248,8 +251,10 @@ static int handle_atomic_base_op(void)
 	ret = check_base_atomic_op(ep, op_type, datatype, &count);
 	if (ret)
 		return ret;
+	if (atomic_count > count)
+		return -FI_EOPNOTSUPP;
 
-	opts.transfer_size = datatype_to_size(datatype);
+	opts.transfer_size = datatype_to_size(datatype) * atomic_count;
 	ft_start();
 	for (i = 0; i < opts.iterations; i++) {
 		if (ft_check_opts(FT_OPT_VERIFY_DATA)) {
@@ -266,7 +271,7 @@ static int handle_atomic_base_op(void)
 			ft_sync();
 			ret = ft_check_atomic(FT_ATOMIC_BASE, op_type, datatype,
 					      tx_buf, cpy_dst, rx_buf, compare,
-					      result, 1);
+					      result, atomic_count);
 			if (ret)
 				return ret;
 		}
@@ -284,8 +289,10 @@ static int handle_atomic_fetch_op(void)
 	ret = check_fetch_atomic_op(ep, op_type, datatype, &count);
 	if (ret)
 		return ret;
+	if (atomic_count > count)
+		return -FI_EOPNOTSUPP;
 
-	opts.transfer_size = datatype_to_size(datatype);
+	opts.transfer_size = datatype_to_size(datatype) * atomic_count;
 	ft_start();
 	for (i = 0; i < opts.iterations; i++) {
 		if (ft_check_opts(FT_OPT_VERIFY_DATA)) {
@@ -302,7 +309,7 @@ static int handle_atomic_fetch_op(void)
 			ft_sync();
 			ret = ft_check_atomic(FT_ATOMIC_FETCH, op_type, datatype,
 					      tx_buf, cpy_dst, rx_buf, compare,
-					      result, 1);
+					      result, atomic_count);
 			if (ret)
 				return ret;
 		}
@@ -320,8 +327,10 @@ static int handle_atomic_compare_op(void)
 	ret = check_compare_atomic_op(ep, op_type, datatype, &count);
 	if (ret)
 		return ret;
+	if (atomic_count > count)
+		return -FI_EOPNOTSUPP;
 
-	opts.transfer_size = datatype_to_size(datatype);
+	opts.transfer_size = datatype_to_size(datatype) * atomic_count;
 	ft_start();
 	for (i = 0; i < opts.iterations; i++) {
 		if (ft_check_opts(FT_OPT_VERIFY_DATA)) {
@@ -338,7 +347,7 @@ static int handle_atomic_compare_op(void)
 			ft_sync();
 			ret = ft_check_atomic(FT_ATOMIC_COMPARE, op_type, datatype,
 					      tx_buf, cpy_dst, rx_buf, compare,
-					      result, 1);
+					      result, atomic_count);
 			if (ret)
 				return ret;
 		}
@@ -478,7 +487,9 @@ static int alloc_ep_res(struct fi_info *fi)
 		return -1;
 	}
 
-	ret = ft_hmem_alloc_host(opts.iface, &cpy_dst, opts.transfer_size);
+	ret = ft_hmem_alloc_host(opts.iface, &cpy_dst,
+				 MAX(opts.transfer_size, atomic_count *
+				     datatype_to_size(FI_LONG_DOUBLE_COMPLEX)));
 	if (ret)
 		return ret;
 
@@ -539,7 +550,7 @@ int main(int argc, char **argv)
 	if (!hints)
 		return EXIT_FAILURE;
 
-	while ((op = getopt_long(argc, argv, "ho:Uz:v" CS_OPTS INFO_OPTS,
+	while ((op = getopt_long(argc, argv, "ho:Un:z:v" CS_OPTS INFO_OPTS,
 				 long_opts, &lopt_idx)) != -1) {
 		switch (op) {
 		case 'o':
@@ -557,6 +568,13 @@ int main(int argc, char **argv)
 		case 'U':
 			hints->tx_attr->op_flags |= FI_DELIVERY_COMPLETE;
 			break;
+		case 'n':
+			atomic_count = strtoul(optarg, NULL, 0);
+			if (!atomic_count) {
+				print_opts_usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
 		case 'z':
 			if (!strncasecmp("all", optarg, 3)) {
 				run_all_datatypes = 1;
@@ -111,6 +111,12 @@ enum precision {
 	MILLI = 1000000,
 };
 
+enum ft_output_fmt {
+	FT_OUTPUT_TEXT = 0,
+	FT_OUTPUT_JSON,
+	FT_OUTPUT_CSV,
+};
+
 enum ft_comp_method {
 	FT_COMP_SPIN = 0,
 	FT_COMP_SREAD,
@@ -207,6 +213,7 @@ struct ft_opts {
 	int options;
 	enum ft_comp_method comp_method;
 	int machr;
+	enum ft_output_fmt output_fmt;
 	enum ft_rma_opcodes rma_op;
 	enum ft_cqdata_opcodes cqdata_op;
 	char *oob_port;
@@ -264,6 +271,31 @@ extern struct fi_rma_iov remote;
 
 extern char test_name[50];
 extern struct timespec start, end;
+
+/*
+ * Log-bucketed latency histogram.  Values below 2^FT_HIST_SUB_BITS are
+ * counted exactly; larger values fall into one of FT_HIST_SUB_CNT linear
+ * sub-buckets per power of two, bounding the relative error to ~3%.
+ */
+#define FT_HIST_SUB_BITS 5
+#define FT_HIST_SUB_CNT (1 << FT_HIST_SUB_BITS)
+#define FT_HIST_BUCKETS ((64 - FT_HIST_SUB_BITS + 1) * FT_HIST_SUB_CNT)
+
+struct ft_hist {
+	uint64_t count;
+	uint64_t min;
+	uint64_t max;
+	uint64_t last;
+	uint64_t bucket[FT_HIST_BUCKETS];
+};
+
+/* Per-transfer latency samples (ns) of the current timed loop */
+extern struct ft_hist lat_hist;
+
+void ft_hist_reset(struct ft_hist *hist);
+void ft_hist_record(struct ft_hist *hist, uint64_t val);
+uint64_t ft_hist_percentile(const struct ft_hist *hist, double pct);
+
 extern struct ft_opts opts;
 
 void ft_parseinfo(int op, char *optarg, struct fi_info *hints,
@@ -494,6 +526,10 @@ int ft_get_dmabuf_from_iov(struct fi_mr_dmabuf *dmabuf,
 int ft_reg_mr(struct fi_info *info, void *buf, size_t size, uint64_t access,
 	      uint64_t key, enum fi_hmem_iface iface, uint64_t device,
 	      struct fid_mr **mr, void **desc);
+int ft_reg_mr_ep(struct fi_info *fi, struct fid_domain *dom,
+		 struct fid_ep *endpoint, void *buf, size_t size,
+		 uint64_t access, uint64_t key, enum fi_hmem_iface iface,
+		 uint64_t device, struct fid_mr **mr, void **desc);
 void ft_freehints(struct fi_info *hints);
 void ft_free_res();
 void init_test(struct ft_opts *opts, char *test_name, size_t test_name_len);
@@ -519,7 +555,25 @@ static inline uint64_t ft_gettime_ms(void)
 static inline void ft_start(void)
 {
 	opts.options |= FT_OPT_ACTIVE;
+	ft_hist_reset(&lat_hist);
 	clock_gettime(CLOCK_MONOTONIC, &start);
+	lat_hist.last = start.tv_sec * 1000000000ULL + start.tv_nsec;
+}
+
+/*
+ * Record the time since the previous sample (or ft_start), spread over the
+ * given number of transfers.  Ignored outside of the timed loop.
+ */
+static inline void ft_lat_sample(int xfers)
+{
+	uint64_t now;
+
+	if (!(opts.options & FT_OPT_ACTIVE) || xfers <= 0)
+		return;
+
+	now = ft_gettime_ns();
+	ft_hist_record(&lat_hist, (now - lat_hist.last) / xfers);
+	lat_hist.last = now;
 }
 static inline void ft_stop(void)
 {
@@ -673,6 +727,7 @@ enum {
 	LONG_OPT_MAX_MSG_SIZE,
 	LONG_OPT_USE_FI_MORE,
 	LONG_OPT_THREADING,
+	LONG_OPT_OUTPUT,
 };
 
 extern int debug_assert;
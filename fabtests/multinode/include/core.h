@@ -87,6 +87,8 @@ struct pm_job_info {
 	enum multi_xfer transfer_method;
 	enum multi_pattern pattern;
 	enum multi_pm_type pm;
+	char		*replay_path;
+	bool		replay_paced;
 };
 
 struct multinode_xfer_state {
@@ -133,6 +133,8 @@ static int multi_setup_fabric(int argc, char **argv)
 	if (ret)
 		return ret;
 
+	/* Every pattern transfer is opts.transfer_size bytes. */
+	opts.options |= FT_OPT_SIZE;
 	ret = ft_alloc_msgs();
 	if (ret)
 		return ret;
@@ -135,14 +135,14 @@ static int wait_for_comp(void *ctx)
 	return err;
 }
 
-static int coll_setup_w_start_addr_stride(int start_addr, int stride)
+static int coll_setup_range(size_t start_addr, size_t end_addr, size_t stride)
 {
 	uint64_t done_flag;
 	int err;
 
 	av_set_attr.count = 0;
 	av_set_attr.start_addr = start_addr;
-	av_set_attr.end_addr = pm_job.num_ranks - 1;
+	av_set_attr.end_addr = end_addr;
 	av_set_attr.stride = stride;
 
 	if (!is_my_rank_participating())
@@ -169,12 +169,12 @@ static int coll_setup_w_start_addr_stride(int start_addr, int stride)
 
 static int coll_setup(void)
 {
-	return coll_setup_w_start_addr_stride(0, 1);
+	return coll_setup_range(0, pm_job.num_ranks - 1, 1);
 }
 
 static int coll_setup_w_stride(void)
 {
-	return coll_setup_w_start_addr_stride(1, 2);
+	return coll_setup_range(1, pm_job.num_ranks - 1, 2);
 }
 
 static int coll_teardown(void)
@@ -520,6 +520,234 @@ struct coll_test tests[] = {
 	},
 };
 
+static void *perf_src;
+static void *perf_dst;
+
+static ssize_t barrier_perf_post(size_t count, void *context)
+{
+	return fi_barrier(ep, coll_addr, context);
+}
+
+static ssize_t sum_all_reduce_perf_post(size_t count, void *context)
+{
+	return fi_allreduce(ep, perf_src, count, NULL, perf_dst, NULL,
+			    coll_addr, FI_UINT64, FI_SUM, 0, context);
+}
+
+static ssize_t all_gather_perf_post(size_t count, void *context)
+{
+	return fi_allgather(ep, perf_src, count, NULL, perf_dst, NULL,
+			    coll_addr, FI_UINT64, 0, context);
+}
+
+static ssize_t scatter_perf_post(size_t count, void *context)
+{
+	return fi_scatter(ep, pm_job.my_rank ? NULL : perf_src, count, NULL,
+			  perf_dst, NULL, coll_addr, 0, FI_UINT64, 0, context);
+}
+
+static ssize_t broadcast_perf_post(size_t count, void *context)
+{
+	return fi_broadcast(ep, perf_src, count, NULL, coll_addr, 0,
+			    FI_UINT64, 0, context);
+}
+
+struct coll_perf_test perf_tests[] = {
+	{
+		.name = "barrier",
+		.post = barrier_perf_post,
+		.coll_op = FI_BARRIER,
+		.op = FI_NOOP,
+		.datatype = FI_VOID,
+	},
+	{
+		.name = "allreduce",
+		.post = sum_all_reduce_perf_post,
+		.coll_op = FI_ALLREDUCE,
+		.op = FI_SUM,
+		.datatype = FI_UINT64,
+	},
+	{
+		.name = "allgather",
+		.post = all_gather_perf_post,
+		.coll_op = FI_ALLGATHER,
+		.op = FI_NOOP,
+		.datatype = FI_UINT64,
+	},
+	{
+		.name = "scatter",
+		.post = scatter_perf_post,
+		.coll_op = FI_SCATTER,
+		.op = FI_NOOP,
+		.datatype = FI_UINT64,
+	},
+	{
+		.name = "broadcast",
+		.post = broadcast_perf_post,
+		.coll_op = FI_BROADCAST,
+		.op = FI_NOOP,
+		.datatype = FI_UINT64,
+	},
+	{
+		.name = NULL,
+	},
+};
+
+/*
+ * Times opts.iterations back to back operations after opts.warmup_iterations
+ * untimed ones.  Every rank reports its average latency to rank 0, which
+ * prints the min/avg/max over the members and the algorithmic bandwidth,
+ * i.e. the per rank message size over the average latency.
+ */
+static int coll_perf_run(struct coll_perf_test *test, size_t members,
+			 size_t size)
+{
+	double lat = -1, min = -1, max = 0, sum = 0, *lats;
+	uint64_t done_flag, start = 0;
+	int i, ret = 0, err;
+
+	lats = calloc(pm_job.num_ranks, sizeof(*lats));
+	if (!lats)
+		return -FI_ENOMEM;
+
+	pm_barrier();
+	if (is_my_rank_participating()) {
+		coll_addr = fi_mc_addr(coll_mc);
+		for (i = 0; i < opts.warmup_iterations + opts.iterations; i++) {
+			if (i == opts.warmup_iterations)
+				start = ft_gettime_ns();
+
+			ret = (int) test->post(size / sizeof(uint64_t),
+					       &done_flag);
+			if (ret) {
+				FT_PRINTERR("collective post", ret);
+				break;
+			}
+
+			ret = wait_for_comp(&done_flag);
+			if (ret)
+				break;
+		}
+		lat = (ft_gettime_ns() - start) / 1e3 / opts.iterations;
+	}
+
+	/* every rank takes part in the gather so that none are left behind */
+	err = pm_allgather(&lat, lats, sizeof(lat));
+	if (!ret)
+		ret = err;
+	if (ret || pm_job.my_rank)
+		goto out;
+
+	for (i = 0; i < pm_job.num_ranks; i++) {
+		if (lats[i] < 0)
+			continue;
+		if (min < 0 || lats[i] < min)
+			min = lats[i];
+		if (lats[i] > max)
+			max = lats[i];
+		sum += lats[i];
+	}
+
+	PRINTF("%-12s %8zu %10zu %8d %12.2f %12.2f %12.2f", test->name,
+	       members, size, opts.iterations, min, sum / members, max);
+	if (size)
+		PRINTF(" %12.2f\n", size / (sum / members));
+	else
+		PRINTF(" %12s\n", "-");
+out:
+	free(lats);
+	return ret;
+}
+
+static int coll_perf_members(size_t members)
+{
+	struct coll_perf_test *test;
+	int i, ret;
+
+	ret = coll_setup_range(0, members - 1, 1);
+	if (ret)
+		return ret;
+
+	for (test = perf_tests; test->name && !ret; test++) {
+		if (test_query(test->coll_op, test->op, test->datatype)) {
+			FT_DEBUG("Skipping %s: operation not supported.",
+				 test->name);
+			continue;
+		}
+
+		if (test->coll_op == FI_BARRIER) {
+			ret = coll_perf_run(test, members, 0);
+			continue;
+		}
+
+		if (opts.options & FT_OPT_SIZE) {
+			ret = coll_perf_run(test, members, opts.transfer_size);
+			continue;
+		}
+
+		for (i = 0; i < TEST_CNT && !ret; i++) {
+			if (!ft_use_size(i, opts.sizes_enabled) ||
+			    test_size[i].size % sizeof(uint64_t))
+				continue;
+
+			ret = coll_perf_run(test, members, test_size[i].size);
+		}
+	}
+
+	pm_barrier();
+	if (!ret)
+		ret = coll_teardown();
+	return ret;
+}
+
+/*
+ * Benchmark mode (-T): sweeps the member count over the powers of two up to
+ * the number of ranks, which is always included, and the message size over
+ * the sizes selected with -S, or runs only the size given with -S <size>.
+ */
+static int coll_perf_run_all(void)
+{
+	size_t members, max_size = 0;
+	int i, ret;
+
+	if (opts.options & FT_OPT_SIZE) {
+		if (opts.transfer_size % sizeof(uint64_t)) {
+			FT_ERR("size must be a multiple of %zu", sizeof(uint64_t));
+			return -FI_EINVAL;
+		}
+		max_size = opts.transfer_size;
+	} else {
+		for (i = 0; i < TEST_CNT; i++) {
+			if (ft_use_size(i, opts.sizes_enabled))
+				max_size = MAX(max_size, test_size[i].size);
+		}
+	}
+
+	perf_src = calloc(pm_job.num_ranks, max_size);
+	perf_dst = calloc(pm_job.num_ranks, max_size);
+	if (!perf_src || !perf_dst) {
+		ret = -FI_ENOMEM;
+		goto out;
+	}
+	memset(perf_src, pm_job.my_rank, pm_job.num_ranks * max_size);
+
+	PRINTF("%-12s %8s %10s %8s %12s %12s %12s %12s\n", "collective",
+	       "members", "bytes", "iters", "min usec", "avg usec",
+	       "max usec", "MB/sec");
+
+	members = MIN(pm_job.num_ranks, 2);
+	for (ret = 0; !ret; members *= 2) {
+		members = MIN(members, pm_job.num_ranks);
+		ret = coll_perf_members(members);
+		if (members == pm_job.num_ranks)
+			break;
+	}
+out:
+	free(perf_src);
+	free(perf_dst);
+	return ret;
+}
+
 static inline void setup_hints(void)
 {
 	hints->ep_attr->type = FI_EP_RDM;
@@ -613,6 +841,11 @@ int multinode_run_tests(int argc, char **argv)
 	if (ret)
 		return ret;
 
+	if (ft_check_opts(FT_OPT_PERF)) {
+		ret = coll_perf_run_all();
+		goto out;
+	}
+
 	for (test = tests; test->run && !ret; test++) {
 		FT_DEBUG("Running Test: %s", test->name);
 		ret = test_query(test->coll_op, test->op, test->datatype);
@@ -0,0 +1,868 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Replays the files written by the ofi_hook_record provider.  Rank r
+ * replays the r-th record file, in name order, over a single RDM endpoint.
+ * The recorded peers are mapped to ranks by matching the addresses that
+ * each process inserted into its AV against the endpoint names recorded
+ * by the other processes.  Each recorded completion makes the replay wait
+ * for the completion of the replayed operation with the same recorded
+ * context, which preserves the dependencies between operations.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <poll.h>
+#include <sys/stat.h>
+
+#include <rdma/fi_errno.h>
+#include <rdma/fi_domain.h>
+#include <rdma/fabric.h>
+#include <rdma/fi_endpoint.h>
+#include <rdma/fi_cm.h>
+#include <rdma/fi_rma.h>
+#include <rdma/fi_tagged.h>
+#include <record_file.h>
+
+#include <core.h>
+#include <shared.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#define REPLAY_NAME_MAX		256
+#define REPLAY_CQ_BATCH		16
+
+struct replay_name {
+	uint64_t	len;
+	uint8_t		name[REPLAY_NAME_MAX];
+};
+
+struct replay_peer {
+	uint64_t	rec_addr;
+	size_t		rank;
+};
+
+struct replay_op {
+	struct fi_context2	ctx;
+	struct ofi_record_entry	*entry;
+	fi_addr_t		addr;
+	size_t			rank;
+	bool			done;
+};
+
+static struct {
+	void			*file;
+	size_t			file_size;
+	struct ofi_record_entry	**entries;
+	size_t			entry_cnt;
+	struct replay_op	*ops;
+	size_t			op_cnt;
+	struct replay_name	name;
+	struct replay_peer	*peers;
+	size_t			peer_cnt;
+	struct replay_op	**pending;
+	size_t			pending_cnt;
+	size_t			max_len;
+	bool			rma;
+	size_t			size;
+	void			*buf;
+	void			*tx_buf;
+	void			*rx_buf;
+	struct fid_mr		*mr;
+	void			*desc;
+	struct fi_rma_iov	*remote;
+	size_t			comps;
+	size_t			errors;
+	uint64_t		bytes;
+} replay;
+
+static int replay_filter(const struct dirent *entry)
+{
+	size_t len = strlen(entry->d_name);
+
+	return len > 4 && !strcmp(entry->d_name + len - 4, ".rec");
+}
+
+static int replay_get_path(char *path, size_t size)
+{
+	struct dirent **names;
+	struct stat st;
+	int i, n, ret = 0;
+
+	if (stat(pm_job.replay_path, &st)) {
+		FT_ERR("cannot access %s\n", pm_job.replay_path);
+		return -errno;
+	}
+
+	if (!S_ISDIR(st.st_mode)) {
+		snprintf(path, size, "%s", pm_job.replay_path);
+		return 0;
+	}
+
+	n = scandir(pm_job.replay_path, &names, replay_filter, alphasort);
+	if (n < 0)
+		return -errno;
+
+	if (n <= pm_job.my_rank) {
+		FT_ERR("%s holds %d record files for %zu ranks\n",
+			pm_job.replay_path, n, pm_job.num_ranks);
+		ret = -FI_EINVAL;
+	} else {
+		snprintf(path, size, "%s/%s", pm_job.replay_path,
+			 names[pm_job.my_rank]->d_name);
+	}
+
+	for (i = 0; i < n; i++)
+		free(names[i]);
+	free(names);
+	return ret;
+}
+
+static int replay_read_file(const char *path)
+{
+	FILE *file;
+	long size;
+	int ret = 0;
+
+	file = fopen(path, "r");
+	if (!file) {
+		FT_ERR("cannot open %s\n", path);
+		return -errno;
+	}
+
+	if (fseek(file, 0, SEEK_END) || (size = ftell(file)) < 0 ||
+	    fseek(file, 0, SEEK_SET)) {
+		ret = -errno;
+		goto out;
+	}
+
+	replay.file_size = size;
+	replay.file = malloc(replay.file_size);
+	if (!replay.file) {
+		ret = -FI_ENOMEM;
+		goto out;
+	}
+
+	if (fread(replay.file, 1, replay.file_size, file) != replay.file_size) {
+		FT_ERR("error reading %s\n", path);
+		ret = -FI_EIO;
+	}
+out:
+	fclose(file);
+	return ret;
+}
+
+static int replay_add_peer(struct ofi_record_entry *entry)
+{
+	struct replay_peer *peers;
+
+	peers = realloc(replay.peers, (replay.peer_cnt + 1) * sizeof(*peers));
+	if (!peers)
+		return -FI_ENOMEM;
+
+	replay.peers = peers;
+	replay.peers[replay.peer_cnt].rec_addr = entry->addr;
+	replay.peers[replay.peer_cnt++].rank = SIZE_MAX;
+	return 0;
+}
+
+static int replay_load(void)
+{
+	struct ofi_record_header *hdr;
+	struct ofi_record_entry *entry;
+	char path[PATH_MAX];
+	size_t off, i;
+	int ret;
+
+	ret = replay_get_path(path, sizeof(path));
+	if (ret)
+		return ret;
+
+	ret = replay_read_file(path);
+	if (ret)
+		return ret;
+
+	hdr = replay.file;
+	if (replay.file_size < sizeof(*hdr) || hdr->magic != OFI_RECORD_MAGIC ||
+	    hdr->version != OFI_RECORD_VERSION ||
+	    hdr->entry_size != sizeof(*entry)) {
+		FT_ERR("%s is not a supported record file\n", path);
+		return -FI_EINVAL;
+	}
+
+	/* first pass counts the entries, the second one indexes them, and
+	 * a partially written last entry is ignored */
+	for (i = 0; i < 2; i++) {
+		replay.entry_cnt = 0;
+		replay.op_cnt = 0;
+		for (off = sizeof(*hdr); off + sizeof(*entry) <= replay.file_size;
+		     off += sizeof(*entry)) {
+			entry = (struct ofi_record_entry *)
+				((char *) replay.file + off);
+			if (entry->op >= OFI_RECORD_OP_MAX) {
+				FT_ERR("%s is corrupted\n", path);
+				return -FI_EINVAL;
+			}
+
+			if ((entry->op == OFI_RECORD_NAME ||
+			     entry->op == OFI_RECORD_AV_INSERT) &&
+			    off + sizeof(*entry) + entry->len > replay.file_size)
+				break;
+
+			if (i) {
+				replay.entries[replay.entry_cnt] = entry;
+				if (entry->op > OFI_RECORD_AV_INSERT &&
+				    entry->op < OFI_RECORD_CQ_COMP)
+					replay.ops[replay.op_cnt].entry = entry;
+			}
+			replay.entry_cnt++;
+
+			if (entry->op == OFI_RECORD_NAME ||
+			    entry->op == OFI_RECORD_AV_INSERT) {
+				off += (entry->len + 7) & ~7ULL;
+				continue;
+			}
+			if (entry->op < OFI_RECORD_CQ_COMP)
+				replay.op_cnt++;
+		}
+
+		if (i)
+			break;
+
+		replay.entries = calloc(replay.entry_cnt,
+					sizeof(*replay.entries));
+		replay.ops = calloc(replay.op_cnt, sizeof(*replay.ops));
+		replay.pending = calloc(replay.op_cnt, sizeof(*replay.pending));
+		if (!replay.entries || !replay.ops || !replay.pending)
+			return -FI_ENOMEM;
+	}
+
+	for (i = 0; i < replay.entry_cnt; i++) {
+		entry = replay.entries[i];
+		switch (entry->op) {
+		case OFI_RECORD_NAME:
+			/* all endpoints are replayed over one endpoint, which
+			 * takes the identity of the first recorded one */
+			if (replay.name.len || entry->len > REPLAY_NAME_MAX)
+				break;
+			replay.name.len = entry->len;
+			memcpy(replay.name.name, entry + 1, entry->len);
+			break;
+		case OFI_RECORD_AV_INSERT:
+			ret = replay_add_peer(entry);
+			if (ret)
+				return ret;
+			break;
+		case OFI_RECORD_READ:
+		case OFI_RECORD_WRITE:
+		case OFI_RECORD_INJECT_WRITE:
+			replay.rma = true;
+			/* fall through */
+		default:
+			if (entry->op < OFI_RECORD_CQ_COMP)
+				replay.max_len = MAX(replay.max_len, entry->len);
+			break;
+		}
+	}
+
+	printf("rank %zu: replaying %zu operations from %s\n",
+	       pm_job.my_rank, replay.op_cnt, path);
+	return 0;
+}
+
+/*
+ * Compares the port and address of two socket addresses.  An endpoint
+ * bound to a wildcard address reports it in its name, while its peers
+ * insert a routable address, so a wildcard name matches any address.
+ */
+static bool replay_sockaddr_match(const struct replay_name *name,
+				  const struct replay_name *addr)
+{
+	struct sockaddr_storage sn, sa;
+	struct sockaddr_in *sin_n, *sin_a;
+	struct sockaddr_in6 *sin6_n, *sin6_a;
+
+	if (name->len != addr->len || name->len < sizeof(struct sockaddr_in) ||
+	    name->len > sizeof(sn))
+		return false;
+
+	memcpy(&sn, name->name, name->len);
+	memcpy(&sa, addr->name, addr->len);
+	if (sn.ss_family != sa.ss_family)
+		return false;
+
+	switch (sn.ss_family) {
+	case AF_INET:
+		sin_n = (struct sockaddr_in *) &sn;
+		sin_a = (struct sockaddr_in *) &sa;
+		return sin_n->sin_port == sin_a->sin_port &&
+		       (sin_n->sin_addr.s_addr == htonl(INADDR_ANY) ||
+			sin_n->sin_addr.s_addr == sin_a->sin_addr.s_addr);
+	case AF_INET6:
+		if (name->len < sizeof(struct sockaddr_in6))
+			return false;
+		sin6_n = (struct sockaddr_in6 *) &sn;
+		sin6_a = (struct sockaddr_in6 *) &sa;
+		return sin6_n->sin6_port == sin6_a->sin6_port &&
+		       (!memcmp(&sin6_n->sin6_addr, &in6addr_any,
+				sizeof(in6addr_any)) ||
+			!memcmp(&sin6_n->sin6_addr, &sin6_a->sin6_addr,
+				sizeof(sin6_a->sin6_addr)));
+	default:
+		return false;
+	}
+}
+
+/*
+ * Providers may prefix their names with a URI scheme that is not part of
+ * the AV address, such as shm.
+ */
+static bool replay_suffix_match(const struct replay_name *name,
+				const struct replay_name *addr)
+{
+	return addr->len && addr->len < name->len &&
+	       !memcmp(name->name + name->len - addr->len, addr->name,
+		       addr->len);
+}
+
+/*
+ * A recorded peer is mapped to the rank whose recorded name is the
+ * inserted address, or else to the only rank whose name matches it as a
+ * socket address or by suffix.  Peers that cannot be mapped to exactly
+ * one rank fail the replay.
+ */
+static int replay_map_peers(void)
+{
+	struct replay_name *names, addr;
+	struct ofi_record_entry *entry;
+	size_t i, j, k, r, match_cnt;
+	int ret;
+
+	names = calloc(pm_job.num_ranks, sizeof(*names));
+	if (!names)
+		return -FI_ENOMEM;
+
+	ret = pm_allgather(&replay.name, names, sizeof(*names));
+	if (ret) {
+		FT_PRINTERR("error exchanging recorded names", ret);
+		goto out;
+	}
+
+	for (i = 0, j = 0; i < replay.entry_cnt; i++) {
+		entry = replay.entries[i];
+		if (entry->op != OFI_RECORD_AV_INSERT)
+			continue;
+
+		addr.len = MIN(entry->len, REPLAY_NAME_MAX);
+		memcpy(addr.name, entry + 1, addr.len);
+		for (r = 0; r < pm_job.num_ranks; r++) {
+			if (names[r].len && names[r].len == addr.len &&
+			    !memcmp(names[r].name, addr.name, addr.len))
+				break;
+		}
+		for (k = 0, match_cnt = 0;
+		     r == pm_job.num_ranks && k < pm_job.num_ranks; k++) {
+			if (replay_suffix_match(&names[k], &addr) ||
+			    (names[k].len &&
+			     replay_sockaddr_match(&names[k], &addr))) {
+				replay.peers[j].rank = k;
+				match_cnt++;
+			}
+		}
+		if (r < pm_job.num_ranks) {
+			replay.peers[j].rank = r;
+		} else if (match_cnt != 1) {
+			FT_ERR("cannot map recorded peer %" PRIu64 " to a rank, "
+			       "%zu ranks match\n", entry->addr, match_cnt);
+			ret = -FI_ENOENT;
+			goto out;
+		}
+		j++;
+	}
+
+	for (i = 0; i < replay.op_cnt; i++) {
+		entry = replay.ops[i].entry;
+		replay.ops[i].addr = FI_ADDR_UNSPEC;
+		replay.ops[i].rank = pm_job.num_ranks == 2 ?
+				     !pm_job.my_rank : pm_job.my_rank;
+		if (entry->addr == FI_ADDR_UNSPEC)
+			continue;
+
+		/* the most recent insertion of an fi_addr_t is the valid one */
+		for (j = replay.peer_cnt; j > 0; j--) {
+			if (replay.peers[j - 1].rec_addr == entry->addr) {
+				replay.ops[i].rank = replay.peers[j - 1].rank;
+				break;
+			}
+		}
+		if (!j) {
+			FT_ERR("operation %zu targets peer %" PRIu64 ", which "
+			       "was never inserted\n", i, entry->addr);
+			ret = -FI_ENOENT;
+			goto out;
+		}
+		replay.ops[i].addr = pm_job.fi_addrs[replay.ops[i].rank];
+	}
+out:
+	free(names);
+	return ret;
+}
+
+static int replay_alloc_bufs(void)
+{
+	struct fi_rma_iov remote = { 0 };
+	int ret;
+
+	replay.size = MAX(replay.max_len, 1);
+	replay.buf = calloc(2, replay.size);
+	if (!replay.buf)
+		return -FI_ENOMEM;
+
+	replay.tx_buf = replay.buf;
+	replay.rx_buf = (char *) replay.buf + replay.size;
+
+	ret = ft_reg_mr(fi, replay.buf, 2 * replay.size,
+			ft_info_to_mr_access(fi), FT_MR_KEY, opts.iface,
+			opts.device, &replay.mr, &replay.desc);
+	if (ret)
+		return ret;
+
+	replay.remote = calloc(pm_job.num_ranks, sizeof(*replay.remote));
+	if (!replay.remote)
+		return -FI_ENOMEM;
+
+	/* RMA operations target the receive half of the peer buffer */
+	if (replay.mr) {
+		remote.addr = fi->domain_attr->mr_mode & FI_MR_VIRT_ADDR ?
+			      (uintptr_t) replay.rx_buf : replay.size;
+		remote.key = fi_mr_key(replay.mr);
+		remote.len = replay.size;
+	}
+
+	ret = pm_allgather(&remote, replay.remote, sizeof(remote));
+	if (ret)
+		FT_PRINTERR("error exchanging rma_iovs", ret);
+	return ret;
+}
+
+static int replay_setup_fabric(void)
+{
+	char my_name[FT_MAX_CTRL_MSG];
+	bool *rma;
+	size_t len, i;
+	int ret;
+
+	rma = calloc(pm_job.num_ranks, sizeof(*rma));
+	if (!rma)
+		return -FI_ENOMEM;
+
+	ret = pm_allgather(&replay.rma, rma, sizeof(*rma));
+	for (i = 0; !ret && i < pm_job.num_ranks; i++)
+		replay.rma |= rma[i];
+	free(rma);
+	if (ret)
+		return ret;
+
+	hints->ep_attr->type = FI_EP_RDM;
+	hints->mode = FI_CONTEXT | FI_CONTEXT2;
+	hints->domain_attr->mr_mode = opts.mr_mode;
+	hints->caps = FI_MSG | FI_TAGGED;
+	if (replay.rma)
+		hints->caps |= FI_RMA;
+
+	ret = ft_getinfo(hints, &fi);
+	if (ret)
+		return ret;
+
+	ret = ft_open_fabric_res();
+	if (ret)
+		return ret;
+
+	opts.av_size = pm_job.num_ranks;
+	cq_attr.format = FI_CQ_FORMAT_CONTEXT;
+	ret = ft_alloc_active_res(fi);
+	if (ret)
+		return ret;
+
+	ret = ft_enable_ep(ep, eq, av, txcq, rxcq, txcntr, rxcntr, rma_cntr);
+	if (ret)
+		return ret;
+
+	len = FT_MAX_CTRL_MSG;
+	ret = fi_getname(&ep->fid, (void *) my_name, &len);
+	if (ret) {
+		FT_PRINTERR("error determining local endpoint name", ret);
+		return ret;
+	}
+
+	pm_job.name_len = FT_MAX_CTRL_MSG;
+	pm_job.names = malloc(pm_job.name_len * pm_job.num_ranks);
+	pm_job.fi_addrs = calloc(pm_job.num_ranks, sizeof(*pm_job.fi_addrs));
+	if (!pm_job.names || !pm_job.fi_addrs)
+		return -FI_ENOMEM;
+
+	ret = pm_allgather(my_name, pm_job.names, pm_job.name_len);
+	if (ret) {
+		FT_PRINTERR("error exchanging addresses", ret);
+		return ret;
+	}
+
+	for (i = 0; i < pm_job.num_ranks; i++) {
+		ret = fi_av_insert(av, (char *) pm_job.names +
+				   i * pm_job.name_len, 1,
+				   &pm_job.fi_addrs[i], 0, NULL);
+		if (ret != 1) {
+			FT_ERR("unable to insert all addresses into AV table\n");
+			return -FI_EOTHER;
+		}
+	}
+
+	ret = replay_map_peers();
+	if (ret)
+		return ret;
+
+	return replay_alloc_bufs();
+}
+
+static int replay_progress_cq(struct fid_cq *cq)
+{
+	struct fi_cq_entry comp[REPLAY_CQ_BATCH];
+	struct fi_cq_err_entry err_entry = { 0 };
+	ssize_t ret, i;
+
+	ret = fi_cq_read(cq, comp, REPLAY_CQ_BATCH);
+	if (ret > 0) {
+		for (i = 0; i < ret; i++)
+			((struct replay_op *) comp[i].op_context)->done = true;
+		replay.comps += ret;
+		return 0;
+	}
+
+	if (ret == -FI_EAVAIL) {
+		ret = fi_cq_readerr(cq, &err_entry, 0);
+		if (ret < 0)
+			return (int) ret;
+
+		if (err_entry.op_context)
+			((struct replay_op *) err_entry.op_context)->done = true;
+		replay.errors++;
+		return 0;
+	}
+
+	return ret == -FI_EAGAIN ? 0 : (int) ret;
+}
+
+static int replay_progress(void)
+{
+	int ret;
+
+	ret = replay_progress_cq(txcq);
+	if (ret || rxcq == txcq)
+		return ret;
+
+	return replay_progress_cq(rxcq);
+}
+
+static ssize_t replay_post(struct replay_op *op)
+{
+	struct ofi_record_entry *entry = op->entry;
+	struct fi_rma_iov *remote = &replay.remote[op->rank];
+	void *ctx = &op->ctx;
+	size_t len = entry->len;
+
+	/* injects that exceed the replay provider limit are sent instead */
+	switch (entry->op) {
+	case OFI_RECORD_SEND:
+		return fi_send(ep, replay.tx_buf, len, replay.desc, op->addr,
+			       ctx);
+	case OFI_RECORD_INJECT:
+		if (len > fi->tx_attr->inject_size)
+			return fi_send(ep, replay.tx_buf, len, replay.desc,
+				       op->addr, ctx);
+		return fi_inject(ep, replay.tx_buf, len, op->addr);
+	case OFI_RECORD_RECV:
+		return fi_recv(ep, replay.rx_buf, len, replay.desc, op->addr,
+			       ctx);
+	case OFI_RECORD_TSEND:
+		return fi_tsend(ep, replay.tx_buf, len, replay.desc, op->addr,
+				entry->tag, ctx);
+	case OFI_RECORD_TINJECT:
+		if (len > fi->tx_attr->inject_size)
+			return fi_tsend(ep, replay.tx_buf, len, replay.desc,
+					op->addr, entry->tag, ctx);
+		return fi_tinject(ep, replay.tx_buf, len, op->addr,
+				  entry->tag);
+	case OFI_RECORD_TRECV:
+		return fi_trecv(ep, replay.rx_buf, len, replay.desc, op->addr,
+				entry->tag, entry->aux, ctx);
+	case OFI_RECORD_READ:
+		return fi_read(ep, replay.rx_buf, len, replay.desc, op->addr,
+			       remote->addr, remote->key, ctx);
+	case OFI_RECORD_WRITE:
+		return fi_write(ep, replay.tx_buf, len, replay.desc, op->addr,
+				remote->addr, remote->key, ctx);
+	case OFI_RECORD_INJECT_WRITE:
+		if (len > fi->tx_attr->inject_size)
+			return fi_write(ep, replay.tx_buf, len, replay.desc,
+					op->addr, remote->addr, remote->key,
+					ctx);
+		return fi_inject_write(ep, replay.tx_buf, len, op->addr,
+				       remote->addr, remote->key);
+	default:
+		return -FI_EINVAL;
+	}
+}
+
+static bool replay_has_comp(struct replay_op *op)
+{
+	switch (op->entry->op) {
+	case OFI_RECORD_INJECT:
+	case OFI_RECORD_TINJECT:
+	case OFI_RECORD_INJECT_WRITE:
+		return op->entry->len > fi->tx_attr->inject_size;
+	default:
+		return true;
+	}
+}
+
+static int replay_issue(struct replay_op *op)
+{
+	ssize_t ret;
+	int err;
+
+	do {
+		ret = replay_post(op);
+		if (ret == -FI_EAGAIN) {
+			err = replay_progress();
+			if (err)
+				return err;
+		}
+	} while (ret == -FI_EAGAIN);
+
+	if (ret) {
+		FT_PRINTERR("replayed operation", ret);
+		return (int) ret;
+	}
+
+	replay.bytes += op->entry->len;
+	if (replay_has_comp(op))
+		replay.pending[replay.pending_cnt++] = op;
+	return 0;
+}
+
+/* Waits for the oldest pending operation posted with the recorded context */
+static int replay_wait(struct ofi_record_entry *entry)
+{
+	struct replay_op *op;
+	size_t i;
+	int ret;
+
+	for (i = 0; i < replay.pending_cnt; i++) {
+		if (replay.pending[i]->entry->context == entry->context)
+			break;
+	}
+	if (i == replay.pending_cnt)
+		return 0;
+
+	op = replay.pending[i];
+	while (!op->done) {
+		ret = replay_progress();
+		if (ret)
+			return ret;
+	}
+
+	memmove(&replay.pending[i], &replay.pending[i + 1],
+		(replay.pending_cnt - i - 1) * sizeof(*replay.pending));
+	replay.pending_cnt--;
+	return 0;
+}
+
+static int replay_pace(struct ofi_record_entry *entry, uint64_t start,
+		       uint64_t base)
+{
+	int ret;
+
+	while (ft_gettime_ns() - start < entry->ns - base) {
+		ret = replay_progress();
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+static int replay_run(uint64_t *elapsed)
+{
+	struct ofi_record_entry *entry;
+	uint64_t start, base;
+	size_t i, op = 0;
+	int ret = 0;
+
+	base = replay.entry_cnt ? replay.entries[0]->ns : 0;
+	start = ft_gettime_ns();
+	for (i = 0; i < replay.entry_cnt && !ret; i++) {
+		entry = replay.entries[i];
+		if (pm_job.replay_paced) {
+			ret = replay_pace(entry, start, base);
+			if (ret)
+				break;
+		}
+
+		switch (entry->op) {
+		case OFI_RECORD_NAME:
+		case OFI_RECORD_AV_INSERT:
+			break;
+		case OFI_RECORD_CQ_COMP:
+		case OFI_RECORD_CQ_ERR:
+			ret = replay_wait(entry);
+			break;
+		default:
+			ret = replay_issue(&replay.ops[op++]);
+			break;
+		}
+	}
+	*elapsed = ft_gettime_ns() - start;
+	return ret;
+}
+
+/*
+ * Barrier over the OOB sockets that keeps progressing the endpoint, since
+ * peers may still depend on data that is queued locally.
+ */
+static int replay_barrier(void)
+{
+	struct pollfd pfd;
+	char ch = 'a';
+	size_t i;
+	int ret;
+
+	if (!pm_job.clients) {
+		if (socket_send(pm_job.sock, &ch, 1, 0) < 0)
+			return -FI_EIO;
+		pfd.fd = pm_job.sock;
+		pfd.events = POLLIN;
+		while (!poll(&pfd, 1, 0)) {
+			ret = replay_progress();
+			if (ret)
+				return ret;
+		}
+		return socket_recv(pm_job.sock, &ch, 1, 0) == 1 ? 0 : -FI_EIO;
+	}
+
+	for (i = 0; i < pm_job.num_ranks - 1; i++) {
+		pfd.fd = pm_job.clients[i];
+		pfd.events = POLLIN;
+		while (!poll(&pfd, 1, 0)) {
+			ret = replay_progress();
+			if (ret)
+				return ret;
+		}
+		if (socket_recv(pm_job.clients[i], &ch, 1, 0) != 1)
+			return -FI_EIO;
+	}
+
+	for (i = 0; i < pm_job.num_ranks - 1; i++) {
+		if (socket_send(pm_job.clients[i], &ch, 1, 0) < 0)
+			return -FI_EIO;
+	}
+	return 0;
+}
+
+static void replay_report(uint64_t elapsed)
+{
+	struct ofi_record_entry *last;
+	uint64_t recorded = 0;
+
+	if (replay.entry_cnt) {
+		last = replay.entries[replay.entry_cnt - 1];
+		recorded = last->ns - replay.entries[0]->ns;
+	}
+
+	printf("rank %zu: %zu operations, %" PRIu64 " bytes, %zu completions, "
+	       "%zu errors in %.3f ms (recorded %.3f ms)\n", pm_job.my_rank,
+	       replay.op_cnt, replay.bytes, replay.comps, replay.errors,
+	       elapsed / 1e6, recorded / 1e6);
+}
+
+static void replay_free_res(void)
+{
+	FT_CLOSE_FID(replay.mr);
+	free(replay.buf);
+	free(replay.remote);
+	free(replay.pending);
+	free(replay.ops);
+	free(replay.peers);
+	free(replay.entries);
+	free(replay.file);
+	free(pm_job.names);
+	free(pm_job.fi_addrs);
+}
+
+int multinode_run_tests(int argc, char **argv)
+{
+	uint64_t elapsed = 0;
+	int ret;
+
+	if (!pm_job.replay_path) {
+		FT_ERR("no record file given, use -r <path>\n");
+		return -FI_EINVAL;
+	}
+
+	ret = replay_load();
+	if (ret)
+		goto out;
+
+	ret = replay_setup_fabric();
+	if (ret)
+		goto out;
+
+	pm_barrier();
+	ret = replay_run(&elapsed);
+	if (ret)
+		goto out;
+
+	ret = replay_barrier();
+	if (!ret)
+		replay_report(elapsed);
+out:
+	if (ret)
+		printf("failed\n");
+	else
+		printf("passed\n");
+
+	replay_free_res();
+	ft_free_res();
+	return ft_exit_code(ret);
+}
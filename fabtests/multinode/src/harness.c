@@ -354,8 +354,8 @@ int main(int argc, char **argv)
 	int c, ret;
 
 	opts = INIT_OPTS;
-	opts.options |= FT_OPT_SIZE | FT_OPT_OOB_ADDR_EXCH |
-			FT_OPT_ADDR_IS_OOB | FT_OPT_DISABLE_TAG_VALIDATION;
+	opts.options |= FT_OPT_OOB_ADDR_EXCH | FT_OPT_ADDR_IS_OOB |
+			FT_OPT_DISABLE_TAG_VALIDATION;
 
 	pm_job.clients = NULL;
 	pm_job.pattern = -1;
@@ -365,7 +365,7 @@ int main(int argc, char **argv)
 	if (!hints)
 		return EXIT_FAILURE;
 
-	while ((c = getopt(argc, argv, "n:x:z:u:Ths:I:" INFO_OPTS)) != -1) {
+	while ((c = getopt(argc, argv, "n:x:z:u:r:tThs:I:S:w:" INFO_OPTS)) != -1) {
 		switch (c) {
 		default:
 			ft_parse_addr_opts(c, optarg, &opts);
@@ -375,6 +375,10 @@ int main(int argc, char **argv)
 			opts.options |= FT_OPT_ITER;
 			opts.iterations = atoi(optarg);
 			break;
+		case 'S':
+		case 'w':
+			ft_parsecsopts(c, optarg, &opts);
+			break;
 		case 'n':
 			pm_job.num_ranks = atoi(optarg);
 			break;
@@ -391,6 +395,12 @@ int main(int argc, char **argv)
 			/* setup the process manager type */
 			pm_job.pm = parse_pm(optarg);
 			break;
+		case 'r':
+			pm_job.replay_path = optarg;
+			break;
+		case 't':
+			pm_job.replay_paced = true;
+			break;
 		case '?':
 		case 'h':
 			fprintf(stderr, "Usage:\n");
@@ -408,9 +418,21 @@ int main(int argc, char **argv)
 			FT_PRINT_OPTS_USAGE("-I <iters>", "number of iterations");
 			FT_PRINT_OPTS_USAGE("-T", "pass to enable performance "
 					    "timing mode");
+			FT_PRINT_OPTS_USAGE("-S <size>", "message size, or "
+					    "all, r:start:inc:end, l:s1,s2,... "
+					    "sizes to sweep in fi_multinode_coll "
+					    "performance mode");
+			FT_PRINT_OPTS_USAGE("-w <iters>", "number of warmup "
+					    "iterations");
 			FT_PRINT_OPTS_USAGE("-z <pattern>", "full_mesh, ring, "
 					    "gather, or broadcast pattern. "
 					    "Default: All\n");
+			FT_PRINT_OPTS_USAGE("-r <path>", "record file, or "
+					    "folder of record files, to replay "
+					    "(fi_multinode_replay)");
+			FT_PRINT_OPTS_USAGE("-t", "replay at the recorded "
+					    "speed instead of as fast as "
+					    "possible");
 
 			fprintf(stderr, "General Fabtests options: \n\n");
 			FT_PRINT_OPTS_USAGE("-f <fabric>", "fabric name");
@@ -175,6 +175,7 @@ short_tests=(
 	"fi_rdm_atomic -I 5 -o all -U"
 	"fi_rdm_atomic -I 5 -o all -v"
 	"fi_rdm_atomic -I 5 -o all -U -v"
+	"fi_rdm_atomic -I 5 -o all -v -n 20000"
 	"fi_rdm_cntr_pingpong -I 5"
 	"fi_multi_recv -e rdm -I 5"
 	"fi_multi_recv -e msg -I 5"
@@ -190,6 +191,7 @@ short_tests=(
 	"fi_rdm_tagged_bw -I 5 -U"
 	"fi_rdm_tagged_bw -I 5 -v"
 	"fi_rdm_tagged_bw -I 5 -v -U"
+	"fi_rdm_conn_storm -I 2"
 	"fi_dgram_pingpong -I 5"
 )
 
@@ -232,6 +234,8 @@ standard_tests=(
 	"fi_rdm_tagged_bw -U"
 	"fi_rdm_tagged_bw -v"
 	"fi_rdm_tagged_bw -v -U"
+	"fi_rdm_conn_storm"
+	"fi_rdm_trigger_chain"
 	"fi_dgram_pingpong"
 	"fi_dgram_pingpong -k"
 )
@@ -260,6 +264,7 @@ multinode_tests=(
 	"fi_multinode -x msg"
 	"fi_multinode -x rma"
 	"fi_multinode_coll"
+	"fi_multinode_coll -T -I 100"
 )
 
 threaded_tests=(
@@ -269,6 +274,11 @@ threaded_tests=(
 	"fi_rdm_bw_mt -n 16 -g"
 	"fi_rdm_bw_mt -n 32"
 	"fi_rdm_bw_mt -n 32 -g"
+	"fi_rdm_msg_rate -n 8"
+	"fi_rdm_msg_rate -n 8 -o inject"
+	"fi_rdm_msg_rate -n 8 -o tagged"
+	"fi_rdm_incast -n 8"
+	"fi_rdm_incast -n 8 -o tagged"
 )
 
 prov_efa_tests=( \
@@ -766,6 +776,28 @@ function multinode_test {
 	fi
 }
 
+# Records a multinode run with the record hook, then replays its record
+# files with fi_multinode_replay.  Every rank must see the record folder,
+# so the test only runs when the server and client are the same host.
+function record_replay_test {
+	local num_procs=$1
+	local env="$EXPORT_ENV"
+	local rec_path
+
+	[[ "$SERVER" != "$CLIENT" ]] && return
+	is_excluded "fi_multinode_replay" && return
+	# fi_multinode_replay is only built from the libfabric tree
+	${SERVER_CMD} "which ${BIN_PATH}fi_multinode_replay" &> /dev/null || return
+
+	rec_path=$(${SERVER_CMD} "mktemp -d /tmp/fabtests.record.XXXXXX")
+	EXPORT_ENV="$env env FI_HOOK=record"
+	EXPORT_ENV="$EXPORT_ENV FI_OFI_HOOK_RECORD_BASEPATH=$rec_path"
+	multinode_test "fi_multinode -x msg -z ring -I 10" $num_procs
+	EXPORT_ENV="$env"
+	multinode_test "fi_multinode_replay -r $rec_path/$(id -u)" $num_procs
+	${SERVER_CMD} "rm -rf $rec_path"
+}
+
 function prov_efa_test {
 	for test in "${prov_efa_tests[@]}"; do
 		cs_test "$test"
@@ -858,6 +890,7 @@ function main {
 			for test in "${multinode_tests[@]}"; do
 					multinode_test "$test" 3
 			done
+			record_replay_test 3
 		;;
 		threaded)
 			for test in "${threaded_tests[@]}"; do
@@ -0,0 +1,109 @@
+#!/bin/bash
+#
+# Compare the bandwidth of the tcp provider with copied and zero copy sends.
+#
+# fi_msg_bw is run for each send mode, and the median MB/sec reported for
+# each message size over all runs is printed side by side:
+#   copy     - zero copy disabled
+#   zcopy    - zero copy for all sends above the fixed threshold
+#   adaptive - zero copy with the threshold tuned at runtime
+#
+# The server runs on the local host.  The client runs locally, or on the
+# host given with -c through ssh.  Note that sends over the loopback device
+# are always copied by the kernel, which disables zero copy.
+
+bin_path=""
+server_addr="127.0.0.1"
+client_host=""
+threshold=0
+size_opt="-S all"
+iters=""
+runs=3
+
+usage() {
+	echo "Usage: $0 [OPTIONS]"
+	echo "Options:"
+	echo -e " -b\tpath to the fabtests binaries (default: PATH)"
+	echo -e " -s\taddress used to reach the server (default: $server_addr)"
+	echo -e " -c\thost to run the client on through ssh (default: local)"
+	echo -e " -t\tzero copy threshold in bytes (default: $threshold)"
+	echo -e " -S\tfi_msg_bw message size option (default: all sizes)"
+	echo -e " -I\tnumber of iterations per message size"
+	echo -e " -r\tnumber of runs of each mode (default: $runs)"
+	echo -e " -h\tdisplay this help output"
+	exit 1
+}
+
+while getopts ":b:s:c:t:S:I:r:h" opt; do
+	case $opt in
+	b) bin_path="${OPTARG%/}/" ;;
+	s) server_addr=$OPTARG ;;
+	c) client_host=$OPTARG ;;
+	t) threshold=$OPTARG ;;
+	S) size_opt="-S $OPTARG" ;;
+	I) iters="-I $OPTARG" ;;
+	r) runs=$OPTARG ;;
+	*) usage ;;
+	esac
+done
+
+run_mode() {
+	local mode=$1 run=$2 env out server_pid
+
+	case $mode in
+	copy) env="FI_TCP_ZEROCOPY_SIZE=-1" ;;
+	zcopy) env="FI_TCP_ZEROCOPY_SIZE=$threshold FI_TCP_ZEROCOPY_TUNE=0" ;;
+	adaptive) env="FI_TCP_ZEROCOPY_SIZE=$threshold FI_TCP_ZEROCOPY_TUNE=1" ;;
+	esac
+
+	env $env ${bin_path}fi_msg_bw -p tcp $size_opt $iters > /dev/null &
+	server_pid=$!
+	sleep 1
+
+	if [ -n "$client_host" ]; then
+		out=$(ssh $client_host "env $env ${bin_path}fi_msg_bw -p tcp \
+			$size_opt $iters $server_addr")
+	else
+		out=$(env $env ${bin_path}fi_msg_bw -p tcp $size_opt $iters \
+			$server_addr)
+	fi
+	wait $server_pid
+
+	# keep the size and MB/sec columns of the result lines
+	echo "$out" | awk '$1 ~ /^[0-9]/ { print $1, $5 }' > "$tmpdir/$mode.$run"
+}
+
+# print the size and the median MB/sec of all runs of a mode
+median() {
+	local mode=$1
+
+	paste -d' ' "$tmpdir/$mode".* | awk '{
+		n = 0
+		for (i = 2; i <= NF; i += 2) {
+			for (j = ++n; j > 1 && bw[j - 1] > $i + 0; j--)
+				bw[j] = bw[j - 1]
+			bw[j] = $i + 0
+		}
+		print $1, n % 2 ? bw[(n + 1) / 2] : (bw[n / 2] + bw[n / 2 + 1]) / 2
+	}' > "$tmpdir/$mode"
+}
+
+tmpdir=$(mktemp -d)
+trap 'rm -rf "$tmpdir"' EXIT
+
+# interleave the modes, so that they see the same system noise
+for ((run = 0; run < runs; run++)); do
+	for mode in copy zcopy adaptive; do
+		run_mode $mode $run || exit 1
+	done
+done
+
+for mode in copy zcopy adaptive; do
+	median $mode
+done
+
+printf "%-8s %12s %12s %12s\n" "bytes" "copy MB/s" "zcopy MB/s" \
+	"adapt MB/s"
+join <(nl -w1 -s' ' "$tmpdir/copy") <(nl -w1 -s' ' "$tmpdir/zcopy") | \
+	join - <(nl -w1 -s' ' "$tmpdir/adaptive") | \
+	awk '{ printf "%-8s %12s %12s %12s\n", $2, $3, $5, $7 }'
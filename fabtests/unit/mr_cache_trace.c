@@ -0,0 +1,404 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <getopt.h>
+#include <limits.h>
+#include <stdio.h>
+#include <sys/mman.h>
+
+#include <rdma/fi_ext.h>
+
+#include "unit_common.h"
+#include "shared.h"
+
+/*
+ * Replays a trace of memory registrations against a provider's MR cache
+ * and reports the hit rate and registration time, so that the eviction
+ * policies selected through FI_MR_CACHE_POLICY can be compared on the same
+ * access pattern.  Each trace entry registers and then closes a region of a
+ * single buffer, given as an offset and a length.
+ */
+
+struct trace_op {
+	size_t offset;
+	size_t len;
+};
+
+static struct trace_op *trace;
+static size_t trace_cnt, trace_max;
+static char *trace_buf;
+static size_t trace_buf_size;
+static char *workload = "mixed";
+static size_t op_cnt = 100000;
+static uint64_t seed = 1;
+
+#define HOT_BUF_CNT	64
+#define HOT_BUF_SIZE	(64 * 1024)
+#define SCAN_BUF_SIZE	(256 * 1024)
+#define HUGE_BUF_SIZE	(32 * 1024 * 1024)
+#define TRACE_BUF_SIZE	(256 * 1024 * 1024)
+
+static uint64_t trace_rand(void)
+{
+	seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+	return seed >> 33;
+}
+
+static int trace_add(size_t offset, size_t len)
+{
+	struct trace_op *tmp;
+
+	if (trace_cnt == trace_max) {
+		trace_max = trace_max ? trace_max * 2 : 1024;
+		tmp = realloc(trace, trace_max * sizeof(*trace));
+		if (!tmp)
+			return -FI_ENOMEM;
+		trace = tmp;
+	}
+
+	trace[trace_cnt].offset = offset;
+	trace[trace_cnt++].len = len;
+	if (offset + len > trace_buf_size)
+		trace_buf_size = offset + len;
+	return 0;
+}
+
+/* Hot buffers between 4 KiB and 64 KiB, reused at random */
+static int trace_hot(void)
+{
+	size_t i, buf;
+
+	for (i = 0; i < op_cnt; i++) {
+		buf = trace_rand() % HOT_BUF_CNT;
+		if (trace_add(buf * HOT_BUF_SIZE,
+			      4096 << (buf % 5)))
+			return -FI_ENOMEM;
+	}
+	return 0;
+}
+
+/* One-time sequential pass over distinct buffers */
+static int trace_scan(void)
+{
+	size_t i, base = HOT_BUF_CNT * HOT_BUF_SIZE;
+	size_t scan_cnt = (TRACE_BUF_SIZE - base) / SCAN_BUF_SIZE;
+
+	for (i = 0; i < op_cnt; i++) {
+		if (trace_add(base + (i % scan_cnt) * SCAN_BUF_SIZE,
+			      SCAN_BUF_SIZE))
+			return -FI_ENOMEM;
+	}
+	return 0;
+}
+
+/*
+ * Hot buffers interleaved with a scan, and an occasional huge region,
+ * which evict the hot buffers from an LRU cache.
+ */
+static int trace_mixed(void)
+{
+	size_t i, buf, scan = 0, base = HOT_BUF_CNT * HOT_BUF_SIZE;
+	size_t scan_cnt = (TRACE_BUF_SIZE - base - HUGE_BUF_SIZE) /
+			  SCAN_BUF_SIZE;
+	int ret;
+
+	for (i = 0; i < op_cnt; i++) {
+		if (i % 1024 == 1023) {
+			ret = trace_add(TRACE_BUF_SIZE - HUGE_BUF_SIZE,
+					HUGE_BUF_SIZE);
+		} else if (i % 4 == 3) {
+			ret = trace_add(base + (scan++ % scan_cnt) *
+					SCAN_BUF_SIZE, SCAN_BUF_SIZE);
+		} else {
+			buf = trace_rand() % HOT_BUF_CNT;
+			ret = trace_add(buf * HOT_BUF_SIZE, 4096 << (buf % 5));
+		}
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+static int trace_read(const char *path)
+{
+	unsigned long long offset, len;
+	char line[256];
+	FILE *file;
+	int ret = 0;
+
+	file = fopen(path, "r");
+	if (!file) {
+		FT_PRINTERR("fopen", -errno);
+		return -errno;
+	}
+
+	while (fgets(line, sizeof(line), file)) {
+		if (line[0] == '#' || line[0] == '\n')
+			continue;
+
+		if (sscanf(line, "%llu %llu", &offset, &len) != 2 || !len) {
+			fprintf(stderr, "invalid trace entry: %s", line);
+			ret = -FI_EINVAL;
+			break;
+		}
+
+		ret = trace_add(offset, len);
+		if (ret)
+			break;
+	}
+
+	fclose(file);
+	return ret;
+}
+
+static int trace_write(const char *path)
+{
+	FILE *file;
+	size_t i;
+
+	file = fopen(path, "w");
+	if (!file) {
+		FT_PRINTERR("fopen", -errno);
+		return -errno;
+	}
+
+	fprintf(file, "# offset length\n");
+	for (i = 0; i < trace_cnt; i++)
+		fprintf(file, "%zu %zu\n", trace[i].offset, trace[i].len);
+
+	fclose(file);
+	return 0;
+}
+
+static int trace_gen(void)
+{
+	if (!strcasecmp(workload, "hot"))
+		return trace_hot();
+	if (!strcasecmp(workload, "scan"))
+		return trace_scan();
+	if (!strcasecmp(workload, "mixed"))
+		return trace_mixed();
+
+	fprintf(stderr, "unknown workload: %s\n", workload);
+	return -FI_EINVAL;
+}
+
+static int mr_cache_stats(struct fid *cache_fid,
+			  struct fi_ops_mr_cache_stats *stats_ops,
+			  struct fi_mr_cache_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	return stats_ops ? stats_ops->query(cache_fid, stats) : 0;
+}
+
+static int trace_replay(void)
+{
+	struct fi_ops_mr_cache_stats *stats_ops = NULL;
+	struct fi_mr_cache_stats before, after;
+	struct fid *cache_fid = NULL;
+	struct fid_mr *trace_mr;
+	struct fi_mr_attr attr = {0};
+	struct iovec iov;
+	uint64_t searches, hits;
+	int64_t elapsed;
+	size_t i;
+	int ret;
+
+	ret = fi_open(FI_VERSION(1, 14), "mr_cache", NULL, 0, 0,
+		      &cache_fid, NULL);
+	if (!ret) {
+		ret = fi_open_ops(cache_fid, FI_MR_CACHE_STATS_OPS, 0,
+				  (void **) &stats_ops, NULL);
+		if (ret)
+			stats_ops = NULL;
+	}
+
+	trace_buf = mmap(NULL, trace_buf_size, PROT_READ | PROT_WRITE,
+			 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (trace_buf == MAP_FAILED) {
+		ret = -errno;
+		FT_PRINTERR("mmap", ret);
+		trace_buf = NULL;
+		goto out;
+	}
+	memset(trace_buf, 0, trace_buf_size);
+
+	attr.mr_iov = &iov;
+	attr.iov_count = 1;
+	attr.access = ft_info_to_mr_access(fi);
+	attr.requested_key = FT_MR_KEY;
+
+	mr_cache_stats(cache_fid, stats_ops, &before);
+	ft_start();
+	for (i = 0; i < trace_cnt; i++) {
+		iov.iov_base = trace_buf + trace[i].offset;
+		iov.iov_len = trace[i].len;
+		ret = fi_mr_regattr(domain, &attr, 0, &trace_mr);
+		if (ret) {
+			FT_PRINTERR("fi_mr_regattr", ret);
+			goto out;
+		}
+
+		ret = fi_close(&trace_mr->fid);
+		if (ret) {
+			FT_PRINTERR("fi_close", ret);
+			goto out;
+		}
+	}
+	ft_stop();
+	mr_cache_stats(cache_fid, stats_ops, &after);
+
+	elapsed = get_elapsed(&start, &end, NANO);
+	searches = after.searches - before.searches;
+	hits = after.hits - before.hits;
+
+	printf("%-12s %10s %10s %10s %10s %12s\n", "workload", "regs",
+	       "searches", "hit rate", "evictions", "ns/reg");
+	printf("%-12s %10zu %10" PRIu64 " ", workload, trace_cnt, searches);
+	if (searches)
+		printf("%9.2f%% ", 100.0 * hits / searches);
+	else
+		printf("%10s ", "n/a");
+	printf("%10" PRIu64 " %12.1f\n", after.evictions - before.evictions,
+	       (double) elapsed / trace_cnt);
+
+	if (!searches)
+		printf("Provider does not use the MR cache, or the cache "
+		       "statistics are not available\n");
+out:
+	if (trace_buf)
+		munmap(trace_buf, trace_buf_size);
+	if (cache_fid)
+		fi_close(cache_fid);
+	return ret;
+}
+
+static void usage(char *name)
+{
+	ft_unit_usage(name,
+		"Replay a trace of memory registrations and report the MR\n"
+		"cache hit rate, evictions and average registration time.\n"
+		"Each entry registers and closes a region of one buffer.\n"
+		"Run with different FI_MR_CACHE_POLICY, FI_MR_CACHE_MAX_COUNT\n"
+		"and FI_MR_CACHE_MAX_SIZE settings to compare eviction\n"
+		"policies on the same trace.");
+	FT_PRINT_OPTS_USAGE("-t <file>", "replay the trace in file, one "
+			    "'<offset> <length>' entry per line");
+	FT_PRINT_OPTS_USAGE("-w <workload>", "generate a trace instead: "
+			    "hot, scan or mixed (default: mixed)");
+	FT_PRINT_OPTS_USAGE("-n <count>", "number of registrations to "
+			    "generate (default: 100000)");
+	FT_PRINT_OPTS_USAGE("-S <seed>", "seed of the generated trace");
+	FT_PRINT_OPTS_USAGE("-o <file>", "write the trace to file");
+}
+
+int main(int argc, char **argv)
+{
+	char *trace_path = NULL, *out_path = NULL;
+	int ret = 0;
+	int op;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return EXIT_FAILURE;
+
+	while ((op = getopt(argc, argv, FAB_OPTS "ht:w:n:S:o:")) != -1) {
+		switch (op) {
+		default:
+			ft_parseinfo(op, optarg, hints, &opts);
+			break;
+		case 't':
+			trace_path = optarg;
+			break;
+		case 'w':
+			workload = optarg;
+			break;
+		case 'n':
+			op_cnt = strtoul(optarg, NULL, 0);
+			break;
+		case 'S':
+			seed = strtoull(optarg, NULL, 0);
+			break;
+		case 'o':
+			out_path = optarg;
+			break;
+		case '?':
+		case 'h':
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	ret = trace_path ? trace_read(trace_path) : trace_gen();
+	if (ret)
+		goto out;
+
+	if (!trace_cnt) {
+		fprintf(stderr, "empty trace\n");
+		ret = -FI_EINVAL;
+		goto out;
+	}
+
+	if (out_path) {
+		ret = trace_write(out_path);
+		if (ret)
+			goto out;
+	}
+
+	hints->mode = ~0;
+	hints->domain_attr->mode = ~0;
+	hints->domain_attr->mr_mode = ~OFI_MR_DEPRECATED;
+	hints->caps |= FI_MSG | FI_RMA;
+
+	ret = fi_getinfo(FT_FIVERSION, NULL, 0, 0, hints, &fi);
+	if (ret) {
+		hints->caps &= ~FI_RMA;
+		ret = fi_getinfo(FT_FIVERSION, NULL, 0, 0, hints, &fi);
+		if (ret) {
+			FT_PRINTERR("fi_getinfo", ret);
+			goto out;
+		}
+	}
+
+	ret = ft_open_fabric_res();
+	if (ret)
+		goto out;
+
+	printf("Replaying %zu registrations on fabric %s domain %s\n",
+	       trace_cnt, fi->fabric_attr->name, fi->domain_attr->name);
+
+	ret = trace_replay();
+out:
+	free(trace);
+	ft_free_res();
+	return ft_exit_code(ret);
+}
@@ -336,6 +336,13 @@ void fi_param_fini(void);
 void fi_param_undefine(const struct fi_provider *provider);
 void ofi_remove_comma(char *buffer);
 void ofi_dump_sysconfig(void);
+uint64_t ofi_sysconfig_hash(uint64_t hash);
+
+void ofi_getinfo_cache_init(void);
+void ofi_getinfo_cache_fini(void);
+int ofi_getinfo_cache(const struct fi_provider *prov, uint32_t version,
+		      const char *node, const char *service, uint64_t flags,
+		      const struct fi_info *hints, struct fi_info **info);
 
 const char *ofi_hex_str(const uint8_t *data, size_t len);
 
@@ -433,6 +440,8 @@ uint8_t ofi_msb(uint64_t num);
 uint8_t ofi_lsb(uint64_t num);
 
 extern size_t ofi_universe_size;
+extern size_t ofi_cq_shards;
+extern size_t ofi_wait_spin;
 extern int ofi_av_remove_cleanup;
 extern char *ofi_offload_coll_prov_name;
 extern int ofi_prefer_sysconfig;
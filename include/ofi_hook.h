@@ -64,7 +64,8 @@ enum ofi_hook_class {
 	HOOK_DEBUG,
 	HOOK_HMEM,
 	HOOK_DMABUF_PEER_MEM,
-	HOOK_MONITOR
+	HOOK_MONITOR,
+	HOOK_RECORD
 };
 
 
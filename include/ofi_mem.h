@@ -328,10 +328,84 @@ enum {
 	OFI_BUFPOOL_HUGEPAGES		= 1 << 3,
 	OFI_BUFPOOL_NONSHARED		= 1 << 4,
 	OFI_BUFPOOL_NO_ZERO		= 1 << 5,
+	OFI_BUFPOOL_ARENA		= 1 << 6,
+	OFI_BUFPOOL_MAGAZINE		= 1 << 7,
 };
 
 struct ofi_bufpool_region;
 
+/*
+ * Buffer pool arena
+ *
+ * An arena backs the regions of any number of pools, such as all pools of
+ * a domain, with slices of a few large chunks.  Chunks are allocated from
+ * huge pages when available, and are passed to reg_fn once when they are
+ * created, so that regions carved from them do not need to be registered
+ * separately.  Chunks are only released when the arena is destroyed.
+ */
+struct ofi_bufpool_arena;
+
+struct ofi_bufpool_arena_chunk {
+	struct dlist_entry		entry;
+	char				*base;
+	size_t				size;
+	void				*context;
+	int				flags;
+};
+
+struct ofi_bufpool_arena_attr {
+	size_t		chunk_size;
+	int		(*reg_fn)(struct ofi_bufpool_arena *arena,
+				  struct ofi_bufpool_arena_chunk *chunk);
+	void		(*dereg_fn)(struct ofi_bufpool_arena *arena,
+				    struct ofi_bufpool_arena_chunk *chunk);
+	void		*context;
+	int		flags;
+};
+
+struct ofi_bufpool_arena {
+	ofi_mutex_t			lock;
+	struct ofi_bufpool_arena_attr	attr;
+	struct dlist_entry		chunk_list;
+	struct dlist_entry		free_list;
+	size_t				chunk_cnt;
+	size_t				slice_cnt;
+	size_t				size;
+	size_t				used;
+	size_t				peak;
+};
+
+int ofi_bufpool_arena_create(struct ofi_bufpool_arena_attr *attr,
+			     struct ofi_bufpool_arena **arena);
+void ofi_bufpool_arena_destroy(struct ofi_bufpool_arena *arena);
+
+/*
+ * Per-thread magazines
+ *
+ * Pools created with OFI_BUFPOOL_MAGAZINE may be used by any number of
+ * threads without a lock held by the caller, through ofi_buf_mag_alloc()
+ * and ofi_buf_mag_free() only.  Each thread caches free buffers in two
+ * small stacks, or magazines.  The pool lock is only taken when both are
+ * empty on alloc, or both are full on free, to exchange a whole magazine
+ * with the depot of the pool.  Threads beyond OFI_BUFPOOL_MAG_THREADS
+ * alloc and free under the pool lock.
+ */
+enum {
+	OFI_BUFPOOL_MAG_SIZE		= 32,
+	OFI_BUFPOOL_MAG_THREADS		= 256,
+};
+
+struct ofi_bufpool_mag {
+	struct slist_entry	entry;
+	size_t			cnt;
+	void			*bufs[OFI_BUFPOOL_MAG_SIZE];
+};
+
+struct ofi_bufpool_mag_cache {
+	struct ofi_bufpool_mag	*loaded;
+	struct ofi_bufpool_mag	*prev;
+};
+
 struct ofi_bufpool_attr {
 	size_t 		size;
 	size_t 		alignment;
@@ -342,6 +416,7 @@ struct ofi_bufpool_attr {
 	void		(*init_fn)(struct ofi_bufpool_region *region, void *buf);
 	void 		*context;
 	int		flags;
+	struct ofi_bufpool_arena *arena;
 };
 
 struct ofi_bufpool {
@@ -358,6 +433,11 @@ struct ofi_bufpool {
 	size_t				alloc_size;
 	size_t				region_size;
 	struct ofi_bufpool_attr		attr;
+
+	ofi_mutex_t			mag_lock;
+	struct slist			mag_full;
+	struct slist			mag_empty;
+	struct ofi_bufpool_mag_cache	**mag_caches;
 };
 
 struct ofi_bufpool_region {
@@ -368,6 +448,7 @@ struct ofi_bufpool_region {
 	size_t				index;
 	void 				*context;
 	struct ofi_bufpool 		*pool;
+	struct ofi_bufpool_arena_chunk	*chunk;
 	int				flags;
 	OFI_DBG_VAR(ofi_atomic32_t,	use_cnt)
 };
@@ -550,6 +631,48 @@ static inline void *ofi_buf_alloc_ex(struct ofi_bufpool *pool,
 	return buf;
 }
 
+extern OFI_THREAD_LOCAL int ofi_bufpool_thread_idx;
+
+void *ofi_buf_mag_alloc_slow(struct ofi_bufpool *pool);
+void ofi_buf_mag_free_slow(struct ofi_bufpool *pool, void *buf);
+
+static inline struct ofi_bufpool_mag_cache *
+ofi_bufpool_mag_cache(struct ofi_bufpool *pool)
+{
+	if (OFI_UNLIKELY(ofi_bufpool_thread_idx < 0))
+		return NULL;
+	return pool->mag_caches[ofi_bufpool_thread_idx];
+}
+
+static inline void *ofi_buf_mag_alloc(struct ofi_bufpool *pool)
+{
+	struct ofi_bufpool_mag_cache *cache;
+
+	assert(pool->attr.flags & OFI_BUFPOOL_MAGAZINE);
+	cache = ofi_bufpool_mag_cache(pool);
+	if (OFI_LIKELY(cache && cache->loaded->cnt))
+		return cache->loaded->bufs[--cache->loaded->cnt];
+
+	return ofi_buf_mag_alloc_slow(pool);
+}
+
+static inline void ofi_buf_mag_free(void *buf)
+{
+	struct ofi_bufpool *pool = ofi_buf_pool(buf);
+	struct ofi_bufpool_mag_cache *cache;
+
+	assert(pool->attr.flags & OFI_BUFPOOL_MAGAZINE);
+	assert(ofi_buf_is_valid(buf));
+	cache = ofi_bufpool_mag_cache(pool);
+	if (OFI_LIKELY(cache &&
+		       cache->loaded->cnt < OFI_BUFPOOL_MAG_SIZE)) {
+		cache->loaded->bufs[cache->loaded->cnt++] = buf;
+		return;
+	}
+
+	ofi_buf_mag_free_slow(pool, buf);
+}
+
 static inline void *ofi_ibuf_alloc(struct ofi_bufpool *pool)
 {
 	struct ofi_bufpool_hdr *buf_hdr;
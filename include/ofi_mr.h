@@ -155,6 +155,10 @@ struct ofi_mr_entry {
 	struct ofi_rbnode		*node;
 	int				use_cnt;
 	struct dlist_entry		list_entry;
+	/* Eviction policy state, set while the entry is idle */
+	uint64_t			idle_tick;
+	uint8_t				seg;
+	uint8_t				reused;
 	union ofi_mr_hmem_info		hmem_info;
 	uint8_t				data[];
 };
@@ -172,6 +176,12 @@ struct ofi_mem_monitor {
 	enum fi_hmem_iface		iface;
 	enum fi_mm_state                state;
 
+	/* Number of events read by the monitor, or being queued to the MR
+	 * caches, that are not yet fully queued.  Caches wait for these
+	 * before applying their queue.
+	 */
+	ofi_atomic32_t			pending;
+
 	void (*init)(struct ofi_mem_monitor *monitor);
 	void (*cleanup)(struct ofi_mem_monitor *monitor);
 	int (*start)(struct ofi_mem_monitor *monitor);
@@ -205,6 +215,8 @@ int ofi_monitors_add_cache(struct ofi_mem_monitor **monitors,
 void ofi_monitors_del_cache(struct ofi_mr_cache *cache);
 void ofi_monitor_notify(struct ofi_mem_monitor *monitor,
 			const void *addr, size_t len);
+void ofi_monitor_queue_notify(struct ofi_mem_monitor *monitor,
+			      const void *addr, size_t len);
 void ofi_monitor_flush(struct ofi_mem_monitor *monitor);
 
 int ofi_monitor_subscribe(struct ofi_mem_monitor *monitor,
@@ -390,12 +402,35 @@ struct ofi_mr_cache_params {
 	int				cuda_monitor_enabled;
 	int				rocr_monitor_enabled;
 	int				ze_monitor_enabled;
+	size_t				notify_queue_size;
+	size_t				granularity;
+	size_t				merge_max;
+	int				prefetch;
+	char *				policy;
+	size_t				reg_cost;
 };
 
 extern struct ofi_mr_cache_params	cache_params;
 
 #define OFI_HMEM_MAX 6
 
+/*
+ * Eviction policies for idle cache entries.  LRU keeps idle entries on
+ * lru_list.  The other policies split them across segment lists:
+ * SLRU keeps one LRU list per size class and evicts the head that is the
+ * cheapest to re-register relative to its size and age, and 2Q keeps
+ * entries that were never reused on a probation list, which is evicted
+ * first, so that one-time scans do not flush reused entries.
+ */
+enum ofi_mr_cache_policy {
+	OFI_MR_POLICY_LRU,
+	OFI_MR_POLICY_SLRU,
+	OFI_MR_POLICY_2Q,
+	OFI_MR_POLICY_MAX,
+};
+
+#define OFI_MR_CACHE_SEGS 4
+
 struct ofi_mr_cache {
 	struct util_domain		*domain;
 	const struct fi_provider	*prov;
@@ -408,6 +443,12 @@ struct ofi_mr_cache {
 	struct dlist_entry		dead_region_list;
 	pthread_mutex_t			lock;
 
+	enum ofi_mr_cache_policy	policy;
+	struct dlist_entry		seg_list[OFI_MR_CACHE_SEGS];
+	size_t				seg_cnt[OFI_MR_CACHE_SEGS];
+	size_t				seg_size[OFI_MR_CACHE_SEGS];
+	uint64_t			idle_tick;
+
 	size_t				cached_cnt;
 	size_t				cached_size;
 	size_t				cached_max_cnt;
@@ -418,8 +459,23 @@ struct ofi_mr_cache {
 	size_t				delete_cnt;
 	size_t				hit_cnt;
 	size_t				notify_cnt;
+	size_t				merge_cnt;
+	size_t				prefetch_cnt;
+	size_t				evict_cnt;
 	struct ofi_bufpool		*entry_pool;
 
+	/* Range of the last registration made on a miss, used to detect
+	 * sequential access when prefetching.
+	 */
+	uintptr_t			last_miss_base;
+	uintptr_t			last_miss_end;
+	struct dlist_entry		cache_entry;
+
+	/* Invalidations queued by memory monitors, applied under mm_lock
+	 * before the cache is searched or flushed.
+	 */
+	struct ofi_mr_notifyq		*notify_queue;
+
 	int				(*add_region)(struct ofi_mr_cache *cache,
 						      struct ofi_mr_entry *entry);
 	void				(*delete_region)(struct ofi_mr_cache *cache,
@@ -432,6 +488,8 @@ int ofi_mr_cache_init(struct util_domain *domain,
 void ofi_mr_cache_cleanup(struct ofi_mr_cache *cache);
 
 void ofi_mr_cache_notify(struct ofi_mr_cache *cache, const void *addr, size_t len);
+bool ofi_mr_cache_queue_notify(struct ofi_mr_cache *cache, const void *addr,
+			       size_t len);
 
 int ofi_ipc_cache_open(struct ofi_mr_cache **cache,
 			struct util_domain *domain);
@@ -527,6 +527,27 @@ size_t ofi_byteq_readv(struct ofi_byteq *byteq, struct iovec *iov,
 		       size_t cnt, size_t offset);
 
 
+/*
+ * Zero copy sends save copying the data into the kernel, but the kernel
+ * pins the user pages for every send and posts a notification to the
+ * socket error queue that must be reaped.  When tuning is enabled, sends
+ * above the zero copy threshold are timed, including the time spent
+ * reaping their notifications, and a fraction of them is copied to time
+ * the alternative.  The threshold moves toward the cheaper option, but
+ * never below the configured size.
+ */
+struct ofi_zerocopy_tune {
+	bool enabled;
+	size_t min_size;
+	uint32_t eligible;
+	uint32_t copy_cnt;
+	uint32_t zc_cnt;
+	uint64_t copy_ns;
+	uint64_t copy_bytes;
+	uint64_t zc_ns;
+	uint64_t zc_bytes;
+};
+
 /*
  * Buffered socket - socket with send/receive staging buffers.
  */
@@ -539,6 +560,7 @@ struct ofi_bsock {
 	struct ofi_byteq sq;
 	struct ofi_byteq rq;
 	size_t zerocopy_size;
+	struct ofi_zerocopy_tune zc_tune;
 	uint32_t async_index;
 	uint32_t done_index;
 	bool async_prefetch;
@@ -556,6 +578,7 @@ ofi_bsock_init(struct ofi_bsock *bsock, struct ofi_sockapi *sockapi,
 	ofi_byteq_init(&bsock->sq, sbuf_size);
 	ofi_byteq_init(&bsock->rq, rbuf_size);
 	bsock->zerocopy_size = SIZE_MAX;
+	memset(&bsock->zc_tune, 0, sizeof(bsock->zc_tune));
 	bsock->async_prefetch = false;
 
 	/* first async op will wrap back to 0 as the starting index */
@@ -563,6 +586,15 @@ ofi_bsock_init(struct ofi_bsock *bsock, struct ofi_sockapi *sockapi,
 	bsock->done_index = UINT32_MAX;
 }
 
+static inline void
+ofi_bsock_set_zerocopy(struct ofi_bsock *bsock, size_t size, bool tune)
+{
+	bsock->zerocopy_size = size;
+	memset(&bsock->zc_tune, 0, sizeof(bsock->zc_tune));
+	bsock->zc_tune.enabled = tune && size != SIZE_MAX;
+	bsock->zc_tune.min_size = size;
+}
+
 static inline void ofi_bsock_discard(struct ofi_bsock *bsock)
 {
 	ofi_byteq_discard(&bsock->rq);
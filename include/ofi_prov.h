@@ -266,6 +266,17 @@ HOOK_MONITOR_INI ;
 #  define HOOK_MONITOR_INIT NULL
 #endif
 
+#if (HAVE_RECORD) && (HAVE_RECORD_DL)
+#  define HOOK_RECORD_INI FI_EXT_INI
+#  define HOOK_RECORD_INIT NULL
+#elif (HAVE_RECORD)
+#  define HOOK_RECORD_INI INI_SIG(fi_hook_record_ini)
+#  define HOOK_RECORD_INIT fi_hook_record_ini()
+HOOK_RECORD_INI ;
+#else
+#  define HOOK_RECORD_INIT NULL
+#endif
+
 #if (HAVE_HOOK_DEBUG) && (HAVE_HOOK_DEBUG_DL)
 #  define HOOK_DEBUG_INI FI_EXT_INI
 #  define HOOK_DEBUG_INIT NULL
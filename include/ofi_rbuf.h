@@ -99,6 +99,7 @@ void dummy ## name (void) /* work-around global ; scope */
 #define ofi_cirque_insert(cq, x)	(cq)->buf[(cq)->wcnt++ & (cq)->size_mask] = x
 #define ofi_cirque_remove(cq)		(&(cq)->buf[(cq)->rcnt++ & (cq)->size_mask])
 #define ofi_cirque_discard(cq)		((cq)->rcnt++)
+#define ofi_cirque_discard_cnt(cq, cnt)	((cq)->rcnt += (cnt))
 #define ofi_cirque_commit(cq)		((cq)->wcnt++)
 
 
@@ -59,7 +59,9 @@
 #include <ofi_mr.h>
 #include <ofi_list.h>
 #include <ofi_mem.h>
+#include <ofi_mb.h>
 #include <ofi_rbuf.h>
+#include <ofi_atomic_queue.h>
 #include <ofi_signal.h>
 #include <ofi_enosys.h>
 #include <ofi_osd.h>
@@ -216,6 +218,12 @@ struct util_domain {
 	enum fi_threading	threading;
 	enum fi_progress	data_progress;
 	enum fi_progress	control_progress;
+
+	/* Counters with queued triggered operations or deferred work */
+	ofi_mutex_t		trigger_lock;
+	struct dlist_entry	trigger_cntrs;
+	ofi_atomic32_t		trigger_cnt;
+	bool			trigger_busy;
 };
 
 int ofi_domain_init(struct fid_fabric *fabric_fid, const struct fi_info *info,
@@ -223,6 +231,7 @@ int ofi_domain_init(struct fid_fabric *fabric_fid, const struct fi_info *info,
 		    enum ofi_lock_type lock_type);
 int ofi_domain_bind(struct fid *fid, struct fid *bfid, uint64_t flags);
 int ofi_domain_close(struct util_domain *domain);
+int ofi_domain_control(struct fid *fid, int command, void *arg);
 
 static const uint64_t ofi_rx_mr_flags[] = {
 	[ofi_op_msg] = FI_RECV,
@@ -477,6 +486,18 @@ struct util_wait_yield {
 int ofi_wait_yield_open(struct fid_fabric *fabric, struct fi_wait_attr *attr,
 			struct fid_wait **waitset);
 
+/*
+ * Blocking reads poll for completions for a while before arming their wait
+ * object.  The spin time follows the average time that recent blocking
+ * reads had to wait, and is 0 once that exceeds the ofi_wait_spin limit.
+ */
+struct ofi_wait_spin {
+	uint64_t		avg_ns;
+};
+
+uint64_t ofi_wait_spin_end(struct ofi_wait_spin *spin, uint64_t start);
+void ofi_wait_spin_update(struct ofi_wait_spin *spin, uint64_t start);
+
 /*
  * Completion queue
  *
@@ -498,6 +519,32 @@ struct util_cq_aux_entry {
 
 OFI_DECLARE_CIRQUE(struct fi_cq_tagged_entry, util_comp_cirq);
 
+struct util_cq_shard_comp {
+	struct fi_cq_tagged_entry	comp;
+	fi_addr_t			src;
+};
+
+OFI_DECLARE_ATOMIC_Q(struct util_cq_shard_comp, util_cq_shardq);
+
+/*
+ * Completion shards are enabled through FI_CQ_SHARDS for CQs that
+ * require locking, or by providers that write completions from their
+ * own threads through ofi_cq_init_sharded().  Each writing thread is
+ * mapped to a shard, which it fills without taking the cq_lock.  On CQs
+ * opened through ofi_cq_init_sharded(), provider threads select their
+ * own shard with ofi_cq_set_thread_shard(), and all other threads share
+ * shard 0.  Readers drain their own shard first, steal from the other
+ * shards, and finally read the cirq, which still holds error completions
+ * and completions that did not fit into a shard.  Once a shard
+ * overflows, its writers use the cirq until it has been drained, so
+ * completions written by a thread are read back in the order in which
+ * they were written.
+ */
+struct util_cq_shard {
+	struct util_cq_shardq	*queue;
+	ofi_atomic32_t		overflow;
+};
+
 typedef void (*ofi_cq_progress_func)(struct util_cq *cq);
 
 struct util_cq {
@@ -513,6 +560,12 @@ struct util_cq {
 	int			internal_wait;
 	ofi_atomic32_t		wakeup;
 	ofi_cq_progress_func	progress;
+	struct ofi_wait_spin	spin;
+
+	/* Lowest FI_CQ_COND_THRESHOLD of the blocked readers, 0 if none */
+	enum fi_cq_wait_cond	wait_cond;
+	ofi_atomic32_t		wait_threshold;
+	int			threshold_waiters;
 
 	struct fid_peer_cq	*peer_cq;
 
@@ -526,6 +579,16 @@ struct util_cq {
 	fi_addr_t		*src;
 	struct slist		aux_queue;
 	fi_cq_read_func		read_entry;
+
+	struct util_cq_shard	*shards;
+	size_t			shard_cnt;
+	/* Shards are selected by ofi_cq_set_thread_shard() */
+	bool			thread_shards;
+
+	/* Entries handed out by FI_CQ_BORROW_OPS and not yet released */
+	size_t			borrowed;
+	struct fi_cq_tagged_entry borrow_comp;
+	fi_addr_t		borrow_src;
 };
 
 int ofi_cq_init(const struct fi_provider *prov, struct fid_domain *domain,
@@ -536,6 +599,13 @@ int ofi_check_bind_cq_flags(struct util_ep *ep, struct util_cq *cq,
 void ofi_cq_progress(struct util_cq *cq);
 int ofi_cq_cleanup(struct util_cq *cq);
 int ofi_cq_control(struct fid *fid, int command, void *arg);
+int ofi_cq_ops_open(struct fid *fid, const char *name, uint64_t flags,
+		    void **ops, void *context);
+int ofi_cq_init_sharded(const struct fi_provider *prov,
+			struct fid_domain *domain, struct fi_cq_attr *attr,
+			struct util_cq *cq, ofi_cq_progress_func progress,
+			size_t shard_cnt, void *context);
+void ofi_cq_set_thread_shard(size_t index);
 
 ssize_t ofi_cq_read(struct fid_cq *cq_fid, void *buf, size_t count);
 ssize_t ofi_cq_readfrom(struct fid_cq *cq_fid, void *buf, size_t count,
@@ -553,23 +623,99 @@ const char *ofi_cq_strerror(struct fid_cq *cq, int prov_errno,
 int ofi_cq_write_overflow(struct util_cq *cq, void *context, uint64_t flags,
 			  size_t len, void *buf, uint64_t data, uint64_t tag,
 			  fi_addr_t src);
+int ofi_cq_write_shard(struct util_cq *cq, void *context, uint64_t flags,
+		       size_t len, void *buf, uint64_t data, uint64_t tag,
+		       fi_addr_t src);
+ssize_t ofi_cq_read_shards(struct util_cq *cq, void *buf, size_t count,
+			   fi_addr_t *src_addr);
+
+/* A writer claims its slot by advancing write_pos before it fills the
+ * entry, so only the sequence of the head slot tells whether a committed
+ * entry is ready to be read.
+ */
+static inline bool ofi_cq_shard_isempty(struct util_cq_shard *shard)
+{
+	struct util_cq_shardq *queue = shard->queue;
+	int64_t pos;
+
+	pos = ofi_atomic_load_explicit64(&queue->read_pos,
+					 memory_order_relaxed);
+	return ofi_atomic_load_explicit64(
+			&queue->entry[pos & queue->size_mask].seq,
+			memory_order_acquire) != pos + 1;
+}
+
+static inline bool ofi_cq_isempty(struct util_cq *cq)
+{
+	size_t i;
+
+	for (i = 0; i < cq->shard_cnt; i++) {
+		if (!ofi_cq_shard_isempty(&cq->shards[i]))
+			return false;
+	}
+	return ofi_cirque_isempty(cq->cirq);
+}
+
+/* Number of queued entries, including overflow and error entries */
+static inline size_t ofi_cq_usedcnt(struct util_cq *cq)
+{
+	size_t i, cnt;
+
+	cnt = ofi_cirque_usedcnt(cq->cirq);
+	for (i = 0; i < cq->shard_cnt; i++) {
+		cnt += (size_t) (ofi_atomic_get64(&cq->shards[i].queue->write_pos) -
+				 ofi_atomic_get64(&cq->shards[i].queue->read_pos));
+	}
+	return cnt;
+}
+
+/* Overflow and error entries always satisfy a threshold */
+static inline bool ofi_cq_threshold_met(struct util_cq *cq, size_t threshold)
+{
+	return threshold <= 1 || ofi_cq_usedcnt(cq) >= threshold ||
+	       !slist_empty(&cq->aux_queue);
+}
+
+/* True if no blocked FI_CQ_COND_THRESHOLD reader needs to wait longer */
+static inline bool ofi_cq_wait_ready(struct util_cq *cq)
+{
+	return cq->wait_cond != FI_CQ_COND_THRESHOLD ||
+	       ofi_cq_threshold_met(cq, ofi_atomic_get32(&cq->wait_threshold));
+}
+
+/*
+ * Wakes blocked readers after a completion has been queued.  The signal is
+ * skipped while fewer entries are queued than any blocked reader asked for.
+ * The fence orders the queued entry against a reader registering its
+ * threshold, which checks the queued count after the same fence.
+ */
+static inline void util_cq_signal(struct util_cq *cq)
+{
+	assert(cq->wait);
+	if (cq->wait_cond == FI_CQ_COND_THRESHOLD) {
+		ofi_mb();
+		if (!ofi_cq_wait_ready(cq))
+			return;
+	}
+	cq->wait->signal(cq->wait);
+}
 
 static inline
-ssize_t ofi_cq_read_entries(struct util_cq *cq, void *buf, size_t count,
-			fi_addr_t *src_addr)
+ssize_t ofi_cq_read_cirq(struct util_cq *cq, void *buf, size_t count,
+			 fi_addr_t *src_addr)
 {
 	struct fi_cq_tagged_entry *entry;
 	struct util_cq_aux_entry *aux_entry;
 	ssize_t i;
 
-	ofi_genlock_lock(&cq->cq_lock);
-
+	assert(ofi_genlock_held(&cq->cq_lock));
 	if (cq->err_data) {
 		free(cq->err_data);
 		cq->err_data = NULL;
 	}
 
-	if (ofi_cirque_isempty(cq->cirq)) {
+	/* Borrowed entries stay at the head of the cirq until released */
+	if (ofi_cirque_isempty(cq->cirq) || cq->borrowed) {
 		i = -FI_EAGAIN;
 		goto out;
 	}
@@ -616,10 +762,24 @@ ssize_t ofi_cq_read_entries(struct util_cq *cq, void *buf, size_t count,
 		}
 	}
 out:
-	ofi_genlock_unlock(&cq->cq_lock);
 	return i;
 }
 
+static inline
+ssize_t ofi_cq_read_entries(struct util_cq *cq, void *buf, size_t count,
+			fi_addr_t *src_addr)
+{
+	ssize_t ret;
+
+	if (cq->shards)
+		return ofi_cq_read_shards(cq, buf, count, src_addr);
+
+	ofi_genlock_lock(&cq->cq_lock);
+	ret = ofi_cq_read_cirq(cq, buf, count, src_addr);
+	ofi_genlock_unlock(&cq->cq_lock);
+	return ret;
+}
+
 static inline void
 ofi_cq_write_entry(struct util_cq *cq, void *context, uint64_t flags,
 		   size_t len, void *buf, uint64_t data, uint64_t tag)
@@ -649,6 +809,10 @@ ofi_cq_write(struct util_cq *cq, void *context, uint64_t flags, size_t len,
 {
 	int ret;
 
+	if (cq->shards)
+		return ofi_cq_write_shard(cq, context, flags, len, buf, data,
+					  tag, FI_ADDR_NOTAVAIL);
+
 	ofi_genlock_lock(&cq->cq_lock);
 	if (ofi_cirque_freecnt(cq->cirq) > 1) {
 		ofi_cq_write_entry(cq, context, flags, len, buf, data, tag);
@@ -667,6 +831,10 @@ ofi_cq_write_src(struct util_cq *cq, void *context, uint64_t flags, size_t len,
 {
 	int ret;
 
+	if (cq->shards)
+		return ofi_cq_write_shard(cq, context, flags, len, buf, data,
+					  tag, src);
+
 	ofi_genlock_lock(&cq->cq_lock);
 	if (ofi_cirque_freecnt(cq->cirq) > 1) {
 		ofi_cq_write_src_entry(cq, context, flags, len, buf, data,
@@ -750,9 +918,21 @@ struct util_cntr {
 
 	int			internal_wait;
 	ofi_cntr_progress_func	progress;
+	struct ofi_wait_spin	spin;
+
+	/* Only the leader blocks on the wait object, other waiters are
+	 * woken through wait_cond each time the leader wakes up. */
+	ofi_mutex_t		wait_lock;
+	pthread_cond_t		wait_cond;
+	bool			wait_leader;
 
 	struct fid_peer_cntr	*peer_cntr;
 	uint64_t		flags;
+
+	/* Triggered operations, sorted by threshold, and the entry on the
+	 * domain's trigger_cntrs while any are queued. */
+	struct dlist_entry	trigger_list;
+	struct dlist_entry	trigger_entry;
 };
 
 #define OFI_TIMEOUT_QUANTUM_MS 50
@@ -834,6 +1014,42 @@ static inline void ofi_ep_peer_rx_cntr_incerr(struct util_ep *ep, uint8_t op)
 		cntr->peer_cntr->owner_ops->incerr(cntr->peer_cntr);
 }
 
+/*
+ * Triggered operations and deferred work
+ */
+
+ssize_t ofi_trigger_msg(struct util_ep *ep, enum fi_op_type op_type,
+			const struct fi_msg *msg, uint64_t flags);
+ssize_t ofi_trigger_tagged(struct util_ep *ep, enum fi_op_type op_type,
+			   const struct fi_msg_tagged *msg, uint64_t flags);
+ssize_t ofi_trigger_rma(struct util_ep *ep, enum fi_op_type op_type,
+			const struct fi_msg_rma *msg, uint64_t flags);
+ssize_t ofi_trigger_atomic(struct util_ep *ep, const struct fi_msg_atomic *msg,
+			   uint64_t flags);
+ssize_t ofi_trigger_fetch_atomic(struct util_ep *ep,
+				 const struct fi_msg_atomic *msg,
+				 struct fi_ioc *resultv, void **result_desc,
+				 size_t result_count, uint64_t flags);
+ssize_t ofi_trigger_compare_atomic(struct util_ep *ep,
+				   const struct fi_msg_atomic *msg,
+				   const struct fi_ioc *comparev,
+				   void **compare_desc, size_t compare_count,
+				   struct fi_ioc *resultv, void **result_desc,
+				   size_t result_count, uint64_t flags);
+int ofi_queue_work(struct util_domain *domain, struct fi_deferred_work *work);
+int ofi_cancel_work(struct util_domain *domain, struct fi_deferred_work *work);
+int ofi_flush_work(struct util_domain *domain, struct util_cntr *cntr);
+void ofi_trigger_start(struct util_domain *domain);
+void ofi_trigger_cntr_cleanup(struct util_cntr *cntr);
+void ofi_trigger_ep_cleanup(struct util_ep *ep);
+
+/* Called on every CQ and counter read, so the idle check stays inline */
+static inline void ofi_trigger_progress(struct util_domain *domain)
+{
+	if (ofi_atomic_get32(&domain->trigger_cnt))
+		ofi_trigger_start(domain);
+}
+
 /*
  * AV / addressing
  */
@@ -938,6 +1154,7 @@ struct util_peer_addr {
 struct util_peer_addr *util_get_peer(struct rxm_av *av, const void *addr,
 				     uint64_t flags);
 void util_put_peer(struct util_peer_addr *peer);
+const char *util_peer_straddr(struct util_peer_addr *peer);
 
 /* All peer addresses, whether they've been inserted into the AV
  * or an endpoint has an active connection to it, are stored in
@@ -185,6 +185,49 @@ static inline int fi_import_log(uint32_t version, uint64_t flags,
 			 log_fid);
 }
 
+
+/*
+ * Zero-copy CQ read extension:
+ * To use, open FI_CQ_BORROW_OPS on a CQ.  borrow() returns up to count
+ * contiguous completions in place, along with their source addresses if
+ * the CQ reports them.  The entries remain owned by the CQ until release()
+ * is called with the number of entries consumed.
+ */
+#define FI_CQ_BORROW_OPS "fi_cq_borrow_ops"
+
+struct fi_ops_cq_borrow {
+	size_t	size;
+	ssize_t	(*borrow)(struct fid_cq *cq, struct fi_cq_tagged_entry **comp,
+			  fi_addr_t **src_addr, size_t count);
+	int	(*release)(struct fid_cq *cq, size_t count);
+};
+
+/*
+ * MR cache statistics extension:
+ * To use, open FI_MR_CACHE_STATS_OPS on the fid returned by
+ * fi_open(.., "mr_cache", ..).  query() sums the statistics of all
+ * registration caches that are open in the process.
+ */
+#define FI_MR_CACHE_STATS_OPS "fi_mr_cache_stats_ops"
+
+struct fi_mr_cache_stats {
+	uint64_t	searches;
+	uint64_t	hits;
+	uint64_t	merges;
+	uint64_t	prefetches;
+	uint64_t	notifies;
+	uint64_t	cached_cnt;
+	uint64_t	cached_size;
+	uint64_t	uncached_cnt;
+	uint64_t	uncached_size;
+	uint64_t	evictions;
+};
+
+struct fi_ops_mr_cache_stats {
+	size_t	size;
+	int	(*query)(struct fid *fid, struct fi_mr_cache_stats *stats);
+};
+
 #ifdef __cplusplus
 }
 #endif
@@ -118,9 +118,48 @@ struct profile_data {
 	uint64_t sum[PROF_SIZE_MAX];
 };
 
+/*
+ * Per-peer communication matrix, keyed by fi_addr_t.  Peers are stored
+ * densely in the order in which they are first seen, and found through an
+ * open addressing table of peer indices.  Both are sized for max peers when
+ * the matrix is created and never move, so that known peers are looked up
+ * and counted without the lock, which only serializes adding new peers.
+ * Once max peers are tracked, traffic to further peers is accumulated into
+ * other.
+ */
+enum prof_peer_op {
+	PROF_PEER_SEND,
+	PROF_PEER_RECV,
+	PROF_PEER_READ,
+	PROF_PEER_WRITE,
+	PROF_PEER_OP_MAX
+};
+
+struct prof_peer {
+	fi_addr_t addr;
+	char *name;
+	ofi_atomic64_t count[PROF_PEER_OP_MAX];
+	ofi_atomic64_t sum[PROF_PEER_OP_MAX];
+};
+
+struct prof_peer_matrix {
+	bool enabled;
+	ofi_mutex_t lock;
+	struct prof_peer *peers;
+	size_t cnt;
+	ofi_atomic32_t *slots;
+	size_t slots_size;
+	size_t max;
+	ofi_atomic32_t full;
+	struct prof_peer other;
+	struct fid_av *hav;
+	char *local;
+};
+
 struct profile_context {
 	const struct fi_provider *hprov;
 	struct profile_data data[prof_api_size];
+	struct prof_peer_matrix peers;
 };
 
 struct profile_fabric {
@@ -130,4 +169,13 @@ struct profile_fabric {
 
 void prof_report(const struct fi_provider *hprov,  struct profile_data *data);
 
+void prof_peer_env_init(struct fi_provider *prov);
+void prof_peer_init(const struct fi_provider *hprov,
+                    struct prof_peer_matrix *matrix);
+void prof_peer_cleanup(struct prof_peer_matrix *matrix);
+void prof_peer_add(struct prof_peer_matrix *matrix, struct fid_ep *hep,
+                   enum prof_peer_op op, fi_addr_t addr, size_t len);
+void prof_peer_report(const struct fi_provider *hprov,
+                      struct prof_peer_matrix *matrix);
+
 #endif /* _HOOK_PROFILE_H_ */
@@ -170,6 +170,36 @@ prof_add_cq_cntr(struct profile_context *ctx, int cntr,
 	}
 }
 
+static inline void
+prof_add_peer(struct hook_ep *ep, enum prof_peer_op op, fi_addr_t addr,
+              size_t len)
+{
+	struct profile_context *ctx = profile_ctx(ep);
+
+	if (ctx->peers.enabled && addr != FI_ADDR_UNSPEC)
+		prof_peer_add(&ctx->peers, ep->hep, op, addr, len);
+}
+
+/* Received bytes are attributed to the source of rx completions */
+static inline void
+prof_add_cq_peer(struct profile_context *ctx, enum fi_cq_format format,
+                 void *buf, fi_addr_t *src_addr, int ret)
+{
+	uint64_t len;
+	int cntr;
+
+	for (int i = 0; i < ret; i++) {
+		if (src_addr[i] == FI_ADDR_UNSPEC ||
+		    src_addr[i] == FI_ADDR_NOTAVAIL ||
+		    !get_cq_entry[format](buf, i, &cntr, &len))
+			continue;
+		if (cntr == prof_cq_msg_rx || cntr == prof_cq_data_rx ||
+		    cntr == prof_cq_tagged_rx)
+			prof_peer_add(&ctx->peers, NULL, PROF_PEER_RECV,
+				      src_addr[i], len);
+	}
+}
+
 /*
  * APIs
  */
@@ -226,6 +256,7 @@ profile_send(struct fid_ep *ep, const void *buf, size_t len, void *desc,
 	if (!ret) {
 		prof_add_cntr(profile_ctx(myep), prof_send,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_SEND, dest_addr, len);
 	}
 
 	return ret;
@@ -244,6 +275,7 @@ profile_sendv(struct fid_ep *ep, const struct iovec *iov, void **desc,
 		len = ofi_total_iov_len(iov, count);
 		prof_add_cntr(profile_ctx(myep), prof_sendv,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_SEND, dest_addr, len);
 	}
 
 	return ret;
@@ -261,6 +293,7 @@ profile_sendmsg(struct fid_ep *ep, const struct fi_msg *msg, uint64_t flags)
 		len = ofi_total_iov_len(msg->msg_iov, msg->iov_count);
 		prof_add_cntr(profile_ctx(myep), prof_sendmsg,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_SEND, msg->addr, len);
 	}
 
 	return ret;
@@ -277,6 +310,7 @@ profile_inject(struct fid_ep *ep, const void *buf, size_t len,
 	if (!ret) {
 		prof_add_cntr(profile_ctx(myep), prof_inject,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_SEND, dest_addr, len);
 	}
 
 	return ret;
@@ -293,6 +327,7 @@ profile_senddata(struct fid_ep *ep, const void *buf, size_t len, void *desc,
 	if (!ret) {
 		prof_add_cntr(profile_ctx(myep), prof_senddata,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_SEND, dest_addr, len);
 
 	}
 
@@ -310,6 +345,7 @@ profile_injectdata(struct fid_ep *ep, const void *buf, size_t len,
 	if (!ret) {
 		prof_add_cntr(profile_ctx(myep), prof_injectdata,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_SEND, dest_addr, len);
 	}
 
 	return ret;
@@ -340,6 +376,7 @@ profile_read(struct fid_ep *ep, void *buf, size_t len, void *desc,
 	if (!ret) {
 		prof_add_cntr(profile_ctx(myep), prof_read,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_READ, src_addr, len);
 	}
 
 	return ret;
@@ -360,6 +397,7 @@ profile_readv(struct fid_ep *ep, const struct iovec *iov, void **desc,
 		len = ofi_total_iov_len(iov, count);
 		prof_add_cntr(profile_ctx(myep), prof_readv,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_READ, src_addr, len);
 	}
 
 	return ret;
@@ -378,6 +416,7 @@ profile_readmsg(struct fid_ep *ep, const struct fi_msg_rma *msg,
 		len = ofi_total_iov_len(msg->msg_iov, msg->iov_count);
 		prof_add_cntr(profile_ctx(myep), prof_readmsg,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_READ, msg->addr, len);
 	}
 
 	return ret;
@@ -394,6 +433,7 @@ profile_write(struct fid_ep *ep, const void *buf, size_t len, void *desc,
 	if (!ret) {
 		prof_add_cntr(profile_ctx(myep), prof_write,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_WRITE, dest_addr, len);
 	}
 
 	return ret;
@@ -414,6 +454,7 @@ profile_writev(struct fid_ep *ep, const struct iovec *iov, void **desc,
 		len =  ofi_total_iov_len(iov, count);
 		prof_add_cntr(profile_ctx(myep), prof_writev,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_WRITE, dest_addr, len);
 	}
 
 	return ret;
@@ -432,6 +473,7 @@ profile_writemsg(struct fid_ep *ep, const struct fi_msg_rma *msg,
 		len =  ofi_total_iov_len(msg->msg_iov, msg->iov_count);
 		prof_add_cntr(profile_ctx(myep), prof_writemsg,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_WRITE, msg->addr, len);
 	}
 	return ret;
 }
@@ -447,6 +489,7 @@ profile_inject_write(struct fid_ep *ep, const void *buf, size_t len,
 	if (!ret) {
 		prof_add_cntr(profile_ctx(myep), prof_inject_write,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_WRITE, dest_addr, len);
 	}
 
 	return ret;
@@ -465,6 +508,7 @@ profile_writedata(struct fid_ep *ep, const void *buf, size_t len, void *desc,
 	if (!ret) {
 		prof_add_cntr(profile_ctx(myep), prof_writedata,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_WRITE, dest_addr, len);
 	}
 
 	return ret;
@@ -483,6 +527,7 @@ profile_inject_writedata(struct fid_ep *ep, const void *buf, size_t len,
 	if (!ret) {
 		prof_add_cntr(profile_ctx(myep), prof_injectdata,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_WRITE, dest_addr, len);
 	}
 
 	return ret;
@@ -561,6 +606,7 @@ profile_tsend(struct fid_ep *ep, const void *buf, size_t len, void *desc,
 	if (!ret) {
 		prof_add_cntr(profile_ctx(myep), prof_tsend,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_SEND, dest_addr, len);
 	}
 
 	return ret;
@@ -580,6 +626,7 @@ profile_tsendv(struct fid_ep *ep, const struct iovec *iov, void **desc,
 		len = ofi_total_iov_len(iov, count);
 		prof_add_cntr(profile_ctx(myep), prof_tsendv,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_SEND, dest_addr, len);
 	}
 
 	return ret;
@@ -598,6 +645,7 @@ profile_tsendmsg(struct fid_ep *ep, const struct fi_msg_tagged *msg,
 		len = ofi_total_iov_len(msg->msg_iov, msg->iov_count);
 		prof_add_cntr(profile_ctx(myep), prof_tsendmsg,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_SEND, msg->addr, len);
 	}
 
 	return ret;
@@ -614,6 +662,7 @@ profile_tinject(struct fid_ep *ep, const void *buf, size_t len,
 	if (!ret) {
 		prof_add_cntr(profile_ctx(myep), prof_tinject,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_SEND, dest_addr, len);
 	}
 
 	return ret;
@@ -632,6 +681,7 @@ profile_tsenddata(struct fid_ep *ep, const void *buf, size_t len, void *desc,
 	if (!ret) {
 		prof_add_cntr(profile_ctx(myep), prof_tsenddata,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_SEND, dest_addr, len);
 	}
 
 	return ret;
@@ -648,6 +698,7 @@ profile_tinjectdata(struct fid_ep *ep, const void *buf, size_t len,
 	if (!ret) {
 		prof_add_cntr(profile_ctx(myep), prof_tinjectdata,
 		              prof_size_bucket(len), len);
+		prof_add_peer(myep, PROF_PEER_SEND, dest_addr, len);
 	}
 
 	return ret;
@@ -689,6 +740,9 @@ profile_cq_readfrom(struct fid_cq *cq, void *buf, size_t count, fi_addr_t *src_a
 	if (ret>0) {
 		prof_add_cq_cntr(profile_ctx_cq(mycq), prof_cq_readfrom,
 		                 mycq->format, buf, ret);
+		if (src_addr && profile_ctx_cq(mycq)->peers.enabled)
+			prof_add_cq_peer(profile_ctx_cq(mycq), mycq->format,
+					 buf, src_addr, ret);
 	}
 
 	return ret;
@@ -730,6 +784,9 @@ profile_cq_sreadfrom(struct fid_cq *cq, void *buf, size_t count,
 	if (ret > 0) {
 		prof_add_cq_cntr(profile_ctx_cq(mycq), prof_cq_sreadfrom,
 		                 mycq->format, buf, ret);
+		if (src_addr && profile_ctx_cq(mycq)->peers.enabled)
+			prof_add_cq_peer(profile_ctx_cq(mycq), mycq->format,
+					 buf, src_addr, ret);
 	}
 	return ret;
 }
@@ -814,9 +871,72 @@ static struct fi_ops_mr profile_mr_ops = {
 	.regattr = profile_mr_regattr,
 };
 
+/*
+ * The peer matrix resolves peers through the first AV that is opened, so
+ * that the matrices of all ranks can be merged by address.
+ */
+static int profile_av_close(struct fid *fid)
+{
+	struct hook_av *myav = container_of(fid, struct hook_av, av.fid);
+	struct profile_context *ctx = profile_ctx_domain(myav->domain);
+
+	ofi_mutex_lock(&ctx->peers.lock);
+	if (ctx->peers.hav == myav->hav)
+		ctx->peers.hav = NULL;
+	ofi_mutex_unlock(&ctx->peers.lock);
+
+	return hook_close(fid);
+}
+
+static struct fi_ops profile_av_fid_ops = {
+	.size = sizeof(struct fi_ops),
+	.close = profile_av_close,
+	.bind = hook_bind,
+	.control = hook_control,
+	.ops_open = hook_ops_open,
+};
+
+static int
+profile_av_open(struct fid_domain *domain, struct fi_av_attr *attr,
+		struct fid_av **av, void *context)
+{
+	struct hook_domain *dom = container_of(domain, struct hook_domain,
+					       domain);
+	struct profile_context *ctx = profile_ctx_domain(dom);
+	struct hook_av *myav;
+	int ret;
+
+	ret = hook_av_open(domain, attr, av, context);
+	if (ret || !ctx->peers.enabled)
+		return ret;
+
+	myav = container_of(*av, struct hook_av, av);
+	myav->av.fid.ops = &profile_av_fid_ops;
+	ofi_mutex_lock(&ctx->peers.lock);
+	if (!ctx->peers.hav)
+		ctx->peers.hav = myav->hav;
+	ofi_mutex_unlock(&ctx->peers.lock);
+	return 0;
+}
+
+static struct fi_ops_domain profile_domain_ops = {
+	.size = sizeof(struct fi_ops_domain),
+	.av_open = profile_av_open,
+	.cq_open = hook_cq_open,
+	.endpoint = hook_endpoint,
+	.scalable_ep = hook_scalable_ep,
+	.cntr_open = hook_cntr_open,
+	.poll_open = hook_poll_open,
+	.stx_ctx = hook_stx_ctx,
+	.srx_ctx = hook_srx_ctx,
+	.query_atomic = hook_query_atomic,
+	.query_collective = hook_query_collective,
+};
+
 static int profile_domain_init(struct fid *fid)
 {
 	struct fid_domain *domain = container_of(fid, struct fid_domain, fid);
+	domain->ops = &profile_domain_ops;
 	domain->mr = &profile_mr_ops;
 
 	return 0;
@@ -828,6 +948,8 @@ static int hook_profile_close(struct fid *fid)
 		&(container_of(fid, struct profile_fabric, fabric_hook)->prof_ctx);
 
 	prof_report(ctx->hprov, ctx->data);
+	prof_peer_report(ctx->hprov, &ctx->peers);
+	prof_peer_cleanup(&ctx->peers);
 
 	hook_close(fid);
 	return FI_SUCCESS;
@@ -857,6 +979,7 @@ hook_profile_fabric(struct fi_fabric_attr *attr,
 
 	fab->prof_ctx.hprov = hprov;
 	memset(&fab->prof_ctx.data, 0, sizeof (fab->prof_ctx.data));
+	prof_peer_init(hprov, &fab->prof_ctx.peers);
 	hook_fabric_init(&fab->fabric_hook, HOOK_PROFILE, attr->fabric, hprov,
 	                 &profile_fabric_fid_ops, &hook_profile_ctx);
 	*fabric = &fab->fabric_hook.fabric;
@@ -898,6 +1021,7 @@ HOOK_PROFILE_INI
 	hook_profile_ctx.ini_fid[FI_CLASS_DOMAIN] = profile_domain_init;
 	hook_profile_ctx.ini_fid[FI_CLASS_CQ] = profile_cq_init;
 	hook_profile_ctx.ini_fid[FI_CLASS_EP] = profile_ep_init;
+	prof_peer_env_init(&hook_profile_ctx.prov);
 
 	return &hook_profile_ctx.prov;
 }
@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "hook_profile.h"
+
+#define PROF_PEER_MAX_DEFAULT	(1 << 16)
+#define PROF_PEER_NAME_LEN	256
+
+static const char *prof_peer_op_str[] = {
+	[PROF_PEER_SEND] = "send",
+	[PROF_PEER_RECV] = "recv",
+	[PROF_PEER_READ] = "read",
+	[PROF_PEER_WRITE] = "write",
+};
+
+static struct {
+	char *path;
+	size_t max;
+} prof_peer_env = {
+	.path = NULL,
+	.max = PROF_PEER_MAX_DEFAULT,
+};
+
+static int prof_peer_seq;
+
+void prof_peer_env_init(struct fi_provider *prov)
+{
+	size_t max;
+
+	fi_param_define(prov, "peer_matrix", FI_PARAM_STRING,
+			"Directory where a per-peer matrix of the messages and "
+			"bytes sent, received, read and written is written "
+			"when a fabric is closed.  The matrix is only collected "
+			"if set. (default: unset)");
+	fi_param_get_str(prov, "peer_matrix", &prof_peer_env.path);
+
+	fi_param_define(prov, "peer_max", FI_PARAM_SIZE_T,
+			"Maximum number of peers tracked by the peer matrix. "
+			"Traffic to further peers is accumulated into a single "
+			"entry. (default: %zu)", prof_peer_env.max);
+	if (!fi_param_get_size_t(prov, "peer_max", &max) && max)
+		prof_peer_env.max = MIN(max, INT32_MAX - 1);
+}
+
+static void prof_peer_init_counters(struct prof_peer *peer, fi_addr_t addr)
+{
+	int op;
+
+	peer->addr = addr;
+	for (op = 0; op < PROF_PEER_OP_MAX; op++) {
+		ofi_atomic_initialize64(&peer->count[op], 0);
+		ofi_atomic_initialize64(&peer->sum[op], 0);
+	}
+}
+
+void prof_peer_init(const struct fi_provider *hprov,
+                    struct prof_peer_matrix *matrix)
+{
+	size_t i;
+
+	memset(matrix, 0, sizeof(*matrix));
+	ofi_mutex_init(&matrix->lock);
+	prof_peer_init_counters(&matrix->other, FI_ADDR_NOTAVAIL);
+	ofi_atomic_initialize32(&matrix->full, 0);
+	if (!prof_peer_env.path)
+		return;
+
+	/* keep the slot table at most half full */
+	matrix->max = prof_peer_env.max;
+	matrix->slots_size = roundup_power_of_two(matrix->max * 2);
+	matrix->peers = calloc(matrix->max, sizeof(*matrix->peers));
+	matrix->slots = calloc(matrix->slots_size, sizeof(*matrix->slots));
+	if (!matrix->peers || !matrix->slots) {
+		FI_WARN(hprov, FI_LOG_CORE,
+			"Cannot allocate a peer matrix of %zu peers\n",
+			matrix->max);
+		free(matrix->peers);
+		free(matrix->slots);
+		matrix->peers = NULL;
+		matrix->slots = NULL;
+		return;
+	}
+
+	for (i = 0; i < matrix->slots_size; i++)
+		ofi_atomic_initialize32(&matrix->slots[i], 0);
+	matrix->enabled = true;
+}
+
+void prof_peer_cleanup(struct prof_peer_matrix *matrix)
+{
+	size_t i;
+
+	for (i = 0; i < matrix->cnt; i++)
+		free(matrix->peers[i].name);
+	free(matrix->peers);
+	free(matrix->slots);
+	free(matrix->local);
+	ofi_mutex_destroy(&matrix->lock);
+}
+
+static inline size_t prof_peer_hash(fi_addr_t addr, size_t mask)
+{
+	return (size_t) ((addr * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+/* Resolves the peer into a name that is valid across processes */
+static char *prof_peer_name(struct prof_peer_matrix *matrix, fi_addr_t addr)
+{
+	char addr_buf[PROF_PEER_NAME_LEN];
+	char name[PROF_PEER_NAME_LEN];
+	size_t addrlen = sizeof(addr_buf);
+	size_t len = sizeof(name);
+
+	if (!matrix->hav ||
+	    fi_av_lookup(matrix->hav, addr, addr_buf, &addrlen) ||
+	    addrlen > sizeof(addr_buf))
+		return NULL;
+
+	fi_av_straddr(matrix->hav, addr_buf, name, &len);
+	name[sizeof(name) - 1] = '\0';
+	return strdup(name);
+}
+
+/*
+ * Returns the peer, or NULL and the free slot where it belongs.  Slots are
+ * published with release semantics after their peer is set up, so this is
+ * safe to call without the lock.  The table is never more than half full,
+ * so a free slot is always found.
+ */
+static struct prof_peer *
+prof_peer_find(struct prof_peer_matrix *matrix, fi_addr_t addr, size_t *slot)
+{
+	int32_t idx;
+
+	*slot = prof_peer_hash(addr, matrix->slots_size - 1);
+	while ((idx = ofi_atomic_load_explicit32(&matrix->slots[*slot],
+						 memory_order_acquire))) {
+		if (matrix->peers[idx - 1].addr == addr)
+			return &matrix->peers[idx - 1];
+		*slot = (*slot + 1) & (matrix->slots_size - 1);
+	}
+	return NULL;
+}
+
+static void prof_peer_set_local(struct prof_peer_matrix *matrix,
+                                struct fid_ep *hep)
+{
+	char addr_buf[PROF_PEER_NAME_LEN];
+	char name[PROF_PEER_NAME_LEN];
+	size_t addrlen = sizeof(addr_buf);
+	size_t len = sizeof(name);
+
+	if (fi_getname(&hep->fid, addr_buf, &addrlen) ||
+	    addrlen > sizeof(addr_buf))
+		return;
+
+	fi_av_straddr(matrix->hav, addr_buf, name, &len);
+	name[sizeof(name) - 1] = '\0';
+	matrix->local = strdup(name);
+}
+
+static struct prof_peer *
+prof_peer_insert(struct prof_peer_matrix *matrix, struct fid_ep *hep,
+                 fi_addr_t addr)
+{
+	struct prof_peer *peer;
+	size_t slot;
+
+	ofi_mutex_lock(&matrix->lock);
+	if (!matrix->local && hep && matrix->hav)
+		prof_peer_set_local(matrix, hep);
+
+	/* another thread may have added the peer */
+	peer = prof_peer_find(matrix, addr, &slot);
+	if (peer)
+		goto unlock;
+
+	if (matrix->cnt >= matrix->max) {
+		ofi_atomic_store_explicit32(&matrix->full, 1,
+					    memory_order_release);
+		peer = &matrix->other;
+		goto unlock;
+	}
+
+	peer = &matrix->peers[matrix->cnt];
+	prof_peer_init_counters(peer, addr);
+	peer->name = prof_peer_name(matrix, addr);
+	ofi_atomic_store_explicit32(&matrix->slots[slot],
+				    (int32_t) ++matrix->cnt,
+				    memory_order_release);
+unlock:
+	ofi_mutex_unlock(&matrix->lock);
+	return peer;
+}
+
+void prof_peer_add(struct prof_peer_matrix *matrix, struct fid_ep *hep,
+                   enum prof_peer_op op, fi_addr_t addr, size_t len)
+{
+	struct prof_peer *peer;
+	size_t slot;
+
+	peer = prof_peer_find(matrix, addr, &slot);
+	if (OFI_UNLIKELY(!peer)) {
+		peer = ofi_atomic_load_explicit32(&matrix->full,
+						  memory_order_acquire) ?
+		       &matrix->other : prof_peer_insert(matrix, hep, addr);
+	}
+
+	ofi_atomic_inc64(&peer->count[op]);
+	ofi_atomic_add64(&peer->sum[op], (int64_t) len);
+}
+
+static bool prof_peer_empty(struct prof_peer *peer)
+{
+	int op;
+
+	for (op = 0; op < PROF_PEER_OP_MAX; op++) {
+		if (ofi_atomic_get64(&peer->count[op]))
+			return false;
+	}
+	return true;
+}
+
+static void prof_peer_write(FILE *file, const char *local,
+                            struct prof_peer *peer, const char *name)
+{
+	uint64_t count;
+	int op;
+
+	for (op = 0; op < PROF_PEER_OP_MAX; op++) {
+		count = (uint64_t) ofi_atomic_get64(&peer->count[op]);
+		if (!count)
+			continue;
+		fprintf(file, "%s,%s,%" PRIu64 ",%s,%" PRIu64 ",%" PRIu64 "\n",
+			local, name, peer->addr == FI_ADDR_NOTAVAIL ? 0 :
+			(uint64_t) peer->addr, prof_peer_op_str[op], count,
+			(uint64_t) ofi_atomic_get64(&peer->sum[op]));
+	}
+}
+
+/*
+ * Writes the matrix as CSV rows of local,peer,fi_addr,op,count,bytes.
+ * The local and peer columns hold the endpoint and peer addresses in the
+ * format of fi_av_straddr, so the files of all ranks of a job can be
+ * concatenated and aggregated by address.  Peers beyond the tracked
+ * maximum are reported as peer "*".
+ */
+void prof_peer_report(const struct fi_provider *hprov,
+                      struct prof_peer_matrix *matrix)
+{
+	char hostname[HOST_NAME_MAX + 1];
+	char path[PATH_MAX];
+	const char *local;
+	FILE *file;
+	size_t i;
+
+	if (!matrix->enabled ||
+	    (!matrix->cnt && prof_peer_empty(&matrix->other)))
+		return;
+
+	if (gethostname(hostname, sizeof(hostname)))
+		strcpy(hostname, "localhost");
+	hostname[HOST_NAME_MAX] = '\0';
+
+	if (snprintf(path, sizeof(path), "%s/%s_%d_%d.csv", prof_peer_env.path,
+		     hostname, getpid(), prof_peer_seq++) >= sizeof(path)) {
+		FI_WARN(hprov, FI_LOG_CORE, "Peer matrix path too long\n");
+		return;
+	}
+
+	file = fopen(path, "w");
+	if (!file) {
+		FI_WARN(hprov, FI_LOG_CORE, "Failed to create %s: %s\n", path,
+			strerror(errno));
+		return;
+	}
+
+	local = matrix->local ? matrix->local : hostname;
+	fprintf(file, "local,peer,fi_addr,op,count,bytes\n");
+	for (i = 0; i < matrix->cnt; i++)
+		prof_peer_write(file, local, &matrix->peers[i],
+				matrix->peers[i].name ? matrix->peers[i].name : "");
+	prof_peer_write(file, local, &matrix->other, "*");
+	fclose(file);
+
+	FI_INFO(hprov, FI_LOG_CORE, "Wrote matrix of %zu peers to %s\n",
+		matrix->cnt, path);
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _RECORD_FILE_H_
+#define _RECORD_FILE_H_
+
+#include <stdint.h>
+
+/*
+ * Layout of the files written by the ofi_hook_record provider, which
+ * record the communication pattern of a process for later replay.  The
+ * layout is private to the hook and to fi_multinode_replay in fabtests,
+ * which includes this header from the source tree.
+ *
+ * A file holds one process' calls, in call order, as an ofi_record_header
+ * followed by ofi_record_entry structures.  The name and av_insert entries
+ * are followed by len bytes of address, padded to a multiple of 8 bytes.
+ * Completions carry the context of the operation that they complete,
+ * which makes the dependencies between operations replayable.
+ */
+#define OFI_RECORD_MAGIC	0x445243455249464fULL	/* "OFIRECRD" */
+#define OFI_RECORD_VERSION	2
+
+enum ofi_record_op {
+	OFI_RECORD_NAME,
+	OFI_RECORD_AV_INSERT,
+	OFI_RECORD_SEND,
+	OFI_RECORD_INJECT,
+	OFI_RECORD_RECV,
+	OFI_RECORD_TSEND,
+	OFI_RECORD_TINJECT,
+	OFI_RECORD_TRECV,
+	OFI_RECORD_READ,
+	OFI_RECORD_WRITE,
+	OFI_RECORD_INJECT_WRITE,
+	OFI_RECORD_CQ_COMP,
+	OFI_RECORD_CQ_ERR,
+	OFI_RECORD_OP_MAX
+};
+
+struct ofi_record_header {
+	uint64_t	magic;
+	uint32_t	version;
+	uint32_t	entry_size;
+	uint32_t	pid;
+	uint32_t	rsvd;
+};
+
+/*
+ * ns is the time since the record file was opened.  index is the endpoint
+ * of operations and names, and the CQ of completions.  addr is the peer
+ * fi_addr_t of operations, the inserted fi_addr_t of av_insert, and the
+ * source address of completions read with fi_cq_readfrom.  aux holds the
+ * ignore bits of tagged receives, the target address of RMA operations,
+ * whose key is stored in tag, and the flags of completions.  err is only
+ * set for completions read with fi_cq_readerr.
+ */
+struct ofi_record_entry {
+	uint64_t	ns;
+	uint64_t	context;
+	uint64_t	len;
+	uint64_t	tag;
+	uint64_t	aux;
+	uint64_t	addr;
+	uint32_t	index;
+	uint32_t	op;
+	uint32_t	err;
+	uint32_t	rsvd;
+};
+
+#endif /* _RECORD_FILE_H_ */
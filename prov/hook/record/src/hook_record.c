@@ -0,0 +1,1139 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <config.h>
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "ofi_hook.h"
+#include "ofi_prov.h"
+#include "ofi_iov.h"
+#include "hook_prov.h"
+
+#include "hook_record.h"
+
+/*
+ * All fabrics of a process share one record file, which is opened by the
+ * first fabric and closed with the last one.  Entries are appended through
+ * a buffered stream under record_lock, so the file reflects the order in
+ * which the calls returned.  Endpoints and CQs are numbered in the order
+ * in which they are first seen.
+ */
+#define RECORD_NAME_MAX		256
+
+struct hook_prov_ctx hook_record_ctx;
+
+static struct {
+	char basepath[PATH_MAX];
+} record_env = {
+	.basepath = RECORD_BASEPATH_DEFAULT,
+};
+
+static struct {
+	FILE *file;
+	int refcnt;
+	uint64_t start_ns;
+	const void **ep;
+	size_t ep_cnt;
+	const void **cq;
+	size_t cq_cnt;
+} record;
+
+static pthread_mutex_t record_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const size_t record_cq_entry_size[] = {
+	[FI_CQ_FORMAT_UNSPEC] = 0,
+	[FI_CQ_FORMAT_CONTEXT] = sizeof(struct fi_cq_entry),
+	[FI_CQ_FORMAT_MSG] = sizeof(struct fi_cq_msg_entry),
+	[FI_CQ_FORMAT_DATA] = sizeof(struct fi_cq_data_entry),
+	[FI_CQ_FORMAT_TAGGED] = sizeof(struct fi_cq_tagged_entry),
+};
+
+/*
+ * Files are created in a private <basepath>/<uid> folder.  The basepath
+ * may be shared by several users, so the folder is only used if it is
+ * owned by the calling user and not accessible to anyone else.
+ */
+static int record_open_dir(char *dirpath, size_t len)
+{
+	const struct fi_provider *prov = &hook_record_ctx.prov;
+	struct stat st;
+
+	if (mkdir(record_env.basepath, 01777) && errno != EEXIST) {
+		FI_WARN(prov, FI_LOG_CORE, "Could not create folder at %s: %s\n",
+			record_env.basepath, strerror(errno));
+		return -FI_EIO;
+	}
+
+	if (snprintf(dirpath, len, "%s/%u", record_env.basepath,
+		     getuid()) >= len) {
+		FI_WARN(prov, FI_LOG_CORE, "Record folder path too long\n");
+		return -FI_EINVAL;
+	}
+
+	if (mkdir(dirpath, RECORD_DIR_MODE) && errno != EEXIST) {
+		FI_WARN(prov, FI_LOG_CORE, "Could not create folder at %s: %s\n",
+			dirpath, strerror(errno));
+		return -FI_EIO;
+	}
+
+	if (lstat(dirpath, &st) || !S_ISDIR(st.st_mode) ||
+	    st.st_uid != getuid() || (st.st_mode & 077)) {
+		FI_WARN(prov, FI_LOG_CORE,
+			"%s is not a private folder of the current user\n",
+			dirpath);
+		return -FI_EPERM;
+	}
+	return 0;
+}
+
+static int record_open(void)
+{
+	const struct fi_provider *prov = &hook_record_ctx.prov;
+	struct ofi_record_header hdr = {
+		.magic = OFI_RECORD_MAGIC,
+		.version = OFI_RECORD_VERSION,
+		.entry_size = sizeof(struct ofi_record_entry),
+	};
+	char hostname[HOST_NAME_MAX + 1];
+	char dirpath[PATH_MAX];
+	char path[PATH_MAX];
+	int ret, fd;
+
+	ret = record_open_dir(dirpath, sizeof(dirpath));
+	if (ret)
+		return ret;
+
+	if (gethostname(hostname, sizeof(hostname)))
+		strcpy(hostname, "localhost");
+	hostname[HOST_NAME_MAX] = '\0';
+
+	if (snprintf(path, sizeof(path), "%s/%s_%d.rec", dirpath,
+		     hostname, getpid()) >= sizeof(path)) {
+		FI_WARN(prov, FI_LOG_CORE, "Record file path too long\n");
+		return -FI_EINVAL;
+	}
+
+	/* The file of an earlier process with the same pid is replaced */
+	fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW,
+		  RECORD_FILE_MODE);
+	if (fd < 0 && errno == EEXIST && !unlink(path))
+		fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW,
+			  RECORD_FILE_MODE);
+	if (fd < 0) {
+		FI_WARN(prov, FI_LOG_CORE, "Failed to create %s: %s\n",
+			path, strerror(errno));
+		return -FI_EIO;
+	}
+
+	record.file = fdopen(fd, "w");
+	if (!record.file) {
+		FI_WARN(prov, FI_LOG_CORE, "Failed to open %s: %s\n",
+			path, strerror(errno));
+		close(fd);
+		return -FI_EIO;
+	}
+
+	hdr.pid = getpid();
+	if (fwrite(&hdr, sizeof(hdr), 1, record.file) != 1) {
+		FI_WARN(prov, FI_LOG_CORE, "Failed to write %s\n", path);
+		fclose(record.file);
+		record.file = NULL;
+		return -FI_EIO;
+	}
+
+	record.start_ns = ofi_gettime_ns();
+	FI_INFO(prov, FI_LOG_CORE, "Recording to %s\n", path);
+	return 0;
+}
+
+static void record_close(void)
+{
+	if (record.file) {
+		fclose(record.file);
+		record.file = NULL;
+	}
+	free(record.ep);
+	free(record.cq);
+	memset(&record, 0, sizeof(record));
+}
+
+static int record_index(const void ***table, size_t *cnt, const void *fid,
+			bool *added)
+{
+	const void **tmp;
+	size_t i;
+
+	*added = false;
+	for (i = 0; i < *cnt; i++) {
+		if ((*table)[i] == fid)
+			return (int) i;
+	}
+
+	tmp = realloc(*table, (*cnt + 1) * sizeof(**table));
+	if (!tmp)
+		return -FI_ENOMEM;
+
+	tmp[*cnt] = fid;
+	*table = tmp;
+	*added = true;
+	return (int) (*cnt)++;
+}
+
+/* Called with record_lock held */
+static void record_write(struct ofi_record_entry *entry, const void *payload)
+{
+	static const uint8_t pad[8];
+	size_t padlen;
+
+	entry->ns = ofi_gettime_ns() - record.start_ns;
+	if (fwrite(entry, sizeof(*entry), 1, record.file) != 1)
+		goto err;
+
+	if (payload && entry->len) {
+		padlen = ofi_get_aligned_size(entry->len, 8) - entry->len;
+		if (fwrite(payload, entry->len, 1, record.file) != 1 ||
+		    (padlen && fwrite(pad, padlen, 1, record.file) != 1))
+			goto err;
+	}
+	return;
+err:
+	FI_WARN(&hook_record_ctx.prov, FI_LOG_CORE,
+		"Failed to write record file, recording stopped\n");
+	fclose(record.file);
+	record.file = NULL;
+}
+
+/* Called with record_lock held */
+static int record_ep_index(struct hook_ep *ep)
+{
+	struct ofi_record_entry entry = {
+		.op = OFI_RECORD_NAME,
+		.addr = FI_ADDR_NOTAVAIL,
+	};
+	uint8_t name[RECORD_NAME_MAX];
+	size_t len = sizeof(name);
+	bool added;
+	int index;
+
+	index = record_index(&record.ep, &record.ep_cnt, ep, &added);
+	if (index < 0 || !added)
+		return index;
+
+	/* The name is only known once the endpoint is enabled, which is
+	 * guaranteed by the time that it transfers data.
+	 */
+	if (fi_getname(&ep->hep->fid, name, &len))
+		len = 0;
+
+	entry.index = index;
+	entry.len = len;
+	record_write(&entry, name);
+	return index;
+}
+
+static void
+record_post(struct hook_ep *ep, enum ofi_record_op op, size_t len,
+	    fi_addr_t addr, uint64_t tag, uint64_t aux, void *context)
+{
+	struct ofi_record_entry entry = {
+		.context = (uintptr_t) context,
+		.len = len,
+		.tag = tag,
+		.aux = aux,
+		.addr = addr,
+		.op = op,
+	};
+	int index;
+
+	pthread_mutex_lock(&record_lock);
+	if (!record.file)
+		goto unlock;
+
+	index = record_ep_index(ep);
+	if (index < 0)
+		goto unlock;
+
+	entry.index = index;
+	record_write(&entry, NULL);
+unlock:
+	pthread_mutex_unlock(&record_lock);
+}
+
+static void
+record_cq(struct hook_cq *cq, ssize_t count, void *buf, fi_addr_t *src_addr)
+{
+	struct ofi_record_entry entry = {
+		.op = OFI_RECORD_CQ_COMP,
+	};
+	struct fi_cq_tagged_entry *comp;
+	bool added;
+	int index;
+	ssize_t i;
+
+	if (cq->format == FI_CQ_FORMAT_UNSPEC)
+		return;
+
+	pthread_mutex_lock(&record_lock);
+	if (!record.file)
+		goto unlock;
+
+	index = record_index(&record.cq, &record.cq_cnt, cq, &added);
+	if (index < 0)
+		goto unlock;
+
+	entry.index = index;
+	for (i = 0; i < count && record.file; i++) {
+		comp = (struct fi_cq_tagged_entry *)
+			((char *) buf + i * record_cq_entry_size[cq->format]);
+		entry.context = (uintptr_t) comp->op_context;
+		entry.len = cq->format >= FI_CQ_FORMAT_MSG ? comp->len : 0;
+		entry.tag = cq->format == FI_CQ_FORMAT_TAGGED ? comp->tag : 0;
+		entry.aux = cq->format >= FI_CQ_FORMAT_MSG ? comp->flags : 0;
+		entry.addr = src_addr ? src_addr[i] : FI_ADDR_NOTAVAIL;
+		record_write(&entry, NULL);
+	}
+unlock:
+	pthread_mutex_unlock(&record_lock);
+}
+
+static void record_cq_err(struct hook_cq *cq, struct fi_cq_err_entry *err)
+{
+	struct ofi_record_entry entry = {
+		.context = (uintptr_t) err->op_context,
+		.len = err->len,
+		.tag = err->tag,
+		.aux = err->flags,
+		.addr = FI_ADDR_NOTAVAIL,
+		.op = OFI_RECORD_CQ_ERR,
+		.err = (uint32_t) err->err,
+	};
+	bool added;
+	int index;
+
+	pthread_mutex_lock(&record_lock);
+	if (!record.file)
+		goto unlock;
+
+	index = record_index(&record.cq, &record.cq_cnt, cq, &added);
+	if (index < 0)
+		goto unlock;
+
+	entry.index = index;
+	record_write(&entry, NULL);
+unlock:
+	pthread_mutex_unlock(&record_lock);
+}
+
+#define RECORD_MSG(ret, ep, op, len, addr, context)			\
+	if (!(ret))							\
+		record_post(ep, op, len, addr, 0, 0, context)
+
+#define RECORD_TAGGED(ret, ep, op, len, addr, tag, ignore, context)	\
+	if (!(ret))							\
+		record_post(ep, op, len, addr, tag, ignore, context)
+
+#define RECORD_RMA(ret, ep, op, len, addr, raddr, key, context)	\
+	if (!(ret))							\
+		record_post(ep, op, len, addr, key, raddr, context)
+
+/*
+ * Message operations
+ */
+static ssize_t
+record_msg_recv(struct fid_ep *ep, void *buf, size_t len, void *desc,
+		fi_addr_t src_addr, void *context)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_recv(myep->hep, buf, len, desc, src_addr, context);
+	RECORD_MSG(ret, myep, OFI_RECORD_RECV, len, src_addr, context);
+	return ret;
+}
+
+static ssize_t
+record_msg_recvv(struct fid_ep *ep, const struct iovec *iov, void **desc,
+		 size_t count, fi_addr_t src_addr, void *context)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_recvv(myep->hep, iov, desc, count, src_addr, context);
+	RECORD_MSG(ret, myep, OFI_RECORD_RECV, ofi_total_iov_len(iov, count),
+		   src_addr, context);
+	return ret;
+}
+
+static ssize_t
+record_msg_recvmsg(struct fid_ep *ep, const struct fi_msg *msg,
+		   uint64_t flags)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_recvmsg(myep->hep, msg, flags);
+	RECORD_MSG(ret, myep, OFI_RECORD_RECV,
+		   ofi_total_iov_len(msg->msg_iov, msg->iov_count),
+		   msg->addr, msg->context);
+	return ret;
+}
+
+static ssize_t
+record_msg_send(struct fid_ep *ep, const void *buf, size_t len, void *desc,
+		fi_addr_t dest_addr, void *context)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_send(myep->hep, buf, len, desc, dest_addr, context);
+	RECORD_MSG(ret, myep, OFI_RECORD_SEND, len, dest_addr, context);
+	return ret;
+}
+
+static ssize_t
+record_msg_sendv(struct fid_ep *ep, const struct iovec *iov, void **desc,
+		 size_t count, fi_addr_t dest_addr, void *context)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_sendv(myep->hep, iov, desc, count, dest_addr, context);
+	RECORD_MSG(ret, myep, OFI_RECORD_SEND, ofi_total_iov_len(iov, count),
+		   dest_addr, context);
+	return ret;
+}
+
+static ssize_t
+record_msg_sendmsg(struct fid_ep *ep, const struct fi_msg *msg,
+		   uint64_t flags)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_sendmsg(myep->hep, msg, flags);
+	RECORD_MSG(ret, myep, OFI_RECORD_SEND,
+		   ofi_total_iov_len(msg->msg_iov, msg->iov_count),
+		   msg->addr, msg->context);
+	return ret;
+}
+
+static ssize_t
+record_msg_inject(struct fid_ep *ep, const void *buf, size_t len,
+		  fi_addr_t dest_addr)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_inject(myep->hep, buf, len, dest_addr);
+	RECORD_MSG(ret, myep, OFI_RECORD_INJECT, len, dest_addr, NULL);
+	return ret;
+}
+
+static ssize_t
+record_msg_senddata(struct fid_ep *ep, const void *buf, size_t len,
+		    void *desc, uint64_t data, fi_addr_t dest_addr,
+		    void *context)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_senddata(myep->hep, buf, len, desc, data, dest_addr, context);
+	RECORD_MSG(ret, myep, OFI_RECORD_SEND, len, dest_addr, context);
+	return ret;
+}
+
+static ssize_t
+record_msg_injectdata(struct fid_ep *ep, const void *buf, size_t len,
+		      uint64_t data, fi_addr_t dest_addr)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_injectdata(myep->hep, buf, len, data, dest_addr);
+	RECORD_MSG(ret, myep, OFI_RECORD_INJECT, len, dest_addr, NULL);
+	return ret;
+}
+
+static struct fi_ops_msg record_msg_ops = {
+	.size = sizeof(struct fi_ops_msg),
+	.recv = record_msg_recv,
+	.recvv = record_msg_recvv,
+	.recvmsg = record_msg_recvmsg,
+	.send = record_msg_send,
+	.sendv = record_msg_sendv,
+	.sendmsg = record_msg_sendmsg,
+	.inject = record_msg_inject,
+	.senddata = record_msg_senddata,
+	.injectdata = record_msg_injectdata,
+};
+
+/*
+ * RMA operations
+ */
+static ssize_t
+record_rma_read(struct fid_ep *ep, void *buf, size_t len, void *desc,
+		fi_addr_t src_addr, uint64_t addr, uint64_t key, void *context)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_read(myep->hep, buf, len, desc, src_addr, addr, key, context);
+	RECORD_RMA(ret, myep, OFI_RECORD_READ, len, src_addr, addr, key,
+		   context);
+	return ret;
+}
+
+static ssize_t
+record_rma_readv(struct fid_ep *ep, const struct iovec *iov, void **desc,
+		 size_t count, fi_addr_t src_addr, uint64_t addr, uint64_t key,
+		 void *context)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_readv(myep->hep, iov, desc, count, src_addr, addr, key,
+		       context);
+	RECORD_RMA(ret, myep, OFI_RECORD_READ, ofi_total_iov_len(iov, count),
+		   src_addr, addr, key, context);
+	return ret;
+}
+
+static ssize_t
+record_rma_readmsg(struct fid_ep *ep, const struct fi_msg_rma *msg,
+		   uint64_t flags)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_readmsg(myep->hep, msg, flags);
+	RECORD_RMA(ret, myep, OFI_RECORD_READ,
+		   ofi_total_iov_len(msg->msg_iov, msg->iov_count), msg->addr,
+		   msg->rma_iov_count ? msg->rma_iov[0].addr : 0,
+		   msg->rma_iov_count ? msg->rma_iov[0].key : 0, msg->context);
+	return ret;
+}
+
+static ssize_t
+record_rma_write(struct fid_ep *ep, const void *buf, size_t len, void *desc,
+		 fi_addr_t dest_addr, uint64_t addr, uint64_t key,
+		 void *context)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_write(myep->hep, buf, len, desc, dest_addr, addr, key,
+		       context);
+	RECORD_RMA(ret, myep, OFI_RECORD_WRITE, len, dest_addr, addr, key,
+		   context);
+	return ret;
+}
+
+static ssize_t
+record_rma_writev(struct fid_ep *ep, const struct iovec *iov, void **desc,
+		  size_t count, fi_addr_t dest_addr, uint64_t addr,
+		  uint64_t key, void *context)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_writev(myep->hep, iov, desc, count, dest_addr, addr, key,
+			context);
+	RECORD_RMA(ret, myep, OFI_RECORD_WRITE, ofi_total_iov_len(iov, count),
+		   dest_addr, addr, key, context);
+	return ret;
+}
+
+static ssize_t
+record_rma_writemsg(struct fid_ep *ep, const struct fi_msg_rma *msg,
+		    uint64_t flags)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_writemsg(myep->hep, msg, flags);
+	RECORD_RMA(ret, myep, OFI_RECORD_WRITE,
+		   ofi_total_iov_len(msg->msg_iov, msg->iov_count), msg->addr,
+		   msg->rma_iov_count ? msg->rma_iov[0].addr : 0,
+		   msg->rma_iov_count ? msg->rma_iov[0].key : 0, msg->context);
+	return ret;
+}
+
+static ssize_t
+record_rma_inject_write(struct fid_ep *ep, const void *buf, size_t len,
+			fi_addr_t dest_addr, uint64_t addr, uint64_t key)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_inject_write(myep->hep, buf, len, dest_addr, addr, key);
+	RECORD_RMA(ret, myep, OFI_RECORD_INJECT_WRITE, len, dest_addr, addr,
+		   key, NULL);
+	return ret;
+}
+
+static ssize_t
+record_rma_writedata(struct fid_ep *ep, const void *buf, size_t len,
+		     void *desc, uint64_t data, fi_addr_t dest_addr,
+		     uint64_t addr, uint64_t key, void *context)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_writedata(myep->hep, buf, len, desc, data, dest_addr, addr,
+			   key, context);
+	RECORD_RMA(ret, myep, OFI_RECORD_WRITE, len, dest_addr, addr, key,
+		   context);
+	return ret;
+}
+
+static ssize_t
+record_rma_inject_writedata(struct fid_ep *ep, const void *buf, size_t len,
+			    uint64_t data, fi_addr_t dest_addr, uint64_t addr,
+			    uint64_t key)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_inject_writedata(myep->hep, buf, len, data, dest_addr, addr,
+				  key);
+	RECORD_RMA(ret, myep, OFI_RECORD_INJECT_WRITE, len, dest_addr, addr,
+		   key, NULL);
+	return ret;
+}
+
+static struct fi_ops_rma record_rma_ops = {
+	.size = sizeof(struct fi_ops_rma),
+	.read = record_rma_read,
+	.readv = record_rma_readv,
+	.readmsg = record_rma_readmsg,
+	.write = record_rma_write,
+	.writev = record_rma_writev,
+	.writemsg = record_rma_writemsg,
+	.inject = record_rma_inject_write,
+	.writedata = record_rma_writedata,
+	.injectdata = record_rma_inject_writedata,
+};
+
+/*
+ * Tagged operations
+ */
+static ssize_t
+record_trecv(struct fid_ep *ep, void *buf, size_t len, void *desc,
+	     fi_addr_t src_addr, uint64_t tag, uint64_t ignore, void *context)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_trecv(myep->hep, buf, len, desc, src_addr, tag, ignore,
+		       context);
+	RECORD_TAGGED(ret, myep, OFI_RECORD_TRECV, len, src_addr, tag, ignore,
+		      context);
+	return ret;
+}
+
+static ssize_t
+record_trecvv(struct fid_ep *ep, const struct iovec *iov, void **desc,
+	      size_t count, fi_addr_t src_addr, uint64_t tag, uint64_t ignore,
+	      void *context)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_trecvv(myep->hep, iov, desc, count, src_addr, tag, ignore,
+			context);
+	RECORD_TAGGED(ret, myep, OFI_RECORD_TRECV,
+		      ofi_total_iov_len(iov, count), src_addr, tag, ignore,
+		      context);
+	return ret;
+}
+
+static ssize_t
+record_trecvmsg(struct fid_ep *ep, const struct fi_msg_tagged *msg,
+		uint64_t flags)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_trecvmsg(myep->hep, msg, flags);
+	RECORD_TAGGED(ret, myep, OFI_RECORD_TRECV,
+		      ofi_total_iov_len(msg->msg_iov, msg->iov_count),
+		      msg->addr, msg->tag, msg->ignore, msg->context);
+	return ret;
+}
+
+static ssize_t
+record_tsend(struct fid_ep *ep, const void *buf, size_t len, void *desc,
+	     fi_addr_t dest_addr, uint64_t tag, void *context)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_tsend(myep->hep, buf, len, desc, dest_addr, tag, context);
+	RECORD_TAGGED(ret, myep, OFI_RECORD_TSEND, len, dest_addr, tag, 0,
+		      context);
+	return ret;
+}
+
+static ssize_t
+record_tsendv(struct fid_ep *ep, const struct iovec *iov, void **desc,
+	      size_t count, fi_addr_t dest_addr, uint64_t tag, void *context)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_tsendv(myep->hep, iov, desc, count, dest_addr, tag, context);
+	RECORD_TAGGED(ret, myep, OFI_RECORD_TSEND,
+		      ofi_total_iov_len(iov, count), dest_addr, tag, 0,
+		      context);
+	return ret;
+}
+
+static ssize_t
+record_tsendmsg(struct fid_ep *ep, const struct fi_msg_tagged *msg,
+		uint64_t flags)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_tsendmsg(myep->hep, msg, flags);
+	RECORD_TAGGED(ret, myep, OFI_RECORD_TSEND,
+		      ofi_total_iov_len(msg->msg_iov, msg->iov_count),
+		      msg->addr, msg->tag, 0, msg->context);
+	return ret;
+}
+
+static ssize_t
+record_tinject(struct fid_ep *ep, const void *buf, size_t len,
+	       fi_addr_t dest_addr, uint64_t tag)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_tinject(myep->hep, buf, len, dest_addr, tag);
+	RECORD_TAGGED(ret, myep, OFI_RECORD_TINJECT, len, dest_addr, tag, 0,
+		      NULL);
+	return ret;
+}
+
+static ssize_t
+record_tsenddata(struct fid_ep *ep, const void *buf, size_t len, void *desc,
+		 uint64_t data, fi_addr_t dest_addr, uint64_t tag,
+		 void *context)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_tsenddata(myep->hep, buf, len, desc, data, dest_addr, tag,
+			   context);
+	RECORD_TAGGED(ret, myep, OFI_RECORD_TSEND, len, dest_addr, tag, 0,
+		      context);
+	return ret;
+}
+
+static ssize_t
+record_tinjectdata(struct fid_ep *ep, const void *buf, size_t len,
+		   uint64_t data, fi_addr_t dest_addr, uint64_t tag)
+{
+	struct hook_ep *myep = container_of(ep, struct hook_ep, ep);
+	ssize_t ret;
+
+	ret = fi_tinjectdata(myep->hep, buf, len, data, dest_addr, tag);
+	RECORD_TAGGED(ret, myep, OFI_RECORD_TINJECT, len, dest_addr, tag, 0,
+		      NULL);
+	return ret;
+}
+
+static struct fi_ops_tagged record_tagged_ops = {
+	.size = sizeof(struct fi_ops_tagged),
+	.recv = record_trecv,
+	.recvv = record_trecvv,
+	.recvmsg = record_trecvmsg,
+	.send = record_tsend,
+	.sendv = record_tsendv,
+	.sendmsg = record_tsendmsg,
+	.inject = record_tinject,
+	.senddata = record_tsenddata,
+	.injectdata = record_tinjectdata,
+};
+
+/*
+ * CQ operations
+ */
+static ssize_t record_cq_read(struct fid_cq *cq, void *buf, size_t count)
+{
+	struct hook_cq *mycq = container_of(cq, struct hook_cq, cq);
+	ssize_t ret;
+
+	ret = fi_cq_read(mycq->hcq, buf, count);
+	if (ret > 0)
+		record_cq(mycq, ret, buf, NULL);
+	return ret;
+}
+
+static ssize_t
+record_cq_readfrom(struct fid_cq *cq, void *buf, size_t count,
+		   fi_addr_t *src_addr)
+{
+	struct hook_cq *mycq = container_of(cq, struct hook_cq, cq);
+	ssize_t ret;
+
+	ret = fi_cq_readfrom(mycq->hcq, buf, count, src_addr);
+	if (ret > 0)
+		record_cq(mycq, ret, buf, src_addr);
+	return ret;
+}
+
+static ssize_t
+record_cq_readerr(struct fid_cq *cq, struct fi_cq_err_entry *buf,
+		  uint64_t flags)
+{
+	struct hook_cq *mycq = container_of(cq, struct hook_cq, cq);
+	ssize_t ret;
+
+	ret = fi_cq_readerr(mycq->hcq, buf, flags);
+	if (ret > 0)
+		record_cq_err(mycq, buf);
+	return ret;
+}
+
+static ssize_t
+record_cq_sread(struct fid_cq *cq, void *buf, size_t count,
+		const void *cond, int timeout)
+{
+	struct hook_cq *mycq = container_of(cq, struct hook_cq, cq);
+	ssize_t ret;
+
+	ret = fi_cq_sread(mycq->hcq, buf, count, cond, timeout);
+	if (ret > 0)
+		record_cq(mycq, ret, buf, NULL);
+	return ret;
+}
+
+static ssize_t
+record_cq_sreadfrom(struct fid_cq *cq, void *buf, size_t count,
+		    fi_addr_t *src_addr, const void *cond, int timeout)
+{
+	struct hook_cq *mycq = container_of(cq, struct hook_cq, cq);
+	ssize_t ret;
+
+	ret = fi_cq_sreadfrom(mycq->hcq, buf, count, src_addr, cond, timeout);
+	if (ret > 0)
+		record_cq(mycq, ret, buf, src_addr);
+	return ret;
+}
+
+static int record_cq_signal(struct fid_cq *cq)
+{
+	struct hook_cq *mycq = container_of(cq, struct hook_cq, cq);
+
+	return fi_cq_signal(mycq->hcq);
+}
+
+static struct fi_ops_cq record_cq_ops = {
+	.size = sizeof(struct fi_ops_cq),
+	.read = record_cq_read,
+	.readfrom = record_cq_readfrom,
+	.readerr = record_cq_readerr,
+	.sread = record_cq_sread,
+	.sreadfrom = record_cq_sreadfrom,
+	.signal = record_cq_signal,
+	.strerror = hook_cq_strerror,
+};
+
+/*
+ * AV operations
+ */
+static void
+record_av_insert_entries(struct hook_av *av, fi_addr_t *fi_addr, size_t count)
+{
+	struct ofi_record_entry entry = {
+		.op = OFI_RECORD_AV_INSERT,
+	};
+	uint8_t name[RECORD_NAME_MAX];
+	size_t i, len;
+
+	pthread_mutex_lock(&record_lock);
+	for (i = 0; i < count && record.file; i++) {
+		if (fi_addr[i] == FI_ADDR_NOTAVAIL)
+			continue;
+
+		len = sizeof(name);
+		if (fi_av_lookup(av->hav, fi_addr[i], name, &len) ||
+		    len > sizeof(name))
+			len = 0;
+
+		entry.addr = fi_addr[i];
+		entry.len = len;
+		record_write(&entry, name);
+	}
+	pthread_mutex_unlock(&record_lock);
+}
+
+static int
+record_av_insert(struct fid_av *av, const void *addr, size_t count,
+		 fi_addr_t *fi_addr, uint64_t flags, void *context)
+{
+	struct hook_av *myav = container_of(av, struct hook_av, av);
+	fi_addr_t *addrs = fi_addr;
+	int ret;
+
+	/* The inserted addresses are needed to map peers during replay */
+	if (!addrs) {
+		addrs = calloc(count, sizeof(*addrs));
+		if (!addrs)
+			return -FI_ENOMEM;
+	}
+
+	ret = fi_av_insert(myav->hav, addr, count, addrs, flags, context);
+	if (ret > 0)
+		record_av_insert_entries(myav, addrs, count);
+
+	if (addrs != fi_addr)
+		free(addrs);
+	return ret;
+}
+
+static int
+record_av_insertsvc(struct fid_av *av, const char *node, const char *service,
+		    fi_addr_t *fi_addr, uint64_t flags, void *context)
+{
+	struct hook_av *myav = container_of(av, struct hook_av, av);
+	fi_addr_t addr;
+	int ret;
+
+	ret = fi_av_insertsvc(myav->hav, node, service, &addr, flags, context);
+	if (ret > 0) {
+		record_av_insert_entries(myav, &addr, 1);
+		if (fi_addr)
+			*fi_addr = addr;
+	}
+	return ret;
+}
+
+static int
+record_av_insertsym(struct fid_av *av, const char *node, size_t nodecnt,
+		    const char *service, size_t svccnt, fi_addr_t *fi_addr,
+		    uint64_t flags, void *context)
+{
+	struct hook_av *myav = container_of(av, struct hook_av, av);
+	fi_addr_t *addrs = fi_addr;
+	int ret;
+
+	if (!addrs) {
+		addrs = calloc(nodecnt * svccnt, sizeof(*addrs));
+		if (!addrs)
+			return -FI_ENOMEM;
+	}
+
+	ret = fi_av_insertsym(myav->hav, node, nodecnt, service, svccnt,
+			      addrs, flags, context);
+	if (ret > 0)
+		record_av_insert_entries(myav, addrs, nodecnt * svccnt);
+
+	if (addrs != fi_addr)
+		free(addrs);
+	return ret;
+}
+
+static int
+record_av_remove(struct fid_av *av, fi_addr_t *fi_addr, size_t count,
+		 uint64_t flags)
+{
+	struct hook_av *myav = container_of(av, struct hook_av, av);
+
+	return fi_av_remove(myav->hav, fi_addr, count, flags);
+}
+
+static int
+record_av_lookup(struct fid_av *av, fi_addr_t fi_addr, void *addr,
+		 size_t *addrlen)
+{
+	struct hook_av *myav = container_of(av, struct hook_av, av);
+
+	return fi_av_lookup(myav->hav, fi_addr, addr, addrlen);
+}
+
+static const char *
+record_av_straddr(struct fid_av *av, const void *addr, char *buf, size_t *len)
+{
+	struct hook_av *myav = container_of(av, struct hook_av, av);
+
+	return fi_av_straddr(myav->hav, addr, buf, len);
+}
+
+static struct fi_ops_av record_av_ops = {
+	.size = sizeof(struct fi_ops_av),
+	.insert = record_av_insert,
+	.insertsvc = record_av_insertsvc,
+	.insertsym = record_av_insertsym,
+	.remove = record_av_remove,
+	.lookup = record_av_lookup,
+	.straddr = record_av_straddr,
+};
+
+/*
+ * Domain operations
+ */
+static int
+record_av_open(struct fid_domain *domain, struct fi_av_attr *attr,
+	       struct fid_av **av, void *context)
+{
+	int ret;
+
+	ret = hook_av_open(domain, attr, av, context);
+	if (!ret)
+		(*av)->ops = &record_av_ops;
+	return ret;
+}
+
+static struct fi_ops_domain record_domain_ops = {
+	.size = sizeof(struct fi_ops_domain),
+	.av_open = record_av_open,
+	.cq_open = hook_cq_open,
+	.endpoint = hook_endpoint,
+	.scalable_ep = hook_scalable_ep,
+	.cntr_open = hook_cntr_open,
+	.poll_open = hook_poll_open,
+	.stx_ctx = hook_stx_ctx,
+	.srx_ctx = hook_srx_ctx,
+	.query_atomic = hook_query_atomic,
+	.query_collective = hook_query_collective,
+};
+
+static int record_domain_init(struct fid *fid)
+{
+	struct fid_domain *domain = container_of(fid, struct fid_domain, fid);
+
+	domain->ops = &record_domain_ops;
+	return 0;
+}
+
+static int record_cq_init(struct fid *fid)
+{
+	struct fid_cq *cq = container_of(fid, struct fid_cq, fid);
+
+	cq->ops = &record_cq_ops;
+	return 0;
+}
+
+static int record_ep_init(struct fid *fid)
+{
+	struct fid_ep *ep = container_of(fid, struct fid_ep, fid);
+
+	ep->msg = &record_msg_ops;
+	ep->rma = &record_rma_ops;
+	ep->tagged = &record_tagged_ops;
+	return 0;
+}
+
+/*
+ * Fabric operations
+ */
+static int record_fabric_close(struct fid *fid)
+{
+	pthread_mutex_lock(&record_lock);
+	if (--record.refcnt == 0)
+		record_close();
+	pthread_mutex_unlock(&record_lock);
+
+	return hook_close(fid);
+}
+
+static struct fi_ops record_fabric_fid_ops = {
+	.size = sizeof(struct fi_ops),
+	.close = record_fabric_close,
+	.bind = hook_bind,
+	.control = hook_control,
+	.ops_open = hook_ops_open,
+};
+
+static int hook_record_fabric(struct fi_fabric_attr *attr,
+			      struct fid_fabric **fabric, void *context)
+{
+	struct fi_provider *hprov = context;
+	struct hook_fabric *fab;
+
+	FI_TRACE(hprov, FI_LOG_FABRIC, "Installing record hook\n");
+	fab = calloc(1, sizeof *fab);
+	if (!fab)
+		return -FI_ENOMEM;
+
+	/* A failure to open the file leaves the fabric usable, unrecorded */
+	pthread_mutex_lock(&record_lock);
+	if (record.refcnt++ == 0)
+		(void) record_open();
+	pthread_mutex_unlock(&record_lock);
+
+	hook_fabric_init(fab, HOOK_RECORD, attr->fabric, hprov,
+			 &record_fabric_fid_ops, &hook_record_ctx);
+	*fabric = &fab->fabric;
+	return 0;
+}
+
+struct hook_prov_ctx hook_record_ctx = {
+	.prov = {
+		.version = OFI_VERSION_DEF_PROV,
+		/* We're a pass-through provider, so the fi_version is always the latest */
+		.fi_version = OFI_VERSION_LATEST,
+		.name = "ofi_hook_record",
+		.getinfo = NULL,
+		.fabric = hook_record_fabric,
+		.cleanup = NULL,
+	},
+};
+
+static void record_env_init(void)
+{
+	struct fi_provider *prov = &hook_record_ctx.prov;
+	char *basepath = NULL;
+
+	fi_param_define(prov, "basepath", FI_PARAM_STRING,
+			"Directory where the record files are created. "
+			"(default: %s)", record_env.basepath);
+	fi_param_get_str(prov, "basepath", &basepath);
+	if (basepath && strlen(basepath) < PATH_MAX)
+		snprintf(record_env.basepath, PATH_MAX, "%s", basepath);
+}
+
+HOOK_RECORD_INI
+{
+	record_env_init();
+
+	hook_record_ctx.ini_fid[FI_CLASS_DOMAIN] = record_domain_init;
+	hook_record_ctx.ini_fid[FI_CLASS_CQ] = record_cq_init;
+	hook_record_ctx.ini_fid[FI_CLASS_EP] = record_ep_init;
+
+	return &hook_record_ctx.prov;
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _HOOK_TRACE_H_
+#define _HOOK_TRACE_H_
+
+#include <stdint.h>
+#include "ofi.h"
+
+/*
+ * Binary trace file layout, shared with util/trace_decode.c.
+ *
+ * Each thread that issues traced calls owns one file, made of a
+ * trace_header followed by ring_size fixed size records.  The thread is
+ * the only writer of its file.  head counts all records ever written, so
+ * the newest record is at (head - 1) % ring_size, and older records are
+ * overwritten once head exceeds ring_size.
+ */
+#define TRACE_MAGIC		0x45434152544f4649ULL	/* "OFITRACE" */
+#define TRACE_VERSION		1
+#define TRACE_RING_SIZE_DEFAULT	(1 << 16)
+#define TRACE_BASEPATH_DEFAULT	"/dev/shm/ofi_trace"
+#define TRACE_FILE_MODE		0600
+#define TRACE_DIR_MODE		0700
+
+#define TRACE_OPS(DECL)		\
+	DECL(trace_op_recv),	\
+	DECL(trace_op_recvv),	\
+	DECL(trace_op_recvmsg),	\
+	DECL(trace_op_send),	\
+	DECL(trace_op_sendv),	\
+	DECL(trace_op_sendmsg),	\
+	DECL(trace_op_inject),	\
+	DECL(trace_op_senddata),	\
+	DECL(trace_op_injectdata),	\
+	DECL(trace_op_read),	\
+	DECL(trace_op_readv),	\
+	DECL(trace_op_readmsg),	\
+	DECL(trace_op_write),	\
+	DECL(trace_op_writev),	\
+	DECL(trace_op_writemsg),	\
+	DECL(trace_op_inject_write),	\
+	DECL(trace_op_writedata),	\
+	DECL(trace_op_inject_writedata),	\
+	DECL(trace_op_trecv),	\
+	DECL(trace_op_trecvv),	\
+	DECL(trace_op_trecvmsg),	\
+	DECL(trace_op_tsend),	\
+	DECL(trace_op_tsendv),	\
+	DECL(trace_op_tsendmsg),	\
+	DECL(trace_op_tinject),	\
+	DECL(trace_op_tsenddata),	\
+	DECL(trace_op_tinjectdata),	\
+	DECL(trace_op_cq_comp),	\
+	DECL(trace_op_cq_err)
+
+enum trace_op {
+	TRACE_OPS(OFI_ENUM_VAL),
+	trace_op_size
+};
+
+struct trace_header {
+	uint64_t	magic;
+	uint32_t	version;
+	uint32_t	record_size;
+	uint64_t	ring_size;
+	uint64_t	head;
+	uint32_t	pid;
+	uint32_t	thread;
+	/* tick/time pairs taken at creation and later by the writer,
+	 * used to convert record ticks into nanoseconds */
+	uint64_t	base_ticks;
+	uint64_t	base_ns;
+	uint64_t	sync_ticks;
+	uint64_t	sync_ns;
+	uint8_t		rsvd[56];
+};
+
+/*
+ * Posted operations and completions carry the operation context, which
+ * links a completion back to the operation that it completes.  Posted
+ * operations are recorded against the endpoint, completions against the
+ * CQ.  err is only set for completions read with fi_cq_readerr.
+ */
+struct trace_record {
+	uint64_t	ticks;
+	uint64_t	fid;
+	uint64_t	context;
+	uint64_t	len;
+	uint64_t	tag;
+	uint64_t	addr;
+	uint64_t	flags;
+	uint16_t	op;
+	uint16_t	rsvd;
+	int32_t		err;
+};
+
+#endif /* _HOOK_TRACE_H_ */
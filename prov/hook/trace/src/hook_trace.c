@@ -32,9 +32,19 @@
 #include "ofi_hook.h"
 #include "ofi_prov.h"
 #include "ofi_iov.h"
+#include "ofi_mb.h"
+#include "hook_trace.h"
 #include <config.h>
 
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <rdma/fi_profile.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 struct hook_trace_ep {
 	struct hook_ep hook_ep;
 	struct fid_profile *prof_fid;
@@ -197,6 +207,305 @@ static void hook_trace_prof_init(void *context)
 
 #define TRACE_BUF_SIZE	1024
 
+/*
+ * Binary tracing: each thread appends fixed size records to its own ring,
+ * which is a file mapped from the basepath directory.  The thread is the
+ * only writer of the ring, so recording is a store into the mapping and a
+ * release of the new head, which lets a reader follow a live ring.  The
+ * rings are left mapped until the process exits.
+ */
+#define TRACE_SYNC_INTERVAL	(1 << 12)
+
+struct hook_prov_ctx hook_trace_ctx;
+
+struct trace_ring {
+	struct trace_header *hdr;
+	struct trace_record *rec;
+	uint64_t head;
+	uint64_t mask;
+	struct dlist_entry entry;
+};
+
+static struct {
+	int binary;
+	size_t ring_size;
+	char basepath[PATH_MAX];
+} trace_env = {
+	.binary = 0,
+	.ring_size = TRACE_RING_SIZE_DEFAULT,
+	.basepath = TRACE_BASEPATH_DEFAULT,
+};
+
+static OFI_THREAD_LOCAL struct trace_ring *trace_thread_ring;
+static OFI_THREAD_LOCAL bool trace_ring_failed;
+static DEFINE_LIST(trace_ring_list);
+static pthread_mutex_t trace_ring_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t trace_thread_cnt;
+
+static const size_t trace_cq_entry_size[] = {
+	[FI_CQ_FORMAT_UNSPEC] = 0,
+	[FI_CQ_FORMAT_CONTEXT] = sizeof(struct fi_cq_entry),
+	[FI_CQ_FORMAT_MSG] = sizeof(struct fi_cq_msg_entry),
+	[FI_CQ_FORMAT_DATA] = sizeof(struct fi_cq_data_entry),
+	[FI_CQ_FORMAT_TAGGED] = sizeof(struct fi_cq_tagged_entry),
+};
+
+static inline uint64_t trace_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#elif defined(__aarch64__)
+	uint64_t ticks;
+
+	asm volatile("mrs %0, cntvct_el0" : "=r" (ticks));
+	return ticks;
+#else
+	return ofi_gettime_ns();
+#endif
+}
+
+static void trace_ring_sync(struct trace_ring *ring)
+{
+	ring->hdr->sync_ticks = trace_ticks();
+	ring->hdr->sync_ns = ofi_gettime_ns();
+}
+
+/*
+ * Files are created in a private <basepath>/<uid> folder.  The basepath
+ * may be shared by several users, so the folder is only used if it is
+ * owned by the calling user and not accessible to anyone else.
+ */
+static int trace_open_dir(char *dirpath, size_t len)
+{
+	const struct fi_provider *prov = &hook_trace_ctx.prov;
+	struct stat st;
+
+	if (mkdir(trace_env.basepath, 01777) && errno != EEXIST) {
+		FI_WARN(prov, FI_LOG_CORE, "Could not create folder at %s: %s\n",
+			trace_env.basepath, strerror(errno));
+		return -errno;
+	}
+
+	if (snprintf(dirpath, len, "%s/%u", trace_env.basepath,
+		     getuid()) >= len) {
+		FI_WARN(prov, FI_LOG_CORE, "Trace folder path too long\n");
+		return -FI_EINVAL;
+	}
+
+	if (mkdir(dirpath, TRACE_DIR_MODE) && errno != EEXIST) {
+		FI_WARN(prov, FI_LOG_CORE, "Could not create folder at %s: %s\n",
+			dirpath, strerror(errno));
+		return -errno;
+	}
+
+	if (lstat(dirpath, &st) || !S_ISDIR(st.st_mode) ||
+	    st.st_uid != getuid() || (st.st_mode & 077)) {
+		FI_WARN(prov, FI_LOG_CORE,
+			"%s is not a private folder of the current user\n",
+			dirpath);
+		return -FI_EPERM;
+	}
+	return 0;
+}
+
+static struct trace_ring *trace_ring_create(void)
+{
+	const struct fi_provider *prov = &hook_trace_ctx.prov;
+	struct trace_ring *ring;
+	char hostname[HOST_NAME_MAX + 1];
+	char dirpath[PATH_MAX];
+	char path[PATH_MAX];
+	size_t size;
+	void *map;
+	int fd;
+
+	if (trace_open_dir(dirpath, sizeof(dirpath)))
+		return NULL;
+
+	if (gethostname(hostname, sizeof(hostname)))
+		strcpy(hostname, "localhost");
+	hostname[HOST_NAME_MAX] = '\0';
+
+	ring = calloc(1, sizeof(*ring));
+	if (!ring)
+		return NULL;
+
+	pthread_mutex_lock(&trace_ring_lock);
+	if (snprintf(path, sizeof(path), "%s/%s_%d_%u.trace",
+		     dirpath, hostname, getpid(),
+		     trace_thread_cnt) >= sizeof(path)) {
+		FI_WARN(prov, FI_LOG_CORE, "Trace file path too long\n");
+		goto err;
+	}
+
+	fd = open(path, O_CREAT | O_TRUNC | O_RDWR, TRACE_FILE_MODE);
+	if (fd < 0) {
+		FI_WARN(prov, FI_LOG_CORE, "Failed to create %s: %s\n",
+			path, strerror(errno));
+		goto err;
+	}
+
+	size = sizeof(*ring->hdr) + trace_env.ring_size * sizeof(*ring->rec);
+	if (ftruncate(fd, size)) {
+		FI_WARN(prov, FI_LOG_CORE, "Failed to truncate %s: %s\n",
+			path, strerror(errno));
+		goto err_close;
+	}
+
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		FI_WARN(prov, FI_LOG_CORE, "Failed to mmap %s: %s\n",
+			path, strerror(errno));
+		goto err_close;
+	}
+	close(fd);
+
+	ring->hdr = map;
+	ring->rec = (struct trace_record *) (ring->hdr + 1);
+	ring->mask = trace_env.ring_size - 1;
+
+	ring->hdr->version = TRACE_VERSION;
+	ring->hdr->record_size = sizeof(*ring->rec);
+	ring->hdr->ring_size = trace_env.ring_size;
+	ring->hdr->pid = getpid();
+	ring->hdr->thread = trace_thread_cnt++;
+	ring->hdr->base_ticks = trace_ticks();
+	ring->hdr->base_ns = ofi_gettime_ns();
+	trace_ring_sync(ring);
+	ofi_wmb();
+	ring->hdr->magic = TRACE_MAGIC;
+
+	dlist_insert_tail(&ring->entry, &trace_ring_list);
+	pthread_mutex_unlock(&trace_ring_lock);
+
+	FI_INFO(prov, FI_LOG_CORE, "Tracing thread %u to %s\n",
+		ring->hdr->thread, path);
+	return ring;
+
+err_close:
+	close(fd);
+	unlink(path);
+err:
+	pthread_mutex_unlock(&trace_ring_lock);
+	free(ring);
+	return NULL;
+}
+
+static void trace_sync_rings(void)
+{
+	struct trace_ring *ring;
+
+	pthread_mutex_lock(&trace_ring_lock);
+	dlist_foreach_container(&trace_ring_list, struct trace_ring,
+				ring, entry)
+		trace_ring_sync(ring);
+	pthread_mutex_unlock(&trace_ring_lock);
+}
+
+static inline struct trace_record *trace_record_get(void)
+{
+	struct trace_ring *ring = trace_thread_ring;
+
+	if (OFI_UNLIKELY(!ring)) {
+		if (trace_ring_failed)
+			return NULL;
+
+		ring = trace_ring_create();
+		if (!ring) {
+			trace_ring_failed = true;
+			return NULL;
+		}
+		trace_thread_ring = ring;
+	}
+	return &ring->rec[ring->head & ring->mask];
+}
+
+static inline void trace_record_commit(void)
+{
+	struct trace_ring *ring = trace_thread_ring;
+
+	if (!(++ring->head & (TRACE_SYNC_INTERVAL - 1)))
+		trace_ring_sync(ring);
+
+	ofi_wmb();
+	ring->hdr->head = ring->head;
+}
+
+static void
+trace_post(struct hook_ep *ep, enum trace_op op, size_t len,
+	   fi_addr_t addr, uint64_t tag, uint64_t flags, void *context)
+{
+	struct trace_record *rec;
+
+	rec = trace_record_get();
+	if (!rec)
+		return;
+
+	rec->ticks = trace_ticks();
+	rec->fid = (uintptr_t) &ep->ep.fid;
+	rec->context = (uintptr_t) context;
+	rec->len = len;
+	rec->tag = tag;
+	rec->addr = addr;
+	rec->flags = flags;
+	rec->op = op;
+	rec->err = 0;
+	trace_record_commit();
+}
+
+static void
+trace_cq_binary(struct hook_cq *cq, int count, void *buf, fi_addr_t *src_addr)
+{
+	struct fi_cq_tagged_entry *entry;
+	struct trace_record *rec;
+	uint64_t ticks;
+	int i;
+
+	if (cq->format == FI_CQ_FORMAT_UNSPEC)
+		return;
+
+	ticks = trace_ticks();
+	for (i = 0; i < count; i++) {
+		rec = trace_record_get();
+		if (!rec)
+			return;
+
+		entry = (struct fi_cq_tagged_entry *)
+			((char *) buf + i * trace_cq_entry_size[cq->format]);
+		rec->ticks = ticks;
+		rec->fid = (uintptr_t) &cq->cq.fid;
+		rec->context = (uintptr_t) entry->op_context;
+		rec->len = cq->format >= FI_CQ_FORMAT_MSG ? entry->len : 0;
+		rec->tag = cq->format == FI_CQ_FORMAT_TAGGED ? entry->tag : 0;
+		rec->addr = src_addr ? src_addr[i] : FI_ADDR_NOTAVAIL;
+		rec->flags = cq->format >= FI_CQ_FORMAT_MSG ? entry->flags : 0;
+		rec->op = trace_op_cq_comp;
+		rec->err = 0;
+		trace_record_commit();
+	}
+}
+
+static void
+trace_cq_err_binary(struct hook_cq *cq, struct fi_cq_err_entry *entry)
+{
+	struct trace_record *rec;
+
+	rec = trace_record_get();
+	if (!rec)
+		return;
+
+	rec->ticks = trace_ticks();
+	rec->fid = (uintptr_t) &cq->cq.fid;
+	rec->context = (uintptr_t) entry->op_context;
+	rec->len = entry->len;
+	rec->tag = entry->tag;
+	rec->addr = FI_ADDR_NOTAVAIL;
+	rec->flags = entry->flags;
+	rec->op = trace_op_cq_err;
+	rec->err = entry->err;
+	trace_record_commit();
+}
+
 #define IOV_BASE(iov, count)	(count ? iov[0].iov_base : NULL)
 #define IOV_LEN(iov, count)	    ofi_total_iov_len(iov, count)
 #define MSG_DATA(data, flags)   (flags & FI_REMOTE_CQ_DATA ? data : 0)
@@ -218,8 +527,10 @@ static void hook_trace_prof_init(void *context)
 				"addr", addr);	\
 	}
 
-#define TRACE_EP_MSG(ret, ep, buf, len, addr, data, flags, context) \
+#define TRACE_EP_MSG(ret, op, ep, buf, len, addr, data, flags, context) \
 	if (!(ret)) { \
+		if (trace_env.binary) \
+			trace_post(ep, op, len, addr, 0, flags, context); \
 		FI_TRACE((ep)->domain->fabric->hprov, FI_LOG_EP_DATA, \
 			"buf %p len %zu addr %zu data %lu " \
 			"flags 0x%zx ctx %p\n", \
@@ -227,8 +538,11 @@ static void hook_trace_prof_init(void *context)
 			(uint64_t)flags, context); \
 	}
 
-#define TRACE_EP_RMA(ret, ep, buf, len, addr, raddr, data, flags, key, context) \
+#define TRACE_EP_RMA(ret, op, ep, buf, len, addr, raddr, data, flags, key, \
+		     context) \
 	if (!(ret)) { \
+		if (trace_env.binary) \
+			trace_post(ep, op, len, addr, 0, flags, context); \
 		FI_TRACE((ep)->domain->fabric->hprov, FI_LOG_EP_DATA, \
 			"buf %p len %zu addr %zu raddr %lu data %lu " \
 			"flags 0x%zx key 0x%zx ctx %p\n", \
@@ -236,8 +550,11 @@ static void hook_trace_prof_init(void *context)
 			(uint64_t)flags, (uint64_t)key, context); \
 	}
 
-#define TRACE_EP_TAGGED(ret, ep, buf, len, addr, data, flags, tag, ignore, context) \
+#define TRACE_EP_TAGGED(ret, op, ep, buf, len, addr, data, flags, tag, \
+			ignore, context) \
 	if (!(ret)) { \
+		if (trace_env.binary) \
+			trace_post(ep, op, len, addr, tag, flags, context); \
 		FI_TRACE((ep)->domain->fabric->hprov, FI_LOG_EP_DATA, \
 			"buf %p len %zu addr %zu data %lu " \
 			"flags 0x%zx tag 0x%lx ignore 0x%zx ctx %p\n", \
@@ -365,12 +682,18 @@ static trace_cq_entry_fn trace_cq_entry[] = {
 
 static inline void
 trace_cq(struct hook_cq *cq, const char *func, int line,
-	 int count, void *buf, uint64_t data)
+	 int count, void *buf, fi_addr_t *src_addr)
 {
-	if ((count > 0) &&
-	    fi_log_enabled(cq->domain->fabric->hprov, FI_LOG_TRACE, FI_LOG_CQ)) {
+	if (count <= 0)
+		return;
+
+	if (trace_env.binary)
+		trace_cq_binary(cq, count, buf, src_addr);
+
+	if (fi_log_enabled(cq->domain->fabric->hprov, FI_LOG_TRACE, FI_LOG_CQ)) {
 		trace_cq_entry[cq->format](cq->domain->fabric->hprov, func,
-					   line, count, buf, data);
+					   line, count, buf,
+					   src_addr ? *src_addr : 0);
 	}
 }
 
@@ -617,7 +940,8 @@ trace_recv(struct fid_ep *ep, void *buf, size_t len, void *desc,
 	ssize_t ret;
 
 	ret = fi_recv(myep->hep, buf, len, desc, src_addr, context);
-	TRACE_EP_MSG(ret, myep, buf, len, src_addr, 0, 0, context);
+	TRACE_EP_MSG(ret, trace_op_recv, myep, buf, len, src_addr, 0, 0,
+		     context);
 
 	return ret;
 }
@@ -630,7 +954,8 @@ trace_recvv(struct fid_ep *ep, const struct iovec *iov, void **desc,
 	ssize_t ret;
 
 	ret = fi_recvv(myep->hep, iov, desc, count, src_addr, context);
-	TRACE_EP_MSG(ret, myep, IOV_BASE(iov, count), IOV_LEN(iov, count),
+	TRACE_EP_MSG(ret, trace_op_recvv, myep, IOV_BASE(iov, count),
+		     IOV_LEN(iov, count),
 		     src_addr, 0, 0, context);
 
 	return ret;
@@ -643,7 +968,8 @@ trace_recvmsg(struct fid_ep *ep, const struct fi_msg *msg, uint64_t flags)
 	ssize_t ret;
 
 	ret = fi_recvmsg(myep->hep, msg, flags);
-	TRACE_EP_MSG(ret, myep, IOV_BASE(msg->msg_iov, msg->iov_count),
+	TRACE_EP_MSG(ret, trace_op_recvmsg, myep,
+		     IOV_BASE(msg->msg_iov, msg->iov_count),
 		     IOV_LEN(msg->msg_iov, msg->iov_count), msg->addr,
 		     flags & FI_REMOTE_CQ_DATA ? msg->data : 0,
 		     flags, msg->context);
@@ -659,7 +985,8 @@ trace_send(struct fid_ep *ep, const void *buf, size_t len, void *desc,
 	ssize_t ret;
 
 	ret = fi_send(myep->hep, buf, len, desc, dest_addr, context);
-	TRACE_EP_MSG(ret, myep, buf, len, dest_addr, 0, 0, context);
+	TRACE_EP_MSG(ret, trace_op_send, myep, buf, len, dest_addr, 0, 0,
+		     context);
 
 	return ret;
 }
@@ -672,7 +999,8 @@ trace_sendv(struct fid_ep *ep, const struct iovec *iov, void **desc,
 	ssize_t ret;
 
 	ret = fi_sendv(myep->hep, iov, desc, count, dest_addr, context);
-	TRACE_EP_MSG(ret, myep, IOV_BASE(iov, count), IOV_LEN(iov, count),
+	TRACE_EP_MSG(ret, trace_op_sendv, myep, IOV_BASE(iov, count),
+		     IOV_LEN(iov, count),
 		     dest_addr, 0, 0, context);
 
 	return ret;
@@ -685,7 +1013,8 @@ trace_sendmsg(struct fid_ep *ep, const struct fi_msg *msg, uint64_t flags)
 	ssize_t ret;
 
 	ret = fi_sendmsg(myep->hep, msg, flags);
-	TRACE_EP_MSG(ret, myep, IOV_BASE(msg->msg_iov, msg->iov_count),
+	TRACE_EP_MSG(ret, trace_op_sendmsg, myep,
+		     IOV_BASE(msg->msg_iov, msg->iov_count),
 		     IOV_LEN(msg->msg_iov, msg->iov_count), msg->addr,
 		     MSG_DATA(msg->data, flags), flags, msg->context);
 
@@ -700,7 +1029,8 @@ trace_inject(struct fid_ep *ep, const void *buf, size_t len,
 	ssize_t ret;
 
 	ret = fi_inject(myep->hep, buf, len, dest_addr);
-	TRACE_EP_MSG(ret, myep, buf, len, dest_addr, 0, 0, NULL);
+	TRACE_EP_MSG(ret, trace_op_inject, myep, buf, len, dest_addr, 0, 0,
+		     NULL);
 
 	return ret;
 }
@@ -713,7 +1043,8 @@ trace_senddata(struct fid_ep *ep, const void *buf, size_t len, void *desc,
 	ssize_t ret;
 
 	ret = fi_senddata(myep->hep, buf, len, desc, data, dest_addr, context);
-	TRACE_EP_MSG(ret, myep, buf, len, dest_addr, data, 0, context);
+	TRACE_EP_MSG(ret, trace_op_senddata, myep, buf, len, dest_addr, data, 0,
+		     context);
 
 	return ret;
 }
@@ -726,7 +1057,8 @@ trace_injectdata(struct fid_ep *ep, const void *buf, size_t len,
 	ssize_t ret;
 
 	ret = fi_injectdata(myep->hep, buf, len, data, dest_addr);
-	TRACE_EP_MSG(ret, myep, buf, len, dest_addr, data, 0,  NULL);
+	TRACE_EP_MSG(ret, trace_op_injectdata, myep, buf, len, dest_addr, data,
+		     0,  NULL);
 
 	return ret;
 }
@@ -753,7 +1085,8 @@ trace_read(struct fid_ep *ep, void *buf, size_t len, void *desc,
 	ssize_t ret;
 
 	ret = fi_read(myep->hep, buf, len, desc, src_addr, addr, key, context);
-	TRACE_EP_RMA(ret, myep, buf, len, src_addr, addr, 0, 0, key, context);
+	TRACE_EP_RMA(ret, trace_op_read, myep, buf, len, src_addr, addr, 0, 0,
+		     key, context);
 
 	return ret;
 }
@@ -768,7 +1101,8 @@ trace_readv(struct fid_ep *ep, const struct iovec *iov, void **desc,
 
 	ret = fi_readv(myep->hep, iov, desc, count, src_addr,
 		       addr, key, context);
-	TRACE_EP_RMA(ret, myep, IOV_BASE(iov, count), IOV_LEN(iov, count),
+	TRACE_EP_RMA(ret, trace_op_readv, myep, IOV_BASE(iov, count),
+		     IOV_LEN(iov, count),
 		     src_addr, addr, 0, 0, key, context);
 
 	return ret;
@@ -781,7 +1115,8 @@ trace_readmsg(struct fid_ep *ep, const struct fi_msg_rma *msg, uint64_t flags)
 	ssize_t ret;
 
 	ret = fi_readmsg(myep->hep, msg, flags);
-	TRACE_EP_RMA(ret, myep, IOV_BASE(msg->msg_iov, msg->iov_count),
+	TRACE_EP_RMA(ret, trace_op_readmsg, myep,
+		     IOV_BASE(msg->msg_iov, msg->iov_count),
 		     IOV_LEN(msg->msg_iov, msg->iov_count), msg->addr,
 		     msg->rma_iov_count ? msg->rma_iov[0].addr : 0,
 		     MSG_DATA(msg->data, flags), flags,
@@ -800,7 +1135,8 @@ trace_write(struct fid_ep *ep, const void *buf, size_t len, void *desc,
 
 	ret = fi_write(myep->hep, buf, len, desc, dest_addr,
 		       addr, key, context);
-	TRACE_EP_RMA(ret, myep, buf, len, dest_addr, addr, 0, 0, key, context);
+	TRACE_EP_RMA(ret, trace_op_write, myep, buf, len, dest_addr, addr, 0, 0,
+		     key, context);
 
 	return ret;
 }
@@ -815,7 +1151,8 @@ trace_writev(struct fid_ep *ep, const struct iovec *iov, void **desc,
 
 	ret = fi_writev(myep->hep, iov, desc, count, dest_addr,
 			addr, key, context);
-	TRACE_EP_RMA(ret, myep, IOV_BASE(iov, count), IOV_LEN(iov, count),
+	TRACE_EP_RMA(ret, trace_op_writev, myep, IOV_BASE(iov, count),
+		     IOV_LEN(iov, count),
 		     dest_addr, addr, 0, 0, key, context);
 
 	return ret;
@@ -828,7 +1165,8 @@ trace_writemsg(struct fid_ep *ep, const struct fi_msg_rma *msg, uint64_t flags)
 	ssize_t ret;
 
 	ret = fi_writemsg(myep->hep, msg, flags);
-	TRACE_EP_RMA(ret, myep, IOV_BASE(msg->msg_iov, msg->iov_count),
+	TRACE_EP_RMA(ret, trace_op_writemsg, myep,
+		     IOV_BASE(msg->msg_iov, msg->iov_count),
 		     IOV_LEN(msg->msg_iov, msg->iov_count), msg->addr,
 		     msg->rma_iov_count ? msg->rma_iov[0].addr : 0,
 		     MSG_DATA(msg->data, flags), flags,
@@ -846,7 +1184,8 @@ trace_inject_write(struct fid_ep *ep, const void *buf, size_t len,
 	ssize_t ret;
 
 	ret = fi_inject_write(myep->hep, buf, len, dest_addr, addr, key);
-	TRACE_EP_RMA(ret, myep, buf, len, dest_addr, addr, 0, 0, key, NULL);
+	TRACE_EP_RMA(ret, trace_op_inject_write, myep, buf, len, dest_addr,
+		     addr, 0, 0, key, NULL);
 
 	return ret;
 }
@@ -861,7 +1200,8 @@ trace_writedata(struct fid_ep *ep, const void *buf, size_t len, void *desc,
 
 	ret = fi_writedata(myep->hep, buf, len, desc, data,
 			   dest_addr, addr, key, context);
-	TRACE_EP_RMA(ret, myep, buf, len, dest_addr, addr, data, 0, key, context);
+	TRACE_EP_RMA(ret, trace_op_writedata, myep, buf, len, dest_addr, addr,
+		     data, 0, key, context);
 
 	return ret;
 }
@@ -876,7 +1216,8 @@ trace_inject_writedata(struct fid_ep *ep, const void *buf, size_t len,
 
 	ret = fi_inject_writedata(myep->hep, buf, len, data, dest_addr,
 				  addr, key);
-	TRACE_EP_RMA(ret, myep, buf, len, dest_addr, addr, data, 0, key, NULL);
+	TRACE_EP_RMA(ret, trace_op_inject_writedata, myep, buf, len, dest_addr,
+		     addr, data, 0, key, NULL);
 
 	return ret;
 }
@@ -905,7 +1246,8 @@ trace_trecv(struct fid_ep *ep, void *buf, size_t len, void *desc,
 
 	ret = fi_trecv(myep->hep, buf, len, desc, src_addr,
 		       tag, ignore, context);
-	TRACE_EP_TAGGED(ret, myep, buf, len, src_addr, 0, 0, tag, ignore, context);
+	TRACE_EP_TAGGED(ret, trace_op_trecv, myep, buf, len, src_addr, 0, 0,
+			tag, ignore, context);
 
 	return ret;
 }
@@ -920,7 +1262,8 @@ trace_trecvv(struct fid_ep *ep, const struct iovec *iov, void **desc,
 
 	ret = fi_trecvv(myep->hep, iov, desc, count, src_addr,
 			tag, ignore, context);
-	TRACE_EP_TAGGED(ret, myep, IOV_BASE(iov, count), IOV_LEN(iov, count),
+	TRACE_EP_TAGGED(ret, trace_op_trecvv, myep, IOV_BASE(iov, count),
+			IOV_LEN(iov, count),
 			src_addr, 0, 0, tag, ignore, context);
 
 	return ret;
@@ -934,7 +1277,8 @@ trace_trecvmsg(struct fid_ep *ep, const struct fi_msg_tagged *msg,
 	ssize_t ret;
 
 	ret = fi_trecvmsg(myep->hep, msg, flags);
-	TRACE_EP_TAGGED(ret, myep, IOV_BASE(msg->msg_iov, msg->iov_count),
+	TRACE_EP_TAGGED(ret, trace_op_trecvmsg, myep,
+			IOV_BASE(msg->msg_iov, msg->iov_count),
 			IOV_LEN(msg->msg_iov, msg->iov_count), msg->addr,
 			MSG_DATA(msg->data, flags), flags,
 			msg->tag, msg->ignore, msg->context);
@@ -950,7 +1294,8 @@ trace_tsend(struct fid_ep *ep, const void *buf, size_t len, void *desc,
 	ssize_t ret;
 
 	ret = fi_tsend(myep->hep, buf, len, desc, dest_addr, tag, context);
-	TRACE_EP_TAGGED(ret, myep, buf, len, dest_addr, 0, 0, tag, 0, context);
+	TRACE_EP_TAGGED(ret, trace_op_tsend, myep, buf, len, dest_addr, 0, 0,
+			tag, 0, context);
 
 	return ret;
 }
@@ -963,7 +1308,8 @@ trace_tsendv(struct fid_ep *ep, const struct iovec *iov, void **desc,
 	ssize_t ret;
 
 	ret = fi_tsendv(myep->hep, iov, desc, count, dest_addr, tag, context);
-	TRACE_EP_TAGGED(ret, myep, IOV_BASE(iov, count), IOV_LEN(iov, count),
+	TRACE_EP_TAGGED(ret, trace_op_tsendv, myep, IOV_BASE(iov, count),
+			IOV_LEN(iov, count),
 			dest_addr, 0, 0, tag, 0, context);
 
 	return ret;
@@ -977,7 +1323,8 @@ trace_tsendmsg(struct fid_ep *ep, const struct fi_msg_tagged *msg,
 	ssize_t ret;
 
 	ret = fi_tsendmsg(myep->hep, msg, flags);
-	TRACE_EP_TAGGED(ret, myep, IOV_BASE(msg->msg_iov, msg->iov_count),
+	TRACE_EP_TAGGED(ret, trace_op_tsendmsg, myep,
+			IOV_BASE(msg->msg_iov, msg->iov_count),
 			IOV_LEN(msg->msg_iov, msg->iov_count), msg->addr,
 			MSG_DATA(msg->data, flags), flags,
 			msg->tag, 0, msg->context);
@@ -993,7 +1340,8 @@ trace_tinject(struct fid_ep *ep, const void *buf, size_t len,
 	ssize_t ret;
 
 	ret = fi_tinject(myep->hep, buf, len, dest_addr, tag);
-	TRACE_EP_TAGGED(ret, myep, buf, len, dest_addr, 0, 0, tag, 0, NULL);
+	TRACE_EP_TAGGED(ret, trace_op_tinject, myep, buf, len, dest_addr, 0, 0,
+			tag, 0, NULL);
 
 	return ret;
 }
@@ -1008,7 +1356,8 @@ trace_tsenddata(struct fid_ep *ep, const void *buf, size_t len, void *desc,
 
 	ret = fi_tsenddata(myep->hep, buf, len, desc, data,
 			   dest_addr, tag, context);
-	TRACE_EP_TAGGED(ret, myep, buf, len, dest_addr, data, 0, tag, 0, context);
+	TRACE_EP_TAGGED(ret, trace_op_tsenddata, myep, buf, len, dest_addr,
+			data, 0, tag, 0, context);
 
 	return ret;
 }
@@ -1021,7 +1370,8 @@ trace_tinjectdata(struct fid_ep *ep, const void *buf, size_t len,
 	ssize_t ret;
 
 	ret = fi_tinjectdata(myep->hep, buf, len, data, dest_addr, tag);
-	TRACE_EP_TAGGED(ret, myep, buf, len, dest_addr, data, 0, tag, 0, NULL);
+	TRACE_EP_TAGGED(ret, trace_op_tinjectdata, myep, buf, len, dest_addr,
+			data, 0, tag, 0, NULL);
 
 	return ret;
 }
@@ -1181,7 +1531,7 @@ static ssize_t trace_cq_read(struct fid_cq *cq, void *buf, size_t count)
 	ssize_t ret;
 
 	ret = fi_cq_read(mycq->hcq, buf, count);
-	trace_cq(mycq, __func__, __LINE__, ret, buf, 0);
+	trace_cq(mycq, __func__, __LINE__, ret, buf, NULL);
 	return ret;
 }
 
@@ -1192,8 +1542,11 @@ trace_cq_readerr(struct fid_cq *cq, struct fi_cq_err_entry *buf, uint64_t flags)
 	ssize_t ret;
 
 	ret = fi_cq_readerr(mycq->hcq, buf, flags);
-	if (ret > 0)
+	if (ret > 0) {
+		if (trace_env.binary)
+			trace_cq_err_binary(mycq, buf);
 		trace_cq_err(mycq, __func__, __LINE__, buf, flags);
+	}
 	return ret;
 }
 
@@ -1204,7 +1557,7 @@ trace_cq_readfrom(struct fid_cq *cq, void *buf, size_t count, fi_addr_t *src_add
 	ssize_t ret;
 
 	ret = fi_cq_readfrom(mycq->hcq, buf, count, src_addr);
-	trace_cq(mycq, __func__, __LINE__, ret, buf, src_addr ? *src_addr : 0);
+	trace_cq(mycq, __func__, __LINE__, ret, buf, src_addr);
 	return ret;
 }
 
@@ -1216,7 +1569,7 @@ trace_cq_sread(struct fid_cq *cq, void *buf, size_t count,
 	ssize_t ret;
 
 	ret = fi_cq_sread(mycq->hcq, buf, count, cond, timeout);
-	trace_cq(mycq, __func__, __LINE__, ret, buf, 0);
+	trace_cq(mycq, __func__, __LINE__, ret, buf, NULL);
 	return ret;
 }
 
@@ -1228,7 +1581,7 @@ trace_cq_sreadfrom(struct fid_cq *cq, void *buf, size_t count,
 	ssize_t ret;
 
 	ret = fi_cq_sreadfrom(mycq->hcq, buf, count, src_addr, cond, timeout);
-	trace_cq(mycq, __func__, __LINE__, ret, buf, src_addr ? *src_addr : 0);
+	trace_cq(mycq, __func__, __LINE__, ret, buf, src_addr);
 	return ret;
 }
 
@@ -1583,16 +1936,22 @@ static int trace_domain_init(struct fid *fid)
 	return 0;
 }
 
+static int trace_fabric_close(struct fid *fid)
+{
+	if (trace_env.binary)
+		trace_sync_rings();
+
+	return hook_close(fid);
+}
+
 static struct fi_ops trace_fabric_fid_ops = {
 	.size = sizeof(struct fi_ops),
-	.close = hook_close,
+	.close = trace_fabric_close,
 	.bind = hook_bind,
 	.control = hook_control,
 	.ops_open = hook_ops_open,
 };
 
-struct hook_prov_ctx hook_trace_ctx;
-
 static int hook_trace_fabric(struct fi_fabric_attr *attr,
 			     struct fid_fabric **fabric, void *context)
 {
@@ -1622,8 +1981,37 @@ struct hook_prov_ctx hook_trace_ctx = {
 	},
 };
 
+static void trace_env_init(void)
+{
+	struct fi_provider *prov = &hook_trace_ctx.prov;
+	char *basepath = NULL;
+	size_t ring_size;
+
+	fi_param_define(prov, "binary", FI_PARAM_BOOL,
+			"Record data transfers and completions into per-thread "
+			"binary ring buffers instead of only logging them. "
+			"(default: %d)", trace_env.binary);
+	fi_param_get_bool(prov, "binary", &trace_env.binary);
+
+	fi_param_define(prov, "ring_size", FI_PARAM_SIZE_T,
+			"Number of records kept per thread in binary mode, "
+			"rounded up to a power of two. (default: %zu)",
+			trace_env.ring_size);
+	if (!fi_param_get_size_t(prov, "ring_size", &ring_size) && ring_size)
+		trace_env.ring_size = roundup_power_of_two(ring_size);
+
+	fi_param_define(prov, "basepath", FI_PARAM_STRING,
+			"Directory where the binary ring buffers are created. "
+			"(default: %s)", trace_env.basepath);
+	fi_param_get_str(prov, "basepath", &basepath);
+	if (basepath && strlen(basepath) < PATH_MAX)
+		snprintf(trace_env.basepath, PATH_MAX, "%s", basepath);
+}
+
 HOOK_TRACE_INI
 {
+	trace_env_init();
+
 	hook_trace_ctx.ini_fid[FI_CLASS_DOMAIN] = trace_domain_init;
 	hook_trace_ctx.ini_fid[FI_CLASS_PEP] = trace_pep_init;
 
@@ -77,7 +77,7 @@ static int rxd_cq_write_signal(struct rxd_cq *cq,
 			       struct fi_cq_tagged_entry *cq_entry)
 {
 	int ret = rxd_cq_write(cq, cq_entry);
-	cq->util_cq.wait->signal(cq->util_cq.wait);
+	util_cq_signal(&cq->util_cq);
 	return ret;
 }
 
@@ -1226,7 +1226,7 @@ static struct fi_ops rxd_cq_fi_ops = {
 	.close = rxd_cq_close,
 	.bind = fi_no_bind,
 	.control = fi_no_control,
-	.ops_open = fi_no_ops_open,
+	.ops_open = ofi_cq_ops_open,
 };
 
 ssize_t rxd_cq_sreadfrom(struct fid_cq *cq_fid, void *buf, size_t count,
@@ -127,6 +127,9 @@ extern size_t rxm_packet_size;
 
 #define RXM_IOV_LIMIT 4
 
+/* Requests a segmented atomic may be split into */
+#define RXM_ATOMIC_MAX_SEGS	1024
+
 #define RXM_PEER_XFER_TAG_FLAG	(1ULL << 63)
 
 #define RXM_MR_MODES	(OFI_MR_BASIC_MAP | FI_MR_LOCAL)
@@ -202,6 +205,7 @@ extern size_t rxm_msg_tx_size;
 extern size_t rxm_msg_rx_size;
 extern size_t rxm_cm_progress_interval;
 extern size_t rxm_cq_eq_fairness;
+extern size_t rxm_buf_arena_size;
 extern int rxm_passthru;
 extern int force_auto_progress;
 extern int rxm_use_write_rndv;
@@ -273,7 +277,10 @@ struct rxm_domain {
 	bool passthru;
 	struct ofi_ops_flow_ctrl *flow_ctrl_ops;
 	struct ofi_bufpool *amo_bufpool;
-	ofi_mutex_t amo_bufpool_lock;
+	/* Backs the buffer pools of all endpoints, registered per chunk */
+	struct ofi_bufpool_arena *buf_arena;
+	bool arena_mr_local;
+	bool arena_hmem;
 	struct fid_domain *util_coll_domain;
 	struct fid_domain *offload_coll_domain;
 	uint64_t offload_coll_mask;
@@ -452,6 +459,40 @@ struct rxm_iov {
 	uint8_t count;
 };
 
+/*
+ * Atomics whose operands do not fit in one packet are split into several
+ * atomic requests.  Each request covers whole elements of the target, so
+ * per-element atomicity is kept, and a single completion is written once
+ * every request has been answered.
+ */
+struct rxm_atomic_seg {
+	struct rxm_conn *conn;
+	void *app_context;
+	uint64_t flags;
+	uint8_t op;
+	enum fi_datatype datatype;
+	enum fi_op atomic_op;
+
+	struct iovec buf_iov[RXM_IOV_LIMIT];
+	size_t buf_count;
+	enum fi_hmem_iface buf_iface;
+	uint64_t buf_device;
+	struct iovec cmp_iov[RXM_IOV_LIMIT];
+	size_t cmp_count;
+	enum fi_hmem_iface cmp_iface;
+	uint64_t cmp_device;
+	struct rxm_iov result;
+	struct fi_rma_ioc rma_ioc[RXM_IOV_LIMIT];
+	size_t rma_ioc_count;
+
+	size_t seg_cnt;		/* elements per request */
+	size_t total_cnt;
+	size_t sent_cnt;
+	size_t pending;		/* requests awaiting a response */
+	bool active;		/* requests are still being posted */
+	int status;
+};
+
 struct rxm_proto_info {
         /* Used for SAR protocol */
         struct {
@@ -521,6 +562,7 @@ struct rxm_tx_buf {
 		} rma;
 		struct rxm_iov atomic_result;
 	};
+	struct rxm_atomic_seg *atomic_seg;
 
 	struct {
 		struct iovec iov[RXM_IOV_LIMIT];
@@ -560,6 +602,7 @@ enum rxm_deferred_tx_entry_type {
 	RXM_DEFERRED_TX_RNDV_WRITE,
 	RXM_DEFERRED_TX_SAR_SEG,
 	RXM_DEFERRED_TX_ATOMIC_RESP,
+	RXM_DEFERRED_TX_ATOMIC_SEG,
 	RXM_DEFERRED_TX_CREDIT_SEND,
 };
 
@@ -611,6 +654,9 @@ struct rxm_deferred_tx_entry {
 			struct rxm_tx_buf *tx_buf;
 			ssize_t len;
 		} atomic_resp;
+		struct {
+			struct rxm_atomic_seg *seg;
+		} atomic_seg;
 		struct {
 			struct rxm_tx_buf *tx_buf;
 		} credit_msg;
@@ -750,6 +796,8 @@ void rxm_finish_coll_eager_send(struct rxm_ep *rxm_ep,
 
 int rxm_prepost_recv(struct rxm_ep *rxm_ep, struct fid_ep *rx_ep);
 
+ssize_t rxm_atomic_send_segs(struct rxm_ep *rxm_ep, struct rxm_atomic_seg *seg);
+void rxm_finish_atomic_seg(struct rxm_ep *rxm_ep, struct rxm_atomic_seg *seg);
 int rxm_ep_query_atomic(struct fid_domain *domain, enum fi_datatype datatype,
 			enum fi_op op, struct fi_atomic_attr *attr,
 			uint64_t flags);
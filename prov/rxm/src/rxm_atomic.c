@@ -73,8 +73,6 @@ rxm_ep_send_atomic_req(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
 	else
 		ret = fi_send(rxm_conn->msg_ep, &tx_buf->pkt, len,
 			      tx_buf->hdr.desc, 0, tx_buf);
-	if (ret == -FI_EAGAIN)
-		rxm_ep_do_progress(&rxm_ep->util_ep);
 
 	if (OFI_LIKELY(!ret))
 		FI_DBG(&rxm_prov, FI_LOG_EP_DATA, "sent atomic request: op: %"
@@ -87,6 +85,242 @@ rxm_ep_send_atomic_req(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
 	return ret;
 }
 
+static size_t
+rxm_ep_atomic_max_cnt(struct rxm_ep *rxm_ep, size_t datatype_sz, uint8_t op)
+{
+	struct rxm_domain *domain = container_of(rxm_ep->util_ep.domain,
+						 struct rxm_domain,
+						 util_domain);
+
+	return (op == ofi_op_atomic_compare ? domain->max_atomic_size / 2 :
+		domain->max_atomic_size) / datatype_sz;
+}
+
+/* Selects the target elements [start, start + cnt) of the atomic */
+static size_t
+rxm_atomic_seg_rma_ioc(struct rxm_atomic_seg *seg, size_t start, size_t cnt,
+		       size_t datatype_sz, struct fi_rma_ioc *rma_ioc)
+{
+	size_t i, seg_cnt, rma_ioc_count = 0;
+
+	for (i = 0; i < seg->rma_ioc_count && cnt; i++) {
+		if (start >= seg->rma_ioc[i].count) {
+			start -= seg->rma_ioc[i].count;
+			continue;
+		}
+
+		seg_cnt = MIN(cnt, seg->rma_ioc[i].count - start);
+		rma_ioc[rma_ioc_count].addr = seg->rma_ioc[i].addr +
+					      start * datatype_sz;
+		rma_ioc[rma_ioc_count].count = seg_cnt;
+		rma_ioc[rma_ioc_count].key = seg->rma_ioc[i].key;
+		rma_ioc_count++;
+		cnt -= seg_cnt;
+		start = 0;
+	}
+	return rma_ioc_count;
+}
+
+static ssize_t
+rxm_atomic_send_seg(struct rxm_ep *rxm_ep, struct rxm_atomic_seg *seg)
+{
+	struct fi_rma_ioc rma_ioc[RXM_IOV_LIMIT];
+	struct rxm_atomic_hdr *atomic_hdr;
+	struct rxm_tx_buf *tx_buf;
+	size_t datatype_sz = ofi_datatype_size(seg->datatype);
+	size_t cnt, len, buf_len, cmp_len, data_len, rma_ioc_count;
+	size_t result_index, result_offset, result_count;
+	int index;
+	ssize_t ret;
+
+	tx_buf = rxm_get_tx_buf(rxm_ep);
+	if (!tx_buf)
+		return -FI_EAGAIN;
+
+	cnt = MIN(seg->seg_cnt, seg->total_cnt - seg->sent_cnt);
+	len = cnt * datatype_sz;
+	buf_len = seg->buf_count ? len : 0;
+	cmp_len = seg->cmp_count ? len : 0;
+	data_len = buf_len + cmp_len + sizeof(struct rxm_atomic_hdr);
+
+	rma_ioc_count = rxm_atomic_seg_rma_ioc(seg, seg->sent_cnt, cnt,
+					       datatype_sz, rma_ioc);
+	rxm_ep_format_atomic_pkt_hdr(seg->conn, tx_buf, data_len, seg->op,
+				     seg->datatype, seg->atomic_op,
+				     seg->flags, 0, rma_ioc, rma_ioc_count);
+	tx_buf->pkt.ctrl_hdr.msg_id = ofi_buf_index(tx_buf);
+	tx_buf->app_context = seg->app_context;
+	tx_buf->atomic_seg = seg;
+
+	atomic_hdr = (struct rxm_atomic_hdr *) tx_buf->pkt.data;
+	if (buf_len) {
+		ret = ofi_copy_from_hmem_iov(atomic_hdr->data, buf_len,
+					     seg->buf_iface, seg->buf_device,
+					     seg->buf_iov, seg->buf_count,
+					     seg->sent_cnt * datatype_sz);
+		assert((size_t) ret == buf_len);
+	}
+	if (cmp_len) {
+		ret = ofi_copy_from_hmem_iov(atomic_hdr->data + buf_len,
+					     cmp_len, seg->cmp_iface,
+					     seg->cmp_device, seg->cmp_iov,
+					     seg->cmp_count,
+					     seg->sent_cnt * datatype_sz);
+		assert((size_t) ret == cmp_len);
+	}
+
+	/* The response is copied straight into its part of the results */
+	tx_buf->atomic_result.count = 0;
+	if (seg->result.count) {
+		ret = ofi_iov_locate(seg->result.iov, seg->result.count,
+				     seg->sent_cnt * datatype_sz,
+				     &index, &result_offset);
+		if (!ret) {
+			result_index = (size_t) index;
+			ret = ofi_copy_iov_desc(tx_buf->atomic_result.iov,
+						tx_buf->atomic_result.desc,
+						&result_count, seg->result.iov,
+						seg->result.desc,
+						seg->result.count,
+						&result_index, &result_offset,
+						len);
+		}
+		if (ret) {
+			rxm_free_tx_buf(rxm_ep, tx_buf);
+			return -FI_EINVAL;
+		}
+		tx_buf->atomic_result.count = (uint8_t) result_count;
+	}
+
+	ret = rxm_ep_send_atomic_req(rxm_ep, seg->conn, tx_buf,
+				     data_len + sizeof(struct rxm_pkt));
+	if (ret) {
+		rxm_free_tx_buf(rxm_ep, tx_buf);
+		return ret;
+	}
+
+	seg->sent_cnt += cnt;
+	seg->pending++;
+	return 0;
+}
+
+/* Returns -FI_EAGAIN while requests remain to be posted */
+ssize_t rxm_atomic_send_segs(struct rxm_ep *rxm_ep, struct rxm_atomic_seg *seg)
+{
+	ssize_t ret;
+
+	while (seg->sent_cnt < seg->total_cnt && !seg->status) {
+		ret = rxm_atomic_send_seg(rxm_ep, seg);
+		if (ret == -FI_EAGAIN)
+			return ret;
+		if (ret)
+			seg->status = (int) ret;
+	}
+
+	seg->active = false;
+	rxm_finish_atomic_seg(rxm_ep, seg);
+	return 0;
+}
+
+static ssize_t
+rxm_ep_atomic_seg(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
+		  const struct fi_msg_atomic *msg,
+		  const struct fi_ioc *comparev, void **compare_desc,
+		  size_t compare_iov_count, struct fi_ioc *resultv,
+		  void **result_desc, size_t result_iov_count, uint8_t op,
+		  uint64_t flags)
+{
+	struct rxm_deferred_tx_entry *def_tx;
+	struct rxm_atomic_seg *seg;
+	size_t datatype_sz = ofi_datatype_size(msg->datatype);
+	ssize_t ret;
+
+	if (flags & FI_INJECT) {
+		FI_WARN(&rxm_prov, FI_LOG_EP_DATA,
+			"atomic inject data too large\n");
+		return -FI_EINVAL;
+	}
+
+	if (ofi_total_rma_ioc_cnt(msg->rma_iov, msg->rma_iov_count) >
+	    rxm_ep_atomic_max_cnt(rxm_ep, datatype_sz, op) *
+	    RXM_ATOMIC_MAX_SEGS) {
+		FI_WARN(&rxm_prov, FI_LOG_EP_DATA,
+			"atomic count exceeds max count\n");
+		return -FI_EINVAL;
+	}
+
+	seg = calloc(1, sizeof(*seg));
+	if (!seg)
+		return -FI_ENOMEM;
+
+	seg->conn = rxm_conn;
+	seg->app_context = msg->context;
+	seg->flags = flags;
+	seg->op = op;
+	seg->datatype = msg->datatype;
+	seg->atomic_op = msg->op;
+
+	if (msg->op != FI_ATOMIC_READ) {
+		ofi_ioc_to_iov(msg->msg_iov, seg->buf_iov, msg->iov_count,
+			       datatype_sz);
+		seg->buf_count = msg->iov_count;
+		seg->buf_iface = rxm_iov_desc_to_hmem_iface_dev(seg->buf_iov,
+						msg->desc, msg->iov_count,
+						&seg->buf_device);
+	}
+
+	if (op == ofi_op_atomic_compare) {
+		ofi_ioc_to_iov(comparev, seg->cmp_iov, compare_iov_count,
+			       datatype_sz);
+		seg->cmp_count = compare_iov_count;
+		seg->cmp_iface = rxm_iov_desc_to_hmem_iface_dev(seg->cmp_iov,
+						compare_desc, compare_iov_count,
+						&seg->cmp_device);
+	}
+
+	if (resultv) {
+		ofi_ioc_to_iov(resultv, seg->result.iov, result_iov_count,
+			       datatype_sz);
+		if (result_desc)
+			memcpy(seg->result.desc, result_desc,
+			       sizeof(*result_desc) * result_iov_count);
+		seg->result.count = (uint8_t) result_iov_count;
+	}
+
+	memcpy(seg->rma_ioc, msg->rma_iov,
+	       sizeof(*msg->rma_iov) * msg->rma_iov_count);
+	seg->rma_ioc_count = msg->rma_iov_count;
+	seg->seg_cnt = rxm_ep_atomic_max_cnt(rxm_ep, datatype_sz, op);
+	seg->total_cnt = ofi_total_rma_ioc_cnt(msg->rma_iov,
+					       msg->rma_iov_count);
+	seg->active = true;
+
+	/* The call only fails if the first request cannot be posted */
+	ret = rxm_atomic_send_seg(rxm_ep, seg);
+	if (ret) {
+		if (ret == -FI_EAGAIN)
+			rxm_ep_do_progress(&rxm_ep->util_ep);
+		free(seg);
+		return ret;
+	}
+
+	if (rxm_atomic_send_segs(rxm_ep, seg) != -FI_EAGAIN)
+		return 0;
+
+	def_tx = rxm_ep_alloc_deferred_tx_entry(rxm_ep, rxm_conn,
+						RXM_DEFERRED_TX_ATOMIC_SEG);
+	if (!def_tx) {
+		seg->status = -FI_ENOMEM;
+		seg->active = false;
+		rxm_finish_atomic_seg(rxm_ep, seg);
+		return 0;
+	}
+
+	def_tx->atomic_seg.seg = seg;
+	rxm_queue_deferred_tx(def_tx, OFI_LIST_TAIL);
+	return 0;
+}
+
 static ssize_t
 rxm_ep_atomic_common(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
 		const struct fi_msg_atomic *msg, const struct fi_ioc *comparev,
@@ -118,6 +352,15 @@ rxm_ep_atomic_common(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
 		return -FI_EINVAL;
 	}
 
+	if (datatype_sz && ofi_total_rma_ioc_cnt(msg->rma_iov,
+						 msg->rma_iov_count) >
+	    rxm_ep_atomic_max_cnt(rxm_ep, datatype_sz, op)) {
+		return rxm_ep_atomic_seg(rxm_ep, rxm_conn, msg, comparev,
+					 compare_desc, compare_iov_count,
+					 resultv, result_desc,
+					 result_iov_count, op, flags);
+	}
+
 	if (msg->op != FI_ATOMIC_READ) {
 		assert(msg->msg_iov);
 		ofi_ioc_to_iov(msg->msg_iov, buf_iov, msg->iov_count,
@@ -161,6 +404,7 @@ rxm_ep_atomic_common(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
 				msg->rma_iov, msg->rma_iov_count);
 	tx_buf->pkt.ctrl_hdr.msg_id = ofi_buf_index(tx_buf);
 	tx_buf->app_context = msg->context;
+	tx_buf->atomic_seg = NULL;
 
 	atomic_hdr = (struct rxm_atomic_hdr *) tx_buf->pkt.data;
 
@@ -187,8 +431,11 @@ rxm_ep_atomic_common(struct rxm_ep *rxm_ep, struct rxm_conn *rxm_conn,
 	}
 
 	ret = rxm_ep_send_atomic_req(rxm_ep, rxm_conn, tx_buf, tot_len);
-	if (ret)
+	if (ret) {
+		if (ret == -FI_EAGAIN)
+			rxm_ep_do_progress(&rxm_ep->util_ep);
 		rxm_free_tx_buf(rxm_ep, tx_buf);
+	}
 
 	return ret;
 }
@@ -218,6 +465,8 @@ rxm_ep_atomic_writemsg(struct fid_ep *ep_fid, const struct fi_msg_atomic *msg,
 {
 	struct rxm_ep *rxm_ep = container_of(ep_fid, struct rxm_ep,
 					     util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_atomic(&rxm_ep->util_ep, msg, flags);
 
 	return rxm_ep_generic_atomic_writemsg(rxm_ep, msg,
 				flags | rxm_ep->util_ep.tx_msg_flags);
@@ -332,6 +581,9 @@ rxm_ep_atomic_readwritemsg(struct fid_ep *ep_fid,
 
 	struct rxm_ep *rxm_ep = container_of(ep_fid, struct rxm_ep,
 					     util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_fetch_atomic(&rxm_ep->util_ep, msg,
+				resultv, result_desc, result_count, flags);
 
 	return rxm_ep_generic_atomic_readwritemsg(rxm_ep, msg,
 			resultv, result_desc, result_count,
@@ -427,6 +679,10 @@ rxm_ep_atomic_compwritemsg(struct fid_ep *ep_fid,
 {
 	struct rxm_ep *rxm_ep = container_of(ep_fid, struct rxm_ep,
 					     util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_compare_atomic(&rxm_ep->util_ep, msg,
+				comparev, compare_desc, compare_count, resultv,
+				result_desc, result_count, flags);
 
 	return rxm_ep_generic_atomic_compwritemsg(rxm_ep, msg, comparev,
 				    compare_desc, compare_count, resultv,
@@ -528,10 +784,12 @@ int rxm_ep_query_atomic(struct fid_domain *domain, enum fi_datatype datatype,
 	if (!attr->size)
 		return -FI_EOPNOTSUPP;
 
-	attr->count = tot_size / attr->size;
-	if (attr->count == 0)
+	if (tot_size / attr->size == 0)
 		return -FI_EOPNOTSUPP;
 
+	/* Atomics larger than a packet are split into several requests */
+	attr->count = tot_size / attr->size * RXM_ATOMIC_MAX_SEGS;
+
 	return FI_SUCCESS;
 }
 
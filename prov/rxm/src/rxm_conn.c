@@ -56,17 +56,26 @@ static void rxm_close_conn(struct rxm_conn *conn)
 {
 	struct rxm_deferred_tx_entry *tx_entry;
 	struct fi_peer_rx_entry *rx_entry;
+	struct rxm_atomic_seg *seg;
 	struct rxm_rx_buf *buf;
+	struct dlist_entry atomic_segs;
 
 	FI_DBG(&rxm_prov, FI_LOG_EP_CTRL, "closing conn %p\n", conn);
 
 	assert(ofi_genlock_held(&conn->ep->util_ep.lock));
-	/* All deferred transfers are internally generated */
+	/* Deferred transfers are internally generated, except for the rest
+	 * of a segmented atomic.  That operation is failed once the msg ep is
+	 * flushed, as the responses to its outstanding requests can no longer
+	 * arrive. */
+	dlist_init(&atomic_segs);
 	while (!dlist_empty(&conn->deferred_tx_queue)) {
 		tx_entry = container_of(conn->deferred_tx_queue.next,
 				     struct rxm_deferred_tx_entry, entry);
 		rxm_dequeue_deferred_tx(tx_entry);
-		free(tx_entry);
+		if (tx_entry->type == RXM_DEFERRED_TX_ATOMIC_SEG)
+			dlist_insert_tail(&tx_entry->entry, &atomic_segs);
+		else
+			free(tx_entry);
 	}
 
 	while (!dlist_empty(&conn->deferred_sar_segments)) {
@@ -81,6 +90,18 @@ static void rxm_close_conn(struct rxm_conn *conn)
 	}
 	fi_close(&conn->msg_ep->fid);
 	rxm_flush_msg_cq(conn->ep);
+
+	while (!dlist_empty(&atomic_segs)) {
+		dlist_pop_front(&atomic_segs, struct rxm_deferred_tx_entry,
+				tx_entry, entry);
+		seg = tx_entry->atomic_seg.seg;
+		if (!seg->status)
+			seg->status = -FI_ECONNABORTED;
+		seg->active = false;
+		seg->pending = 0;
+		rxm_finish_atomic_seg(conn->ep, seg);
+		free(tx_entry);
+	}
 	dlist_remove_init(&conn->loopback_entry);
 	conn->msg_ep = NULL;
 
@@ -218,6 +218,25 @@ rxm_cq_write_tx_comp(struct rxm_ep *rxm_ep, uint64_t comp_flags,
 	}
 }
 
+/* Sends issued by util_coll complete to it, whatever the protocol used,
+ * and are not counted */
+static void
+rxm_cq_write_send_comp(struct rxm_ep *rxm_ep, uint64_t comp_flags,
+		       void *app_context, uint64_t flags, uint64_t tag)
+{
+	if (rxm_ep->util_coll_ep && (tag & RXM_PEER_XFER_TAG_FLAG)) {
+		struct fi_cq_tagged_entry cqe = {
+			.tag = tag,
+			.op_context = app_context,
+		};
+		rxm_ep->util_coll_peer_xfer_ops->
+			complete(rxm_ep->util_coll_ep, &cqe, 0);
+		return;
+	}
+	rxm_cq_write_tx_comp(rxm_ep, comp_flags, app_context, flags);
+	ofi_ep_peer_tx_cntr_inc(&rxm_ep->util_ep, ofi_op_msg);
+}
+
 static void rxm_finish_rma(struct rxm_ep *rxm_ep, struct rxm_tx_buf *rma_buf,
 			  uint64_t comp_flags)
 {
@@ -276,17 +295,17 @@ static void rxm_handle_sar_comp(struct rxm_ep *rxm_ep,
 				struct rxm_tx_buf *tx_buf)
 {
 	void *app_context;
-	uint64_t comp_flags, tx_flags;
+	uint64_t comp_flags, tx_flags, tag;
 
 	app_context = tx_buf->app_context;
 	comp_flags = ofi_tx_cq_flags(tx_buf->pkt.hdr.op);
 	tx_flags = tx_buf->flags;
+	tag = tx_buf->pkt.hdr.tag;
 
 	if (!rxm_complete_sar(rxm_ep, tx_buf))
 		return;
 
-	rxm_cq_write_tx_comp(rxm_ep, comp_flags, app_context, tx_flags);
-	ofi_ep_peer_tx_cntr_inc(&rxm_ep->util_ep, ofi_op_msg);
+	rxm_cq_write_send_comp(rxm_ep, comp_flags, app_context, tx_flags, tag);
 }
 
 static void rxm_rndv_rx_finish(struct rxm_rx_buf *rx_buf)
@@ -316,15 +335,15 @@ static void rxm_rndv_tx_finish(struct rxm_ep *rxm_ep,
 	if (!rxm_ep->rdm_mr_local)
 		rxm_msg_mr_closev(tx_buf->rma.mr, tx_buf->rma.count);
 
-	rxm_cq_write_tx_comp(rxm_ep, ofi_tx_cq_flags(tx_buf->pkt.hdr.op),
-			     tx_buf->app_context, tx_buf->flags);
+	rxm_cq_write_send_comp(rxm_ep, ofi_tx_cq_flags(tx_buf->pkt.hdr.op),
+			       tx_buf->app_context, tx_buf->flags,
+			       tx_buf->pkt.hdr.tag);
 
 	if (rxm_ep->rndv_ops == &rxm_rndv_ops_write &&
 	    tx_buf->write_rndv.done_buf) {
 		ofi_buf_free(tx_buf->write_rndv.done_buf);
 		tx_buf->write_rndv.done_buf = NULL;
 	}
-	ofi_ep_peer_tx_cntr_inc(&rxm_ep->util_ep, ofi_op_msg);
 	rxm_free_tx_buf(rxm_ep, tx_buf);
 }
 
@@ -1190,9 +1209,7 @@ static int rxm_do_device_mem_atomic(struct rxm_mr *dev_mr, uint8_t op,
 		.iov_len = amo_op_size,
 	};
 
-	ofi_mutex_lock(&dom->amo_bufpool_lock);
-	tx_buf = ofi_buf_alloc(dom->amo_bufpool);
-	ofi_mutex_unlock(&dom->amo_bufpool_lock);
+	tx_buf = ofi_buf_mag_alloc(dom->amo_bufpool);
 
 	if (!tx_buf)
 		return -FI_ENOMEM;
@@ -1211,9 +1228,7 @@ static int rxm_do_device_mem_atomic(struct rxm_mr *dev_mr, uint8_t op,
 
 	ofi_mutex_unlock(&dev_mr->amo_lock);
 
-	ofi_mutex_lock(&dom->amo_bufpool_lock);
-	ofi_buf_free(tx_buf);
-	ofi_mutex_unlock(&dom->amo_bufpool_lock);
+	ofi_buf_mag_free(tx_buf);
 
 	return FI_SUCCESS;
 }
@@ -1313,6 +1328,17 @@ static ssize_t rxm_handle_atomic_req(struct rxm_ep *rxm_ep,
 				    result_len, FI_SUCCESS);
 }
 
+/* Stops posting requests, the error is reported once the outstanding
+ * ones are answered */
+static void rxm_fail_atomic_seg_req(struct rxm_ep *rxm_ep,
+				    struct rxm_atomic_seg *seg, int err)
+{
+	if (!seg->status)
+		seg->status = err;
+	seg->pending--;
+	rxm_finish_atomic_seg(rxm_ep, seg);
+}
+
 static ssize_t rxm_handle_atomic_resp(struct rxm_ep *rxm_ep,
 				      struct rxm_rx_buf *rx_buf)
 {
@@ -1363,6 +1389,12 @@ static ssize_t rxm_handle_atomic_resp(struct rxm_ep *rxm_ep,
 		goto write_err;
 	}
 
+	if (tx_buf->atomic_seg) {
+		tx_buf->atomic_seg->pending--;
+		rxm_finish_atomic_seg(rxm_ep, tx_buf->atomic_seg);
+		goto free;
+	}
+
 	if (!(tx_buf->flags & FI_INJECT))
 		rxm_cq_write_tx_comp(rxm_ep, ofi_tx_cq_flags(tx_buf->pkt.hdr.op),
 				     tx_buf->app_context, tx_buf->flags);
@@ -1374,11 +1406,34 @@ free:
 	return ret;
 
 write_err:
+	if (tx_buf->atomic_seg) {
+		rxm_fail_atomic_seg_req(rxm_ep, tx_buf->atomic_seg, (int) ret);
+		ret = 0;
+		goto free;
+	}
+
 	rxm_cq_write_tx_error(rxm_ep, tx_buf->pkt.hdr.op, tx_buf->app_context,
 			      (int) ret);
 	goto free;
 }
 
+/* Completes a segmented atomic once all of its requests are answered */
+void rxm_finish_atomic_seg(struct rxm_ep *rxm_ep, struct rxm_atomic_seg *seg)
+{
+	if (seg->active || seg->pending)
+		return;
+
+	if (seg->status) {
+		rxm_cq_write_tx_error(rxm_ep, seg->op, seg->app_context,
+				      seg->status);
+	} else {
+		rxm_cq_write_tx_comp(rxm_ep, ofi_tx_cq_flags(seg->op),
+				     seg->app_context, seg->flags);
+		ofi_ep_peer_tx_cntr_inc(&rxm_ep->util_ep, seg->op);
+	}
+	free(seg);
+}
+
 static ssize_t rxm_handle_credit(struct rxm_ep *rxm_ep, struct rxm_rx_buf *rx_buf)
 {
 	struct rxm_domain *domain;
@@ -1395,17 +1450,11 @@ static ssize_t rxm_handle_credit(struct rxm_ep *rxm_ep, struct rxm_rx_buf *rx_bu
 void rxm_finish_coll_eager_send(struct rxm_ep *rxm_ep,
 			        struct rxm_tx_buf *tx_eager_buf)
 {
-	if (rxm_ep->util_coll_ep &&
-	    (tx_eager_buf->pkt.hdr.tag & RXM_PEER_XFER_TAG_FLAG)) {
-		struct fi_cq_tagged_entry cqe = {
-			.tag = tx_eager_buf->pkt.hdr.tag,
-			.op_context = tx_eager_buf->app_context,
-		};
-		rxm_ep->util_coll_peer_xfer_ops->
-			complete(rxm_ep->util_coll_ep, &cqe, 0);
-	} else {
-		rxm_finish_eager_send(rxm_ep, tx_eager_buf);
-	}
+	assert(ofi_tx_cq_flags(tx_eager_buf->pkt.hdr.op) & FI_SEND);
+
+	rxm_cq_write_send_comp(rxm_ep, ofi_tx_cq_flags(tx_eager_buf->pkt.hdr.op),
+			       tx_eager_buf->app_context, tx_eager_buf->flags,
+			       tx_eager_buf->pkt.hdr.tag);
 }
 
 ssize_t rxm_handle_comp(struct rxm_ep *rxm_ep, struct fi_cq_data_entry *comp)
@@ -1640,10 +1689,18 @@ void rxm_handle_comp_error(struct rxm_ep *rxm_ep)
 	cntr = rxm_ep->util_ep.cntrs[CNTR_TX];
 
 	switch (RXM_GET_PROTO_STATE(err_entry.op_context)) {
+	case RXM_ATOMIC_RESP_WAIT:
+		tx_buf = err_entry.op_context;
+		if (tx_buf->atomic_seg) {
+			rxm_fail_atomic_seg_req(rxm_ep, tx_buf->atomic_seg,
+						-err_entry.err);
+			rxm_free_tx_buf(rxm_ep, tx_buf);
+			return;
+		}
+		/* fall through */
 	case RXM_TX:
 	case RXM_RNDV_TX:
 	case RXM_RNDV_WRITE_DONE_SENT:
-	case RXM_ATOMIC_RESP_WAIT:
 		tx_buf = err_entry.op_context;
 		err_entry.op_context = tx_buf->app_context;
 		err_entry.flags = ofi_tx_cq_flags(tx_buf->pkt.hdr.op);
@@ -1751,7 +1808,7 @@ ssize_t rxm_thru_comp(struct rxm_ep *ep, struct fi_cq_data_entry *comp)
 		assert(0);
 	}
 	if (cq->wait)
-		cq->wait->signal(cq->wait);
+		util_cq_signal(cq);
 
 	return ret;
 }
@@ -1988,7 +2045,7 @@ static struct fi_ops rxm_cq_fi_ops = {
 	.close = rxm_cq_close,
 	.bind = fi_no_bind,
 	.control = ofi_cq_control,
-	.ops_open = fi_no_ops_open,
+	.ops_open = ofi_cq_ops_open,
 };
 
 static struct fi_ops rxm_peer_cq_fi_ops = {
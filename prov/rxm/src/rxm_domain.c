@@ -424,9 +424,13 @@ static int rxm_domain_close(fid_t fid)
 
 	rxm_domain = container_of(fid, struct rxm_domain, util_domain.domain_fid.fid);
 
-	ofi_mutex_destroy(&rxm_domain->amo_bufpool_lock);
 	ofi_bufpool_destroy(rxm_domain->amo_bufpool);
 
+	if (rxm_domain->buf_arena) {
+		ofi_bufpool_arena_destroy(rxm_domain->buf_arena);
+		rxm_domain->buf_arena = NULL;
+	}
+
 	ret = fi_close(&rxm_domain->msg_domain->fid);
 	if (ret)
 		return ret;
@@ -457,7 +461,7 @@ static struct fi_ops rxm_domain_fi_ops = {
 	.size = sizeof(struct fi_ops),
 	.close = rxm_domain_close,
 	.bind = fi_no_bind,
-	.control = fi_no_control,
+	.control = ofi_domain_control,
 	.ops_open = fi_no_ops_open,
 };
 
@@ -561,6 +565,59 @@ err:
 	return ret;
 }
 
+static int rxm_arena_reg(struct ofi_bufpool_arena *arena,
+			 struct ofi_bufpool_arena_chunk *chunk)
+{
+	struct rxm_domain *rxm_domain = arena->attr.context;
+	int ret;
+
+	if (rxm_domain->arena_hmem) {
+		ret = ofi_hmem_host_register(chunk->base, chunk->size);
+		if (ret)
+			return ret;
+	}
+
+	if (!rxm_domain->arena_mr_local)
+		return 0;
+
+	ret = rxm_msg_mr_reg_internal(rxm_domain, chunk->base, chunk->size,
+				      FI_SEND | FI_RECV | FI_READ | FI_WRITE,
+				      OFI_MR_NOCACHE,
+				      (struct fid_mr **) &chunk->context);
+	if (ret && rxm_domain->arena_hmem)
+		ofi_hmem_host_unregister(chunk->base);
+
+	return ret;
+}
+
+static void rxm_arena_dereg(struct ofi_bufpool_arena *arena,
+			    struct ofi_bufpool_arena_chunk *chunk)
+{
+	struct rxm_domain *rxm_domain = arena->attr.context;
+
+	if (rxm_domain->arena_hmem)
+		ofi_hmem_host_unregister(chunk->base);
+
+	if (chunk->context)
+		fi_close(chunk->context);
+}
+
+static int rxm_domain_open_arena(struct rxm_domain *rxm_domain,
+				 struct fi_info *info, struct fi_info *msg_info)
+{
+	struct ofi_bufpool_arena_attr attr = {
+		.chunk_size = rxm_buf_arena_size,
+		.reg_fn = rxm_arena_reg,
+		.dereg_fn = rxm_arena_dereg,
+		.context = rxm_domain,
+		.flags = OFI_BUFPOOL_HUGEPAGES,
+	};
+
+	rxm_domain->arena_mr_local = ofi_mr_local(msg_info);
+	rxm_domain->arena_hmem = !!(info->caps & FI_HMEM);
+	return ofi_bufpool_arena_create(&attr, &rxm_domain->buf_arena);
+}
+
 /* Large send/recv transfers use RMA rendezvous protocol */
 static uint64_t
 rxm_mr_get_msg_access(struct rxm_domain *rxm_domain, uint64_t access)
@@ -967,12 +1024,11 @@ int rxm_domain_open(struct fid_fabric *fabric, struct fi_info *info,
 	(*domain)->ops = &rxm_domain_ops;
 
 	ret = ofi_bufpool_create(&rxm_domain->amo_bufpool,
-				 rxm_domain->max_atomic_size, 64, 0, 0, 0);
+				 rxm_domain->max_atomic_size, 64, 0, 0,
+				 OFI_BUFPOOL_MAGAZINE);
 	if (ret)
 		goto err5;
 
-	ofi_mutex_init(&rxm_domain->amo_bufpool_lock);
-
 	rxm_domain->passthru = rxm_passthru_info(info);
 	if (rxm_domain->passthru)
 		(*domain)->mr = &rxm_domain_mr_thru_ops;
@@ -983,11 +1039,16 @@ int rxm_domain_open(struct fid_fabric *fabric, struct fi_info *info,
 	if (ret)
 		goto err6;
 
+	if (rxm_buf_arena_size && !rxm_domain->passthru) {
+		ret = rxm_domain_open_arena(rxm_domain, info, msg_info);
+		if (ret)
+			goto err6;
+	}
+
 	fi_freeinfo(msg_info);
 	return 0;
 
 err6:
-	ofi_mutex_destroy(&rxm_domain->amo_bufpool_lock);
 	ofi_bufpool_destroy(rxm_domain->amo_bufpool);
 err5:
 	if (rxm_domain->offload_coll_domain)
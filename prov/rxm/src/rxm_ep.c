@@ -49,6 +49,12 @@ static int rxm_buf_reg(struct ofi_bufpool_region *region)
 	int ret;
 	bool hmem_enabled = !!(rxm_ep->util_ep.caps & FI_HMEM);
 
+	/* Arena chunks are registered when the arena grows */
+	if (region->chunk) {
+		region->context = region->chunk->context;
+		return 0;
+	}
+
 	if (hmem_enabled) {
 		ret = ofi_hmem_host_register(region->mem_region,
 					     region->pool->region_size);
@@ -104,6 +110,9 @@ static void rxm_buf_close(struct ofi_bufpool_region *region)
 {
 	struct rxm_ep *ep = region->pool->attr.context;
 
+	if (region->chunk)
+		return;
+
 	if (ep->util_ep.caps & FI_HMEM)
 		ofi_hmem_host_unregister(region->mem_region);
 
@@ -114,6 +123,21 @@ static void rxm_buf_close(struct ofi_bufpool_region *region)
 	}
 }
 
+/* The arena can back the pools if it registers what the endpoint needs */
+static struct ofi_bufpool_arena *rxm_ep_buf_arena(struct rxm_ep *rxm_ep)
+{
+	struct rxm_domain *rxm_domain;
+
+	rxm_domain = container_of(rxm_ep->util_ep.domain,
+				  struct rxm_domain, util_domain);
+	if (!rxm_domain->buf_arena ||
+	    (rxm_ep->msg_mr_local && !rxm_domain->arena_mr_local) ||
+	    ((rxm_ep->util_ep.caps & FI_HMEM) && !rxm_domain->arena_hmem))
+		return NULL;
+
+	return rxm_domain->buf_arena;
+}
+
 static int rxm_ep_create_pools(struct rxm_ep *rxm_ep)
 {
 	struct ofi_bufpool_attr attr = {0};
@@ -127,6 +151,7 @@ static int rxm_ep_create_pools(struct rxm_ep *rxm_ep)
 	attr.init_fn = rxm_init_rx_buf;
 	attr.context = rxm_ep;
 	attr.flags = OFI_BUFPOOL_NO_TRACK;
+	attr.arena = rxm_ep_buf_arena(rxm_ep);
 
 	ret = ofi_bufpool_create_attr(&attr, &rxm_ep->rx_pool);
 	if (ret) {
@@ -625,6 +650,12 @@ void rxm_ep_progress_deferred_queue(struct rxm_ep *rxm_ep,
 			if (ret == -FI_EAGAIN)
 				return;
 			break;
+		case RXM_DEFERRED_TX_ATOMIC_SEG:
+			ret = rxm_atomic_send_segs(rxm_ep,
+					def_tx_entry->atomic_seg.seg);
+			if (ret == -FI_EAGAIN)
+				return;
+			break;
 		case RXM_DEFERRED_TX_CREDIT_SEND:
 			iov.iov_base = &def_tx_entry->credit_msg.tx_buf->pkt;
 			iov.iov_len = sizeof(def_tx_entry->credit_msg.tx_buf->pkt);
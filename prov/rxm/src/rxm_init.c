@@ -54,6 +54,7 @@ size_t rxm_def_tx_size = 2048;
 
 size_t rxm_buffer_size = 16384;
 size_t rxm_packet_size;
+size_t rxm_buf_arena_size;
 
 int rxm_passthru = 0; /* disable by default, need to analyze performance */
 int force_auto_progress;
@@ -708,6 +709,14 @@ RXM_INI
 			"in. This allows such buffers be copied or registered "
 			"internally by RxM. (default: false).");
 
+	fi_param_define(&rxm_prov, "buf_arena_size", FI_PARAM_SIZE_T,
+			"Allocate the bounce buffer pools of all endpoints of "
+			"a domain from a shared arena of huge pages, which is "
+			"registered with the MSG provider once per chunk "
+			"instead of once per pool region.  The value is the "
+			"size of the chunks that the arena grows by.  "
+			"(default: 0, disabled)");
+
 	fi_param_define(&rxm_prov, "rescan", FI_PARAM_BOOL,
 			"Force or disable rescanning for network interface changes. "
 			"Setting this to true will force rescanning on each fi_getinfo() invocation; "
@@ -740,6 +749,7 @@ RXM_INI
 
 	fi_param_get_bool(&rxm_prov, "detect_hmem_iface", &rxm_detect_hmem_iface);
 	fi_param_get_bool(&rxm_prov, "rescan", &rxm_rescan);
+	fi_param_get_size_t(&rxm_prov, "buf_arena_size", &rxm_buf_arena_size);
 
 #if HAVE_RXM_DL
 	ofi_mem_init();
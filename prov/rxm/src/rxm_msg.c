@@ -45,6 +45,9 @@ rxm_recvmsg(struct fid_ep *ep_fid, const struct fi_msg *msg, uint64_t flags)
 {
 	struct rxm_ep *rxm_ep = container_of(ep_fid, struct rxm_ep,
 					     util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_msg(&rxm_ep->util_ep,
+				FI_OP_RECV, msg, flags);
 
 	return util_srx_generic_recv(&rxm_ep->srx->ep_fid, msg->msg_iov,
 				     msg->desc, msg->iov_count, msg->addr,
@@ -544,6 +547,10 @@ rxm_sendmsg(struct fid_ep *ep_fid, const struct fi_msg *msg, uint64_t flags)
 	ssize_t ret;
 
 	rxm_ep = container_of(ep_fid, struct rxm_ep, util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_msg(&rxm_ep->util_ep,
+				FI_OP_SEND, msg, flags);
+
 	ofi_genlock_lock(&rxm_ep->util_ep.lock);
 	ret = rxm_get_conn(rxm_ep, msg->addr, &rxm_conn);
 	if (ret)
@@ -121,6 +121,10 @@ rxm_ep_readmsg(struct fid_ep *ep_fid, const struct fi_msg_rma *msg,
 	struct rxm_ep *rxm_ep;
 
 	rxm_ep = container_of(ep_fid, struct rxm_ep, util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_rma(&rxm_ep->util_ep,
+				FI_OP_READ, msg, flags);
+
 	return rxm_ep_rma_common(rxm_ep, msg, flags | rxm_ep->util_ep.tx_msg_flags,
 				 fi_readmsg, FI_READ);
 }
@@ -338,6 +342,10 @@ rxm_ep_writemsg(struct fid_ep *ep_fid, const struct fi_msg_rma *msg,
 	struct rxm_ep *rxm_ep;
 
 	rxm_ep = container_of(ep_fid, struct rxm_ep, util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_rma(&rxm_ep->util_ep,
+				FI_OP_WRITE, msg, flags);
+
 	return rxm_ep_generic_writemsg(ep_fid, msg, flags |
 				       rxm_ep->util_ep.tx_msg_flags);
 }
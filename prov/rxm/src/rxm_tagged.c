@@ -50,6 +50,9 @@ rxm_trecvmsg(struct fid_ep *ep_fid, const struct fi_msg_tagged *msg,
 	uint64_t tag = msg->tag;
 	struct rxm_ep *rxm_ep = container_of(ep_fid, struct rxm_ep,
 					     util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_tagged(&rxm_ep->util_ep,
+				FI_OP_TRECV, msg, flags);
 
 	if (flags & FI_PEER_TRANSFER)
 		tag |= RXM_PEER_XFER_TAG_FLAG;
@@ -99,6 +102,10 @@ rxm_tsendmsg(struct fid_ep *ep_fid, const struct fi_msg_tagged *msg,
 	ssize_t ret;
 
 	rxm_ep = container_of(ep_fid, struct rxm_ep, util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_tagged(&rxm_ep->util_ep,
+				FI_OP_TSEND, msg, flags);
+
 	ofi_genlock_lock(&rxm_ep->util_ep.lock);
 	ret = rxm_get_conn(rxm_ep, msg->addr, &rxm_conn);
 	if (ret)
@@ -279,6 +279,8 @@ static ssize_t smr_atomic_writemsg(struct fid_ep *ep_fid,
 	struct smr_ep *ep;
 
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_atomic(&ep->util_ep, msg, flags);
 
 	return smr_generic_atomic(ep, msg->msg_iov, msg->desc, msg->iov_count,
 				  NULL, NULL, 0, NULL, NULL, 0, msg->addr,
@@ -400,6 +402,9 @@ static ssize_t smr_atomic_readwritemsg(struct fid_ep *ep_fid,
 	struct smr_ep *ep;
 
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_fetch_atomic(&ep->util_ep, msg, resultv,
+				result_desc, result_count, flags);
 
 	return smr_generic_atomic(ep, msg->msg_iov, msg->desc, msg->iov_count,
 				  NULL, NULL, 0, resultv, result_desc,
@@ -469,6 +474,10 @@ static ssize_t smr_atomic_compwritemsg(struct fid_ep *ep_fid,
 	struct smr_ep *ep;
 
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_compare_atomic(&ep->util_ep, msg, comparev,
+				compare_desc, compare_count, resultv,
+				result_desc, result_count, flags);
 
 	return smr_generic_atomic(ep, msg->msg_iov, msg->desc, msg->iov_count,
 				  comparev, compare_desc, compare_count,
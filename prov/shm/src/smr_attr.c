@@ -32,10 +32,11 @@
 
 #include "smr.h"
 
-#define SMR_TX_CAPS (OFI_TX_MSG_CAPS | FI_TAGGED | OFI_TX_RMA_CAPS | FI_ATOMICS)
+#define SMR_TX_CAPS (OFI_TX_MSG_CAPS | FI_TAGGED | OFI_TX_RMA_CAPS | FI_ATOMICS | \
+		     FI_TRIGGER)
 #define SMR_RX_CAPS (FI_SOURCE | FI_RMA_EVENT | OFI_RX_MSG_CAPS | FI_TAGGED | \
 		     OFI_RX_RMA_CAPS | FI_ATOMICS | FI_DIRECTED_RECV | \
-		     FI_MULTI_RECV)
+		     FI_MULTI_RECV | FI_TRIGGER)
 #define SMR_DOMAIN_CAPS (FI_LOCAL_COMM | FI_PEER | FI_AV_USER_ID)
 #define SMR_HMEM_TX_CAPS (SMR_TX_CAPS | FI_HMEM)
 #define SMR_HMEM_RX_CAPS (SMR_RX_CAPS | FI_HMEM)
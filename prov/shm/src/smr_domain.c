@@ -143,7 +143,7 @@ static struct fi_ops smr_domain_fi_ops = {
 	.size = sizeof(struct fi_ops),
 	.close = smr_domain_close,
 	.bind = fi_no_bind,
-	.control = fi_no_control,
+	.control = ofi_domain_control,
 	.ops_open = fi_no_ops_open,
 };
 
@@ -44,6 +44,8 @@ static ssize_t smr_recvmsg(struct fid_ep *ep_fid, const struct fi_msg *msg,
 	struct smr_ep *ep;
 
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_msg(&ep->util_ep, FI_OP_RECV, msg, flags);
 
 	return util_srx_generic_recv(&ep->srx->ep_fid, msg->msg_iov, msg->desc,
 				     msg->iov_count, msg->addr, msg->context,
@@ -171,6 +173,8 @@ static ssize_t smr_sendmsg(struct fid_ep *ep_fid, const struct fi_msg *msg,
 	struct smr_ep *ep;
 
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_msg(&ep->util_ep, FI_OP_SEND, msg, flags);
 
 	return smr_generic_sendmsg(ep, msg->msg_iov, msg->desc, msg->iov_count,
 				   msg->addr, 0, msg->data, msg->context,
@@ -317,6 +321,9 @@ static ssize_t smr_trecvmsg(struct fid_ep *ep_fid,
 	struct smr_ep *ep;
 
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_tagged(&ep->util_ep,
+				FI_OP_TRECV, msg, flags);
 
 	return util_srx_generic_trecv(&ep->srx->ep_fid, msg->msg_iov, msg->desc,
 				      msg->iov_count, msg->addr, msg->context,
@@ -359,6 +366,9 @@ static ssize_t smr_tsendmsg(struct fid_ep *ep_fid,
 	struct smr_ep *ep;
 
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_tagged(&ep->util_ep,
+				FI_OP_TSEND, msg, flags);
 
 	return smr_generic_sendmsg(ep, msg->msg_iov, msg->desc, msg->iov_count,
 				   msg->addr, msg->tag, msg->data, msg->context,
@@ -244,6 +244,8 @@ static ssize_t smr_readmsg(struct fid_ep *ep_fid, const struct fi_msg_rma *msg,
 	struct smr_ep *ep;
 
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_rma(&ep->util_ep, FI_OP_READ, msg, flags);
 
 	return smr_generic_rma(ep, msg->msg_iov, msg->iov_count,
 			       msg->rma_iov, msg->rma_iov_count,
@@ -298,6 +300,8 @@ static ssize_t smr_writemsg(struct fid_ep *ep_fid, const struct fi_msg_rma *msg,
 	struct smr_ep *ep;
 
 	ep = container_of(ep_fid, struct smr_ep, util_ep.ep_fid.fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_rma(&ep->util_ep, FI_OP_WRITE, msg, flags);
 
 	return smr_generic_rma(ep, msg->msg_iov, msg->iov_count,
 			       msg->rma_iov, msg->rma_iov_count,
@@ -112,8 +112,11 @@ extern int xnet_prefetch_rbuf_size;
 extern size_t xnet_default_tx_size;
 extern size_t xnet_default_rx_size;
 extern size_t xnet_zerocopy_size;
+extern int xnet_zerocopy_tune;
 extern int xnet_trace_msg;
 extern int xnet_disable_autoprog;
+extern size_t xnet_progress_workers;
+extern char *xnet_progress_affinity;
 extern int xnet_io_uring;
 extern int xnet_max_saved;
 extern size_t xnet_max_saved_size;
@@ -182,6 +185,7 @@ union xnet_hdrs {
 	struct xnet_tag_hdr	tag_hdr;
 	struct xnet_tag_rts_hdr	tag_rts_hdr;
 	struct xnet_tag_rts_data_hdr tag_rts_data_hdr;
+	struct xnet_atomic_hdr	atomic_hdr;
 	uint8_t			max_hdr[XNET_MAX_HDR];
 };
 
@@ -235,6 +239,7 @@ int xnet_srx_context(struct fid_domain *domain, struct fi_rx_attr *attr,
 
 /* xnet_ep::util_ep::flags */
 #define XNET_EP_RENDEZVOUS (1 << 0)
+#define XNET_EP_ATOMIC (1 << 1)
 
 struct xnet_ep {
 	struct util_ep		util_ep;
@@ -266,6 +271,7 @@ struct xnet_ep {
 	void (*hdr_bswap)(struct xnet_ep *ep, struct xnet_base_hdr *hdr);
 
 	short			pollflags;
+	struct xnet_progress	*progress;
 
 	xnet_profile_t *profile;
 };
@@ -379,6 +385,10 @@ struct xnet_progress {
 
 	bool			auto_progress;
 	pthread_t		thread;
+	/* CPU set applied to the progress thread, may be NULL */
+	char			*affinity;
+	/* CQ shard written by the progress thread, 0 if shared */
+	size_t			cq_shard;
 };
 
 int xnet_init_progress(struct xnet_progress *progress, struct fi_info *info);
@@ -504,14 +514,22 @@ struct xnet_domain {
 	 struct fi_info		*subdomain_info;
 	 struct ofi_genlock	subdomain_list_lock;
 	 struct dlist_entry	subdomain_list;
+
+	/* A domain exporting msg endpoints may instead partition its
+	 * endpoints across worker progress instances, each with its own
+	 * poll set, lock, and progress thread.  The domain progress
+	 * instance is still used for endpoints attached to a shared
+	 * receive context.  Completions are handed off to the CQ through
+	 * per-thread completion shards.
+	 */
+	struct xnet_progress	*workers;
+	size_t			worker_cnt;
+	ofi_atomic32_t		next_worker;
 };
 
 static inline struct xnet_progress *xnet_ep2_progress(struct xnet_ep *ep)
 {
-	struct xnet_domain *domain;
-	domain = container_of(ep->util_ep.domain, struct xnet_domain,
-			      util_domain);
-	return &domain->progress;
+	return ep->progress;
 }
 
 static inline struct xnet_progress *xnet_rdm2_progress(struct xnet_rdm *rdm)
@@ -781,6 +799,14 @@ static inline uint64_t xnet_msg_len(union xnet_hdrs *hdr)
 	}
 }
 
+int xnet_query_atomic(struct fid_domain *domain_fid, enum fi_datatype datatype,
+		      enum fi_op op, struct fi_atomic_attr *attr,
+		      uint64_t flags);
+ssize_t xnet_atomic_msg(struct xnet_ep *ep, const struct fi_msg_atomic *msg,
+			const struct fi_ioc *comparev, size_t compare_count,
+			struct fi_ioc *resultv, size_t result_count,
+			uint8_t op, uint64_t flags);
+
 int xnet_ep_ops_open(struct fid *fid, const char *name,
 		     uint64_t flags, void **ops, void *context);
 int xnet_rdm_ops_open(struct fid *fid, const char *name,
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <rdma/fi_errno.h>
+#include <ofi_iov.h>
+#include <ofi_atomic.h>
+#include "xnet.h"
+
+
+int xnet_query_atomic(struct fid_domain *domain_fid, enum fi_datatype datatype,
+		      enum fi_op op, struct fi_atomic_attr *attr,
+		      uint64_t flags)
+{
+	struct xnet_domain *domain;
+	int ret;
+
+	domain = container_of(domain_fid, struct xnet_domain,
+			      util_domain.domain_fid);
+	if (domain->ep_type == FI_EP_RDM && (flags & FI_TAGGED))
+		return -FI_EOPNOTSUPP;
+
+	ret = ofi_atomic_valid(&xnet_prov, datatype, op, flags);
+	if (ret || !attr)
+		return ret;
+
+	/* Only the rdm protocol carries atomic operations */
+	if (domain->ep_type != FI_EP_RDM)
+		return -FI_EOPNOTSUPP;
+
+	/* Operands are staged by the target, so the count is not bounded
+	 * by the transfer buffers.
+	 */
+	attr->size = ofi_datatype_size(datatype);
+	attr->count = SIZE_MAX / ((flags & FI_COMPARE_ATOMIC) ?
+				  2 * attr->size : attr->size);
+	return 0;
+}
+
+/* Operands which can't be sent from the user's buffers are copied,
+ * inline after the header if they fit, or to an allocated buffer.
+ */
+static int
+xnet_atomic_copy_data(struct xnet_xfer_entry *send_entry, size_t offset,
+		      const struct iovec *iov, size_t iov_cnt, size_t len)
+{
+	void *buf;
+
+	if (offset + len <= sizeof(send_entry->hdr) + xnet_buf_size) {
+		ofi_copy_iov_buf(iov, iov_cnt, 0,
+				 (uint8_t *) &send_entry->hdr + offset, len,
+				 OFI_COPY_IOV_TO_BUF);
+		send_entry->iov[0].iov_len += len;
+		return 0;
+	}
+
+	buf = malloc(len);
+	if (!buf)
+		return -FI_ENOMEM;
+
+	ofi_copy_iov_buf(iov, iov_cnt, 0, buf, len, OFI_COPY_IOV_TO_BUF);
+	send_entry->user_buf = buf;
+	send_entry->ctrl_flags |= XNET_FREE_BUF;
+	send_entry->iov[1].iov_base = buf;
+	send_entry->iov[1].iov_len = len;
+	send_entry->iov_cnt = 2;
+	return 0;
+}
+
+static void
+xnet_atomic_recv_entry_fill(struct xnet_xfer_entry *recv_entry,
+			    struct xnet_ep *ep, const struct fi_msg_atomic *msg,
+			    struct fi_ioc *resultv, size_t result_count,
+			    uint8_t op, uint64_t flags)
+{
+	ofi_ioc_to_iov(resultv, recv_entry->iov, result_count,
+		       ofi_datatype_size(msg->datatype));
+	recv_entry->iov_cnt = result_count;
+	recv_entry->context = msg->context;
+	recv_entry->cq_flags = (flags & FI_COMPLETION) | ofi_tx_cq_flags(op);
+
+	/* As with RMA reads, the response completes the operation, and
+	 * is only reported once the request has been sent.
+	 */
+	recv_entry->cntr = ep->util_ep.cntrs[CNTR_RD];
+	recv_entry->cq = xnet_ep_tx_cq(ep);
+	recv_entry->ctrl_flags = XNET_INTERNAL_XFER;
+}
+
+ssize_t xnet_atomic_msg(struct xnet_ep *ep, const struct fi_msg_atomic *msg,
+			const struct fi_ioc *comparev, size_t compare_count,
+			struct fi_ioc *resultv, size_t result_count,
+			uint8_t op, uint64_t flags)
+{
+	struct xnet_xfer_entry *send_entry, *recv_entry = NULL;
+	struct ofi_rma_ioc *rma_ioc;
+	struct iovec iov[XNET_IOV_LIMIT * 2];
+	size_t dt_size, data_len, iov_cnt, offset, i;
+	ssize_t ret = 0;
+
+	assert(ep->util_ep.flags & XNET_EP_ATOMIC);
+	assert(msg->iov_count <= XNET_IOV_LIMIT);
+	assert(msg->rma_iov_count <= XNET_IOV_LIMIT);
+	assert(compare_count <= XNET_IOV_LIMIT);
+	assert(result_count <= XNET_IOV_LIMIT);
+
+	dt_size = ofi_datatype_size(msg->datatype);
+	if (!dt_size)
+		return -FI_EINVAL;
+
+	if (msg->op == FI_ATOMIC_READ) {
+		data_len = 0;
+		iov_cnt = 0;
+	} else {
+		ofi_ioc_to_iov(msg->msg_iov, iov, msg->iov_count, dt_size);
+		iov_cnt = msg->iov_count;
+		if (op == ofi_op_atomic_compare) {
+			ofi_ioc_to_iov(comparev, &iov[iov_cnt], compare_count,
+				       dt_size);
+			iov_cnt += compare_count;
+		}
+		data_len = ofi_total_iov_len(iov, iov_cnt);
+	}
+
+	ofi_genlock_lock(&xnet_ep2_progress(ep)->ep_lock);
+	send_entry = xnet_alloc_tx(ep);
+	if (!send_entry) {
+		ret = -FI_EAGAIN;
+		goto unlock;
+	}
+
+	if (op != ofi_op_atomic) {
+		recv_entry = xnet_alloc_xfer(xnet_ep2_progress(ep));
+		if (!recv_entry) {
+			ret = -FI_EAGAIN;
+			goto free;
+		}
+	}
+
+	send_entry->hdr.base_hdr.op = xnet_op_atomic_req;
+	send_entry->hdr.base_hdr.op_data = op;
+	send_entry->hdr.atomic_hdr.op = msg->op;
+	send_entry->hdr.atomic_hdr.datatype = msg->datatype;
+
+	offset = sizeof(send_entry->hdr.atomic_hdr);
+	rma_ioc = (struct ofi_rma_ioc *) ((uint8_t *) &send_entry->hdr + offset);
+	for (i = 0; i < msg->rma_iov_count; i++) {
+		rma_ioc[i].addr = msg->rma_iov[i].addr;
+		rma_ioc[i].count = msg->rma_iov[i].count;
+		rma_ioc[i].key = msg->rma_iov[i].key;
+	}
+	send_entry->hdr.base_hdr.rma_iov_cnt = (uint8_t) msg->rma_iov_count;
+	offset += msg->rma_iov_count * sizeof(*rma_ioc);
+
+	send_entry->hdr.base_hdr.hdr_size = (uint8_t) offset;
+	send_entry->hdr.base_hdr.size = offset + data_len;
+
+	send_entry->iov[0].iov_base = (void *) &send_entry->hdr;
+	send_entry->iov[0].iov_len = offset;
+	send_entry->iov_cnt = 1;
+
+	if ((flags & FI_INJECT) || iov_cnt > XNET_IOV_LIMIT) {
+		ret = xnet_atomic_copy_data(send_entry, offset, iov, iov_cnt,
+					    data_len);
+		if (ret)
+			goto free;
+	} else {
+		memcpy(&send_entry->iov[1], iov, iov_cnt * sizeof(*iov));
+		send_entry->iov_cnt += iov_cnt;
+	}
+
+	send_entry->context = msg->context;
+	if (op == ofi_op_atomic) {
+		send_entry->cq_flags = (flags & FI_COMPLETION) |
+				       ofi_tx_cq_flags(op);
+		send_entry->cntr = ep->util_ep.cntrs[CNTR_WR];
+		xnet_set_commit_flags(send_entry, flags);
+	} else {
+		/* Request generates a completion on error */
+		send_entry->cntr = ep->util_ep.cntrs[CNTR_RD];
+		send_entry->ctrl_flags |= XNET_NEED_RESP;
+		send_entry->resp_entry = recv_entry;
+
+		xnet_atomic_recv_entry_fill(recv_entry, ep, msg, resultv,
+					    result_count, op, flags);
+		slist_insert_tail(&recv_entry->entry, &ep->rma_read_queue);
+	}
+
+	xnet_tx_queue_insert(ep, send_entry);
+unlock:
+	ofi_genlock_unlock(&xnet_ep2_progress(ep)->ep_lock);
+	return ret;
+
+free:
+	if (recv_entry)
+		xnet_free_xfer(xnet_ep2_progress(ep), recv_entry);
+	xnet_free_xfer(xnet_ep2_progress(ep), send_entry);
+	goto unlock;
+}
@@ -36,7 +36,7 @@
 #define XNET_DOMAIN_CAPS (FI_LOCAL_COMM | FI_REMOTE_COMM)
 #define XNET_EP_CAPS	 (FI_MSG | FI_RMA | FI_RMA_PMEM)
 #define XNET_SRX_EP_CAPS (XNET_EP_CAPS | FI_TAGGED)
-#define XNET_RDM_EP_CAPS (XNET_EP_CAPS | FI_TAGGED)
+#define XNET_RDM_EP_CAPS (XNET_EP_CAPS | FI_TAGGED | FI_ATOMIC | FI_TRIGGER)
 #define XNET_TX_CAPS	 (FI_SEND | FI_WRITE | FI_READ)
 #define XNET_RX_CAPS	 (FI_RECV | FI_REMOTE_READ | \
 			  FI_REMOTE_WRITE | FI_RMA_EVENT)
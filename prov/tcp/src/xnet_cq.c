@@ -47,8 +47,12 @@ xnet_cq_readfrom(struct fid_cq *cq_fid, void *buf, size_t count,
 
 	cq = container_of(cq_fid, struct xnet_cq, util_cq.cq_fid);
 	ofi_genlock_lock(xnet_cq2_progress(cq)->active_lock);
-	ret = ofi_cq_readfrom(cq_fid, buf, count, src_addr);
+	cq->util_cq.progress(&cq->util_cq);
+	ret = ofi_cq_read_entries(&cq->util_cq, buf, count, src_addr);
 	ofi_genlock_unlock(xnet_cq2_progress(cq)->active_lock);
+
+	/* Triggered operations take the progress lock when issued */
+	ofi_trigger_progress(cq->util_cq.domain);
 	return ret;
 }
 
@@ -180,7 +184,7 @@ void xnet_report_success(struct xnet_xfer_entry *xfer_entry)
 			     xfer_entry->user_buf, data, tag);
 	}
 	if (cq->wait)
-		cq->wait->signal(cq->wait);
+		util_cq_signal(cq);
 }
 
 void xnet_report_error(struct xnet_xfer_entry *xfer_entry, int err)
@@ -262,7 +266,7 @@ static struct fi_ops xnet_cq_fi_ops = {
 	.close = xnet_cq_close,
 	.bind = fi_no_bind,
 	.control = xnet_cq_control,
-	.ops_open = fi_no_ops_open,
+	.ops_open = ofi_cq_ops_open,
 };
 
 static int xnet_cq_wait_try_func(void *arg)
@@ -274,6 +278,7 @@ static int xnet_cq_wait_try_func(void *arg)
 int xnet_cq_open(struct fid_domain *domain, struct fi_cq_attr *attr,
 		 struct fid_cq **cq_fid, void *context)
 {
+	struct xnet_domain *xnet_domain;
 	struct xnet_cq *cq;
 	struct fi_cq_attr cq_attr;
 	int ret;
@@ -291,8 +296,16 @@ int xnet_cq_open(struct fid_domain *domain, struct fi_cq_attr *attr,
 		attr = &cq_attr;
 	}
 
-	ret = ofi_cq_init(&xnet_prov, domain, attr, &cq->util_cq,
-			  &xnet_cq_progress, context);
+	/* Each worker progress thread writes completions to its own shard */
+	xnet_domain = container_of(domain, struct xnet_domain,
+				   util_domain.domain_fid);
+	if (xnet_domain->worker_cnt)
+		ret = ofi_cq_init_sharded(&xnet_prov, domain, attr,
+					  &cq->util_cq, &xnet_cq_progress,
+					  xnet_domain->worker_cnt + 1, context);
+	else
+		ret = ofi_cq_init(&xnet_prov, domain, attr, &cq->util_cq,
+				  &xnet_cq_progress, context);
 	if (ret)
 		goto free_cq;
 
@@ -338,6 +351,7 @@ static uint64_t xnet_cntr_read(struct fid_cntr *cntr_fid)
 
 	cntr = container_of(cntr_fid, struct util_cntr, cntr_fid);
 	xnet_progress(xnet_cntr2_progress(cntr), false);
+	ofi_trigger_progress(cntr->domain);
 	return ofi_atomic_get64(&cntr->cnt);
 }
 
@@ -347,6 +361,7 @@ static uint64_t xnet_cntr_readerr(struct fid_cntr *cntr_fid)
 
 	cntr = container_of(cntr_fid, struct util_cntr, cntr_fid);
 	xnet_progress(xnet_cntr2_progress(cntr), false);
+	ofi_trigger_progress(cntr->domain);
 	return ofi_atomic_get64(&cntr->err);
 }
 
@@ -416,6 +431,7 @@ xnet_cntr_wait(struct fid_cntr *cntr_fid, uint64_t threshold, int timeout)
 			break;
 
 		xnet_progress(xnet_cntr2_progress(cntr), true);
+		ofi_trigger_progress(cntr->domain);
 	} while (true);
 
 	return ret;
@@ -461,7 +477,7 @@ int xnet_cntr_open(struct fid_domain *fid_domain, struct fi_cntr_attr *attr,
 			      util_domain.domain_fid);
 	if (attr->wait_obj == FI_WAIT_UNSPEC) {
 		cntr_attr = *attr;
-		if (domain->progress.auto_progress ||
+		if (domain->progress.auto_progress || domain->worker_cnt ||
 		    domain->util_domain.threading != FI_THREAD_DOMAIN) {
 			cntr_attr.wait_obj = FI_WAIT_FD;
 		} else {
@@ -477,7 +493,9 @@ int xnet_cntr_open(struct fid_domain *fid_domain, struct fi_cntr_attr *attr,
 		goto free;
 
 	if (attr->wait_obj == FI_WAIT_NONE) {
-		cntr->cntr_fid.ops = &xnet_cntr_ops;
+		/* xnet_cntr_wait cannot wait on the worker progress threads */
+		if (!domain->worker_cnt)
+			cntr->cntr_fid.ops = &xnet_cntr_ops;
 	} else {
 		progress = xnet_cntr2_progress(cntr);
 		if (attr->wait_obj == FI_WAIT_FD && ofi_have_epoll) {
@@ -263,17 +263,93 @@ static int xnet_open_ep(struct fid_domain *domain_fid, struct fi_info *info,
 	return -FI_EINVAL;
 }
 
-static int
-xnet_query_atomic(struct fid_domain *domain, enum fi_datatype datatype,
-		  enum fi_op op, struct fi_atomic_attr *attr, uint64_t flags)
+static void xnet_close_workers(struct xnet_domain *domain)
+{
+	while (domain->worker_cnt)
+		xnet_close_progress(&domain->workers[--domain->worker_cnt]);
+	free(domain->workers);
+	domain->workers = NULL;
+}
+
+/* Each ';' separated cpu set is bound to the next worker, and the sets
+ * are reused if there are more workers than sets.
+ */
+static int xnet_set_worker_affinity(struct xnet_domain *domain)
 {
+	char *sets, *set, *saveptr = NULL;
+	size_t i, set_cnt = 0;
+	int ret = 0;
+
+	if (!xnet_progress_affinity || !strlen(xnet_progress_affinity))
+		return 0;
+
+	sets = strdup(xnet_progress_affinity);
+	if (!sets)
+		return -FI_ENOMEM;
+
+	for (set = strtok_r(sets, ";", &saveptr);
+	     set && set_cnt < domain->worker_cnt;
+	     set = strtok_r(NULL, ";", &saveptr)) {
+		domain->workers[set_cnt].affinity = strdup(set);
+		if (!domain->workers[set_cnt++].affinity) {
+			ret = -FI_ENOMEM;
+			goto out;
+		}
+	}
+
+	for (i = set_cnt; set_cnt && i < domain->worker_cnt; i++) {
+		domain->workers[i].affinity =
+			strdup(domain->workers[i % set_cnt].affinity);
+		if (!domain->workers[i].affinity) {
+			ret = -FI_ENOMEM;
+			goto out;
+		}
+	}
+out:
+	free(sets);
+	return ret;
+}
+
+static int xnet_init_workers(struct xnet_domain *domain, struct fi_info *info)
+{
+	size_t i;
 	int ret;
 
-	ret = ofi_atomic_valid(&xnet_prov, datatype, op, flags);
-	if (ret || !attr)
-		return ret;
+	domain->workers = calloc(xnet_progress_workers,
+				 sizeof(*domain->workers));
+	if (!domain->workers)
+		return -FI_ENOMEM;
+
+	for (; domain->worker_cnt < xnet_progress_workers;
+	     domain->worker_cnt++) {
+		ret = xnet_init_progress(&domain->workers[domain->worker_cnt],
+					 info);
+		if (ret)
+			goto close;
+
+		/* shard 0 is shared by the domain progress and app threads */
+		domain->workers[domain->worker_cnt].cq_shard =
+			domain->worker_cnt + 1;
+	}
+
+	ret = xnet_set_worker_affinity(domain);
+	if (ret)
+		goto close;
+
+	for (i = 0; i < domain->worker_cnt; i++) {
+		ret = xnet_start_progress(&domain->workers[i]);
+		if (ret)
+			goto close;
+	}
+
+	ofi_atomic_initialize32(&domain->next_worker, 0);
+	FI_INFO(&xnet_prov, FI_LOG_DOMAIN, "using %zu progress workers\n",
+		domain->worker_cnt);
+	return 0;
 
-	return -FI_EOPNOTSUPP;
+close:
+	xnet_close_workers(domain);
+	return ret;
 }
 
 static int xnet_domain_close(fid_t fid)
@@ -289,6 +365,7 @@ static int xnet_domain_close(fid_t fid)
 	if (ret)
 		return ret;
 
+	xnet_close_workers(domain);
 	xnet_close_progress(&domain->progress);
 	free(domain);
 	return FI_SUCCESS;
@@ -413,7 +490,7 @@ static struct fi_ops xnet_domain_fi_ops = {
 	.size = sizeof(struct fi_ops),
 	.close = xnet_domain_close,
 	.bind = ofi_domain_bind,
-	.control = fi_no_control,
+	.control = ofi_domain_control,
 	.ops_open = fi_no_ops_open,
 	.tostr = fi_no_tostr,
 	.ops_set = fi_no_ops_set,
@@ -430,6 +507,7 @@ int xnet_domain_open(struct fid_fabric *fabric_fid, struct fi_info *info,
 		     struct fid_domain **domain_fid, void *context)
 {
 	struct xnet_domain *domain;
+	bool use_workers = false;
 	int ret;
 
 	ret = ofi_prov_check_info(&xnet_util_prov, fabric_fid->api_version, info);
@@ -444,8 +522,20 @@ int xnet_domain_open(struct fid_fabric *fabric_fid, struct fi_info *info,
 	if (!domain)
 		return -FI_ENOMEM;
 
+	if (xnet_progress_workers && info->ep_attr->type == FI_EP_MSG) {
+		if (xnet_disable_autoprog) {
+			FI_WARN(&xnet_prov, FI_LOG_DOMAIN, "progress workers "
+				"require auto progress, ignoring\n");
+		} else {
+			use_workers = true;
+		}
+	}
+
+	/* Workers access the MR map in parallel, which is protected by
+	 * the util domain lock.
+	 */
 	ret = ofi_domain_init(fabric_fid, info, &domain->util_domain, context,
-			      OFI_LOCK_NONE);
+			      use_workers ? OFI_LOCK_MUTEX : OFI_LOCK_NONE);
 	if (ret)
 		goto free;
 
@@ -453,6 +543,12 @@ int xnet_domain_open(struct fid_fabric *fabric_fid, struct fi_info *info,
 	if (ret)
 		goto close;
 
+	if (use_workers) {
+		ret = xnet_init_workers(domain, info);
+		if (ret)
+			goto close_progress;
+	}
+
 	domain->ep_type = info->ep_attr->type;
 	domain->util_domain.domain_fid.fid.ops = &xnet_domain_fi_ops;
 	domain->util_domain.domain_fid.ops = &xnet_domain_ops;
@@ -461,6 +557,8 @@ int xnet_domain_open(struct fid_fabric *fabric_fid, struct fi_info *info,
 
 	return FI_SUCCESS;
 
+close_progress:
+	xnet_close_progress(&domain->progress);
 close:
 	(void) ofi_domain_close(&domain->util_domain);
 free:
@@ -53,6 +53,8 @@ static const char *const xnet_opstr[] = {
 	[xnet_op_tag_rts] = "tag rts",
 	[xnet_op_cts] = "cts",
 	[xnet_op_data] = "rndv data",
+	[xnet_op_atomic_req] = "atomic req",
+	[xnet_op_atomic_rsp] = "atomic resp",
 };
 
 static const char *xnet_op_str(uint8_t op)
@@ -129,10 +131,12 @@ static void xnet_config_bsock(struct ofi_bsock *bsock)
 
 	ret = getsockopt(bsock->sock, SOL_SOCKET, SO_ZEROCOPY, &val, &len);
 	if (!ret && val) {
-		bsock->zerocopy_size = xnet_zerocopy_size;
+		ofi_bsock_set_zerocopy(bsock, xnet_zerocopy_size,
+				       xnet_zerocopy_tune);
 		FI_INFO(&xnet_prov, FI_LOG_EP_CTRL,
-			"zero copy enabled for transfers > %zu\n",
-			bsock->zerocopy_size);
+			"zero copy enabled for transfers > %zu%s\n",
+			bsock->zerocopy_size,
+			xnet_zerocopy_tune ? ", adaptive" : "");
 	}
 }
 #else
@@ -382,24 +386,28 @@ xnet_ep_accept(struct fid_ep *ep_fid, const void *param, size_t paramlen)
 	ep->state = XNET_CONNECTED;
 	assert(!ofi_bsock_readable(&ep->bsock) && !ep->cur_rx.handler);
 
+	cm_entry.fid = &ep->util_ep.ep_fid.fid;
+	cm_entry.info = NULL;
+	if (paramlen)
+		memcpy(cm_entry.data, param, paramlen);
+
+	/* Once monitored, the socket may be progressed by a progress thread,
+	 * which must not report a shutdown ahead of the connected event.
+	 */
 	progress = xnet_ep2_progress(ep);
 	ofi_genlock_lock(&progress->ep_lock);
 	ep->pollflags = POLLIN;
 	ret = xnet_monitor_ep(progress, ep);
+	if (!ret) {
+		ret = xnet_eq_write(ep->util_ep.eq, FI_CONNECTED, &cm_entry,
+				    sizeof(cm_entry), 0);
+		if (ret < 0)
+			FI_WARN(&xnet_prov, FI_LOG_EP_CTRL,
+				"Error writing to EQ\n");
+	}
 	ofi_genlock_unlock(&progress->ep_lock);
-	if (ret)
-		return ret;
-
-	cm_entry.fid = &ep->util_ep.ep_fid.fid;
-	cm_entry.info = NULL;
-	if (paramlen)
-		memcpy(cm_entry.data, param, paramlen);
-	ret = xnet_eq_write(ep->util_ep.eq, FI_CONNECTED, &cm_entry,
-			    sizeof(cm_entry), 0);
-	if (ret < 0) {
-		FI_WARN(&xnet_prov, FI_LOG_EP_CTRL, "Error writing to EQ\n");
+	if (ret < 0)
 		return ret;
-	}
 
 	/* Only free conn on success; on failure, app may try to reject */
 	free(conn);
@@ -731,6 +739,11 @@ static int xnet_ep_bind(struct fid *fid, struct fid *bfid, uint64_t flags)
 	case FI_CLASS_SRX_CTX:
 		srx = container_of(bfid, struct xnet_srx, rx_fid.fid);
 		ep->srx = srx;
+		/* Endpoints sharing a receive context are progressed
+		 * together with the srx.  The socket is not monitored yet.
+		 */
+		ep->progress = xnet_srx2_progress(srx);
+		ep->bsock.sockapi = &ep->progress->sockapi;
 		if (!ep->profile)
 			ep->profile = srx->profile;
 		return FI_SUCCESS;
@@ -802,6 +815,17 @@ static struct fi_ops_ep xnet_ep_ops = {
 	.tx_size_left = fi_no_tx_size_left,
 };
 
+static struct xnet_progress *xnet_select_progress(struct xnet_domain *domain)
+{
+	uint32_t worker;
+
+	if (!domain->worker_cnt)
+		return &domain->progress;
+
+	worker = (uint32_t) ofi_atomic_inc32(&domain->next_worker);
+	return &domain->workers[worker % domain->worker_cnt];
+}
+
 int xnet_endpoint(struct fid_domain *domain, struct fi_info *info,
 		  struct fid_ep **ep_fid, void *context)
 {
@@ -820,6 +844,8 @@ int xnet_endpoint(struct fid_domain *domain, struct fi_info *info,
 		goto err1;
 
 	assert(info->ep_attr->type == FI_EP_MSG);
+	ep->progress = xnet_select_progress(container_of(domain,
+				struct xnet_domain, util_domain.domain_fid));
 	ofi_bsock_init(&ep->bsock, &xnet_ep2_progress(ep)->sockapi,
 		       xnet_staging_sbuf_size, xnet_prefetch_rbuf_size,
 		       &ep->util_ep.ep_fid);
@@ -64,8 +64,11 @@ int xnet_prefetch_rbuf_size = 9000;
 size_t xnet_default_tx_size = 256;
 size_t xnet_default_rx_size = 256;
 size_t xnet_zerocopy_size = SIZE_MAX;
+int xnet_zerocopy_tune = 0;
 int xnet_trace_msg;
 int xnet_disable_autoprog;
+size_t xnet_progress_workers;
+char *xnet_progress_affinity;
 int xnet_io_uring;
 int xnet_max_saved = 64;
 size_t xnet_max_inject = XNET_DEF_INJECT;
@@ -174,6 +177,12 @@ static void xnet_init_env(void)
 	fi_param_get_int(&xnet_prov, "prefetch_rbuf_size",
 			 &xnet_prefetch_rbuf_size);
 	fi_param_get_size_t(&xnet_prov, "zerocopy_size", &xnet_zerocopy_size);
+	fi_param_define(&xnet_prov, "zerocopy_tune", FI_PARAM_BOOL,
+			"adjust the zero copy threshold at runtime, based on "
+			"the measured cost of zero copy and copied sends.  "
+			"The threshold never drops below zerocopy_size "
+			"(default: %d)", xnet_zerocopy_tune);
+	fi_param_get_bool(&xnet_prov, "zerocopy_tune", &xnet_zerocopy_tune);
 
 	fi_param_define(&xnet_prov, "trace_msg", FI_PARAM_BOOL,
 			"Capture and display transport message information "
@@ -183,6 +192,20 @@ static void xnet_init_env(void)
 			"prevent auto-progress thread from starting");
 	fi_param_get_bool(&xnet_prov, "disable_auto_progress",
 			&xnet_disable_autoprog);
+	fi_param_define(&xnet_prov, "progress_workers", FI_PARAM_SIZE_T,
+			"number of progress threads that the connections of "
+			"a domain exporting msg endpoints are partitioned "
+			"across, 0 to progress all connections of the domain "
+			"together (default: %zu)", xnet_progress_workers);
+	fi_param_get_size_t(&xnet_prov, "progress_workers",
+			    &xnet_progress_workers);
+	fi_param_define(&xnet_prov, "progress_affinity", FI_PARAM_STRING,
+			"bind the worker progress threads to the indicated "
+			"range(s) of processor ID(s).  Sets for each worker "
+			"are separated by ';' and reused round-robin.  "
+			"Usage: id_start[-id_end[:stride]][,][;]");
+	fi_param_get_str(&xnet_prov, "progress_affinity",
+			 &xnet_progress_affinity);
 	fi_param_define(&xnet_prov, "io_uring", FI_PARAM_BOOL,
 			"Enable io_uring support if available (default: %d)", xnet_io_uring);
 	fi_param_get_bool(&xnet_prov, "io_uring",
@@ -43,6 +43,7 @@
 #include <net/if.h>
 #include <ofi_util.h>
 #include <ofi_iov.h>
+#include <ofi_atomic.h>
 
 
 static int (*xnet_start_op[xnet_op_max])(struct xnet_ep *ep);
@@ -1009,6 +1010,221 @@ static int xnet_handle_read_rsp(struct xnet_ep *ep)
 	return xnet_recv_msg_data(ep);
 }
 
+/* The response carries the initial target data for fetch and compare
+ * operations.  It's allocated before the operation is applied, so that
+ * the target is unchanged if the request fails.
+ */
+static struct xnet_xfer_entry *
+xnet_alloc_atomic_rsp(struct xnet_ep *ep, size_t len)
+{
+	struct xnet_xfer_entry *resp;
+
+	resp = xnet_alloc_xfer(xnet_ep2_progress(ep));
+	if (!resp)
+		return NULL;
+
+	if (len <= xnet_buf_size) {
+		resp->user_buf = &resp->msg_data;
+	} else {
+		resp->user_buf = malloc(len);
+		if (!resp->user_buf) {
+			xnet_free_xfer(xnet_ep2_progress(ep), resp);
+			return NULL;
+		}
+		resp->ctrl_flags = XNET_FREE_BUF;
+	}
+
+	resp->hdr.base_hdr.version = XNET_HDR_VERSION;
+	resp->hdr.base_hdr.op = xnet_op_atomic_rsp;
+	resp->hdr.base_hdr.op_data = 0;
+	resp->hdr.base_hdr.rma_iov_cnt = 0;
+	resp->hdr.base_hdr.hdr_size = (uint8_t) sizeof(resp->hdr.base_hdr);
+	resp->hdr.base_hdr.size = sizeof(resp->hdr.base_hdr) + len;
+
+	resp->iov[0].iov_base = (void *) &resp->hdr;
+	resp->iov[0].iov_len = sizeof(resp->hdr.base_hdr);
+	resp->iov[1].iov_base = resp->user_buf;
+	resp->iov[1].iov_len = len;
+	resp->iov_cnt = 2;
+
+	resp->ctrl_flags |= XNET_INTERNAL_XFER;
+	if (ep->peer)
+		resp->src_addr = ep->peer->fi_addr;
+	return resp;
+}
+
+/* Atomics are applied from progress, with the progress lock held */
+static int xnet_do_atomic(struct xnet_ep *ep)
+{
+	struct xnet_xfer_entry *rx_entry, *resp = NULL;
+	struct xnet_atomic_hdr *hdr;
+	struct ofi_rma_ioc *rma_ioc;
+	uint8_t *src, *cmp, *res = NULL;
+	size_t dt_size, len, i;
+	void *dst;
+
+	rx_entry = ep->cur_rx.entry;
+	hdr = &rx_entry->hdr.atomic_hdr;
+	rma_ioc = (struct ofi_rma_ioc *) (hdr + 1);
+	dt_size = ofi_datatype_size(hdr->datatype);
+
+	for (i = 0, len = 0; i < hdr->base_hdr.rma_iov_cnt; i++)
+		len += rma_ioc[i].count * dt_size;
+
+	if (hdr->base_hdr.op_data != ofi_op_atomic) {
+		resp = xnet_alloc_atomic_rsp(ep, len);
+		if (!resp)
+			return -FI_ENOMEM;
+		res = resp->user_buf;
+	}
+
+	src = rx_entry->user_buf;
+	cmp = src + len;
+	for (i = 0; i < hdr->base_hdr.rma_iov_cnt; i++) {
+		dst = (void *) (uintptr_t) rma_ioc[i].addr;
+
+		switch (hdr->base_hdr.op_data) {
+		case ofi_op_atomic:
+			ofi_atomic_write_handler(hdr->op, hdr->datatype, dst,
+						 src, rma_ioc[i].count);
+			break;
+		case ofi_op_atomic_fetch:
+			ofi_atomic_readwrite_handler(hdr->op, hdr->datatype,
+						     dst, src, res,
+						     rma_ioc[i].count);
+			break;
+		default:
+			ofi_atomic_swap_handler(hdr->op, hdr->datatype, dst,
+						src, cmp, res,
+						rma_ioc[i].count);
+			break;
+		}
+
+		if (hdr->op != FI_ATOMIC_READ) {
+			src += rma_ioc[i].count * dt_size;
+			cmp += rma_ioc[i].count * dt_size;
+		}
+		if (res)
+			res += rma_ioc[i].count * dt_size;
+	}
+
+	if (resp)
+		xnet_tx_queue_insert(ep, resp);
+	return FI_SUCCESS;
+}
+
+static int xnet_recv_atomic(struct xnet_ep *ep)
+{
+	int ret;
+
+	ret = xnet_recv_msg_data(ep);
+	if (ret)
+		return ret;
+
+	return xnet_do_atomic(ep);
+}
+
+static int xnet_handle_atomic_req(struct xnet_ep *ep)
+{
+	struct xnet_xfer_entry *rx_entry;
+	struct xnet_atomic_hdr *hdr;
+	struct ofi_rma_ioc *rma_ioc;
+	size_t dt_size, data_len = 0;
+	uint64_t flags;
+	ssize_t i;
+	int ret;
+
+	assert(xnet_progress_locked(xnet_ep2_progress(ep)));
+	hdr = &ep->cur_rx.hdr.atomic_hdr;
+	switch (hdr->base_hdr.op_data) {
+	case ofi_op_atomic:
+		flags = 0;
+		break;
+	case ofi_op_atomic_fetch:
+		flags = FI_FETCH_ATOMIC;
+		break;
+	case ofi_op_atomic_compare:
+		flags = FI_COMPARE_ATOMIC;
+		break;
+	default:
+		return -FI_EINVAL;
+	}
+
+	if (!(ep->util_ep.flags & XNET_EP_ATOMIC) ||
+	    hdr->base_hdr.rma_iov_cnt > XNET_IOV_LIMIT ||
+	    hdr->op >= OFI_ATOMIC_OP_LAST || hdr->datatype >= OFI_DATATYPE_CNT ||
+	    ofi_atomic_valid(&xnet_prov, (enum fi_datatype) hdr->datatype,
+			     (enum fi_op) hdr->op, flags)) {
+		FI_WARN(&xnet_prov, FI_LOG_EP_DATA,
+			"invalid atomic request received\n");
+		return -FI_EINVAL;
+	}
+
+	rx_entry = xnet_alloc_xfer(xnet_ep2_progress(ep));
+	if (!rx_entry)
+		return -FI_ENOMEM;
+
+	memcpy(&rx_entry->hdr, &ep->cur_rx.hdr,
+	       (size_t) ep->cur_rx.hdr.base_hdr.hdr_size);
+	if (ep->peer)
+		rx_entry->src_addr = ep->peer->fi_addr;
+	/* Only the remote counters see the operation, not the rx cq */
+	rx_entry->cntr = hdr->base_hdr.op_data == ofi_op_atomic ?
+			 ep->util_ep.cntrs[CNTR_REM_WR] :
+			 ep->util_ep.cntrs[CNTR_REM_RD];
+	rx_entry->cq = xnet_ep_rx_cq(ep);
+
+	hdr = &rx_entry->hdr.atomic_hdr;
+	rma_ioc = (struct ofi_rma_ioc *) (hdr + 1);
+	dt_size = ofi_datatype_size(hdr->datatype);
+	for (i = 0; i < hdr->base_hdr.rma_iov_cnt; i++) {
+		ret = ofi_mr_verify(&ep->util_ep.domain->mr_map,
+				    rma_ioc[i].count * dt_size,
+				    (uintptr_t *) &rma_ioc[i].addr,
+				    rma_ioc[i].key,
+				    ofi_rx_mr_reg_flags(hdr->base_hdr.op_data,
+							(uint16_t) hdr->op));
+		if (ret) {
+			FI_WARN(&xnet_prov, FI_LOG_EP_DATA,
+			       "invalid rma ioc received\n");
+			goto free;
+		}
+		data_len += rma_ioc[i].count * dt_size;
+	}
+
+	if (hdr->op == FI_ATOMIC_READ)
+		data_len = 0;
+	else if (hdr->base_hdr.op_data == ofi_op_atomic_compare)
+		data_len *= 2;
+
+	if (ep->cur_rx.data_left != data_len) {
+		FI_WARN(&xnet_prov, FI_LOG_EP_DATA,
+			"atomic request size mismatch\n");
+		ret = -FI_EIO;
+		goto free;
+	}
+
+	/* The operands are staged, then applied once fully received */
+	if (data_len <= xnet_buf_size) {
+		rx_entry->user_buf = &rx_entry->msg_data;
+		rx_entry->iov[0].iov_base = rx_entry->user_buf;
+		rx_entry->iov[0].iov_len = data_len;
+		rx_entry->iov_cnt = 1;
+	} else {
+		ret = xnet_alloc_xfer_buf(rx_entry, data_len);
+		if (ret)
+			goto free;
+	}
+
+	ep->cur_rx.entry = rx_entry;
+	ep->cur_rx.handler = xnet_recv_atomic;
+	return xnet_recv_atomic(ep);
+
+free:
+	xnet_free_xfer(xnet_ep2_progress(ep), rx_entry);
+	return ret;
+}
+
 static int xnet_progress_hdr(struct xnet_ep *ep)
 {
 	if (ep->cur_rx.hdr_done == sizeof(ep->cur_rx.hdr.base_hdr)) {
@@ -1448,6 +1664,9 @@ static int (*xnet_start_op[xnet_op_max])(struct xnet_ep *ep) = {
 	[xnet_op_tag_rts] = xnet_handle_tag,
 	[xnet_op_cts] = xnet_handle_cts,
 	[xnet_op_data] = xnet_handle_data,
+	[xnet_op_atomic_req] = xnet_handle_atomic_req,
+	/* fetch responses share the ordered read response queue */
+	[xnet_op_atomic_rsp] = xnet_handle_read_rsp,
 };
 
 static void xnet_run_ep(struct xnet_ep *ep, bool pin, bool pout, bool perr)
@@ -1627,7 +1846,7 @@ int xnet_trywait(struct fid_fabric *fabric_fid, struct fid **fid, int count)
 			cq = container_of(fid[i], struct xnet_cq,
 					  util_cq.cq_fid.fid);
 			ofi_genlock_lock(xnet_cq2_progress(cq)->active_lock);
-			if (ofi_cirque_isempty(cq->util_cq.cirq))
+			if (ofi_cq_isempty(&cq->util_cq))
 				xnet_reset_wait(cq->util_cq.wait);
 			else
 				ret = -FI_EAGAIN;
@@ -1696,6 +1915,13 @@ static void *xnet_auto_progress(void *arg)
 	int nfds;
 
 	FI_INFO(&xnet_prov, FI_LOG_DOMAIN, "progress thread starting\n");
+	if (progress->affinity && ofi_set_thread_affinity(progress->affinity)) {
+		FI_WARN(&xnet_prov, FI_LOG_DOMAIN,
+			"unable to bind progress thread to cpus %s\n",
+			progress->affinity);
+	}
+	ofi_cq_set_thread_shard(progress->cq_shard);
+
 	ofi_genlock_lock(progress->active_lock);
 	while (progress->auto_progress) {
 		ofi_genlock_unlock(progress->active_lock);
@@ -1856,6 +2082,8 @@ int xnet_init_progress(struct xnet_progress *progress, struct fi_info *info)
 
 	progress->fid.fclass = XNET_CLASS_PROGRESS;
 	progress->auto_progress = false;
+	progress->affinity = NULL;
+	progress->cq_shard = 0;
 	dlist_init(&progress->unexp_msg_list);
 	dlist_init(&progress->unexp_tag_list);
 	dlist_init(&progress->saved_tag_list);
@@ -1948,4 +2176,5 @@ void xnet_close_progress(struct xnet_progress *progress)
 	ofi_genlock_destroy(&progress->ep_lock);
 	ofi_genlock_destroy(&progress->rdm_lock);
 	fd_signal_free(&progress->signal);
+	free(progress->affinity);
 }
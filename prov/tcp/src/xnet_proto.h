@@ -57,15 +57,19 @@ enum {
 	xnet_op_tag_rts,
 	xnet_op_cts,
 	xnet_op_data,
+	xnet_op_atomic_req,
+	xnet_op_atomic_rsp,
 	xnet_op_max
 };
 
 /* Version 1 adds support for tagged rendezvous transfers.
  * ops: tag_rts, cts, data
+ * Version 2 adds support for atomic operations.
+ * ops: atomic_req, atomic_rsp
  * VERSION_FLAG set in a response indicates the peer checks the version
  */
 #define XNET_RDM_VERSION_FLAG	(1 << 7)
-#define XNET_RDM_VERSION	1
+#define XNET_RDM_VERSION	2
 
 #define XNET_CTRL_HDR_VERSION	3
 
@@ -146,9 +150,22 @@ struct xnet_tag_rts_data_hdr {
 	uint64_t		size;
 };
 
-/* Maximum header is scatter RMA with CQ data */
-#define XNET_MAX_HDR (sizeof(struct xnet_cq_data_hdr) + \
-		     sizeof(struct ofi_rma_iov) * XNET_IOV_LIMIT)
+/* RDM protocol version 2
+ * base_hdr::op_data carries the ofi_op_atomic* type.  The header is
+ * followed by rma_iov_cnt struct ofi_rma_ioc entries.  The request data
+ * is the operand buffer followed, for compare operations, by the compare
+ * buffer.  Fetch and compare requests are answered by an atomic_rsp
+ * carrying the initial target data.
+ */
+struct xnet_atomic_hdr {
+	struct xnet_base_hdr	base_hdr;
+	uint64_t		op;
+	uint64_t		datatype;
+};
+
+/* Maximum header is scatter atomic, which exceeds scatter RMA with CQ data */
+#define XNET_MAX_HDR (sizeof(struct xnet_atomic_hdr) + \
+		     sizeof(struct ofi_rma_ioc) * XNET_IOV_LIMIT)
 
 
 #endif //_XNET_PROTO_H_
@@ -34,6 +34,7 @@
 #include <errno.h>
 
 #include <ofi_prov.h>
+#include <ofi_iov.h>
 #include "xnet.h"
 
 
@@ -64,6 +65,9 @@ xnet_rdm_recvmsg(struct fid_ep *ep_fid, const struct fi_msg *msg,
 	struct xnet_rdm *rdm;
 
 	rdm = container_of(ep_fid, struct xnet_rdm, util_ep.ep_fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_msg(&rdm->util_ep, FI_OP_RECV, msg, flags);
+
 	return fi_recvmsg(&rdm->srx->rx_fid, msg, flags);
 }
 
@@ -116,6 +120,9 @@ xnet_rdm_sendmsg(struct fid_ep *ep_fid, const struct fi_msg *msg,
 	ssize_t ret;
 
 	rdm = container_of(ep_fid, struct xnet_rdm, util_ep.ep_fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_msg(&rdm->util_ep, FI_OP_SEND, msg, flags);
+
 	ofi_genlock_lock(&xnet_rdm2_progress(rdm)->rdm_lock);
 	ret = xnet_get_conn(rdm, msg->addr, &conn);
 	if (ret)
@@ -232,6 +239,10 @@ xnet_rdm_trecvmsg(struct fid_ep *ep_fid, const struct fi_msg_tagged *msg,
 	struct xnet_rdm *rdm;
 
 	rdm = container_of(ep_fid, struct xnet_rdm, util_ep.ep_fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_tagged(&rdm->util_ep,
+				FI_OP_TRECV, msg, flags);
+
 	return fi_trecvmsg(&rdm->srx->rx_fid, msg, flags);
 }
 
@@ -287,6 +298,10 @@ xnet_rdm_tsendmsg(struct fid_ep *ep_fid, const struct fi_msg_tagged *msg,
 	ssize_t ret;
 
 	rdm = container_of(ep_fid, struct xnet_rdm, util_ep.ep_fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_tagged(&rdm->util_ep,
+				FI_OP_TSEND, msg, flags);
+
 	ofi_genlock_lock(&xnet_rdm2_progress(rdm)->rdm_lock);
 	ret = xnet_get_conn(rdm, msg->addr, &conn);
 	if (ret)
@@ -426,6 +441,9 @@ xnet_rdm_readmsg(struct fid_ep *ep_fid, const struct fi_msg_rma *msg,
 	ssize_t ret;
 
 	rdm = container_of(ep_fid, struct xnet_rdm, util_ep.ep_fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_rma(&rdm->util_ep, FI_OP_READ, msg, flags);
+
 	ofi_genlock_lock(&xnet_rdm2_progress(rdm)->rdm_lock);
 	ret = xnet_get_conn(rdm, msg->addr, &conn);
 	if (ret)
@@ -490,6 +508,9 @@ xnet_rdm_writemsg(struct fid_ep *ep_fid, const struct fi_msg_rma *msg,
 	ssize_t ret;
 
 	rdm = container_of(ep_fid, struct xnet_rdm, util_ep.ep_fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_rma(&rdm->util_ep, FI_OP_WRITE, msg, flags);
+
 	ofi_genlock_lock(&xnet_rdm2_progress(rdm)->rdm_lock);
 	ret = xnet_get_conn(rdm, msg->addr, &conn);
 	if (ret)
@@ -581,21 +602,332 @@ static struct fi_ops_rma xnet_rdm_rma_ops = {
 	.injectdata = xnet_rdm_inject_writedata,
 };
 
+static ssize_t
+xnet_rdm_atomic_generic(struct xnet_rdm *rdm, const struct fi_msg_atomic *msg,
+			const struct fi_ioc *comparev, size_t compare_count,
+			struct fi_ioc *resultv, size_t result_count,
+			uint8_t op, uint64_t flags)
+{
+	struct xnet_conn *conn;
+	ssize_t ret;
+
+	ofi_genlock_lock(&xnet_rdm2_progress(rdm)->rdm_lock);
+	ret = xnet_get_conn(rdm, msg->addr, &conn);
+	if (ret)
+		goto unlock;
+
+	if (!(conn->ep->util_ep.flags & XNET_EP_ATOMIC)) {
+		FI_WARN(&xnet_prov, FI_LOG_EP_DATA,
+			"peer %s does not support atomic operations\n",
+			util_peer_straddr(conn->peer));
+		ret = -FI_EOPNOTSUPP;
+		goto unlock;
+	}
+
+	ret = xnet_atomic_msg(conn->ep, msg, comparev, compare_count,
+			      resultv, result_count, op, flags);
+unlock:
+	ofi_genlock_unlock(&xnet_rdm2_progress(rdm)->rdm_lock);
+	return ret;
+}
+
+static ssize_t
+xnet_rdm_atomic_writemsg(struct fid_ep *ep_fid, const struct fi_msg_atomic *msg,
+			 uint64_t flags)
+{
+	struct xnet_rdm *rdm;
+
+	rdm = container_of(ep_fid, struct xnet_rdm, util_ep.ep_fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_atomic(&rdm->util_ep, msg, flags);
+
+	return xnet_rdm_atomic_generic(rdm, msg, NULL, 0, NULL, 0,
+				       ofi_op_atomic,
+				       flags | rdm->util_ep.tx_msg_flags);
+}
+
+static ssize_t
+xnet_rdm_atomic_writev(struct fid_ep *ep_fid, const struct fi_ioc *iov,
+		       void **desc, size_t count, fi_addr_t dest_addr,
+		       uint64_t addr, uint64_t key, enum fi_datatype datatype,
+		       enum fi_op op, void *context)
+{
+	struct xnet_rdm *rdm;
+	struct fi_rma_ioc rma_iov = {
+		.addr = addr,
+		.count = ofi_total_ioc_cnt(iov, count),
+		.key = key,
+	};
+	struct fi_msg_atomic msg = {
+		.msg_iov = iov,
+		.desc = desc,
+		.iov_count = count,
+		.addr = dest_addr,
+		.rma_iov = &rma_iov,
+		.rma_iov_count = 1,
+		.datatype = datatype,
+		.op = op,
+		.context = context,
+	};
+
+	rdm = container_of(ep_fid, struct xnet_rdm, util_ep.ep_fid);
+	return xnet_rdm_atomic_generic(rdm, &msg, NULL, 0, NULL, 0,
+				       ofi_op_atomic, rdm->util_ep.tx_op_flags);
+}
+
+static ssize_t
+xnet_rdm_atomic_write(struct fid_ep *ep_fid, const void *buf, size_t count,
+		      void *desc, fi_addr_t dest_addr, uint64_t addr,
+		      uint64_t key, enum fi_datatype datatype, enum fi_op op,
+		      void *context)
+{
+	struct fi_ioc iov = {
+		.addr = (void *) buf,
+		.count = count,
+	};
+
+	return xnet_rdm_atomic_writev(ep_fid, &iov, &desc, 1, dest_addr, addr,
+				      key, datatype, op, context);
+}
+
+static ssize_t
+xnet_rdm_atomic_inject(struct fid_ep *ep_fid, const void *buf, size_t count,
+		       fi_addr_t dest_addr, uint64_t addr, uint64_t key,
+		       enum fi_datatype datatype, enum fi_op op)
+{
+	struct xnet_rdm *rdm;
+	struct fi_ioc iov = {
+		.addr = (void *) buf,
+		.count = count,
+	};
+	struct fi_rma_ioc rma_iov = {
+		.addr = addr,
+		.count = count,
+		.key = key,
+	};
+	struct fi_msg_atomic msg = {
+		.msg_iov = &iov,
+		.iov_count = 1,
+		.addr = dest_addr,
+		.rma_iov = &rma_iov,
+		.rma_iov_count = 1,
+		.datatype = datatype,
+		.op = op,
+	};
+
+	rdm = container_of(ep_fid, struct xnet_rdm, util_ep.ep_fid);
+	return xnet_rdm_atomic_generic(rdm, &msg, NULL, 0, NULL, 0,
+				       ofi_op_atomic, FI_INJECT);
+}
+
+static ssize_t
+xnet_rdm_atomic_readwritemsg(struct fid_ep *ep_fid,
+			     const struct fi_msg_atomic *msg,
+			     struct fi_ioc *resultv, void **result_desc,
+			     size_t result_count, uint64_t flags)
+{
+	struct xnet_rdm *rdm;
+
+	rdm = container_of(ep_fid, struct xnet_rdm, util_ep.ep_fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_fetch_atomic(&rdm->util_ep, msg, resultv,
+				result_desc, result_count, flags);
+
+	return xnet_rdm_atomic_generic(rdm, msg, NULL, 0, resultv,
+				       result_count, ofi_op_atomic_fetch,
+				       flags | rdm->util_ep.tx_msg_flags);
+}
+
+static ssize_t
+xnet_rdm_atomic_readwritev(struct fid_ep *ep_fid, const struct fi_ioc *iov,
+			   void **desc, size_t count, struct fi_ioc *resultv,
+			   void **result_desc, size_t result_count,
+			   fi_addr_t dest_addr, uint64_t addr, uint64_t key,
+			   enum fi_datatype datatype, enum fi_op op,
+			   void *context)
+{
+	struct xnet_rdm *rdm;
+	struct fi_rma_ioc rma_iov = {
+		.addr = addr,
+		.count = ofi_total_ioc_cnt(resultv, result_count),
+		.key = key,
+	};
+	struct fi_msg_atomic msg = {
+		.msg_iov = iov,
+		.desc = desc,
+		.iov_count = count,
+		.addr = dest_addr,
+		.rma_iov = &rma_iov,
+		.rma_iov_count = 1,
+		.datatype = datatype,
+		.op = op,
+		.context = context,
+	};
+
+	rdm = container_of(ep_fid, struct xnet_rdm, util_ep.ep_fid);
+	return xnet_rdm_atomic_generic(rdm, &msg, NULL, 0, resultv,
+				       result_count, ofi_op_atomic_fetch,
+				       rdm->util_ep.tx_op_flags);
+}
+
+static ssize_t
+xnet_rdm_atomic_readwrite(struct fid_ep *ep_fid, const void *buf, size_t count,
+			  void *desc, void *result, void *result_desc,
+			  fi_addr_t dest_addr, uint64_t addr, uint64_t key,
+			  enum fi_datatype datatype, enum fi_op op,
+			  void *context)
+{
+	struct fi_ioc iov = {
+		.addr = (void *) buf,
+		.count = count,
+	};
+	struct fi_ioc resultv = {
+		.addr = result,
+		.count = count,
+	};
+
+	return xnet_rdm_atomic_readwritev(ep_fid, &iov, &desc, 1, &resultv,
+					  &result_desc, 1, dest_addr, addr,
+					  key, datatype, op, context);
+}
+
+static ssize_t
+xnet_rdm_atomic_compwritemsg(struct fid_ep *ep_fid,
+			     const struct fi_msg_atomic *msg,
+			     const struct fi_ioc *comparev,
+			     void **compare_desc, size_t compare_count,
+			     struct fi_ioc *resultv, void **result_desc,
+			     size_t result_count, uint64_t flags)
+{
+	struct xnet_rdm *rdm;
+
+	rdm = container_of(ep_fid, struct xnet_rdm, util_ep.ep_fid);
+	if (flags & FI_TRIGGER)
+		return ofi_trigger_compare_atomic(&rdm->util_ep, msg, comparev,
+				compare_desc, compare_count, resultv,
+				result_desc, result_count, flags);
+
+	return xnet_rdm_atomic_generic(rdm, msg, comparev, compare_count,
+				       resultv, result_count,
+				       ofi_op_atomic_compare,
+				       flags | rdm->util_ep.tx_msg_flags);
+}
+
+static ssize_t
+xnet_rdm_atomic_compwritev(struct fid_ep *ep_fid, const struct fi_ioc *iov,
+			   void **desc, size_t count,
+			   const struct fi_ioc *comparev, void **compare_desc,
+			   size_t compare_count, struct fi_ioc *resultv,
+			   void **result_desc, size_t result_count,
+			   fi_addr_t dest_addr, uint64_t addr, uint64_t key,
+			   enum fi_datatype datatype, enum fi_op op,
+			   void *context)
+{
+	struct xnet_rdm *rdm;
+	struct fi_rma_ioc rma_iov = {
+		.addr = addr,
+		.count = ofi_total_ioc_cnt(iov, count),
+		.key = key,
+	};
+	struct fi_msg_atomic msg = {
+		.msg_iov = iov,
+		.desc = desc,
+		.iov_count = count,
+		.addr = dest_addr,
+		.rma_iov = &rma_iov,
+		.rma_iov_count = 1,
+		.datatype = datatype,
+		.op = op,
+		.context = context,
+	};
+
+	rdm = container_of(ep_fid, struct xnet_rdm, util_ep.ep_fid);
+	return xnet_rdm_atomic_generic(rdm, &msg, comparev, compare_count,
+				       resultv, result_count,
+				       ofi_op_atomic_compare,
+				       rdm->util_ep.tx_op_flags);
+}
+
+static ssize_t
+xnet_rdm_atomic_compwrite(struct fid_ep *ep_fid, const void *buf, size_t count,
+			  void *desc, const void *compare, void *compare_desc,
+			  void *result, void *result_desc, fi_addr_t dest_addr,
+			  uint64_t addr, uint64_t key, enum fi_datatype datatype,
+			  enum fi_op op, void *context)
+{
+	struct fi_ioc iov = {
+		.addr = (void *) buf,
+		.count = count,
+	};
+	struct fi_ioc comparev = {
+		.addr = (void *) compare,
+		.count = count,
+	};
+	struct fi_ioc resultv = {
+		.addr = result,
+		.count = count,
+	};
+
+	return xnet_rdm_atomic_compwritev(ep_fid, &iov, &desc, 1, &comparev,
+					  &compare_desc, 1, &resultv,
+					  &result_desc, 1, dest_addr, addr,
+					  key, datatype, op, context);
+}
+
+static int
+xnet_rdm_atomic_valid_common(struct fid_ep *ep_fid, enum fi_datatype datatype,
+			     enum fi_op op, size_t *count, uint64_t flags)
+{
+	struct xnet_rdm *rdm;
+	struct fi_atomic_attr attr;
+	int ret;
+
+	rdm = container_of(ep_fid, struct xnet_rdm, util_ep.ep_fid);
+	ret = fi_query_atomic(&rdm->util_ep.domain->domain_fid, datatype, op,
+			      &attr, flags);
+	if (!ret)
+		*count = attr.count;
+	return ret;
+}
+
+static int
+xnet_rdm_atomic_valid(struct fid_ep *ep_fid, enum fi_datatype datatype,
+		      enum fi_op op, size_t *count)
+{
+	return xnet_rdm_atomic_valid_common(ep_fid, datatype, op, count, 0);
+}
+
+static int
+xnet_rdm_atomic_fetch_valid(struct fid_ep *ep_fid, enum fi_datatype datatype,
+			    enum fi_op op, size_t *count)
+{
+	return xnet_rdm_atomic_valid_common(ep_fid, datatype, op, count,
+					    FI_FETCH_ATOMIC);
+}
+
+static int
+xnet_rdm_atomic_comp_valid(struct fid_ep *ep_fid, enum fi_datatype datatype,
+			   enum fi_op op, size_t *count)
+{
+	return xnet_rdm_atomic_valid_common(ep_fid, datatype, op, count,
+					    FI_COMPARE_ATOMIC);
+}
+
 static struct fi_ops_atomic xnet_rdm_atomic_ops = {
 	.size = sizeof(struct fi_ops_atomic),
-	.write = fi_no_atomic_write,
-	.writev = fi_no_atomic_writev,
-	.writemsg = fi_no_atomic_writemsg,
-	.inject = fi_no_atomic_inject,
-	.readwrite = fi_no_atomic_readwrite,
-	.readwritev = fi_no_atomic_readwritev,
-	.readwritemsg = fi_no_atomic_readwritemsg,
-	.compwrite = fi_no_atomic_compwrite,
-	.compwritev = fi_no_atomic_compwritev,
-	.compwritemsg = fi_no_atomic_compwritemsg,
-	.writevalid = fi_no_atomic_writevalid,
-	.readwritevalid = fi_no_atomic_readwritevalid,
-	.compwritevalid = fi_no_atomic_compwritevalid,
+	.write = xnet_rdm_atomic_write,
+	.writev = xnet_rdm_atomic_writev,
+	.writemsg = xnet_rdm_atomic_writemsg,
+	.inject = xnet_rdm_atomic_inject,
+	.readwrite = xnet_rdm_atomic_readwrite,
+	.readwritev = xnet_rdm_atomic_readwritev,
+	.readwritemsg = xnet_rdm_atomic_readwritemsg,
+	.compwrite = xnet_rdm_atomic_compwrite,
+	.compwritev = xnet_rdm_atomic_compwritev,
+	.compwritemsg = xnet_rdm_atomic_compwritemsg,
+	.writevalid = xnet_rdm_atomic_valid,
+	.readwritevalid = xnet_rdm_atomic_fetch_valid,
+	.compwritevalid = xnet_rdm_atomic_comp_valid,
 };
 
 static int xnet_rdm_setname(fid_t fid, void *addr, size_t addrlen)
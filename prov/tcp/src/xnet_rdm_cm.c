@@ -373,7 +373,7 @@ ssize_t xnet_get_conn(struct xnet_rdm *rdm, fi_addr_t addr,
 		if ((*peer)->firewall_addr) {
 			FI_WARN(&xnet_prov, FI_LOG_EP_CTRL,
 				"warn: peer %s is behind firewall\n",
-				(*peer)->str_addr);
+				util_peer_straddr(*peer));
 
 			return -FI_EFIREWALLADDR;
 		}
@@ -420,6 +420,12 @@ static void xnet_set_protocol(struct xnet_ep *ep, struct xnet_rdm_cm *msg)
 		return;
 
 	switch (msg->version & ~XNET_RDM_VERSION_FLAG) {
+	case 2:
+		/* Atomic operands are applied as sent, not byte swapped */
+		if (ep->hdr_bswap == xnet_hdr_none ||
+		    ep->hdr_bswap == xnet_hdr_trace)
+			ep->util_ep.flags |= XNET_EP_ATOMIC;
+		/* fall through */
 	case 1:
 		ep->util_ep.flags |= XNET_EP_RENDEZVOUS;
 		/* fall through */
@@ -538,7 +544,8 @@ accept:
 	if ((msg->features & ~XNET_RDM_FEATURES) != 0) {
 		FI_WARN(&xnet_prov, FI_LOG_EP_CTRL,
 			"peer: %s requested unsupported features: %x\n",
-			peer->str_addr, msg->features & ~XNET_RDM_FEATURES);
+			util_peer_straddr(peer),
+			msg->features & ~XNET_RDM_FEATURES);
 	}
 	msg->features &= XNET_RDM_FEATURES;
 
@@ -576,7 +583,7 @@ static void xnet_process_connected(struct fi_eq_cm_entry *cm_entry)
 	xnet_set_protocol(conn->ep, msg);
 
 	FI_INFO(&xnet_prov, FI_LOG_EP_CTRL, "peer %s feature supported: %x\n",
-		conn->peer->str_addr, msg->features);
+		util_peer_straddr(conn->peer), msg->features);
 }
 
 void xnet_handle_event_list(struct xnet_progress *progress)
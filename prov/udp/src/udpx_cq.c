@@ -53,7 +53,7 @@ static struct fi_ops udpx_cq_fi_ops = {
 	.close = udpx_cq_close,
 	.bind = fi_no_bind,
 	.control = ofi_cq_control,
-	.ops_open = fi_no_ops_open,
+	.ops_open = ofi_cq_ops_open,
 };
 
 int udpx_cq_open(struct fid_domain *domain, struct fi_cq_attr *attr,
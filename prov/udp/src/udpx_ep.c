@@ -231,7 +231,7 @@ static void udpx_tx_comp(struct udpx_ep *ep, void *context)
 static void udpx_tx_comp_signal(struct udpx_ep *ep, void *context)
 {
 	udpx_tx_comp(ep, context);
-	ep->util_ep.tx_cq->wait->signal(ep->util_ep.tx_cq->wait);
+	util_cq_signal(ep->util_ep.tx_cq);
 }
 
 static void udpx_rx_comp(struct udpx_ep *ep, void *context, uint64_t flags,
@@ -260,14 +260,14 @@ static void udpx_rx_comp_signal(struct udpx_ep *ep, void *context,
 			uint64_t flags, size_t len, void *buf, void *addr)
 {
 	udpx_rx_comp(ep, context, flags, len, buf, addr);
-	ep->util_ep.rx_cq->wait->signal(ep->util_ep.rx_cq->wait);
+	util_cq_signal(ep->util_ep.rx_cq);
 }
 
 static void udpx_rx_src_comp_signal(struct udpx_ep *ep, void *context,
 			uint64_t flags, size_t len, void *buf, void *addr)
 {
 	udpx_rx_src_comp(ep, context, flags, len, buf, addr);
-	ep->util_ep.rx_cq->wait->signal(ep->util_ep.rx_cq->wait);
+	util_cq_signal(ep->util_ep.rx_cq);
 }
 
 static void udpx_ep_progress(struct util_ep *util_ep)
@@ -82,10 +82,8 @@ static struct util_peer_addr *rxm_alloc_peer(struct rxm_av *av,
 	peer->refcnt = 1;
 	memcpy(&peer->addr, addr, av->util_av.addrlen);
 	peer->firewall_addr = false;
-
-	size_t len = sizeof(peer->str_addr);
-	(void) av->util_av.av_fid.ops->straddr(&av->util_av.av_fid, addr,
-					       peer->str_addr, &len);
+	/* Formatted on first use by util_peer_straddr() */
+	peer->str_addr[0] = '\0';
 
 	if (ofi_rbmap_insert(&av->addr_map, &peer->addr, peer, &peer->node)) {
 		ofi_ibuf_free(peer);
@@ -103,13 +101,13 @@ static void rxm_free_peer(struct util_peer_addr *peer)
 	ofi_ibuf_free(peer);
 }
 
-struct util_peer_addr *util_get_peer(struct rxm_av *av, const void *addr,
-				     uint64_t flags)
+static struct util_peer_addr *
+rxm_get_peer(struct rxm_av *av, const void *addr, uint64_t flags)
 {
 	struct util_peer_addr *peer;
 	struct ofi_rbnode *node;
 
-	ofi_genlock_lock(&av->util_av.lock);
+	assert(ofi_genlock_held(&av->util_av.lock));
 	node = ofi_rbmap_find(&av->addr_map, (void *) addr);
 	if (node) {
 		peer = node->data;
@@ -121,10 +119,36 @@ struct util_peer_addr *util_get_peer(struct rxm_av *av, const void *addr,
 	if (peer)
 		peer->firewall_addr |= !!(flags & FI_FIREWALL_ADDR);
 
+	return peer;
+}
+
+struct util_peer_addr *util_get_peer(struct rxm_av *av, const void *addr,
+				     uint64_t flags)
+{
+	struct util_peer_addr *peer;
+
+	ofi_genlock_lock(&av->util_av.lock);
+	peer = rxm_get_peer(av, addr, flags);
 	ofi_genlock_unlock(&av->util_av.lock);
 	return peer;
 }
 
+const char *util_peer_straddr(struct util_peer_addr *peer)
+{
+	struct rxm_av *av = peer->av;
+	size_t len;
+
+	ofi_genlock_lock(&av->util_av.lock);
+	if (!peer->str_addr[0]) {
+		len = sizeof(peer->str_addr);
+		(void) av->util_av.av_fid.ops->straddr(&av->util_av.av_fid,
+						       &peer->addr,
+						       peer->str_addr, &len);
+	}
+	ofi_genlock_unlock(&av->util_av.lock);
+	return peer->str_addr;
+}
+
 static void util_deref_peer(struct util_peer_addr *peer)
 {
 	assert(ofi_genlock_held(&peer->av->util_av.lock));
@@ -178,14 +202,16 @@ static int rxm_av_add_peers(struct rxm_av *av, const void *addr, size_t count,
 	fi_addr_t cur_fi_addr;
 	size_t i;
 
+	/* Peers are added under a single acquisition of the AV lock */
+	ofi_genlock_lock(&av->util_av.lock);
 	for (i = 0; i < count; i++) {
 		cur_addr = ((char *) addr + i * av->util_av.addrlen);
-		peer = util_get_peer(av, cur_addr, flags);
+		peer = rxm_get_peer(av, cur_addr, flags);
 		if (!peer)
 			goto err;
 
 		cur_fi_addr = (fi_addr) ? fi_addr[i] :
-			ofi_av_lookup_fi_addr(&av->util_av, cur_addr);
+			ofi_av_lookup_fi_addr_unsafe(&av->util_av, cur_addr);
 
 		if (user_ids)
 			peer->fi_addr = user_ids[i];
@@ -196,6 +222,7 @@ static int rxm_av_add_peers(struct rxm_av *av, const void *addr, size_t count,
 		if (peer->fi_addr != FI_ADDR_NOTAVAIL)
 			rxm_set_av_context(av, cur_fi_addr, peer);
 	}
+	ofi_genlock_unlock(&av->util_av.lock);
 	return 0;
 
 err:
@@ -204,15 +231,13 @@ err:
 			cur_fi_addr = fi_addr[i];
 		} else {
 			cur_addr = ((char *) addr + i * av->util_av.addrlen);
-			cur_fi_addr =
-				ofi_av_lookup_fi_addr(&av->util_av, cur_addr);
+			cur_fi_addr = ofi_av_lookup_fi_addr_unsafe(&av->util_av,
+								   cur_addr);
 		}
-		if (cur_fi_addr != FI_ADDR_NOTAVAIL) {
-			ofi_genlock_lock(&av->util_av.lock);
+		if (cur_fi_addr != FI_ADDR_NOTAVAIL)
 			rxm_put_peer_addr(av, cur_fi_addr);
-			ofi_genlock_unlock(&av->util_av.lock);
-		}
 	}
+	ofi_genlock_unlock(&av->util_av.lock);
 	return -FI_ENOMEM;
 }
 
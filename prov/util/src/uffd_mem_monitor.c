@@ -86,6 +86,23 @@ static void ofi_uffd_unsubscribe(struct ofi_mem_monitor *monitor,
 				 const void *addr, size_t len,
 				 union ofi_mr_hmem_info *hmem_info);
 
+static void ofi_uffd_handler_unlock(bool queued)
+{
+	if (queued)
+		ofi_atomic_dec32(&uffd.monitor.pending);
+	else
+		pthread_mutex_unlock(&mm_lock);
+	pthread_rwlock_unlock(&mm_list_rwlock);
+}
+
+static void ofi_uffd_notify(bool queued, const void *addr, size_t len)
+{
+	if (queued)
+		ofi_monitor_queue_notify(&uffd.monitor, addr, len);
+	else
+		ofi_monitor_notify(&uffd.monitor, addr, len);
+}
+
 /* The userfault fd monitor requires for events that could
  * trigger it to be handled outside of the monitor functions
  * itself. When a fault occurs on a monitored region, the
@@ -99,6 +116,7 @@ static void *ofi_uffd_handler(void *arg)
 {
 	struct uffd_msg msg;
 	struct pollfd fds[2];
+	bool queued = cache_params.notify_queue_size > 0;
 	int ret;
 
 	fds[0].fd     = uffd.fd;
@@ -111,12 +129,19 @@ static void *ofi_uffd_handler(void *arg)
 		if (ret < 0 || fds[1].revents)
 			break;
 
+		/* When invalidations are queued, the pending count makes
+		 * searches wait until the event is queued, instead of
+		 * serializing with mm_lock.  The thread that changed the
+		 * mapping resumes as soon as the event has been read.
+		 */
 		pthread_rwlock_rdlock(&mm_list_rwlock);
-		pthread_mutex_lock(&mm_lock);
+		if (queued)
+			ofi_atomic_inc32(&uffd.monitor.pending);
+		else
+			pthread_mutex_lock(&mm_lock);
 		ret = read(uffd.fd, &msg, sizeof(msg));
 		if (ret != sizeof(msg)) {
-			pthread_mutex_unlock(&mm_lock);
-			pthread_rwlock_unlock(&mm_list_rwlock);
+			ofi_uffd_handler_unlock(queued);
 			if (errno != EAGAIN)
 				break;
 			continue;
@@ -132,13 +157,13 @@ static void *ofi_uffd_handler(void *arg)
 					  msg.arg.remove.start), NULL);
 			/* fall through */
 		case UFFD_EVENT_UNMAP:
-			ofi_monitor_notify(&uffd.monitor,
+			ofi_uffd_notify(queued,
 				(void *) (uintptr_t) msg.arg.remove.start,
 				(size_t) (msg.arg.remove.end -
 					  msg.arg.remove.start));
 			break;
 		case UFFD_EVENT_REMAP:
-			ofi_monitor_notify(&uffd.monitor,
+			ofi_uffd_notify(queued,
 				(void *) (uintptr_t) msg.arg.remap.from,
 				(size_t) msg.arg.remap.len);
 			break;
@@ -150,8 +175,7 @@ static void *ofi_uffd_handler(void *arg)
 				"Unhandled uffd event %d\n", msg.event);
 			break;
 		}
-		pthread_mutex_unlock(&mm_lock);
-		pthread_rwlock_unlock(&mm_list_rwlock);
+		ofi_uffd_handler_unlock(queued);
 	}
 	return NULL;
 }
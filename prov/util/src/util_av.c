@@ -55,6 +55,13 @@ enum {
 	UTIL_NO_ENTRY = -1,
 };
 
+enum {
+	/* Addresses hashed outside of the AV lock per lock acquisition */
+	UTIL_AV_INSERT_BATCH = 256,
+	/* Average bucket chain length targeted when presizing the hash */
+	UTIL_AV_HASH_BKT_LOAD = 4,
+};
+
 static int fi_get_src_sockaddr(const struct sockaddr *dest_addr, size_t dest_addrlen,
 			       struct sockaddr **src_addr, size_t *src_addrlen)
 {
@@ -300,13 +307,14 @@ int ofi_av_insert_addr_at(struct util_av *av, const void *addr, fi_addr_t fi_add
 	return 0;
 }
 
-int ofi_av_insert_addr(struct util_av *av, const void *addr, fi_addr_t *fi_addr)
+static int util_av_insert_addr_hashv(struct util_av *av, const void *addr,
+				     unsigned hashv, fi_addr_t *fi_addr)
 {
 	struct util_av_entry *entry = NULL;
 
 	assert(ofi_genlock_held(&av->lock));
 	ofi_av_straddr_log(av, FI_LOG_INFO, "inserting addr", addr);
-	HASH_FIND(hh, av->hash, addr, av->addrlen, entry);
+	HASH_FIND_BYHASHVALUE(hh, av->hash, addr, av->addrlen, hashv, entry);
 	if (entry) {
 		if (fi_addr)
 			*fi_addr = ofi_buf_index(entry);
@@ -325,13 +333,52 @@ int ofi_av_insert_addr(struct util_av *av, const void *addr, fi_addr_t *fi_addr)
 			*fi_addr = ofi_buf_index(entry);
 		memcpy(entry->data, addr, av->addrlen);
 		ofi_atomic_initialize32(&entry->use_cnt, 1);
-		HASH_ADD(hh, av->hash, data, av->addrlen, entry);
+		HASH_ADD_BYHASHVALUE(hh, av->hash, data, av->addrlen, hashv,
+				     entry);
 		FI_INFO(av->prov, FI_LOG_AV, "fi_addr: %" PRIu64 "\n",
 			ofi_buf_index(entry));
 	}
 	return 0;
 }
 
+int ofi_av_insert_addr(struct util_av *av, const void *addr, fi_addr_t *fi_addr)
+{
+	unsigned hashv;
+
+	HASH_VALUE(addr, av->addrlen, hashv);
+	return util_av_insert_addr_hashv(av, addr, hashv, fi_addr);
+}
+
+/*
+ * Size the entry pool and hash table for 'count' additional addresses,
+ * so that large inserts don't repeatedly grow the pool and rehash the
+ * table one chunk at a time.  Failures are not fatal here; they will
+ * be reported by the individual insertions.
+ */
+static void util_av_reserve(struct util_av *av, size_t count)
+{
+	UT_hash_table *tbl;
+	size_t total;
+	int oomed = 0;
+
+	assert(ofi_genlock_held(&av->lock));
+	total = HASH_COUNT(av->hash) + count;
+	while (av->av_entry_pool->entry_cnt < total) {
+		if (ofi_bufpool_grow(av->av_entry_pool))
+			break;
+	}
+
+	/* The hash table is created by the first insertion */
+	if (!av->hash)
+		return;
+
+	tbl = av->hash->hh.tbl;
+	while (!tbl->noexpand &&
+	       tbl->num_buckets * UTIL_AV_HASH_BKT_LOAD < total)
+		HASH_EXPAND_BUCKETS(hh, tbl, oomed);
+	OFI_UNUSED(oomed);
+}
+
 int ofi_av_remove_addr(struct util_av *av, fi_addr_t fi_addr)
 {
 	struct util_av_entry *av_entry;
@@ -587,14 +634,13 @@ fi_addr_t ofi_ip_av_get_fi_addr(struct util_av *av, const void *addr)
 }
 
 static int ip_av_insert_addr(struct util_av *av, const void *addr,
-			     fi_addr_t *fi_addr, void *context)
+			     unsigned hashv, fi_addr_t *fi_addr)
 {
 	int ret;
 
+	assert(ofi_genlock_held(&av->lock));
 	if (ofi_valid_dest_ipaddr(addr)) {
-		ofi_genlock_lock(&av->lock);
-		ret = ofi_av_insert_addr(av, addr, fi_addr);
-		ofi_genlock_unlock(&av->lock);
+		ret = util_av_insert_addr_hashv(av, addr, hashv, fi_addr);
 	} else {
 		ret = -FI_EADDRNOTAVAIL;
 		if (fi_addr)
@@ -614,9 +660,11 @@ int ofi_ip_av_insertv(struct util_av *av, const void *addr, size_t addrlen,
 		      size_t count, fi_addr_t *fi_addr, uint64_t flags,
 		      void *context)
 {
+	unsigned hashv[UTIL_AV_INSERT_BATCH];
 	int ret, success_cnt = 0;
 	int *sync_err = NULL;
-	size_t i;
+	const char *cur_addr;
+	size_t i, j, batch;
 
 	if (!count)
 		goto done;
@@ -638,13 +686,31 @@ int ofi_ip_av_insertv(struct util_av *av, const void *addr, size_t addrlen,
 		memset(sync_err, 0, sizeof(*sync_err) * count);
 	}
 
-	for (i = 0; i < count; i++) {
-		ret = ip_av_insert_addr(av, (const char *) addr + i * addrlen,
-					fi_addr ? &fi_addr[i] : NULL, context);
-		if (!ret)
-			success_cnt++;
-		else if (sync_err)
-			sync_err[i] = -ret;
+	/*
+	 * Addresses are hashed in batches without holding the AV lock, which
+	 * is then acquired once per batch rather than once per address.
+	 */
+	for (i = 0; i < count; i += batch) {
+		batch = MIN(count - i, UTIL_AV_INSERT_BATCH);
+		for (j = 0; j < batch; j++) {
+			cur_addr = (const char *) addr + (i + j) * addrlen;
+			HASH_VALUE(cur_addr, addrlen, hashv[j]);
+		}
+
+		ofi_genlock_lock(&av->lock);
+		if (count > UTIL_AV_INSERT_BATCH)
+			util_av_reserve(av, count - i);
+
+		for (j = 0; j < batch; j++) {
+			cur_addr = (const char *) addr + (i + j) * addrlen;
+			ret = ip_av_insert_addr(av, cur_addr, hashv[j],
+						fi_addr ? &fi_addr[i + j] : NULL);
+			if (!ret)
+				success_cnt++;
+			else if (sync_err)
+				sync_err[i + j] = -ret;
+		}
+		ofi_genlock_unlock(&av->lock);
 	}
 
 done:
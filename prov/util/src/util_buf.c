@@ -58,6 +58,263 @@ enum {
 	OFI_BUFPOOL_REGION_CHUNK_CNT = 16
 };
 
+/* Free range of an arena chunk.  Free slices are kept in address order. */
+struct ofi_bufpool_arena_slice {
+	struct dlist_entry		entry;
+	struct ofi_bufpool_arena_chunk	*chunk;
+	char				*base;
+	size_t				size;
+};
+
+static int ofi_bufpool_slice_is_lower(struct dlist_entry *item, const void *arg)
+{
+	const struct ofi_bufpool_arena_slice *slice1, *slice2;
+
+	slice1 = container_of(arg, struct ofi_bufpool_arena_slice, entry);
+	slice2 = container_of(item, struct ofi_bufpool_arena_slice, entry);
+
+	return slice1->base < slice2->base;
+}
+
+static int ofi_bufpool_arena_insert(struct ofi_bufpool_arena *arena,
+				    struct ofi_bufpool_arena_chunk *chunk,
+				    char *base, size_t size)
+{
+	struct ofi_bufpool_arena_slice *slice, *prev, *next;
+
+	slice = malloc(sizeof(*slice));
+	if (!slice)
+		return -FI_ENOMEM;
+
+	slice->chunk = chunk;
+	slice->base = base;
+	slice->size = size;
+	dlist_insert_order(&arena->free_list, ofi_bufpool_slice_is_lower,
+			   &slice->entry);
+
+	if (slice->entry.next != &arena->free_list) {
+		next = container_of(slice->entry.next,
+				    struct ofi_bufpool_arena_slice, entry);
+		if (next->chunk == chunk && slice->base + slice->size == next->base) {
+			slice->size += next->size;
+			dlist_remove(&next->entry);
+			free(next);
+		}
+	}
+
+	if (slice->entry.prev != &arena->free_list) {
+		prev = container_of(slice->entry.prev,
+				    struct ofi_bufpool_arena_slice, entry);
+		if (prev->chunk == chunk && prev->base + prev->size == slice->base) {
+			prev->size += slice->size;
+			dlist_remove(&slice->entry);
+			free(slice);
+		}
+	}
+	return 0;
+}
+
+static int ofi_bufpool_arena_grow(struct ofi_bufpool_arena *arena, size_t size)
+{
+	struct ofi_bufpool_arena_chunk *chunk;
+	ssize_t page_size;
+	int ret;
+
+	chunk = calloc(1, sizeof(*chunk));
+	if (!chunk)
+		return -FI_ENOMEM;
+
+	chunk->size = MAX(arena->attr.chunk_size, size);
+	if (arena->attr.flags & OFI_BUFPOOL_HUGEPAGES) {
+		page_size = ofi_get_hugepage_size();
+		if (page_size > 0) {
+			chunk->size = ofi_get_aligned_size(chunk->size,
+							   (size_t) page_size);
+			ret = ofi_alloc_hugepage_buf((void **) &chunk->base,
+						     chunk->size);
+			if (!ret) {
+				chunk->flags = OFI_BUFPOOL_HUGEPAGES;
+				goto reg;
+			}
+		}
+		FI_INFO(&core_prov, FI_LOG_CORE,
+			"huge pages unavailable, using regular pages for "
+			"buffer pool arena %p\n", arena);
+		arena->attr.flags &= ~OFI_BUFPOOL_HUGEPAGES;
+	}
+
+	page_size = ofi_get_page_size();
+	if (page_size < 0) {
+		ret = -ofi_syserr();
+		goto free;
+	}
+	chunk->size = ofi_get_aligned_size(chunk->size, (size_t) page_size);
+	ret = ofi_mmap_anon_pages((void **) &chunk->base, chunk->size, 0);
+	if (!ret) {
+		chunk->flags = OFI_BUFPOOL_NONSHARED;
+	} else if (ret == -FI_ENOSYS) {
+		ret = ofi_memalign((void **) &chunk->base, (size_t) page_size,
+				   chunk->size);
+	}
+	if (ret)
+		goto free;
+
+reg:
+	if (arena->attr.reg_fn) {
+		ret = arena->attr.reg_fn(arena, chunk);
+		if (ret)
+			goto unmap;
+	}
+
+	ret = ofi_bufpool_arena_insert(arena, chunk, chunk->base, chunk->size);
+	if (ret)
+		goto dereg;
+
+	dlist_insert_tail(&chunk->entry, &arena->chunk_list);
+	arena->chunk_cnt++;
+	arena->size += chunk->size;
+	ofi_bufpool_track_mem(chunk->size);
+
+	FI_INFO(&core_prov, FI_LOG_CORE, "buffer pool arena %p grown to "
+		"%zu bytes in %zu chunks, %zu bytes used\n", arena,
+		arena->size, arena->chunk_cnt, arena->used);
+	return 0;
+
+dereg:
+	if (arena->attr.dereg_fn)
+		arena->attr.dereg_fn(arena, chunk);
+unmap:
+	if (chunk->flags & (OFI_BUFPOOL_HUGEPAGES | OFI_BUFPOOL_NONSHARED))
+		(void) ofi_unmap_anon_pages(chunk->base, chunk->size);
+	else
+		ofi_freealign(chunk->base);
+free:
+	free(chunk);
+	return ret;
+}
+
+/* Carve an aligned slice from the first free range large enough for it. */
+static void *ofi_bufpool_arena_alloc(struct ofi_bufpool_arena *arena,
+				     size_t size, size_t alignment,
+				     struct ofi_bufpool_arena_chunk **chunk)
+{
+	struct ofi_bufpool_arena_slice *slice, *next;
+	struct dlist_entry *item;
+	char *buf = NULL, *end;
+	size_t tail;
+	int ret;
+
+	ofi_mutex_lock(&arena->lock);
+	do {
+		dlist_foreach(&arena->free_list, item) {
+			slice = container_of(item, struct ofi_bufpool_arena_slice,
+					     entry);
+			buf = (char *) ofi_get_aligned_size((uintptr_t) slice->base,
+							    alignment);
+			end = slice->base + slice->size;
+			if (buf < end && (size_t) (end - buf) >= size)
+				goto found;
+		}
+
+		ret = ofi_bufpool_arena_grow(arena, size + alignment);
+	} while (!ret);
+
+	ofi_mutex_unlock(&arena->lock);
+	return NULL;
+
+found:
+	*chunk = slice->chunk;
+	tail = end - (buf + size);
+	if (buf == slice->base) {
+		if (tail) {
+			slice->base = buf + size;
+			slice->size = tail;
+		} else {
+			dlist_remove(&slice->entry);
+			free(slice);
+		}
+	} else {
+		if (tail) {
+			next = malloc(sizeof(*next));
+			if (!next) {
+				ofi_mutex_unlock(&arena->lock);
+				return NULL;
+			}
+			next->chunk = slice->chunk;
+			next->base = buf + size;
+			next->size = tail;
+			dlist_insert_after(&next->entry, &slice->entry);
+		}
+		slice->size = buf - slice->base;
+	}
+
+	arena->slice_cnt++;
+	arena->used += size;
+	arena->peak = MAX(arena->peak, arena->used);
+	ofi_mutex_unlock(&arena->lock);
+	return buf;
+}
+
+static void ofi_bufpool_arena_free(struct ofi_bufpool_arena *arena,
+				   struct ofi_bufpool_arena_chunk *chunk,
+				   void *buf, size_t size)
+{
+	ofi_mutex_lock(&arena->lock);
+	/* On failure, the range is leaked until the arena is destroyed */
+	(void) ofi_bufpool_arena_insert(arena, chunk, buf, size);
+	arena->slice_cnt--;
+	arena->used -= size;
+	ofi_mutex_unlock(&arena->lock);
+}
+
+int ofi_bufpool_arena_create(struct ofi_bufpool_arena_attr *attr,
+			     struct ofi_bufpool_arena **arena)
+{
+	*arena = calloc(1, sizeof(**arena));
+	if (!*arena)
+		return -FI_ENOMEM;
+
+	(*arena)->attr = *attr;
+	ofi_mutex_init(&(*arena)->lock);
+	dlist_init(&(*arena)->chunk_list);
+	dlist_init(&(*arena)->free_list);
+	return 0;
+}
+
+void ofi_bufpool_arena_destroy(struct ofi_bufpool_arena *arena)
+{
+	struct ofi_bufpool_arena_slice *slice;
+	struct ofi_bufpool_arena_chunk *chunk;
+
+	FI_INFO(&core_prov, FI_LOG_CORE, "buffer pool arena %p: %zu bytes in "
+		"%zu chunks, peak use %zu bytes (%zu%%)\n", arena, arena->size,
+		arena->chunk_cnt, arena->peak,
+		arena->size ? arena->peak * 100 / arena->size : 0);
+	assert(!arena->slice_cnt);
+
+	while (!dlist_empty(&arena->free_list)) {
+		dlist_pop_front(&arena->free_list, struct ofi_bufpool_arena_slice,
+				slice, entry);
+		free(slice);
+	}
+
+	while (!dlist_empty(&arena->chunk_list)) {
+		dlist_pop_front(&arena->chunk_list,
+				struct ofi_bufpool_arena_chunk, chunk, entry);
+		if (arena->attr.dereg_fn)
+			arena->attr.dereg_fn(arena, chunk);
+
+		if (chunk->flags & (OFI_BUFPOOL_HUGEPAGES | OFI_BUFPOOL_NONSHARED))
+			(void) ofi_unmap_anon_pages(chunk->base, chunk->size);
+		else
+			ofi_freealign(chunk->base);
+		free(chunk);
+	}
+
+	ofi_mutex_destroy(&arena->lock);
+	free(arena);
+}
+
 
 static int ofi_bufpool_region_alloc(struct ofi_bufpool_region *buf_region)
 {
@@ -66,6 +323,19 @@ static int ofi_bufpool_region_alloc(struct ofi_bufpool_region *buf_region)
 	size_t alloc_size;
 	struct ofi_bufpool *pool = buf_region->pool;
 
+	if (pool->attr.arena) {
+		buf_region->alloc_region =
+			ofi_bufpool_arena_alloc(pool->attr.arena,
+				pool->alloc_size,
+				roundup_power_of_two(pool->attr.alignment),
+				&buf_region->chunk);
+		if (!buf_region->alloc_region)
+			return -FI_ENOMEM;
+
+		buf_region->flags = OFI_BUFPOOL_ARENA;
+		return 0;
+	}
+
 	if (pool->attr.flags & OFI_BUFPOOL_HUGEPAGES) {
 		page_size = ofi_get_hugepage_size();
 		if (page_size > 0 && pool->alloc_size >= (size_t) page_size) {
@@ -118,7 +388,10 @@ static void ofi_bufpool_region_free(struct ofi_bufpool_region *buf_region)
 	int ret;
 	struct ofi_bufpool *pool = buf_region->pool;
 
-	if (buf_region->flags & (OFI_BUFPOOL_HUGEPAGES | OFI_BUFPOOL_NONSHARED)) {
+	if (buf_region->flags & OFI_BUFPOOL_ARENA) {
+		ofi_bufpool_arena_free(pool->attr.arena, buf_region->chunk,
+				       buf_region->alloc_region, pool->alloc_size);
+	} else if (buf_region->flags & (OFI_BUFPOOL_HUGEPAGES | OFI_BUFPOOL_NONSHARED)) {
 		ret = ofi_unmap_anon_pages(buf_region->alloc_region, pool->alloc_size);
 		if (ret) {
 			FI_DBG(&core_prov, FI_LOG_CORE,
@@ -165,7 +438,9 @@ int ofi_bufpool_grow(struct ofi_bufpool *pool)
 		goto err1;
 	}
 
-	mem_allocated += buf_region->pool->alloc_size;
+	/* Arena memory is accounted for when the arena grows */
+	if (!(buf_region->flags & OFI_BUFPOOL_ARENA))
+		mem_allocated += buf_region->pool->alloc_size;
 
 	if (!(pool->attr.flags & OFI_BUFPOOL_NO_ZERO))
 		memset(buf_region->alloc_region, 0, pool->alloc_size);
@@ -238,6 +513,254 @@ err1:
 	return ret;
 }
 
+/*
+ * Threads are assigned a slot in the magazine cache table of every pool on
+ * first use.  Slots are recycled when threads exit, in which case the next
+ * thread to take a slot inherits the magazines cached in it.
+ */
+OFI_THREAD_LOCAL int ofi_bufpool_thread_idx = -1;
+
+enum {
+	OFI_BUFPOOL_THREAD_UNSET = -1,
+	OFI_BUFPOOL_THREAD_NONE = -2,
+	OFI_BUFPOOL_MAG_ALIGN = 64,
+};
+
+static pthread_mutex_t ofi_bufpool_thread_lock = PTHREAD_MUTEX_INITIALIZER;
+static int ofi_bufpool_thread_free[OFI_BUFPOOL_MAG_THREADS];
+static int ofi_bufpool_thread_free_cnt;
+static int ofi_bufpool_thread_cnt;
+
+#ifndef _WIN32
+static pthread_once_t ofi_bufpool_thread_once = PTHREAD_ONCE_INIT;
+static pthread_key_t ofi_bufpool_thread_key;
+static bool ofi_bufpool_thread_key_valid;
+
+static void ofi_bufpool_thread_exit(void *arg)
+{
+	pthread_mutex_lock(&ofi_bufpool_thread_lock);
+	ofi_bufpool_thread_free[ofi_bufpool_thread_free_cnt++] =
+		(int) ((uintptr_t) arg - 1);
+	pthread_mutex_unlock(&ofi_bufpool_thread_lock);
+}
+
+static void ofi_bufpool_thread_init(void)
+{
+	ofi_bufpool_thread_key_valid =
+		!pthread_key_create(&ofi_bufpool_thread_key,
+				    ofi_bufpool_thread_exit);
+}
+
+/* Exiting threads must not call into an unloaded provider */
+FI_DESTRUCTOR(ofi_bufpool_thread_fini(void))
+{
+	if (ofi_bufpool_thread_key_valid)
+		pthread_key_delete(ofi_bufpool_thread_key);
+}
+#endif
+
+static int ofi_bufpool_thread_index(void)
+{
+	int idx;
+
+	if (ofi_bufpool_thread_idx != OFI_BUFPOOL_THREAD_UNSET)
+		return ofi_bufpool_thread_idx;
+
+#ifndef _WIN32
+	pthread_once(&ofi_bufpool_thread_once, ofi_bufpool_thread_init);
+#endif
+	pthread_mutex_lock(&ofi_bufpool_thread_lock);
+	if (ofi_bufpool_thread_free_cnt)
+		idx = ofi_bufpool_thread_free[--ofi_bufpool_thread_free_cnt];
+	else if (ofi_bufpool_thread_cnt < OFI_BUFPOOL_MAG_THREADS)
+		idx = ofi_bufpool_thread_cnt++;
+	else
+		idx = OFI_BUFPOOL_THREAD_NONE;
+	pthread_mutex_unlock(&ofi_bufpool_thread_lock);
+
+#ifndef _WIN32
+	if (idx >= 0 && ofi_bufpool_thread_key_valid)
+		(void) pthread_setspecific(ofi_bufpool_thread_key,
+					   (void *) (uintptr_t) (idx + 1));
+#endif
+	ofi_bufpool_thread_idx = idx;
+	return idx;
+}
+
+static struct ofi_bufpool_mag *ofi_bufpool_mag_alloc(void)
+{
+	struct ofi_bufpool_mag *mag;
+
+	/* Keep the magazines of different threads on separate cache lines */
+	if (ofi_memalign((void **) &mag, OFI_BUFPOOL_MAG_ALIGN, sizeof(*mag)))
+		return NULL;
+
+	mag->cnt = 0;
+	return mag;
+}
+
+static void ofi_bufpool_mag_free(struct ofi_bufpool_mag *mag)
+{
+	while (mag->cnt)
+		ofi_buf_free(mag->bufs[--mag->cnt]);
+	ofi_freealign(mag);
+}
+
+static struct ofi_bufpool_mag_cache *
+ofi_bufpool_mag_cache_get(struct ofi_bufpool *pool)
+{
+	struct ofi_bufpool_mag_cache *cache;
+	int idx;
+
+	idx = ofi_bufpool_thread_index();
+	if (idx < 0)
+		return NULL;
+
+	if (pool->mag_caches[idx])
+		return pool->mag_caches[idx];
+
+	cache = calloc(1, sizeof(*cache));
+	if (!cache)
+		return NULL;
+
+	cache->loaded = ofi_bufpool_mag_alloc();
+	cache->prev = ofi_bufpool_mag_alloc();
+	if (!cache->loaded || !cache->prev) {
+		ofi_freealign(cache->loaded);
+		ofi_freealign(cache->prev);
+		free(cache);
+		return NULL;
+	}
+
+	pool->mag_caches[idx] = cache;
+	return cache;
+}
+
+static void ofi_bufpool_mag_swap(struct ofi_bufpool_mag_cache *cache)
+{
+	struct ofi_bufpool_mag *mag;
+
+	mag = cache->loaded;
+	cache->loaded = cache->prev;
+	cache->prev = mag;
+}
+
+void *ofi_buf_mag_alloc_slow(struct ofi_bufpool *pool)
+{
+	struct ofi_bufpool_mag_cache *cache;
+	struct ofi_bufpool_mag *mag;
+	void *buf;
+
+	cache = ofi_bufpool_mag_cache_get(pool);
+	if (!cache) {
+		ofi_mutex_lock(&pool->mag_lock);
+		buf = ofi_buf_alloc(pool);
+		ofi_mutex_unlock(&pool->mag_lock);
+		return buf;
+	}
+
+	if (!cache->loaded->cnt && cache->prev->cnt)
+		ofi_bufpool_mag_swap(cache);
+
+	if (!cache->loaded->cnt) {
+		ofi_mutex_lock(&pool->mag_lock);
+		if (!slist_empty(&pool->mag_full)) {
+			slist_remove_head_container(&pool->mag_full,
+					struct ofi_bufpool_mag, mag, entry);
+			slist_insert_head(&cache->prev->entry,
+					  &pool->mag_empty);
+			cache->prev = cache->loaded;
+			cache->loaded = mag;
+		} else {
+			/* Fill half a magazine, so that buffers freed by
+			 * this thread next do not go back to the depot */
+			while (cache->loaded->cnt < OFI_BUFPOOL_MAG_SIZE / 2) {
+				buf = ofi_buf_alloc(pool);
+				if (!buf)
+					break;
+				cache->loaded->bufs[cache->loaded->cnt++] = buf;
+			}
+		}
+		ofi_mutex_unlock(&pool->mag_lock);
+
+		if (!cache->loaded->cnt)
+			return NULL;
+	}
+
+	return cache->loaded->bufs[--cache->loaded->cnt];
+}
+
+void ofi_buf_mag_free_slow(struct ofi_bufpool *pool, void *buf)
+{
+	struct ofi_bufpool_mag_cache *cache;
+	struct ofi_bufpool_mag *mag;
+
+	cache = ofi_bufpool_mag_cache_get(pool);
+	if (!cache)
+		goto free;
+
+	if (cache->loaded->cnt == OFI_BUFPOOL_MAG_SIZE &&
+	    cache->prev->cnt < OFI_BUFPOOL_MAG_SIZE)
+		ofi_bufpool_mag_swap(cache);
+
+	if (cache->loaded->cnt == OFI_BUFPOOL_MAG_SIZE) {
+		ofi_mutex_lock(&pool->mag_lock);
+		if (!slist_empty(&pool->mag_empty)) {
+			slist_remove_head_container(&pool->mag_empty,
+					struct ofi_bufpool_mag, mag, entry);
+		} else {
+			mag = ofi_bufpool_mag_alloc();
+			if (!mag) {
+				ofi_buf_free(buf);
+				ofi_mutex_unlock(&pool->mag_lock);
+				return;
+			}
+		}
+		slist_insert_head(&cache->prev->entry, &pool->mag_full);
+		ofi_mutex_unlock(&pool->mag_lock);
+		cache->prev = cache->loaded;
+		cache->loaded = mag;
+	}
+
+	cache->loaded->bufs[cache->loaded->cnt++] = buf;
+	return;
+
+free:
+	ofi_mutex_lock(&pool->mag_lock);
+	ofi_buf_free(buf);
+	ofi_mutex_unlock(&pool->mag_lock);
+}
+
+static void ofi_bufpool_mag_cleanup(struct ofi_bufpool *pool)
+{
+	struct ofi_bufpool_mag *mag;
+	int i;
+
+	for (i = 0; i < OFI_BUFPOOL_MAG_THREADS; i++) {
+		if (!pool->mag_caches[i])
+			continue;
+
+		ofi_bufpool_mag_free(pool->mag_caches[i]->loaded);
+		ofi_bufpool_mag_free(pool->mag_caches[i]->prev);
+		free(pool->mag_caches[i]);
+	}
+
+	while (!slist_empty(&pool->mag_full)) {
+		slist_remove_head_container(&pool->mag_full,
+					    struct ofi_bufpool_mag, mag, entry);
+		ofi_bufpool_mag_free(mag);
+	}
+
+	while (!slist_empty(&pool->mag_empty)) {
+		slist_remove_head_container(&pool->mag_empty,
+					    struct ofi_bufpool_mag, mag, entry);
+		ofi_bufpool_mag_free(mag);
+	}
+
+	free(pool->mag_caches);
+	ofi_mutex_destroy(&pool->mag_lock);
+}
+
 int ofi_bufpool_create_attr(struct ofi_bufpool_attr *attr,
 			      struct ofi_bufpool **buf_pool)
 {
@@ -250,6 +773,23 @@ int ofi_bufpool_create_attr(struct ofi_bufpool_attr *attr,
 
 	pool->attr = *attr;
 
+	if (pool->attr.flags & OFI_BUFPOOL_MAGAZINE) {
+		if (pool->attr.flags & OFI_BUFPOOL_INDEXED) {
+			free(pool);
+			return -FI_EINVAL;
+		}
+
+		pool->mag_caches = calloc(OFI_BUFPOOL_MAG_THREADS,
+					  sizeof(*pool->mag_caches));
+		if (!pool->mag_caches) {
+			free(pool);
+			return -FI_ENOMEM;
+		}
+		ofi_mutex_init(&pool->mag_lock);
+		slist_init(&pool->mag_full);
+		slist_init(&pool->mag_empty);
+	}
+
 	entry_sz = (attr->size + sizeof(struct ofi_bufpool_hdr));
 	OFI_DBG_ADD(entry_sz, sizeof(struct ofi_bufpool_ftr));
 	if (!attr->alignment)
@@ -284,6 +824,9 @@ void ofi_bufpool_destroy(struct ofi_bufpool *pool)
 	struct ofi_bufpool_region *buf_region;
 	size_t i;
 
+	if (pool->attr.flags & OFI_BUFPOOL_MAGAZINE)
+		ofi_bufpool_mag_cleanup(pool);
+
 	for (i = 0; i < pool->region_cnt; i++) {
 		buf_region = pool->region_table[i];
 
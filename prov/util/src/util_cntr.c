@@ -69,12 +69,19 @@ static int ofi_check_cntr_attr(const struct fi_provider *prov,
 	return 0;
 }
 
+/* Progress also starts triggered operations whose threshold was reached */
+static void util_cntr_progress(struct util_cntr *cntr)
+{
+	cntr->progress(cntr);
+	ofi_trigger_progress(cntr->domain);
+}
+
 uint64_t ofi_cntr_read(struct fid_cntr *cntr_fid)
 {
 	struct util_cntr *cntr = container_of(cntr_fid, struct util_cntr, cntr_fid);
 
 	assert(cntr->cntr_fid.fid.fclass == FI_CLASS_CNTR);
-	cntr->progress(cntr);
+	util_cntr_progress(cntr);
 
 	return ofi_atomic_get64(&cntr->cnt);
 }
@@ -84,7 +91,7 @@ uint64_t ofi_cntr_readerr(struct fid_cntr *cntr_fid)
 	struct util_cntr *cntr = container_of(cntr_fid, struct util_cntr, cntr_fid);
 
 	assert(cntr->cntr_fid.fid.fclass == FI_CLASS_CNTR);
-	cntr->progress(cntr);
+	util_cntr_progress(cntr);
 
 	return ofi_atomic_get64(&cntr->err);
 }
@@ -140,45 +147,97 @@ int ofi_cntr_seterr(struct fid_cntr *cntr_fid, uint64_t value)
 	return FI_SUCCESS;
 }
 
+static int util_cntr_check(struct util_cntr *cntr, uint64_t threshold,
+			   uint64_t errcnt)
+{
+	if (threshold <= (uint64_t) ofi_atomic_get64(&cntr->cnt))
+		return FI_SUCCESS;
+
+	if (errcnt != (uint64_t) ofi_atomic_get64(&cntr->err))
+		return -FI_EAVAIL;
+
+	return -FI_EAGAIN;
+}
+
+/*
+ * The wait object is reset by the thread that blocks on it, so a signal
+ * seen by one of several blocked threads is lost to the others.  A single
+ * leader therefore blocks on the wait object and drives progress, and wakes
+ * the other waiters through wait_cond every time that it returns.
+ */
+static int util_cntr_wait_lead(struct util_cntr *cntr, uint64_t threshold,
+			       uint64_t errcnt, uint64_t endtime, int timeout)
+{
+	int ret;
+
+	while (1) {
+		util_cntr_progress(cntr);
+
+		ofi_mutex_lock(&cntr->wait_lock);
+		pthread_cond_broadcast(&cntr->wait_cond);
+		ofi_mutex_unlock(&cntr->wait_lock);
+
+		ret = util_cntr_check(cntr, threshold, errcnt);
+		if (ret != -FI_EAGAIN)
+			return ret;
+
+		if (ofi_adjust_timeout(endtime, &timeout))
+			return -FI_ETIMEDOUT;
+
+		ret = ofi_wait(&cntr->wait->wait_fid, timeout);
+		if (ret && ret != -FI_ETIMEDOUT)
+			return ret;
+	}
+}
+
 int ofi_cntr_wait(struct fid_cntr *cntr_fid, uint64_t threshold, int timeout)
 {
 	struct util_cntr *cntr;
-	uint64_t endtime, errcnt;
-	int ret, timeout_quantum;
+	uint64_t endtime, errcnt, start, spin_end;
+	int ret;
 
 	cntr = container_of(cntr_fid, struct util_cntr, cntr_fid);
 	assert(cntr->wait);
 	errcnt = ofi_atomic_get64(&cntr->err);
 	endtime = ofi_timeout_time(timeout);
+	start = ofi_gettime_ns();
+	spin_end = ofi_wait_spin_end(&cntr->spin, start);
 
 	do {
-		cntr->progress(cntr);
-		if (threshold <= (uint64_t)ofi_atomic_get64(&cntr->cnt))
-			return FI_SUCCESS;
-
-		if (errcnt != (uint64_t)ofi_atomic_get64(&cntr->err))
-			return -FI_EAVAIL;
+		util_cntr_progress(cntr);
+		ret = util_cntr_check(cntr, threshold, errcnt);
+		if (ret != -FI_EAGAIN)
+			return ret;
 
 		if (ofi_adjust_timeout(endtime, &timeout))
 			return -FI_ETIMEDOUT;
-
-		/*
-		 * Temporary work-around to avoid a thread hanging in underlying
-		 * epoll_wait called from fi_wait. This can happen if one thread
-		 * updates the counter, another thread reads it (thereby resetting
-		 * cntr signal fd) and the current thread is about to wait. The
-		 * current thread would never wake up and doesn't know the counter
-		 * has been updated. Fix it by checking counter state every now
-		 * and then instead of waiting for a longer period. This does
-		 * have the overhead of threads waking up unnecessarily.
-		 */
-		timeout_quantum = (timeout < 0 ? OFI_TIMEOUT_QUANTUM_MS :
-				   MIN(OFI_TIMEOUT_QUANTUM_MS, timeout));
-
-		ret = ofi_wait(&cntr->wait->wait_fid, timeout_quantum);
-	} while (!ret || (ret == -FI_ETIMEDOUT &&
-			  (timeout < 0 || timeout_quantum < timeout)));
-
+	} while (ofi_gettime_ns() < spin_end);
+
+	ofi_mutex_lock(&cntr->wait_lock);
+	while (cntr->wait_leader) {
+		ofi_pthread_wait_cond(&cntr->wait_cond, &cntr->wait_lock,
+				      timeout);
+
+		ret = util_cntr_check(cntr, threshold, errcnt);
+		if (ret == -FI_EAGAIN && ofi_adjust_timeout(endtime, &timeout))
+			ret = -FI_ETIMEDOUT;
+		if (ret != -FI_EAGAIN) {
+			ofi_mutex_unlock(&cntr->wait_lock);
+			goto out;
+		}
+	}
+	cntr->wait_leader = true;
+	ofi_mutex_unlock(&cntr->wait_lock);
+
+	ret = util_cntr_wait_lead(cntr, threshold, errcnt, endtime, timeout);
+
+	ofi_mutex_lock(&cntr->wait_lock);
+	cntr->wait_leader = false;
+	pthread_cond_broadcast(&cntr->wait_cond);
+	ofi_mutex_unlock(&cntr->wait_lock);
+out:
+	if (!ret)
+		ofi_wait_spin_update(&cntr->spin, start);
 	return ret;
 }
 
@@ -250,6 +309,10 @@ int ofi_cntr_cleanup(struct util_cntr *cntr)
 	if (ofi_atomic_get32(&cntr->ref))
 		return -FI_EBUSY;
 
+	ofi_trigger_cntr_cleanup(cntr);
+	pthread_cond_destroy(&cntr->wait_cond);
+	ofi_mutex_destroy(&cntr->wait_lock);
+
 	if (!(cntr->flags & FI_PEER))
 		fi_close(&cntr->peer_cntr->fid);
 
@@ -343,12 +406,19 @@ int ofi_cntr_init(const struct fi_provider *prov, struct fid_domain *domain,
 	if (ret)
 		return ret;
 
+	ofi_mutex_init(&cntr->wait_lock);
+	pthread_cond_init(&cntr->wait_cond, NULL);
+	cntr->wait_leader = false;
+	cntr->spin.avg_ns = 0;
+
 	cntr->progress = progress;
 	cntr->domain = container_of(domain, struct util_domain, domain_fid);
 	ofi_atomic_initialize32(&cntr->ref, 0);
 	ofi_atomic_initialize64(&cntr->cnt, 0);
 	ofi_atomic_initialize64(&cntr->err, 0);
 	dlist_init(&cntr->ep_list);
+	dlist_init(&cntr->trigger_list);
+	dlist_init(&cntr->trigger_entry);
 
 	cntr->flags = attr->flags;
 	cntr->cntr_fid.fid.fclass = FI_CLASS_CNTR;
@@ -372,14 +442,15 @@ int ofi_cntr_init(const struct fi_provider *prov, struct fid_domain *domain,
 		ret = ofi_wait_open(&cntr->domain->fabric->fabric_fid,
 				    &wait_attr, &wait);
 		if (ret)
-			return ret;
+			goto errout_destroy_lock;
 		break;
 	case FI_WAIT_SET:
 		wait = attr->wait_set;
 		break;
 	default:
 		assert(0);
-		return -FI_EINVAL;
+		ret = -FI_EINVAL;
+		goto errout_destroy_lock;
 	}
 
 	if (attr->flags & FI_PEER) {
@@ -395,7 +466,7 @@ int ofi_cntr_init(const struct fi_provider *prov, struct fid_domain *domain,
 						   cntr->domain->control_progress);
 	ret = ofi_genlock_init(&cntr->ep_list_lock, ep_list_lock_type);
 	if (ret)
-		goto errout_close_wait;
+		goto errout_close_peer;
 
 	ofi_atomic_inc32(&cntr->domain->ref);
 
@@ -405,15 +476,22 @@ int ofi_cntr_init(const struct fi_provider *prov, struct fid_domain *domain,
 		ret = ofi_poll_add(&cntr->wait->pollset->poll_fid,
 				   &cntr->cntr_fid.fid, 0);
 		if (ret) {
-			ofi_cntr_cleanup(cntr);
-			goto errout_close_wait;
+			ofi_atomic_dec32(&cntr->domain->ref);
+			ofi_genlock_destroy(&cntr->ep_list_lock);
+			goto errout_close_peer;
 		}
 	}
 
 	return 0;
 
+errout_close_peer:
+	if (!(attr->flags & FI_PEER))
+		fi_close(&cntr->peer_cntr->fid);
 errout_close_wait:
 	if (wait && attr->wait_obj != FI_WAIT_SET)
 		fi_close(&wait->fid);
+errout_destroy_lock:
+	pthread_cond_destroy(&cntr->wait_cond);
+	ofi_mutex_destroy(&cntr->wait_lock);
 	return ret;
 }
@@ -38,6 +38,49 @@
 
 #define UTIL_DEF_CQ_SIZE (1024)
 
+static pthread_mutex_t util_cq_thread_lock = PTHREAD_MUTEX_INITIALIZER;
+static int util_cq_thread_cnt;
+static OFI_THREAD_LOCAL int util_cq_thread_idx = -1;
+static OFI_THREAD_LOCAL size_t util_cq_thread_shard_idx;
+
+static int util_cq_thread_index(void)
+{
+	if (OFI_UNLIKELY(util_cq_thread_idx < 0)) {
+		pthread_mutex_lock(&util_cq_thread_lock);
+		util_cq_thread_idx = util_cq_thread_cnt++;
+		pthread_mutex_unlock(&util_cq_thread_lock);
+	}
+	return util_cq_thread_idx;
+}
+
+static size_t util_cq_thread_shard_index(struct util_cq *cq)
+{
+	if (cq->thread_shards)
+		return util_cq_thread_shard_idx % cq->shard_cnt;
+	return util_cq_thread_index() % cq->shard_cnt;
+}
+
+static struct util_cq_shard *util_cq_thread_shard(struct util_cq *cq)
+{
+	return &cq->shards[util_cq_thread_shard_index(cq)];
+}
+
+/* Selects the shard written by the calling thread on CQs opened through
+ * ofi_cq_init_sharded().  Threads that do not select a shard use shard 0.
+ */
+void ofi_cq_set_thread_shard(size_t index)
+{
+	util_cq_thread_shard_idx = index;
+}
+
+/* Route the calling thread's later completions through the cirq */
+static void util_cq_set_overflow(struct util_cq *cq)
+{
+	assert(ofi_genlock_held(&cq->cq_lock));
+	if (cq->shards)
+		ofi_atomic_set32(&util_cq_thread_shard(cq)->overflow, 1);
+}
+
 
 /* While the CQ is full, we continue to add new entries to the auxiliary
  * queue.
@@ -93,6 +136,8 @@ static int util_cq_insert_error(struct util_cq *cq,
 	if (!entry)
 		return -FI_ENOMEM;
 
+	util_cq_set_overflow(cq);
+
 	entry->comp = *err_entry;
 
 	if (err_entry->err_data_size) {
@@ -110,6 +155,120 @@ static int util_cq_insert_error(struct util_cq *cq,
 	return 0;
 }
 
+int ofi_cq_write_shard(struct util_cq *cq, void *context, uint64_t flags,
+		       size_t len, void *buf, uint64_t data, uint64_t tag,
+		       fi_addr_t src)
+{
+	struct util_cq_shard_comp *entry;
+	struct util_cq_shard *shard;
+	int64_t pos;
+	int ret;
+
+	shard = util_cq_thread_shard(cq);
+	if (!ofi_atomic_get32(&shard->overflow) &&
+	    !util_cq_shardq_next(shard->queue, &entry, &pos)) {
+		entry->comp.op_context = context;
+		entry->comp.flags = flags;
+		entry->comp.len = len;
+		entry->comp.buf = buf;
+		entry->comp.data = data;
+		entry->comp.tag = tag;
+		entry->src = src;
+		util_cq_shardq_commit(entry, pos);
+		return 0;
+	}
+
+	ofi_genlock_lock(&cq->cq_lock);
+	ofi_atomic_set32(&shard->overflow, 1);
+	if (ofi_cirque_freecnt(cq->cirq) > 1) {
+		if (cq->src)
+			ofi_cq_write_src_entry(cq, context, flags, len, buf,
+					       data, tag, src);
+		else
+			ofi_cq_write_entry(cq, context, flags, len, buf,
+					   data, tag);
+		ret = 0;
+	} else {
+		ret = ofi_cq_write_overflow(cq, context, flags, len, buf,
+					    data, tag, src);
+	}
+	ofi_genlock_unlock(&cq->cq_lock);
+	return ret;
+}
+
+static size_t util_cq_read_shard(struct util_cq *cq,
+				 struct util_cq_shard *shard, void **buf,
+				 size_t count, fi_addr_t *src_addr)
+{
+	struct util_cq_shard_comp *entry;
+	int64_t pos;
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		if (util_cq_shardq_head(shard->queue, &entry, &pos))
+			break;
+
+		if (src_addr)
+			src_addr[i] = cq->src ? entry->src : FI_ADDR_NOTAVAIL;
+		cq->read_entry(buf, &entry->comp);
+		util_cq_shardq_release(shard->queue, entry, pos);
+	}
+	return i;
+}
+
+/* Check for shards that overflowed into the cirq, but are not drained */
+static bool util_cq_shard_pending(struct util_cq *cq)
+{
+	size_t i;
+
+	for (i = 0; i < cq->shard_cnt; i++) {
+		if (ofi_atomic_get32(&cq->shards[i].overflow) &&
+		    !ofi_cq_shard_isempty(&cq->shards[i]))
+			return true;
+	}
+	return false;
+}
+
+ssize_t ofi_cq_read_shards(struct util_cq *cq, void *buf, size_t count,
+			   fi_addr_t *src_addr)
+{
+	size_t i, start, cnt = 0;
+	ssize_t ret;
+
+	/* Drain the local shard first, then steal from the others */
+	start = util_cq_thread_shard_index(cq);
+	for (i = 0; i < cq->shard_cnt && cnt < count; i++) {
+		cnt += util_cq_read_shard(cq,
+				&cq->shards[(start + i) % cq->shard_cnt],
+				&buf, count - cnt, src_addr ? src_addr + cnt : NULL);
+	}
+
+	if (count && cnt == count)
+		return cnt;
+
+	if (!count && !ofi_cq_isempty(cq))
+		return 0;
+
+	ofi_genlock_lock(&cq->cq_lock);
+	if (util_cq_shard_pending(cq)) {
+		ret = cnt ? cnt : -FI_EAGAIN;
+		goto unlock;
+	}
+
+	ret = ofi_cq_read_cirq(cq, buf, count - cnt,
+			       src_addr ? src_addr + cnt : NULL);
+	if (ofi_cirque_isempty(cq->cirq)) {
+		for (i = 0; i < cq->shard_cnt; i++)
+			ofi_atomic_set32(&cq->shards[i].overflow, 0);
+	}
+
+	if (cnt)
+		ret = ret > 0 ? ret + cnt : cnt;
+unlock:
+	ofi_genlock_unlock(&cq->cq_lock);
+	return ret;
+}
+
 int ofi_cq_write_error(struct util_cq *cq,
 		       const struct fi_cq_err_entry *err_entry)
 {
@@ -120,7 +279,7 @@ int ofi_cq_write_error(struct util_cq *cq,
 	ofi_genlock_unlock(&cq->cq_lock);
 
 	if (cq->wait)
-		cq->wait->signal(cq->wait);
+		util_cq_signal(cq);
 	return ret;
 }
 
@@ -268,6 +427,7 @@ ssize_t ofi_cq_readfrom(struct fid_cq *cq_fid, void *buf, size_t count,
 	cq = container_of(cq_fid, struct util_cq, cq_fid);
 
 	cq->progress(cq);
+	ofi_trigger_progress(cq->domain);
 
 	return ofi_cq_read_entries(cq, buf, count, src_addr);
 }
@@ -277,6 +437,25 @@ ssize_t ofi_cq_read(struct fid_cq *cq_fid, void *buf, size_t count)
 	return fi_cq_readfrom(cq_fid, buf, count, NULL);
 }
 
+/* Frees the aux entry at the head of the CQ and retires its cirq slot */
+static void util_cq_remove_aux(struct util_cq *cq)
+{
+	struct util_cq_aux_entry *aux_entry;
+
+	assert(ofi_genlock_held(&cq->cq_lock));
+	aux_entry = container_of(slist_remove_head(&cq->aux_queue),
+				 struct util_cq_aux_entry, list_entry);
+	free(aux_entry);
+	if (slist_empty(&cq->aux_queue)) {
+		ofi_cirque_discard(cq->cirq);
+	} else {
+		aux_entry = container_of(cq->aux_queue.head,
+					 struct util_cq_aux_entry, list_entry);
+		if (aux_entry->cq_slot != ofi_cirque_head(cq->cirq))
+			ofi_cirque_discard(cq->cirq);
+	}
+}
+
 ssize_t ofi_cq_readerr(struct fid_cq *cq_fid, struct fi_cq_err_entry *buf,
 		       uint64_t flags)
 {
@@ -330,18 +509,9 @@ ssize_t ofi_cq_readerr(struct fid_cq *cq_fid, struct fi_cq_err_entry *buf,
 		buf->err_data_size = aux_entry->comp.err_data_size;
 	}
 
-	slist_remove_head(&cq->aux_queue);
 	if (aux_entry->comp.err_data_size)
 		free(aux_entry->comp.err_data);
-	free(aux_entry);
-	if (slist_empty(&cq->aux_queue)) {
-		ofi_cirque_discard(cq->cirq);
-	} else {
-		aux_entry = container_of(cq->aux_queue.head,
-					 struct util_cq_aux_entry, list_entry);
-		if (aux_entry->cq_slot != ofi_cirque_head(cq->cirq))
-			ofi_cirque_discard(cq->cirq);
-	}
+	util_cq_remove_aux(cq);
 
 	ret = 1;
 unlock:
@@ -349,32 +519,91 @@ unlock:
 	return ret;
 }
 
+/*
+ * Readers blocked on an FI_CQ_COND_THRESHOLD CQ publish the lowest
+ * threshold among them, so that writers only signal the wait object once
+ * enough entries are queued.  A reader asking for a single entry still
+ * registers, which forces a signal for every write while it waits.
+ */
+static void util_cq_add_threshold(struct util_cq *cq, size_t threshold)
+{
+	size_t cur;
+
+	ofi_genlock_lock(&cq->cq_lock);
+	cur = ofi_atomic_get32(&cq->wait_threshold);
+	if (!cq->threshold_waiters++ || threshold < cur)
+		ofi_atomic_set32(&cq->wait_threshold, (int32_t) threshold);
+	ofi_genlock_unlock(&cq->cq_lock);
+	ofi_mb();
+}
+
+static void util_cq_del_threshold(struct util_cq *cq)
+{
+	ofi_genlock_lock(&cq->cq_lock);
+	if (!--cq->threshold_waiters)
+		ofi_atomic_set32(&cq->wait_threshold, 0);
+	ofi_genlock_unlock(&cq->cq_lock);
+}
+
 ssize_t ofi_cq_sreadfrom(struct fid_cq *cq_fid, void *buf, size_t count,
 			 fi_addr_t *src_addr, const void *cond, int timeout)
 {
 	struct util_cq *cq;
-	uint64_t endtime;
+	uint64_t endtime, start = 0, spin_end = 0, now;
+	size_t threshold = 1;
 	ssize_t ret;
 
 	cq = container_of(cq_fid, struct util_cq, cq_fid);
 	assert(cq->wait && cq->internal_wait);
 	endtime = ofi_timeout_time(timeout);
 
-	do {
-		ret = fi_cq_readfrom(cq_fid, buf, count, src_addr);
+	if (cq->wait_cond == FI_CQ_COND_THRESHOLD && cq->cirq) {
+		threshold = MIN((uintptr_t) cond, count);
+		/* at most cirq size entries can ever be queued at once */
+		threshold = MIN(threshold, cq->cirq->size - 1);
+		threshold = MAX(threshold, 1);
+		util_cq_add_threshold(cq, threshold);
+	}
+
+	while (1) {
+		if (threshold > 1) {
+			/* a zero count read drives progress */
+			ret = fi_cq_readfrom(cq_fid, NULL, 0, NULL);
+			if (!ret && !ofi_cq_threshold_met(cq, threshold))
+				ret = -FI_EAGAIN;
+		}
+		if (threshold == 1 || !ret)
+			ret = fi_cq_readfrom(cq_fid, buf, count, src_addr);
 		if (ret != -FI_EAGAIN)
 			break;
 
 		if (ofi_adjust_timeout(endtime, &timeout))
-			return -FI_EAGAIN;
+			break;
 
 		if (ofi_atomic_get32(&cq->wakeup)) {
 			ofi_atomic_set32(&cq->wakeup, 0);
-			return -FI_EAGAIN;
+			break;
+		}
+
+		/* Poll, which drives progress, before arming the wait */
+		now = ofi_gettime_ns();
+		if (!start) {
+			start = now;
+			spin_end = ofi_wait_spin_end(&cq->spin, start);
 		}
+		if (now < spin_end)
+			continue;
 
 		ret = ofi_wait(&cq->wait->wait_fid, timeout);
-	} while (!ret);
+		if (ret)
+			break;
+	}
+
+	if (cq->wait_cond == FI_CQ_COND_THRESHOLD && cq->cirq)
+		util_cq_del_threshold(cq);
+
+	if (ret > 0 && start)
+		ofi_wait_spin_update(&cq->spin, start);
 
 	return ret == -FI_ETIMEDOUT ? -FI_EAGAIN : ret;
 }
@@ -412,6 +641,160 @@ static struct fi_ops_cq util_cq_ops = {
 	.strerror = ofi_cq_strerror,
 };
 
+/*
+ * Completions are borrowed in place from the cirq.  A span ends at the
+ * end of the ring buffer or at the first overflow entry.  Overflow entries
+ * are stored outside of the cirq and are lent out one at a time through a
+ * staging entry.
+ */
+static ssize_t util_cq_borrow(struct fid_cq *cq_fid,
+			      struct fi_cq_tagged_entry **comp,
+			      fi_addr_t **src_addr, size_t count)
+{
+	struct util_cq *cq = container_of(cq_fid, struct util_cq, cq_fid);
+	struct util_cq_aux_entry *aux_entry;
+	struct fi_cq_tagged_entry *entry;
+	size_t i, index;
+	ssize_t ret;
+
+	/* A zero count read drives progress through the provider's read */
+	ret = fi_cq_read(cq_fid, NULL, 0);
+	if (ret && ret != -FI_EAGAIN)
+		return ret;
+
+	if (!count)
+		return 0;
+
+	ofi_genlock_lock(&cq->cq_lock);
+	if (cq->borrowed) {
+		ret = -FI_EBUSY;
+		goto unlock;
+	}
+
+	if (ofi_cirque_isempty(cq->cirq)) {
+		ret = -FI_EAGAIN;
+		goto unlock;
+	}
+
+	entry = ofi_cirque_head(cq->cirq);
+	if (entry->flags & UTIL_FLAG_AUX) {
+		assert(!slist_empty(&cq->aux_queue));
+		aux_entry = container_of(cq->aux_queue.head,
+					 struct util_cq_aux_entry, list_entry);
+		if (aux_entry->comp.err) {
+			ret = -FI_EAVAIL;
+			goto unlock;
+		}
+
+		cq->borrow_comp.op_context = aux_entry->comp.op_context;
+		cq->borrow_comp.flags = aux_entry->comp.flags;
+		cq->borrow_comp.len = aux_entry->comp.len;
+		cq->borrow_comp.buf = aux_entry->comp.buf;
+		cq->borrow_comp.data = aux_entry->comp.data;
+		cq->borrow_comp.tag = aux_entry->comp.tag;
+		cq->borrow_src = aux_entry->src;
+
+		*comp = &cq->borrow_comp;
+		if (src_addr)
+			*src_addr = cq->src ? &cq->borrow_src : NULL;
+		ret = 1;
+	} else {
+		index = ofi_cirque_rindex(cq->cirq);
+		count = MIN(count, ofi_cirque_usedcnt(cq->cirq));
+		count = MIN(count, cq->cirq->size - index);
+		for (i = 1; i < count; i++) {
+			if (cq->cirq->buf[index + i].flags & UTIL_FLAG_AUX)
+				break;
+		}
+
+		*comp = entry;
+		if (src_addr)
+			*src_addr = cq->src ? &cq->src[index] : NULL;
+		ret = i;
+	}
+	cq->borrowed = ret;
+unlock:
+	ofi_genlock_unlock(&cq->cq_lock);
+	return ret;
+}
+
+/* Consumes the first count borrowed entries and returns the rest */
+static int util_cq_release(struct fid_cq *cq_fid, size_t count)
+{
+	struct util_cq *cq = container_of(cq_fid, struct util_cq, cq_fid);
+	int ret = FI_SUCCESS;
+
+	ofi_genlock_lock(&cq->cq_lock);
+	if (count > cq->borrowed) {
+		ret = -FI_EINVAL;
+		goto unlock;
+	}
+
+	if (!count)
+		goto out;
+
+	if (ofi_cirque_head(cq->cirq)->flags & UTIL_FLAG_AUX) {
+		assert(count == 1);
+		util_cq_remove_aux(cq);
+	} else {
+		ofi_cirque_discard_cnt(cq->cirq, count);
+	}
+out:
+	cq->borrowed = 0;
+unlock:
+	ofi_genlock_unlock(&cq->cq_lock);
+	return ret;
+}
+
+static struct fi_ops_cq_borrow util_cq_borrow_ops = {
+	.size = sizeof(struct fi_ops_cq_borrow),
+	.borrow = util_cq_borrow,
+	.release = util_cq_release,
+};
+
+static void util_cq_free_shards(struct util_cq *cq)
+{
+	size_t i;
+
+	for (i = 0; i < cq->shard_cnt; i++)
+		ofi_freealign(cq->shards[i].queue);
+	free(cq->shards);
+	cq->shards = NULL;
+	cq->shard_cnt = 0;
+}
+
+static int util_cq_init_shards(struct util_cq *cq, size_t cnt)
+{
+	struct util_cq_shardq *queue;
+	size_t size, qsize;
+	int ret;
+
+	cq->shards = calloc(cnt, sizeof(*cq->shards));
+	if (!cq->shards)
+		return -FI_ENOMEM;
+
+	/* The atomic queue must be cache line aligned */
+	size = roundup_power_of_two(cq->cirq->size);
+	qsize = sizeof(*queue) + sizeof(struct util_cq_shardq_entry) * size;
+	for (cq->shard_cnt = 0; cq->shard_cnt < cnt; cq->shard_cnt++) {
+		ret = ofi_memalign((void **) &queue, OFI_CACHE_LINE_SIZE,
+				   qsize);
+		if (ret) {
+			util_cq_free_shards(cq);
+			return -FI_ENOMEM;
+		}
+
+		memset(queue, 0, qsize);
+		util_cq_shardq_init(queue, size);
+		cq->shards[cq->shard_cnt].queue = queue;
+		ofi_atomic_initialize32(&cq->shards[cq->shard_cnt].overflow, 0);
+	}
+
+	FI_INFO(cq->domain->prov, FI_LOG_CQ, "using %zu completion shards\n",
+		cq->shard_cnt);
+	return 0;
+}
+
 static void util_peer_cq_cleanup(struct util_cq *cq)
 {
 	struct util_cq_aux_entry *err;
@@ -423,6 +806,7 @@ static void util_peer_cq_cleanup(struct util_cq *cq)
 		free(err);
 	}
 
+	util_cq_free_shards(cq);
 	util_comp_cirq_free(cq->cirq);
 	free(cq->src);
 	fi_close(&cq->peer_cq->fid);
@@ -470,6 +854,21 @@ int ofi_cq_control(struct fid *fid, int command, void *arg)
 	}
 }
 
+int ofi_cq_ops_open(struct fid *fid, const char *name, uint64_t flags,
+		    void **ops, void *context)
+{
+	struct util_cq *cq = container_of(fid, struct util_cq, cq_fid.fid);
+
+	/* Sharded completions are not stored contiguously */
+	if (!strcasecmp(name, FI_CQ_BORROW_OPS) &&
+	    !(cq->flags & FI_PEER) && !cq->shards) {
+		*ops = &util_cq_borrow_ops;
+		return FI_SUCCESS;
+	}
+
+	return -FI_ENOSYS;
+}
+
 static int util_cq_close(struct fid *fid)
 {
 	struct util_cq *cq;
@@ -489,7 +888,7 @@ static struct fi_ops util_cq_fi_ops = {
 	.close = util_cq_close,
 	.bind = fi_no_bind,
 	.control = ofi_cq_control,
-	.ops_open = fi_no_ops_open,
+	.ops_open = ofi_cq_ops_open,
 };
 
 int ofi_check_bind_cq_flags(struct util_ep *ep, struct util_cq *cq,
@@ -538,6 +937,12 @@ static ssize_t util_peer_cq_write(struct fid_peer_cq *cq, void *context,
 
 	util_cq = cq->fid.context;
 
+	if (util_cq->shards) {
+		ret = ofi_cq_write_shard(util_cq, context, flags, len, buf,
+					 data, tag, FI_ADDR_NOTAVAIL);
+		goto signal;
+	}
+
 	ofi_genlock_lock(&util_cq->cq_lock);
 	if (ofi_cirque_freecnt(util_cq->cirq) > 1) {
 		ofi_cq_write_entry(util_cq, context, flags, len, buf, data,
@@ -549,8 +954,10 @@ static ssize_t util_peer_cq_write(struct fid_peer_cq *cq, void *context,
 	}
 	ofi_genlock_unlock(&util_cq->cq_lock);
 
+signal:
+
 	if (util_cq->wait)
-		util_cq->wait->signal(util_cq->wait);
+		util_cq_signal(util_cq);
 
 	return ret;
 }
@@ -562,6 +969,12 @@ static ssize_t util_peer_cq_write_src(struct fid_peer_cq *cq, void *context,
 	struct util_cq *util_cq = cq->fid.context;
 	int ret;
 
+	if (util_cq->shards) {
+		ret = ofi_cq_write_shard(util_cq, context, flags, len, buf,
+					 data, tag, src);
+		goto signal;
+	}
+
 	ofi_genlock_lock(&util_cq->cq_lock);
 	if (ofi_cirque_freecnt(util_cq->cirq) > 1) {
 		ofi_cq_write_src_entry(util_cq, context, flags, len, buf, data,
@@ -573,8 +986,10 @@ static ssize_t util_peer_cq_write_src(struct fid_peer_cq *cq, void *context,
 	}
 	ofi_genlock_unlock(&util_cq->cq_lock);
 
+signal:
+
 	if (util_cq->wait)
-		util_cq->wait->signal(util_cq->wait);
+		util_cq_signal(util_cq);
 
 	return ret;
 }
@@ -590,7 +1005,7 @@ static ssize_t util_peer_cq_writeerr(struct fid_peer_cq *cq,
 	ofi_genlock_unlock(&util_cq->cq_lock);
 
 	if (util_cq->wait)
-		util_cq->wait->signal(util_cq->wait);
+		util_cq_signal(util_cq);
 
 	return ret;
 }
@@ -644,7 +1059,8 @@ static struct fi_ops util_peer_cq_fi_ops = {
 	.ops_open = fi_no_ops_open,
 };
 
-static int util_init_peer_cq(struct util_cq *cq, struct fi_cq_attr *attr)
+static int util_init_peer_cq(struct util_cq *cq, struct fi_cq_attr *attr,
+			     size_t shard_cnt)
 {
 	int ret;
 
@@ -692,6 +1108,19 @@ static int util_init_peer_cq(struct util_cq *cq, struct fi_cq_attr *attr)
 		cq->peer_cq->owner_ops = &util_peer_cq_owner_ops;
 	}
 
+	/* Sharding only pays off if the cirq would otherwise be locked */
+	if (!shard_cnt && cq->cq_lock.lock_type != OFI_LOCK_NOOP)
+		shard_cnt = ofi_cq_shards;
+
+	if (shard_cnt) {
+		ret = util_cq_init_shards(cq, shard_cnt);
+		if (ret) {
+			free(cq->src);
+			util_comp_cirq_free(cq->cirq);
+			goto free;
+		}
+	}
+
 	cq->peer_cq->fid.fclass = FI_CLASS_PEER_CQ;
 	cq->peer_cq->fid.context = cq;
 	cq->peer_cq->fid.ops = &util_peer_cq_fi_ops;
@@ -702,9 +1131,10 @@ free:
 	return ret;
 }
 
-int ofi_cq_init(const struct fi_provider *prov, struct fid_domain *domain,
-		 struct fi_cq_attr *attr, struct util_cq *cq,
-		 ofi_cq_progress_func progress, void *context)
+static int util_cq_init(const struct fi_provider *prov,
+			struct fid_domain *domain, struct fi_cq_attr *attr,
+			struct util_cq *cq, ofi_cq_progress_func progress,
+			size_t shard_cnt, void *context)
 {
 	struct fi_wait_attr wait_attr;
 	struct fid_wait *wait;
@@ -721,10 +1151,18 @@ int ofi_cq_init(const struct fi_provider *prov, struct fid_domain *domain,
 	cq->cq_fid.ops = &util_cq_ops;
 	cq->progress = progress;
 	cq->err_data = NULL;
+	cq->borrowed = 0;
+	cq->thread_shards = shard_cnt > 0;
 
 	cq->domain = container_of(domain, struct util_domain, domain_fid);
 	ofi_atomic_initialize32(&cq->ref, 0);
 	ofi_atomic_initialize32(&cq->wakeup, 0);
+	cq->spin.avg_ns = 0;
+	cq->wait_cond = (attr->wait_obj == FI_WAIT_NONE ||
+			 attr->flags & FI_PEER) ?
+			FI_CQ_COND_NONE : attr->wait_cond;
+	ofi_atomic_initialize32(&cq->wait_threshold, 0);
+	cq->threshold_waiters = 0;
 	dlist_init(&cq->ep_list);
 
 	if (cq->domain->threading == FI_THREAD_COMPLETION ||
@@ -733,6 +1171,11 @@ int ofi_cq_init(const struct fi_provider *prov, struct fid_domain *domain,
 	else
 		cq_lock_type = cq->domain->lock.lock_type;
 
+	/* Provider threads still write errors and overflow to the cirq */
+	if (shard_cnt && (cq_lock_type == OFI_LOCK_NOOP ||
+			  cq_lock_type == OFI_LOCK_NONE))
+		cq_lock_type = OFI_LOCK_MUTEX;
+
 	ret = ofi_genlock_init(&cq->cq_lock, cq_lock_type);
 	if (ret)
 		return ret;
@@ -751,7 +1194,7 @@ int ofi_cq_init(const struct fi_provider *prov, struct fid_domain *domain,
 		cq->peer_cq = ((struct fi_peer_cq_context *) context)->cq;
 		cq->cq_fid.ops = &util_peer_cq_ops;
 	} else {
-		ret = util_init_peer_cq(cq, attr);
+		ret = util_init_peer_cq(cq, attr, shard_cnt);
 		if (ret)
 			goto destroy2;
 	}
@@ -806,6 +1249,31 @@ destroy1:
 	return ret;
 }
 
+int ofi_cq_init(const struct fi_provider *prov, struct fid_domain *domain,
+		 struct fi_cq_attr *attr, struct util_cq *cq,
+		 ofi_cq_progress_func progress, void *context)
+{
+	return util_cq_init(prov, domain, attr, cq, progress, 0, context);
+}
+
+/*
+ * For providers that write completions from several internal threads,
+ * independent from the threading model requested by the app.  Each of
+ * those threads should select one of the shard_cnt shards through
+ * ofi_cq_set_thread_shard(), leaving shard 0 to the app threads.
+ */
+int ofi_cq_init_sharded(const struct fi_provider *prov,
+			struct fid_domain *domain, struct fi_cq_attr *attr,
+			struct util_cq *cq, ofi_cq_progress_func progress,
+			size_t shard_cnt, void *context)
+{
+	if (attr->flags & FI_PEER)
+		return -FI_ENOSYS;
+
+	return util_cq_init(prov, domain, attr, cq, progress, shard_cnt,
+			    context);
+}
+
 uint64_t ofi_rx_flags[] = {
 	[ofi_op_msg] = FI_MSG | FI_RECV,
 	[ofi_op_tagged] = FI_RECV | FI_TAGGED,
@@ -86,6 +86,7 @@ int ofi_domain_close(struct util_domain *domain)
 	ofi_mutex_unlock(&domain->fabric->lock);
 
 	free(domain->name);
+	ofi_mutex_destroy(&domain->trigger_lock);
 	ofi_genlock_destroy(&domain->lock);
 	ofi_atomic_dec32(&domain->fabric->ref);
 	return 0;
@@ -109,6 +110,11 @@ util_domain_init(struct util_domain *domain, const struct fi_info *info,
 	if (ret)
 		return ret;
 
+	ofi_mutex_init(&domain->trigger_lock);
+	dlist_init(&domain->trigger_cntrs);
+	ofi_atomic_initialize32(&domain->trigger_cnt, 0);
+	domain->trigger_busy = false;
+
 	domain->info_domain_caps = info->caps | info->domain_attr->caps;
 	domain->info_domain_mode = info->mode | info->domain_attr->mode;
 	domain->mr_mode = info->domain_attr->mr_mode;
@@ -271,6 +271,8 @@ int ofi_endpoint_close(struct util_ep *util_ep)
 {
 	int i;
 
+	ofi_trigger_ep_cleanup(util_ep);
+
 	if (util_ep->tx_cq) {
 		fid_list_remove2(&util_ep->tx_cq->ep_list,
 				&util_ep->tx_cq->ep_list_lock,
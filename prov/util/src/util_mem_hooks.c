@@ -525,9 +525,7 @@ static int ofi_intercept_symbol(struct ofi_intercept *intercept)
 void ofi_intercept_handler(const void *addr, size_t len)
 {
 	pthread_rwlock_rdlock(&mm_list_rwlock);
-	pthread_mutex_lock(&mm_lock);
-	ofi_monitor_notify(memhooks_monitor, addr, len);
-	pthread_mutex_unlock(&mm_lock);
+	ofi_monitor_queue_notify(memhooks_monitor, addr, len);
 	pthread_rwlock_unlock(&mm_list_rwlock);
 }
 
@@ -148,6 +148,7 @@ void ofi_monitor_init(struct ofi_mem_monitor *monitor)
 {
 	dlist_init(&monitor->list);
 	monitor->state = FI_MM_STATE_IDLE;
+	ofi_atomic_initialize32(&monitor->pending, 0);
 }
 
 void ofi_monitor_cleanup(struct ofi_mem_monitor *monitor)
@@ -268,6 +269,41 @@ void ofi_monitors_init(void)
 #endif
 			" is the default if available on the system. 'disabled'"
 			" option disables memory caching.");
+	fi_param_define(NULL, "mr_cache_notify_queue", FI_PARAM_SIZE_T,
+			"Number of memory invalidations that the memhooks and"
+			" userfaultfd monitors may queue to each MR cache."
+			" Queued invalidations are coalesced and applied when"
+			" the cache is next searched or flushed, instead of"
+			" locking the cache for each unmapped region.  The"
+			" monitor falls back to locking the cache when the"
+			" queue is full.  (default: 0, disabled)");
+	fi_param_define(NULL, "mr_cache_granularity", FI_PARAM_SIZE_T,
+			"Round the address range of system memory registrations"
+			" made by the MR cache out to a multiple of this size,"
+			" so that later registrations of nearby buffers hit the"
+			" cache.  (default: 0, disabled)");
+	fi_param_define(NULL, "mr_cache_merge_max", FI_PARAM_SIZE_T,
+			"Merge a new system memory registration with the cached"
+			" regions that it overlaps or adjoins, as long as the"
+			" merged region does not exceed this size.  The merged"
+			" regions are replaced by a single registration."
+			"  (default: 0, disabled)");
+	fi_param_define(NULL, "mr_cache_prefetch", FI_PARAM_BOOL,
+			"When a cache miss continues the range of the previous"
+			" miss, extend the new registration past the requested"
+			" buffer by the length of the sequential run, up to"
+			" 4 MiB, in anticipation of sequential access."
+			"  (default: false)");
+	fi_param_define(NULL, "mr_cache_policy", FI_PARAM_STRING,
+			"Policy used to evict idle registrations when the cache"
+			" is full: lru, slru (LRU per size class, weighted by"
+			" the cost model) or 2q (entries that were never reused"
+			" are evicted first).  (default: lru)");
+	fi_param_define(NULL, "mr_cache_reg_cost", FI_PARAM_SIZE_T,
+			"Fixed cost of a registration, in pages, used by the"
+			" slru and 2q policies.  The cost of re-registering an"
+			" entry is this value plus the number of pages that it"
+			" spans.  (default: 16)");
 	fi_param_define(NULL, "mr_cuda_cache_monitor_enabled", FI_PARAM_BOOL,
 			"Enable or disable the CUDA cache memory monitor."
 			"Enabled by default.");
@@ -281,6 +317,15 @@ void ofi_monitors_init(void)
 	fi_param_get_size_t(NULL, "mr_cache_max_size", &cache_params.max_size);
 	fi_param_get_size_t(NULL, "mr_cache_max_count", &cache_params.max_cnt);
 	fi_param_get_str(NULL, "mr_cache_monitor", &cache_params.monitor);
+	fi_param_get_size_t(NULL, "mr_cache_notify_queue",
+			    &cache_params.notify_queue_size);
+	fi_param_get_size_t(NULL, "mr_cache_granularity",
+			    &cache_params.granularity);
+	fi_param_get_size_t(NULL, "mr_cache_merge_max",
+			    &cache_params.merge_max);
+	fi_param_get_bool(NULL, "mr_cache_prefetch", &cache_params.prefetch);
+	fi_param_get_str(NULL, "mr_cache_policy", &cache_params.policy);
+	fi_param_get_size_t(NULL, "mr_cache_reg_cost", &cache_params.reg_cost);
 	fi_param_get_bool(NULL, "mr_cuda_cache_monitor_enabled",
 			  &cache_params.cuda_monitor_enabled);
 	fi_param_get_bool(NULL, "mr_rocr_cache_monitor_enabled",
@@ -485,6 +530,40 @@ void ofi_monitor_notify(struct ofi_mem_monitor *monitor,
 	}
 }
 
+/* Queue an invalidation to the caches of the monitor.  Caches that do
+ * not queue invalidations, or whose queue is full, are notified directly.
+ * The pending count covers the time between reserving and committing a
+ * queue slot.  A cache that applied its queue meanwhile would stop at the
+ * reserved slot and miss the ranges committed behind it.
+ * Must be called with locks in place like following
+ *	pthread_rwlock_rdlock(&mm_list_rwlock);
+ *	ofi_monitor_queue_notify();
+ *	pthread_rwlock_unlock(&mm_list_rwlock);
+ */
+void ofi_monitor_queue_notify(struct ofi_mem_monitor *monitor,
+			      const void *addr, size_t len)
+{
+	struct ofi_mr_cache *cache;
+	bool locked = false;
+
+	ofi_atomic_inc32(&monitor->pending);
+	dlist_foreach_container(&monitor->list, struct ofi_mr_cache,
+				cache, notify_entries[monitor->iface]) {
+		if (ofi_mr_cache_queue_notify(cache, addr, len))
+			continue;
+
+		if (!locked) {
+			pthread_mutex_lock(&mm_lock);
+			locked = true;
+		}
+		ofi_mr_cache_notify(cache, addr, len);
+	}
+
+	if (locked)
+		pthread_mutex_unlock(&mm_lock);
+	ofi_atomic_dec32(&monitor->pending);
+}
+
 /* Must be called with locks in place like following
  *	pthread_rwlock_rdlock(&mm_list_rwlock);
  *	pthread_mutex_lock(&mm_lock);
@@ -42,6 +42,16 @@
 #include <ofi_list.h>
 #include <ofi_tree.h>
 #include <ofi_enosys.h>
+#include <ofi_atomic_queue.h>
+
+/* Number of queued invalidations that are coalesced at once */
+#define OFI_MR_NOTIFY_BATCH 64
+#define OFI_MR_PREFETCH_MAX (4 * 1024 * 1024)
+
+OFI_DECLARE_ATOMIC_Q(struct iovec, ofi_mr_notifyq);
+
+/* All initialized caches, protected by mm_lock */
+static DEFINE_LIST(ofi_mr_cache_list);
 
 
 struct ofi_mr_cache_params cache_params = {
@@ -49,6 +59,7 @@ struct ofi_mr_cache_params cache_params = {
 	.cuda_monitor_enabled = true,
 	.rocr_monitor_enabled = true,
 	.ze_monitor_enabled = true,
+	.reg_cost = 16,
 };
 
 static int util_mr_find_within(struct ofi_rbmap *map, void *key, void *data)
@@ -141,13 +152,192 @@ static void util_mr_uncache_entry_storage(struct ofi_mr_cache *cache,
 	cache->cached_size -= entry->info.iov.iov_len;
 }
 
+/*
+ * Eviction policies track idle cached entries (use_cnt == 0).  Callers
+ * must hold mm_lock.  insert() is called when an entry becomes idle,
+ * remove() when it is reused or uncached, and victim() returns the next
+ * idle entry to evict, or NULL if there are none.
+ */
+struct util_mr_evict_ops {
+	const char *name;
+	void (*insert)(struct ofi_mr_cache *cache, struct ofi_mr_entry *entry);
+	void (*remove)(struct ofi_mr_cache *cache, struct ofi_mr_entry *entry);
+	struct ofi_mr_entry *(*victim)(struct ofi_mr_cache *cache);
+};
+
+static void util_mr_lru_insert(struct ofi_mr_cache *cache,
+			       struct ofi_mr_entry *entry)
+{
+	dlist_insert_tail(&entry->list_entry, &cache->lru_list);
+}
+
+static void util_mr_lru_remove(struct ofi_mr_cache *cache,
+			       struct ofi_mr_entry *entry)
+{
+	dlist_remove_init(&entry->list_entry);
+}
+
+static struct ofi_mr_entry *util_mr_lru_victim(struct ofi_mr_cache *cache)
+{
+	if (dlist_empty(&cache->lru_list))
+		return NULL;
+
+	return container_of(cache->lru_list.next, struct ofi_mr_entry,
+			    list_entry);
+}
+
+static void util_mr_seg_insert(struct ofi_mr_cache *cache,
+			       struct ofi_mr_entry *entry, uint8_t seg)
+{
+	entry->seg = seg;
+	entry->idle_tick = cache->idle_tick++;
+	dlist_insert_tail(&entry->list_entry, &cache->seg_list[seg]);
+	cache->seg_cnt[seg]++;
+	cache->seg_size[seg] += entry->info.iov.iov_len;
+}
+
+static void util_mr_seg_remove(struct ofi_mr_cache *cache,
+			       struct ofi_mr_entry *entry)
+{
+	dlist_remove_init(&entry->list_entry);
+	cache->seg_cnt[entry->seg]--;
+	cache->seg_size[entry->seg] -= entry->info.iov.iov_len;
+}
+
+static struct ofi_mr_entry *
+util_mr_seg_head(struct ofi_mr_cache *cache, uint8_t seg)
+{
+	if (dlist_empty(&cache->seg_list[seg]))
+		return NULL;
+
+	return container_of(cache->seg_list[seg].next, struct ofi_mr_entry,
+			    list_entry);
+}
+
+/*
+ * Cost model: re-registering a region costs a fixed amount, expressed in
+ * pages by FI_MR_CACHE_REG_COST, plus the number of pages to pin.  Keeping
+ * an idle entry is worth its registration cost per byte of cache that it
+ * occupies, so the entry to evict is the one with the largest
+ * age * size / cost.  Small entries are cheap to keep and are evicted
+ * later than large entries of the same age.
+ */
+static double util_mr_evict_score(struct ofi_mr_cache *cache,
+				  struct ofi_mr_entry *entry)
+{
+	size_t pages = ofi_div_ceil(entry->info.iov.iov_len,
+				    page_sizes[OFI_PAGE_SIZE]);
+
+	return (double) (cache->idle_tick - entry->idle_tick) * pages /
+	       (cache_params.reg_cost + pages);
+}
+
+/* Size classes of 64 KiB, 1 MiB, 16 MiB and larger */
+static void util_mr_slru_insert(struct ofi_mr_cache *cache,
+				struct ofi_mr_entry *entry)
+{
+	size_t len = entry->info.iov.iov_len;
+	uint8_t seg;
+
+	for (seg = 0; seg < OFI_MR_CACHE_SEGS - 1; seg++) {
+		if (len <= (size_t) 1 << (16 + 4 * seg))
+			break;
+	}
+	util_mr_seg_insert(cache, entry, seg);
+}
+
+static struct ofi_mr_entry *util_mr_slru_victim(struct ofi_mr_cache *cache)
+{
+	struct ofi_mr_entry *entry, *victim = NULL;
+	double score, max_score = -1;
+	uint8_t seg;
+
+	for (seg = 0; seg < OFI_MR_CACHE_SEGS; seg++) {
+		entry = util_mr_seg_head(cache, seg);
+		if (!entry)
+			continue;
+
+		score = util_mr_evict_score(cache, entry);
+		if (score > max_score) {
+			max_score = score;
+			victim = entry;
+		}
+	}
+	return victim;
+}
+
+enum {
+	UTIL_MR_2Q_PROBATION,
+	UTIL_MR_2Q_PROTECTED,
+};
+
+static void util_mr_2q_insert(struct ofi_mr_cache *cache,
+			      struct ofi_mr_entry *entry)
+{
+	util_mr_seg_insert(cache, entry, entry->reused ?
+			   UTIL_MR_2Q_PROTECTED : UTIL_MR_2Q_PROBATION);
+}
+
+/*
+ * Entries on probation are evicted first while they hold over a quarter
+ * of the cache limits.  Below that, the probation and protected heads
+ * are compared using the cost model.
+ */
+static struct ofi_mr_entry *util_mr_2q_victim(struct ofi_mr_cache *cache)
+{
+	struct ofi_mr_entry *probation, *protected;
+
+	probation = util_mr_seg_head(cache, UTIL_MR_2Q_PROBATION);
+	protected = util_mr_seg_head(cache, UTIL_MR_2Q_PROTECTED);
+	if (!probation || !protected)
+		return probation ? probation : protected;
+
+	if (cache->seg_cnt[UTIL_MR_2Q_PROBATION] >= cache->cached_max_cnt / 4 ||
+	    cache->seg_size[UTIL_MR_2Q_PROBATION] >= cache->cached_max_size / 4)
+		return probation;
+
+	return util_mr_evict_score(cache, probation) >=
+	       util_mr_evict_score(cache, protected) ? probation : protected;
+}
+
+static const struct util_mr_evict_ops util_mr_evict_ops[] = {
+	[OFI_MR_POLICY_LRU] = {
+		.name = "lru",
+		.insert = util_mr_lru_insert,
+		.remove = util_mr_lru_remove,
+		.victim = util_mr_lru_victim,
+	},
+	[OFI_MR_POLICY_SLRU] = {
+		.name = "slru",
+		.insert = util_mr_slru_insert,
+		.remove = util_mr_seg_remove,
+		.victim = util_mr_slru_victim,
+	},
+	[OFI_MR_POLICY_2Q] = {
+		.name = "2q",
+		.insert = util_mr_2q_insert,
+		.remove = util_mr_seg_remove,
+		.victim = util_mr_2q_victim,
+	},
+};
+
+/* Reuse of a cached entry.  Caller must hold mm_lock. */
+static void util_mr_cache_hit(struct ofi_mr_cache *cache,
+			      struct ofi_mr_entry *entry)
+{
+	cache->hit_cnt++;
+	entry->reused = 1;
+	if (entry->use_cnt++ == 0)
+		util_mr_evict_ops[cache->policy].remove(cache, entry);
+}
+
 static void util_mr_uncache_entry(struct ofi_mr_cache *cache,
 				  struct ofi_mr_entry *entry)
 {
 	util_mr_uncache_entry_storage(cache, entry);
 
 	if (entry->use_cnt == 0) {
-		dlist_remove(&entry->list_entry);
+		util_mr_evict_ops[cache->policy].remove(cache, entry);
 		dlist_insert_tail(&entry->list_entry, &cache->dead_region_list);
 	} else {
 		cache->uncached_cnt++;
@@ -198,6 +388,89 @@ void ofi_mr_cache_notify(struct ofi_mr_cache *cache, const void *addr, size_t le
 		util_mr_uncache_entry(cache, entry);
 }
 
+/*
+ * Memory monitors may queue invalidations instead of calling
+ * ofi_mr_cache_notify() directly, which avoids taking mm_lock from the
+ * thread unmapping memory.  Returns false if the range could not be
+ * queued, in which case the caller must notify the cache synchronously.
+ */
+bool ofi_mr_cache_queue_notify(struct ofi_mr_cache *cache, const void *addr,
+			       size_t len)
+{
+	struct iovec *iov;
+	int64_t pos;
+
+	if (!cache->notify_queue ||
+	    ofi_mr_notifyq_next(cache->notify_queue, &iov, &pos))
+		return false;
+
+	iov->iov_base = (void *) addr;
+	iov->iov_len = len;
+	ofi_mr_notifyq_commit(iov, pos);
+	return true;
+}
+
+static int util_mr_iov_cmp(const void *a, const void *b)
+{
+	const struct iovec *iov_a = a, *iov_b = b;
+
+	if (iov_a->iov_base < iov_b->iov_base)
+		return -1;
+	return iov_a->iov_base > iov_b->iov_base;
+}
+
+/* Apply queued invalidations.  Caller must hold mm_lock. */
+static void util_mr_cache_process_queue(struct ofi_mr_cache *cache)
+{
+	struct iovec batch[OFI_MR_NOTIFY_BATCH], *iov;
+	size_t i, cnt, merged;
+	int64_t pos;
+
+	if (!cache->notify_queue)
+		return;
+
+	for (i = 0; i < OFI_HMEM_MAX; i++) {
+		while (cache->monitors[i] &&
+		       ofi_atomic_get32(&cache->monitors[i]->pending)) {
+			pthread_mutex_unlock(&mm_lock);
+			sched_yield();
+			pthread_mutex_lock(&mm_lock);
+		}
+	}
+
+	do {
+		for (cnt = 0; cnt < OFI_MR_NOTIFY_BATCH; cnt++) {
+			if (ofi_mr_notifyq_head(cache->notify_queue, &iov, &pos))
+				break;
+			batch[cnt] = *iov;
+			ofi_mr_notifyq_release(cache->notify_queue, iov, pos);
+		}
+		if (!cnt)
+			break;
+
+		/* Coalesce overlapping and adjacent ranges */
+		qsort(batch, cnt, sizeof(*batch), util_mr_iov_cmp);
+		for (i = 1, merged = 0; i < cnt; i++) {
+			if ((char *) batch[i].iov_base <=
+			    (char *) batch[merged].iov_base +
+			    batch[merged].iov_len) {
+				batch[merged].iov_len =
+					MAX((char *) batch[merged].iov_base +
+					    batch[merged].iov_len,
+					    (char *) batch[i].iov_base +
+					    batch[i].iov_len) -
+					(char *) batch[merged].iov_base;
+			} else {
+				batch[++merged] = batch[i];
+			}
+		}
+
+		for (i = 0; i <= merged; i++)
+			ofi_mr_cache_notify(cache, batch[i].iov_base,
+					    batch[i].iov_len);
+	} while (cnt == OFI_MR_NOTIFY_BATCH);
+}
+
 /* Function to remove dead regions and prune MR cache size.
  * Returns true if any entries were flushed from the cache.
  */
@@ -211,14 +484,15 @@ bool ofi_mr_cache_flush(struct ofi_mr_cache *cache, bool flush_lru)
 
 	pthread_mutex_lock(&mm_lock);
 
+	util_mr_cache_process_queue(cache);
 	dlist_splice_tail(&free_list, &cache->dead_region_list);
 
-	while (flush_lru && !dlist_empty(&cache->lru_list)) {
-		dlist_pop_front(&cache->lru_list, struct ofi_mr_entry,
-				entry, list_entry);
-		dlist_init(&entry->list_entry);
+	while (flush_lru &&
+	       (entry = util_mr_evict_ops[cache->policy].victim(cache))) {
+		util_mr_evict_ops[cache->policy].remove(cache, entry);
 		util_mr_uncache_entry_storage(cache, entry);
 		dlist_insert_tail(&entry->list_entry, &free_list);
+		cache->evict_cnt++;
 
 		flush_lru = ofi_mr_cache_full(cache);
 	}
@@ -254,11 +528,89 @@ void ofi_mr_cache_delete(struct ofi_mr_cache *cache, struct ofi_mr_entry *entry)
 			util_mr_free_entry(cache, entry);
 			return;
 		}
-		dlist_insert_tail(&entry->list_entry, &cache->lru_list);
+		util_mr_evict_ops[cache->policy].insert(cache, entry);
 	}
 	pthread_mutex_unlock(&mm_lock);
 }
 
+/*
+ * Widen the registration made on a miss for system memory, so that later
+ * searches of nearby regions hit.  The range is rounded out to the cache
+ * granularity, extended by a window if it continues or closely follows the
+ * previous miss, and merged with the cached regions that it overlaps or
+ * touches.  Merged regions are removed from the cache.  Returns true if the
+ * range changed.
+ * Caller must hold mm_lock.
+ */
+static bool util_mr_cache_expand(struct ofi_mr_cache *cache,
+				 struct ofi_mr_info *info)
+{
+	size_t gran = cache_params.granularity;
+	struct ofi_mr_entry *cur;
+	uintptr_t base, end, cur_base, cur_end;
+	struct iovec iov;
+	size_t window;
+
+	if (info->iface != FI_HMEM_SYSTEM || info->peer_id ||
+	    !info->iov.iov_len)
+		return false;
+
+	base = (uintptr_t) info->iov.iov_base;
+	end = base + info->iov.iov_len;
+
+	if (cache_params.prefetch && cache->last_miss_end &&
+	    base >= cache->last_miss_base &&
+	    (base <= cache->last_miss_end ||
+	     base - cache->last_miss_end <= info->iov.iov_len) &&
+	    end > cache->last_miss_end) {
+		/* Grow the window with the length of the sequential run */
+		window = MAX(cache->last_miss_end - cache->last_miss_base,
+			     MAX(gran, info->iov.iov_len));
+		window = MIN(window, MAX(OFI_MR_PREFETCH_MAX,
+					 info->iov.iov_len));
+		if (end <= UINTPTR_MAX - window) {
+			end += window;
+			cache->prefetch_cnt++;
+		}
+	}
+
+	if (gran && end <= UINTPTR_MAX - gran) {
+		base -= base % gran;
+		end = ((end + gran - 1) / gran) * gran;
+	}
+
+	while (cache_params.merge_max) {
+		iov.iov_base = (void *) (base ? base - 1 : base);
+		iov.iov_len = end - (uintptr_t) iov.iov_base +
+			      (end < UINTPTR_MAX);
+		cur = ofi_mr_rbt_overlap(&cache->tree, &iov);
+		if (!cur)
+			break;
+
+		cur_base = (uintptr_t) cur->info.iov.iov_base;
+		cur_end = cur_base + cur->info.iov.iov_len;
+		if (cur_base < base || cur_end > end) {
+			if (MAX(end, cur_end) - MIN(base, cur_base) >
+			    cache_params.merge_max)
+				break;
+			base = MIN(base, cur_base);
+			end = MAX(end, cur_end);
+			cache->merge_cnt++;
+		}
+		util_mr_uncache_entry(cache, cur);
+	}
+
+	cache->last_miss_base = base;
+	cache->last_miss_end = end;
+	if (base == (uintptr_t) info->iov.iov_base &&
+	    end - base == info->iov.iov_len)
+		return false;
+
+	info->iov.iov_base = (void *) base;
+	info->iov.iov_len = end - base;
+	return true;
+}
+
 /*
  * We cannot hold the monitor lock when allocating and registering the
  * mr_entry without creating a potential deadlock situation with the
@@ -289,6 +641,7 @@ util_mr_cache_create(struct ofi_mr_cache *cache, struct ofi_mr_info *info,
 	(*entry)->node = NULL;
 	(*entry)->info = *info;
 	(*entry)->use_cnt = 1;
+	(*entry)->reused = 0;
 
 	ret = cache->add_region(cache, *entry);
 	if (ret)
@@ -342,7 +695,8 @@ int ofi_mr_cache_search(struct ofi_mr_cache *cache, struct ofi_mr_info *info,
 			struct ofi_mr_entry **entry)
 {
 	struct ofi_mem_monitor *monitor;
-	bool flush_lru;
+	struct ofi_mr_info req;
+	bool flush_lru, expand = true, expanded;
 	int ret;
 
 	monitor = cache->monitors[info->iface];
@@ -357,7 +711,10 @@ int ofi_mr_cache_search(struct ofi_mr_cache *cache, struct ofi_mr_info *info,
 	       info->iov.iov_base, info->iov.iov_len);
 
 	do {
+		/* Widen a copy, leaving the caller's range unchanged */
+		req = *info;
 		pthread_mutex_lock(&mm_lock);
+		util_mr_cache_process_queue(cache);
 		flush_lru = ofi_mr_cache_full(cache);
 		if (flush_lru || !dlist_empty(&cache->dead_region_list)) {
 			pthread_mutex_unlock(&mm_lock);
@@ -366,22 +723,43 @@ int ofi_mr_cache_search(struct ofi_mr_cache *cache, struct ofi_mr_info *info,
 		}
 
 		cache->search_cnt++;
-		*entry = ofi_mr_rbt_find(&cache->tree, info);
+		*entry = ofi_mr_rbt_find(&cache->tree, &req);
 
 		if (*entry &&
-		    ofi_iov_within(&info->iov, &(*entry)->info.iov) &&
-		    monitor->valid(monitor, info, *entry))
+		    ofi_iov_within(&req.iov, &(*entry)->info.iov) &&
+		    monitor->valid(monitor, &req, *entry))
 			goto hit;
 
 		/* Purge regions that overlap with new region */
 		while (*entry) {
 			util_mr_uncache_entry(cache, *entry);
-			*entry = ofi_mr_rbt_find(&cache->tree, info);
+			*entry = ofi_mr_rbt_find(&cache->tree, &req);
 		}
+
+		/* The widened range can overlap regions that were too large
+		 * to merge.  Purge them too, or creating the entry would
+		 * conflict with them on every retry.
+		 */
+		expanded = expand && util_mr_cache_expand(cache, &req);
+		while (expanded &&
+		       (*entry = ofi_mr_rbt_find(&cache->tree, &req)))
+			util_mr_uncache_entry(cache, *entry);
 		pthread_mutex_unlock(&mm_lock);
 
-		ret = util_mr_cache_create(cache, info, entry);
-		if (ret && ret != -FI_EAGAIN) {
+		ret = util_mr_cache_create(cache, &req, entry);
+		if (ret && expanded) {
+			/* The widened range may not be mapped, or may keep
+			 * racing with other threads; register only the
+			 * requested range.
+			 */
+			if (ret != -FI_EAGAIN) {
+				pthread_mutex_lock(&mm_lock);
+				cache->last_miss_end = 0;
+				pthread_mutex_unlock(&mm_lock);
+			}
+			expand = false;
+			ret = -FI_EAGAIN;
+		} else if (ret && ret != -FI_EAGAIN) {
 			if (ofi_mr_cache_flush(cache, true))
 				ret = -FI_EAGAIN;
 		}
@@ -390,9 +768,7 @@ int ofi_mr_cache_search(struct ofi_mr_cache *cache, struct ofi_mr_info *info,
 	return ret;
 
 hit:
-	cache->hit_cnt++;
-	if ((*entry)->use_cnt++ == 0)
-		dlist_remove_init(&(*entry)->list_entry);
+	util_mr_cache_hit(cache, *entry);
 	pthread_mutex_unlock(&mm_lock);
 	return 0;
 }
@@ -411,6 +787,7 @@ struct ofi_mr_entry *ofi_mr_cache_find(struct ofi_mr_cache *cache,
 
 	pthread_mutex_lock(&mm_lock);
 
+	util_mr_cache_process_queue(cache);
 	if (!dlist_empty(&cache->dead_region_list)) {
 		pthread_mutex_unlock(&mm_lock);
 		ofi_mr_cache_flush(cache, false);
@@ -430,9 +807,7 @@ struct ofi_mr_entry *ofi_mr_cache_find(struct ofi_mr_cache *cache,
 
 	if (ofi_iov_within(attr->mr_iov, &entry->info.iov) &&
 	    monitor->valid(monitor, entry->info.iov.iov_base, entry)) {
-		cache->hit_cnt++;
-		if ((entry)->use_cnt++ == 0)
-			dlist_remove_init(&(entry)->list_entry);
+		util_mr_cache_hit(cache, entry);
 	} else {
 		while (entry) {
 			util_mr_uncache_entry(cache, entry);
@@ -489,9 +864,15 @@ void ofi_mr_cache_cleanup(struct ofi_mr_cache *cache)
 		return;
 
 	FI_INFO(cache->prov, FI_LOG_MR, "MR cache stats: "
-		"searches %zu, deletes %zu, hits %zu notify %zu\n",
+		"searches %zu, deletes %zu, hits %zu notify %zu "
+		"merges %zu prefetches %zu evictions %zu\n",
 		cache->search_cnt, cache->delete_cnt, cache->hit_cnt,
-		cache->notify_cnt);
+		cache->notify_cnt, cache->merge_cnt, cache->prefetch_cnt,
+		cache->evict_cnt);
+
+	pthread_mutex_lock(&mm_lock);
+	dlist_remove(&cache->cache_entry);
+	pthread_mutex_unlock(&mm_lock);
 
 	while (ofi_mr_cache_flush(cache, true))
 		;
@@ -502,18 +883,63 @@ void ofi_mr_cache_cleanup(struct ofi_mr_cache *cache)
 	if (cache->domain)
 		ofi_atomic_dec32(&cache->domain->ref);
 	ofi_bufpool_destroy(cache->entry_pool);
+	ofi_freealign(cache->notify_queue);
+	cache->notify_queue = NULL;
 	assert(cache->cached_cnt == 0);
 	assert(cache->cached_size == 0);
 	assert(cache->uncached_cnt == 0);
 	assert(cache->uncached_size == 0);
 }
 
+static int util_mr_cache_init_queue(struct ofi_mr_cache *cache)
+{
+	size_t size, qsize;
+	int ret;
+
+	cache->notify_queue = NULL;
+	if (!cache_params.notify_queue_size)
+		return 0;
+
+	/* The atomic queue must be cache line aligned */
+	size = roundup_power_of_two(cache_params.notify_queue_size);
+	qsize = sizeof(*cache->notify_queue) +
+		sizeof(struct ofi_mr_notifyq_entry) * size;
+	ret = ofi_memalign((void **) &cache->notify_queue, OFI_CACHE_LINE_SIZE,
+			   qsize);
+	if (ret) {
+		cache->notify_queue = NULL;
+		return -FI_ENOMEM;
+	}
+
+	memset(cache->notify_queue, 0, qsize);
+	ofi_mr_notifyq_init(cache->notify_queue, size);
+	return 0;
+}
+
+static enum ofi_mr_cache_policy util_mr_cache_policy(struct ofi_mr_cache *cache)
+{
+	enum ofi_mr_cache_policy policy;
+
+	if (!cache_params.policy)
+		return OFI_MR_POLICY_LRU;
+
+	for (policy = 0; policy < OFI_MR_POLICY_MAX; policy++) {
+		if (!strcasecmp(cache_params.policy,
+				util_mr_evict_ops[policy].name))
+			return policy;
+	}
+
+	FI_WARN(cache->prov, FI_LOG_MR,
+		"unknown MR cache policy %s, using lru\n", cache_params.policy);
+	return OFI_MR_POLICY_LRU;
+}
+
 /* Monitors array must be of size OFI_HMEM_MAX. */
 int ofi_mr_cache_init(struct util_domain *domain,
 		      struct ofi_mem_monitor **monitors,
 		      struct ofi_mr_cache *cache)
 {
-	int ret;
+	int ret, i;
 
 	assert(cache->add_region && cache->delete_region);
 	if (!cache_params.max_cnt || !cache_params.max_size)
@@ -532,6 +958,17 @@ int ofi_mr_cache_init(struct util_domain *domain,
 	cache->delete_cnt = 0;
 	cache->hit_cnt = 0;
 	cache->notify_cnt = 0;
+	cache->merge_cnt = 0;
+	cache->prefetch_cnt = 0;
+	cache->last_miss_base = 0;
+	cache->last_miss_end = 0;
+	cache->evict_cnt = 0;
+	cache->idle_tick = 0;
+	for (i = 0; i < OFI_MR_CACHE_SEGS; i++) {
+		dlist_init(&cache->seg_list[i]);
+		cache->seg_cnt[i] = 0;
+		cache->seg_size[i] = 0;
+	}
 	cache->domain = domain;
 	if (domain) {
 		cache->prov = domain->prov;
@@ -539,8 +976,13 @@ int ofi_mr_cache_init(struct util_domain *domain,
 	} else {
 		cache->prov = (const struct fi_provider *) &core_prov;
 	}
+	cache->policy = util_mr_cache_policy(cache);
 
 	ofi_rbmap_init(&cache->tree, util_mr_find_within);
+	ret = util_mr_cache_init_queue(cache);
+	if (ret)
+		goto destroy;
+
 	ret = ofi_monitors_add_cache(monitors, cache);
 	if (ret)
 		goto destroy;
@@ -552,10 +994,15 @@ int ofi_mr_cache_init(struct util_domain *domain,
 	if (ret)
 		goto del;
 
+	pthread_mutex_lock(&mm_lock);
+	dlist_insert_tail(&cache->cache_entry, &ofi_mr_cache_list);
+	pthread_mutex_unlock(&mm_lock);
 	return 0;
 del:
 	ofi_monitors_del_cache(cache);
 destroy:
+	ofi_freealign(cache->notify_queue);
+	cache->notify_queue = NULL;
 	ofi_rbmap_cleanup(&cache->tree);
 	if (domain) {
 		ofi_atomic_dec32(&cache->domain->ref);
@@ -583,12 +1030,56 @@ static int ofi_bind_cache_fid(struct fid *fid, struct fid *bfid,
 	return ofi_monitor_import(bfid);
 }
 
+static int ofi_mr_cache_stats_query(struct fid *fid,
+				    struct fi_mr_cache_stats *stats)
+{
+	struct ofi_mr_cache *cache;
+
+	memset(stats, 0, sizeof(*stats));
+
+	pthread_mutex_lock(&mm_lock);
+	dlist_foreach_container(&ofi_mr_cache_list, struct ofi_mr_cache,
+				cache, cache_entry) {
+		stats->searches += cache->search_cnt;
+		stats->hits += cache->hit_cnt;
+		stats->merges += cache->merge_cnt;
+		stats->prefetches += cache->prefetch_cnt;
+		stats->notifies += cache->notify_cnt;
+		stats->cached_cnt += cache->cached_cnt;
+		stats->cached_size += cache->cached_size;
+		stats->uncached_cnt += cache->uncached_cnt;
+		stats->uncached_size += cache->uncached_size;
+		stats->evictions += cache->evict_cnt;
+	}
+	pthread_mutex_unlock(&mm_lock);
+	return 0;
+}
+
+static struct fi_ops_mr_cache_stats ofi_mr_cache_stats_ops = {
+	.size = sizeof(struct fi_ops_mr_cache_stats),
+	.query = ofi_mr_cache_stats_query,
+};
+
+static int ofi_ops_open_cache_fid(struct fid *fid, const char *name,
+				  uint64_t flags, void **ops, void *context)
+{
+	if (flags)
+		return -FI_EBADFLAGS;
+
+	if (!strcasecmp(name, FI_MR_CACHE_STATS_OPS)) {
+		*ops = &ofi_mr_cache_stats_ops;
+		return 0;
+	}
+
+	return -FI_ENOSYS;
+}
+
 static struct fi_ops ofi_mr_cache_ops = {
 	.size = sizeof(struct fi_ops),
 	.close = ofi_close_cache_fid,
 	.bind = ofi_bind_cache_fid,
 	.control = fi_no_control,
-	.ops_open = fi_no_ops_open,
+	.ops_open = ofi_ops_open_cache_fid,
 	.tostr = fi_no_tostr,
 	.ops_set = fi_no_ops_set,
 };
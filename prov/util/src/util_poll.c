@@ -93,7 +93,7 @@ static int util_poll_run(struct fid_poll *poll_fid, void **context, int count)
 			cq = container_of(fid_entry->fid, struct util_cq,
 					  cq_fid.fid);
 			ret = fi_cq_read(&cq->cq_fid, NULL, 0);
-			if (ret == 0 || ret == -FI_EAVAIL)
+			if (ret == -FI_EAVAIL || (!ret && ofi_cq_wait_ready(cq)))
 				ret = 1;
 			break;
 		case FI_CLASS_CNTR:
@@ -0,0 +1,765 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Software triggered operations and deferred work.
+ *
+ * Requests are held on the triggering counter in threshold order and are
+ * issued through the regular data transfer calls of the target endpoint
+ * once the counter (successes plus errors) reaches their threshold.
+ * Queues are checked when the application reads or waits on a counter or
+ * reads a CQ of the domain, which is also where util providers progress,
+ * so requests are never issued from within a provider's completion path.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <ofi_util.h>
+
+struct util_trigger {
+	struct dlist_entry	entry;
+	struct util_cntr	*cntr;
+	uint64_t		threshold;
+	struct fi_deferred_work	*work;
+
+	/* Set for operations requested with FI_TRIGGER */
+	struct util_ep		*ep;
+	void			*context;
+	uint64_t		flags;
+	struct fi_deferred_work	local_work;
+	union {
+		struct fi_op_msg		msg;
+		struct fi_op_tagged		tagged;
+		struct fi_op_rma		rma;
+		struct fi_op_atomic		atomic;
+		struct fi_op_fetch_atomic	fetch_atomic;
+		struct fi_op_compare_atomic	compare_atomic;
+	} op;
+	char			data[];
+};
+
+#define UTIL_TRIGGER_SIZE(cnt, type) \
+	ofi_get_aligned_size((cnt) * sizeof(type), sizeof(void *))
+
+static void *util_trigger_copy(char **pos, const void *src, size_t cnt,
+			       size_t size)
+{
+	void *dst;
+
+	if (!src || !cnt)
+		return NULL;
+
+	dst = *pos;
+	memcpy(dst, src, cnt * size);
+	*pos += ofi_get_aligned_size(cnt * size, sizeof(void *));
+	return dst;
+}
+
+static int util_trigger_order(struct dlist_entry *item, const void *arg)
+{
+	const struct util_trigger *trigger;
+
+	trigger = container_of(arg, struct util_trigger, entry);
+	return container_of(item, struct util_trigger, entry)->threshold >
+	       trigger->threshold;
+}
+
+/* Requeued triggers go back ahead of requests with the same threshold */
+static int util_trigger_requeue_order(struct dlist_entry *item,
+				      const void *arg)
+{
+	const struct util_trigger *trigger;
+
+	trigger = container_of(arg, struct util_trigger, entry);
+	return container_of(item, struct util_trigger, entry)->threshold >=
+	       trigger->threshold;
+}
+
+static void util_trigger_insert(struct util_domain *domain,
+				struct util_trigger *trigger, bool requeue)
+{
+	struct util_cntr *cntr = trigger->cntr;
+
+	assert(ofi_mutex_held(&domain->trigger_lock));
+	if (dlist_empty(&cntr->trigger_list))
+		dlist_insert_tail(&cntr->trigger_entry, &domain->trigger_cntrs);
+
+	dlist_insert_order(&cntr->trigger_list, requeue ?
+			   util_trigger_requeue_order : util_trigger_order,
+			   &trigger->entry);
+	ofi_atomic_inc32(&domain->trigger_cnt);
+}
+
+static void util_trigger_remove(struct util_domain *domain,
+				struct util_trigger *trigger)
+{
+	struct util_cntr *cntr = trigger->cntr;
+
+	assert(ofi_mutex_held(&domain->trigger_lock));
+	dlist_remove(&trigger->entry);
+	if (dlist_empty(&cntr->trigger_list))
+		dlist_remove_init(&cntr->trigger_entry);
+	ofi_atomic_dec32(&domain->trigger_cnt);
+}
+
+/* Returns the first queued request whose counter reached its threshold */
+static struct util_trigger *util_trigger_next(struct util_domain *domain)
+{
+	struct util_trigger *trigger;
+	struct util_cntr *cntr;
+	uint64_t value;
+
+	dlist_foreach_container(&domain->trigger_cntrs, struct util_cntr,
+				cntr, trigger_entry) {
+		value = ofi_atomic_get64(&cntr->cnt) +
+			ofi_atomic_get64(&cntr->err);
+		trigger = container_of(cntr->trigger_list.next,
+				       struct util_trigger, entry);
+		if (trigger->threshold <= value) {
+			util_trigger_remove(domain, trigger);
+			return trigger;
+		}
+	}
+	return NULL;
+}
+
+static ssize_t util_trigger_issue(struct fi_deferred_work *work)
+{
+	switch (work->op_type) {
+	case FI_OP_SEND:
+		return fi_sendmsg(work->op.msg->ep, &work->op.msg->msg,
+				  work->op.msg->flags);
+	case FI_OP_RECV:
+		return fi_recvmsg(work->op.msg->ep, &work->op.msg->msg,
+				  work->op.msg->flags);
+	case FI_OP_TSEND:
+		return fi_tsendmsg(work->op.tagged->ep, &work->op.tagged->msg,
+				   work->op.tagged->flags);
+	case FI_OP_TRECV:
+		return fi_trecvmsg(work->op.tagged->ep, &work->op.tagged->msg,
+				   work->op.tagged->flags);
+	case FI_OP_READ:
+		return fi_readmsg(work->op.rma->ep, &work->op.rma->msg,
+				  work->op.rma->flags);
+	case FI_OP_WRITE:
+		return fi_writemsg(work->op.rma->ep, &work->op.rma->msg,
+				   work->op.rma->flags);
+	case FI_OP_ATOMIC:
+		return fi_atomicmsg(work->op.atomic->ep, &work->op.atomic->msg,
+				    work->op.atomic->flags);
+	case FI_OP_FETCH_ATOMIC:
+		return fi_fetch_atomicmsg(work->op.fetch_atomic->ep,
+					  &work->op.fetch_atomic->msg,
+					  work->op.fetch_atomic->fetch.msg_iov,
+					  work->op.fetch_atomic->fetch.desc,
+					  work->op.fetch_atomic->fetch.iov_count,
+					  work->op.fetch_atomic->flags);
+	case FI_OP_COMPARE_ATOMIC:
+		return fi_compare_atomicmsg(work->op.compare_atomic->ep,
+					&work->op.compare_atomic->msg,
+					work->op.compare_atomic->compare.msg_iov,
+					work->op.compare_atomic->compare.desc,
+					work->op.compare_atomic->compare.iov_count,
+					work->op.compare_atomic->fetch.msg_iov,
+					work->op.compare_atomic->fetch.desc,
+					work->op.compare_atomic->fetch.iov_count,
+					work->op.compare_atomic->flags);
+	case FI_OP_CNTR_SET:
+		return fi_cntr_set(work->op.cntr->cntr, work->op.cntr->value);
+	case FI_OP_CNTR_ADD:
+		return fi_cntr_add(work->op.cntr->cntr, work->op.cntr->value);
+	default:
+		assert(0);
+		return -FI_ENOSYS;
+	}
+}
+
+static void util_trigger_report(struct util_trigger *trigger, ssize_t err)
+{
+	struct fi_cq_err_entry err_entry = { 0 };
+	struct util_cq *cq;
+
+	if (!trigger->ep) {
+		FI_WARN(trigger->cntr->domain->prov, FI_LOG_DOMAIN,
+			"deferred work failed: %s\n", fi_strerror((int) -err));
+		if (trigger->work->completion_cntr)
+			fi_cntr_adderr(trigger->work->completion_cntr, 1);
+		return;
+	}
+
+	cq = (trigger->local_work.op_type == FI_OP_RECV ||
+	      trigger->local_work.op_type == FI_OP_TRECV) ?
+	     trigger->ep->rx_cq : trigger->ep->tx_cq;
+	FI_WARN(trigger->cntr->domain->prov, FI_LOG_EP_DATA,
+		"triggered operation failed: %s\n", fi_strerror((int) -err));
+	if (!cq)
+		return;
+
+	err_entry.op_context = trigger->context;
+	err_entry.flags = trigger->flags;
+	err_entry.err = (int) -err;
+	err_entry.prov_errno = (int) -err;
+	(void) ofi_peer_cq_write_error(cq, &err_entry);
+}
+
+/*
+ * Requests are issued without holding the trigger lock, which lets them
+ * complete inline and queue further requests.  Only one thread issues at
+ * a time, so requests still start in threshold order.
+ */
+void ofi_trigger_start(struct util_domain *domain)
+{
+	struct util_trigger *trigger;
+	ssize_t ret;
+
+	ofi_mutex_lock(&domain->trigger_lock);
+	if (domain->trigger_busy)
+		goto unlock;
+
+	domain->trigger_busy = true;
+	while ((trigger = util_trigger_next(domain))) {
+		ofi_mutex_unlock(&domain->trigger_lock);
+		ret = util_trigger_issue(trigger->work);
+		if (ret && ret != -FI_EAGAIN)
+			util_trigger_report(trigger, ret);
+
+		ofi_mutex_lock(&domain->trigger_lock);
+		if (ret == -FI_EAGAIN) {
+			util_trigger_insert(domain, trigger, true);
+			break;
+		}
+		free(trigger);
+	}
+	domain->trigger_busy = false;
+unlock:
+	ofi_mutex_unlock(&domain->trigger_lock);
+}
+
+static void util_trigger_queue(struct util_domain *domain,
+			       struct util_trigger *trigger)
+{
+	ofi_mutex_lock(&domain->trigger_lock);
+	util_trigger_insert(domain, trigger, false);
+	ofi_mutex_unlock(&domain->trigger_lock);
+
+	/* Start the request right away if its condition is already met */
+	ofi_trigger_start(domain);
+}
+
+static int util_trigger_cntr(struct util_ep *ep, void *context,
+			     struct util_cntr **cntr, uint64_t *threshold)
+{
+	struct fi_triggered_context *trigger_context = context;
+
+	if (!(ep->caps & FI_TRIGGER) || !trigger_context)
+		return -FI_EINVAL;
+
+	if (trigger_context->event_type != FI_TRIGGER_THRESHOLD)
+		return -FI_ENOSYS;
+
+	if (!trigger_context->trigger.threshold.cntr)
+		return -FI_EINVAL;
+
+	*cntr = container_of(trigger_context->trigger.threshold.cntr,
+			     struct util_cntr, cntr_fid);
+	*threshold = trigger_context->trigger.threshold.threshold;
+	return (*cntr)->domain == ep->domain ? 0 : -FI_EINVAL;
+}
+
+static struct util_trigger *
+util_trigger_alloc(struct util_ep *ep, struct util_cntr *cntr,
+		   uint64_t threshold, enum fi_op_type op_type,
+		   void *context, uint64_t flags, size_t data_size)
+{
+	struct util_trigger *trigger;
+
+	trigger = calloc(1, sizeof(*trigger) + data_size);
+	if (!trigger)
+		return NULL;
+
+	trigger->cntr = cntr;
+	trigger->threshold = threshold;
+	trigger->ep = ep;
+	trigger->context = context;
+	trigger->flags = flags;
+	trigger->work = &trigger->local_work;
+	trigger->local_work.op_type = op_type;
+	return trigger;
+}
+
+ssize_t ofi_trigger_msg(struct util_ep *ep, enum fi_op_type op_type,
+			const struct fi_msg *msg, uint64_t flags)
+{
+	struct util_trigger *trigger;
+	struct util_cntr *cntr;
+	uint64_t threshold;
+	char *pos;
+	int ret;
+
+	assert(op_type == FI_OP_SEND || op_type == FI_OP_RECV);
+	ret = util_trigger_cntr(ep, msg->context, &cntr, &threshold);
+	if (ret)
+		return ret;
+
+	trigger = util_trigger_alloc(ep, cntr, threshold, op_type,
+				     msg->context, flags,
+				     UTIL_TRIGGER_SIZE(msg->iov_count, struct iovec) +
+				     UTIL_TRIGGER_SIZE(msg->iov_count, void *));
+	if (!trigger)
+		return -FI_ENOMEM;
+
+	pos = trigger->data;
+	trigger->op.msg.ep = &ep->ep_fid;
+	trigger->op.msg.msg = *msg;
+	trigger->op.msg.msg.msg_iov = util_trigger_copy(&pos, msg->msg_iov,
+				msg->iov_count, sizeof(*msg->msg_iov));
+	trigger->op.msg.msg.desc = util_trigger_copy(&pos, msg->desc,
+				msg->iov_count, sizeof(*msg->desc));
+	trigger->op.msg.flags = flags & ~FI_TRIGGER;
+	trigger->local_work.op.msg = &trigger->op.msg;
+
+	util_trigger_queue(ep->domain, trigger);
+	return 0;
+}
+
+ssize_t ofi_trigger_tagged(struct util_ep *ep, enum fi_op_type op_type,
+			   const struct fi_msg_tagged *msg, uint64_t flags)
+{
+	struct util_trigger *trigger;
+	struct util_cntr *cntr;
+	uint64_t threshold;
+	char *pos;
+	int ret;
+
+	assert(op_type == FI_OP_TSEND || op_type == FI_OP_TRECV);
+	ret = util_trigger_cntr(ep, msg->context, &cntr, &threshold);
+	if (ret)
+		return ret;
+
+	trigger = util_trigger_alloc(ep, cntr, threshold, op_type,
+				     msg->context, flags,
+				     UTIL_TRIGGER_SIZE(msg->iov_count, struct iovec) +
+				     UTIL_TRIGGER_SIZE(msg->iov_count, void *));
+	if (!trigger)
+		return -FI_ENOMEM;
+
+	pos = trigger->data;
+	trigger->op.tagged.ep = &ep->ep_fid;
+	trigger->op.tagged.msg = *msg;
+	trigger->op.tagged.msg.msg_iov = util_trigger_copy(&pos, msg->msg_iov,
+				msg->iov_count, sizeof(*msg->msg_iov));
+	trigger->op.tagged.msg.desc = util_trigger_copy(&pos, msg->desc,
+				msg->iov_count, sizeof(*msg->desc));
+	trigger->op.tagged.flags = flags & ~FI_TRIGGER;
+	trigger->local_work.op.tagged = &trigger->op.tagged;
+
+	util_trigger_queue(ep->domain, trigger);
+	return 0;
+}
+
+ssize_t ofi_trigger_rma(struct util_ep *ep, enum fi_op_type op_type,
+			const struct fi_msg_rma *msg, uint64_t flags)
+{
+	struct util_trigger *trigger;
+	struct util_cntr *cntr;
+	uint64_t threshold;
+	char *pos;
+	int ret;
+
+	assert(op_type == FI_OP_READ || op_type == FI_OP_WRITE);
+	ret = util_trigger_cntr(ep, msg->context, &cntr, &threshold);
+	if (ret)
+		return ret;
+
+	trigger = util_trigger_alloc(ep, cntr, threshold, op_type,
+			msg->context, flags,
+			UTIL_TRIGGER_SIZE(msg->iov_count, struct iovec) +
+			UTIL_TRIGGER_SIZE(msg->iov_count, void *) +
+			UTIL_TRIGGER_SIZE(msg->rma_iov_count, struct fi_rma_iov));
+	if (!trigger)
+		return -FI_ENOMEM;
+
+	pos = trigger->data;
+	trigger->op.rma.ep = &ep->ep_fid;
+	trigger->op.rma.msg = *msg;
+	trigger->op.rma.msg.msg_iov = util_trigger_copy(&pos, msg->msg_iov,
+				msg->iov_count, sizeof(*msg->msg_iov));
+	trigger->op.rma.msg.desc = util_trigger_copy(&pos, msg->desc,
+				msg->iov_count, sizeof(*msg->desc));
+	trigger->op.rma.msg.rma_iov = util_trigger_copy(&pos, msg->rma_iov,
+				msg->rma_iov_count, sizeof(*msg->rma_iov));
+	trigger->op.rma.flags = flags & ~FI_TRIGGER;
+	trigger->local_work.op.rma = &trigger->op.rma;
+
+	util_trigger_queue(ep->domain, trigger);
+	return 0;
+}
+
+static size_t util_trigger_atomic_size(const struct fi_msg_atomic *msg)
+{
+	return UTIL_TRIGGER_SIZE(msg->iov_count, struct fi_ioc) +
+	       UTIL_TRIGGER_SIZE(msg->iov_count, void *) +
+	       UTIL_TRIGGER_SIZE(msg->rma_iov_count, struct fi_rma_ioc);
+}
+
+static void util_trigger_copy_atomic(char **pos, struct fi_msg_atomic *dst,
+				     const struct fi_msg_atomic *msg)
+{
+	*dst = *msg;
+	dst->msg_iov = util_trigger_copy(pos, msg->msg_iov, msg->iov_count,
+					 sizeof(*msg->msg_iov));
+	dst->desc = util_trigger_copy(pos, msg->desc, msg->iov_count,
+				      sizeof(*msg->desc));
+	dst->rma_iov = util_trigger_copy(pos, msg->rma_iov, msg->rma_iov_count,
+					 sizeof(*msg->rma_iov));
+}
+
+ssize_t ofi_trigger_atomic(struct util_ep *ep, const struct fi_msg_atomic *msg,
+			   uint64_t flags)
+{
+	struct util_trigger *trigger;
+	struct util_cntr *cntr;
+	uint64_t threshold;
+	char *pos;
+	int ret;
+
+	ret = util_trigger_cntr(ep, msg->context, &cntr, &threshold);
+	if (ret)
+		return ret;
+
+	trigger = util_trigger_alloc(ep, cntr, threshold, FI_OP_ATOMIC,
+				     msg->context, flags,
+				     util_trigger_atomic_size(msg));
+	if (!trigger)
+		return -FI_ENOMEM;
+
+	pos = trigger->data;
+	trigger->op.atomic.ep = &ep->ep_fid;
+	util_trigger_copy_atomic(&pos, &trigger->op.atomic.msg, msg);
+	trigger->op.atomic.flags = flags & ~FI_TRIGGER;
+	trigger->local_work.op.atomic = &trigger->op.atomic;
+
+	util_trigger_queue(ep->domain, trigger);
+	return 0;
+}
+
+ssize_t ofi_trigger_fetch_atomic(struct util_ep *ep,
+				 const struct fi_msg_atomic *msg,
+				 struct fi_ioc *resultv, void **result_desc,
+				 size_t result_count, uint64_t flags)
+{
+	struct util_trigger *trigger;
+	struct util_cntr *cntr;
+	uint64_t threshold;
+	char *pos;
+	int ret;
+
+	ret = util_trigger_cntr(ep, msg->context, &cntr, &threshold);
+	if (ret)
+		return ret;
+
+	trigger = util_trigger_alloc(ep, cntr, threshold, FI_OP_FETCH_ATOMIC,
+				     msg->context, flags,
+				     util_trigger_atomic_size(msg) +
+				     UTIL_TRIGGER_SIZE(result_count, struct fi_ioc) +
+				     UTIL_TRIGGER_SIZE(result_count, void *));
+	if (!trigger)
+		return -FI_ENOMEM;
+
+	pos = trigger->data;
+	trigger->op.fetch_atomic.ep = &ep->ep_fid;
+	util_trigger_copy_atomic(&pos, &trigger->op.fetch_atomic.msg, msg);
+	trigger->op.fetch_atomic.fetch.msg_iov = util_trigger_copy(&pos,
+				resultv, result_count, sizeof(*resultv));
+	trigger->op.fetch_atomic.fetch.desc = util_trigger_copy(&pos,
+				result_desc, result_count, sizeof(*result_desc));
+	trigger->op.fetch_atomic.fetch.iov_count = result_count;
+	trigger->op.fetch_atomic.flags = flags & ~FI_TRIGGER;
+	trigger->local_work.op.fetch_atomic = &trigger->op.fetch_atomic;
+
+	util_trigger_queue(ep->domain, trigger);
+	return 0;
+}
+
+ssize_t ofi_trigger_compare_atomic(struct util_ep *ep,
+				   const struct fi_msg_atomic *msg,
+				   const struct fi_ioc *comparev,
+				   void **compare_desc, size_t compare_count,
+				   struct fi_ioc *resultv, void **result_desc,
+				   size_t result_count, uint64_t flags)
+{
+	struct util_trigger *trigger;
+	struct util_cntr *cntr;
+	uint64_t threshold;
+	char *pos;
+	int ret;
+
+	ret = util_trigger_cntr(ep, msg->context, &cntr, &threshold);
+	if (ret)
+		return ret;
+
+	trigger = util_trigger_alloc(ep, cntr, threshold, FI_OP_COMPARE_ATOMIC,
+				     msg->context, flags,
+				     util_trigger_atomic_size(msg) +
+				     UTIL_TRIGGER_SIZE(compare_count, struct fi_ioc) +
+				     UTIL_TRIGGER_SIZE(compare_count, void *) +
+				     UTIL_TRIGGER_SIZE(result_count, struct fi_ioc) +
+				     UTIL_TRIGGER_SIZE(result_count, void *));
+	if (!trigger)
+		return -FI_ENOMEM;
+
+	pos = trigger->data;
+	trigger->op.compare_atomic.ep = &ep->ep_fid;
+	util_trigger_copy_atomic(&pos, &trigger->op.compare_atomic.msg, msg);
+	trigger->op.compare_atomic.compare.msg_iov = util_trigger_copy(&pos,
+				comparev, compare_count, sizeof(*comparev));
+	trigger->op.compare_atomic.compare.desc = util_trigger_copy(&pos,
+				compare_desc, compare_count, sizeof(*compare_desc));
+	trigger->op.compare_atomic.compare.iov_count = compare_count;
+	trigger->op.compare_atomic.fetch.msg_iov = util_trigger_copy(&pos,
+				resultv, result_count, sizeof(*resultv));
+	trigger->op.compare_atomic.fetch.desc = util_trigger_copy(&pos,
+				result_desc, result_count, sizeof(*result_desc));
+	trigger->op.compare_atomic.fetch.iov_count = result_count;
+	trigger->op.compare_atomic.flags = flags & ~FI_TRIGGER;
+	trigger->local_work.op.compare_atomic = &trigger->op.compare_atomic;
+
+	util_trigger_queue(ep->domain, trigger);
+	return 0;
+}
+
+/*
+ * Deferred data transfers are issued through the endpoint, so they
+ * complete through the endpoint's counters.  A completion counter is only
+ * supported if it is the one bound to the endpoint for the operation.
+ */
+static int util_work_check_ep(struct util_domain *domain, struct fid_ep *ep_fid,
+			      enum ofi_cntr_index index,
+			      struct fid_cntr *completion_cntr)
+{
+	struct util_ep *ep;
+
+	if (!ep_fid)
+		return -FI_EINVAL;
+
+	ep = container_of(ep_fid, struct util_ep, ep_fid);
+	if (ep->domain != domain)
+		return -FI_EINVAL;
+
+	if (completion_cntr && (!ep->cntrs[index] ||
+	    &ep->cntrs[index]->cntr_fid != completion_cntr)) {
+		FI_WARN(domain->prov, FI_LOG_DOMAIN, "completion counter "
+			"must be bound to the endpoint of the deferred work\n");
+		return -FI_ENOSYS;
+	}
+	return 0;
+}
+
+static int util_work_check(struct util_domain *domain,
+			   struct fi_deferred_work *work)
+{
+	switch (work->op_type) {
+	case FI_OP_SEND:
+		return util_work_check_ep(domain, work->op.msg->ep, CNTR_TX,
+					  work->completion_cntr);
+	case FI_OP_RECV:
+		return util_work_check_ep(domain, work->op.msg->ep, CNTR_RX,
+					  work->completion_cntr);
+	case FI_OP_TSEND:
+		return util_work_check_ep(domain, work->op.tagged->ep, CNTR_TX,
+					  work->completion_cntr);
+	case FI_OP_TRECV:
+		return util_work_check_ep(domain, work->op.tagged->ep, CNTR_RX,
+					  work->completion_cntr);
+	case FI_OP_READ:
+		return util_work_check_ep(domain, work->op.rma->ep, CNTR_RD,
+					  work->completion_cntr);
+	case FI_OP_WRITE:
+		return util_work_check_ep(domain, work->op.rma->ep, CNTR_WR,
+					  work->completion_cntr);
+	case FI_OP_ATOMIC:
+		return util_work_check_ep(domain, work->op.atomic->ep, CNTR_WR,
+					  work->completion_cntr);
+	case FI_OP_FETCH_ATOMIC:
+		return util_work_check_ep(domain, work->op.fetch_atomic->ep,
+					  CNTR_RD, work->completion_cntr);
+	case FI_OP_COMPARE_ATOMIC:
+		return util_work_check_ep(domain, work->op.compare_atomic->ep,
+					  CNTR_RD, work->completion_cntr);
+	case FI_OP_CNTR_SET:
+	case FI_OP_CNTR_ADD:
+		return (!work->op.cntr->cntr || work->completion_cntr) ?
+		       -FI_EINVAL : 0;
+	default:
+		return -FI_ENOSYS;
+	}
+}
+
+int ofi_queue_work(struct util_domain *domain, struct fi_deferred_work *work)
+{
+	struct util_trigger *trigger;
+	int ret;
+
+	if (!work->triggering_cntr)
+		return -FI_EINVAL;
+
+	ret = util_work_check(domain, work);
+	if (ret)
+		return ret;
+
+	trigger = calloc(1, sizeof(*trigger));
+	if (!trigger)
+		return -FI_ENOMEM;
+
+	trigger->cntr = container_of(work->triggering_cntr, struct util_cntr,
+				     cntr_fid);
+	if (trigger->cntr->domain != domain) {
+		free(trigger);
+		return -FI_EINVAL;
+	}
+	trigger->threshold = work->threshold;
+	trigger->work = work;
+
+	util_trigger_queue(domain, trigger);
+	return 0;
+}
+
+int ofi_cancel_work(struct util_domain *domain, struct fi_deferred_work *work)
+{
+	struct util_trigger *trigger;
+	struct util_cntr *cntr;
+
+	if (!work->triggering_cntr)
+		return -FI_EINVAL;
+
+	cntr = container_of(work->triggering_cntr, struct util_cntr, cntr_fid);
+	ofi_mutex_lock(&domain->trigger_lock);
+	dlist_foreach_container(&cntr->trigger_list, struct util_trigger,
+				trigger, entry) {
+		if (trigger->work == work) {
+			util_trigger_remove(domain, trigger);
+			ofi_mutex_unlock(&domain->trigger_lock);
+			free(trigger);
+			return 0;
+		}
+	}
+	ofi_mutex_unlock(&domain->trigger_lock);
+	return -FI_ENOENT;
+}
+
+/* Drops deferred work queued on cntr, all of the domain's if cntr is NULL */
+int ofi_flush_work(struct util_domain *domain, struct util_cntr *cntr)
+{
+	struct dlist_entry *cntr_item, *cntr_tmp, *item, *tmp;
+	struct util_trigger *trigger;
+	struct util_cntr *cur;
+
+	ofi_mutex_lock(&domain->trigger_lock);
+	dlist_foreach_safe(&domain->trigger_cntrs, cntr_item, cntr_tmp) {
+		cur = container_of(cntr_item, struct util_cntr, trigger_entry);
+		if (cntr && cur != cntr)
+			continue;
+
+		dlist_foreach_safe(&cur->trigger_list, item, tmp) {
+			trigger = container_of(item, struct util_trigger, entry);
+			if (trigger->ep)
+				continue;
+			util_trigger_remove(domain, trigger);
+			free(trigger);
+		}
+	}
+	ofi_mutex_unlock(&domain->trigger_lock);
+	return 0;
+}
+
+/* Releases every request queued on a counter being closed */
+void ofi_trigger_cntr_cleanup(struct util_cntr *cntr)
+{
+	struct util_domain *domain = cntr->domain;
+	struct util_trigger *trigger;
+
+	ofi_mutex_lock(&domain->trigger_lock);
+	while (!dlist_empty(&cntr->trigger_list)) {
+		trigger = container_of(cntr->trigger_list.next,
+				       struct util_trigger, entry);
+		util_trigger_remove(domain, trigger);
+		free(trigger);
+	}
+	ofi_mutex_unlock(&domain->trigger_lock);
+}
+
+/* Releases the FI_TRIGGER operations queued for an endpoint being closed */
+void ofi_trigger_ep_cleanup(struct util_ep *ep)
+{
+	struct util_domain *domain = ep->domain;
+	struct dlist_entry *cntr_item, *cntr_tmp, *item, *tmp;
+	struct util_trigger *trigger;
+	struct util_cntr *cntr;
+
+	if (!ofi_atomic_get32(&domain->trigger_cnt))
+		return;
+
+	ofi_mutex_lock(&domain->trigger_lock);
+	dlist_foreach_safe(&domain->trigger_cntrs, cntr_item, cntr_tmp) {
+		cntr = container_of(cntr_item, struct util_cntr, trigger_entry);
+		dlist_foreach_safe(&cntr->trigger_list, item, tmp) {
+			trigger = container_of(item, struct util_trigger, entry);
+			if (trigger->ep != ep)
+				continue;
+			util_trigger_remove(domain, trigger);
+			free(trigger);
+		}
+	}
+	ofi_mutex_unlock(&domain->trigger_lock);
+}
+
+int ofi_domain_control(struct fid *fid, int command, void *arg)
+{
+	struct util_domain *domain;
+	struct fi_deferred_work *work = arg;
+
+	domain = container_of(fid, struct util_domain, domain_fid.fid);
+	switch (command) {
+	case FI_QUEUE_WORK:
+		return work ? ofi_queue_work(domain, work) : -FI_EINVAL;
+	case FI_CANCEL_WORK:
+		return work ? ofi_cancel_work(domain, work) : -FI_EINVAL;
+	case FI_FLUSH_WORK:
+		return ofi_flush_work(domain, work && work->triggering_cntr ?
+				      container_of(work->triggering_cntr,
+						   struct util_cntr, cntr_fid) :
+				      NULL);
+	default:
+		return -FI_ENOSYS;
+	}
+}
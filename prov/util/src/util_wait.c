@@ -879,3 +879,23 @@ out:
 	ofi_mutex_unlock(&wait->lock);
 	return ret;
 }
+
+uint64_t ofi_wait_spin_end(struct ofi_wait_spin *spin, uint64_t start)
+{
+	uint64_t max_ns = ofi_wait_spin * 1000;
+
+	if (spin->avg_ns > max_ns)
+		return start;
+
+	return start + (spin->avg_ns ? MIN(2 * spin->avg_ns, max_ns) : max_ns);
+}
+
+/* Called when a blocking read that had to wait from start returns data.
+ * Concurrent updates from several threads may lose a sample.
+ */
+void ofi_wait_spin_update(struct ofi_wait_spin *spin, uint64_t start)
+{
+	uint64_t wait_ns = ofi_gettime_ns() - start;
+
+	spin->avg_ns = spin->avg_ns - spin->avg_ns / 8 + wait_ns / 8;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Tests the buffer pool arena.  Pools of several entry sizes and alignments
+ * are created, filled and destroyed from one arena over a number of rounds.
+ * The arena must keep the footprint of the first round, register each chunk
+ * once, and merge the freed slices back into one free range per chunk.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ofi_util.h>
+#include <ofi_mem.h>
+
+#include "util_test.h"
+
+#define CHUNK_SIZE	(4 * 1024 * 1024)
+#define ROUNDS		4
+#define POOL_CNT	4
+
+static const struct {
+	size_t size;
+	size_t alignment;
+	size_t cnt;
+} pool_attr[POOL_CNT] = {
+	{ 64,	16,	16384 },
+	{ 256,	64,	4096 },
+	{ 1000,	128,	2048 },
+	{ 4096,	4096,	256 },
+};
+
+static struct fi_info *info;
+static struct ofi_bufpool_arena *arena;
+static struct ofi_bufpool *pools[POOL_CNT];
+static void **bufs[POOL_CNT];
+static size_t reg_cnt, dereg_cnt;
+
+static int reg_chunk(struct ofi_bufpool_arena *arena,
+		     struct ofi_bufpool_arena_chunk *chunk)
+{
+	reg_cnt++;
+	return 0;
+}
+
+static void dereg_chunk(struct ofi_bufpool_arena *arena,
+			struct ofi_bufpool_arena_chunk *chunk)
+{
+	dereg_cnt++;
+}
+
+static size_t free_range_cnt(void)
+{
+	struct dlist_entry *item;
+	size_t cnt = 0;
+
+	dlist_foreach(&arena->free_list, item)
+		cnt++;
+	return cnt;
+}
+
+static int fill_pool(int i)
+{
+	struct ofi_bufpool_attr attr = {
+		.size = pool_attr[i].size,
+		.alignment = pool_attr[i].alignment,
+		.chunk_cnt = 64,
+		.arena = arena,
+	};
+	struct ofi_bufpool_arena_chunk *chunk;
+	size_t j;
+
+	CHECK(!ofi_bufpool_create_attr(&attr, &pools[i]));
+	for (j = 0; j < pool_attr[i].cnt; j++) {
+		bufs[i][j] = ofi_buf_alloc(pools[i]);
+		CHECK(bufs[i][j]);
+		CHECK(!((uintptr_t) bufs[i][j] % pool_attr[i].alignment));
+
+		chunk = ofi_buf_region(bufs[i][j])->chunk;
+		CHECK(chunk);
+		CHECK((char *) bufs[i][j] >= chunk->base);
+		CHECK((char *) bufs[i][j] + pool_attr[i].size <=
+		      chunk->base + chunk->size);
+		memset(bufs[i][j], i + 1, pool_attr[i].size);
+	}
+	return 0;
+}
+
+/* Buffers of all pools are written while alive, so no two may overlap */
+static int check_pool(int i)
+{
+	size_t j, k;
+
+	for (j = 0; j < pool_attr[i].cnt; j++) {
+		for (k = 0; k < pool_attr[i].size; k++)
+			CHECK(((unsigned char *) bufs[i][j])[k] == i + 1);
+		ofi_buf_free(bufs[i][j]);
+	}
+	ofi_bufpool_destroy(pools[i]);
+	return 0;
+}
+
+static int run_round(void)
+{
+	int i;
+
+	for (i = 0; i < POOL_CNT; i++)
+		CHECK(!fill_pool(i));
+	CHECK(arena->slice_cnt >= POOL_CNT);
+	CHECK(arena->used <= arena->size);
+
+	for (i = 0; i < POOL_CNT; i++)
+		CHECK(!check_pool(i));
+	CHECK(!arena->slice_cnt);
+	CHECK(!arena->used);
+	CHECK(free_range_cnt() == arena->chunk_cnt);
+	return 0;
+}
+
+static int test_rounds(void)
+{
+	size_t size, chunk_cnt;
+	int round;
+
+	CHECK(!run_round());
+	size = arena->size;
+	chunk_cnt = arena->chunk_cnt;
+	CHECK(chunk_cnt > 1);
+	CHECK(reg_cnt == chunk_cnt);
+
+	/* freed slices are reused, so the arena does not grow any further */
+	for (round = 1; round < ROUNDS; round++) {
+		CHECK(!run_round());
+		CHECK(arena->size == size);
+		CHECK(arena->chunk_cnt == chunk_cnt);
+	}
+	CHECK(reg_cnt == chunk_cnt);
+	CHECK(arena->peak <= arena->size);
+	return 0;
+}
+
+static int init(void)
+{
+	struct ofi_bufpool_arena_attr attr = {
+		.chunk_size = CHUNK_SIZE,
+		.reg_fn = reg_chunk,
+		.dereg_fn = dereg_chunk,
+		.flags = OFI_BUFPOOL_HUGEPAGES,
+	};
+	struct fi_info *hints;
+	int i, ret;
+
+	/* initializes the library, including logging */
+	hints = fi_allocinfo();
+	if (!hints)
+		return -FI_ENOMEM;
+
+	hints->fabric_attr->prov_name = strdup("udp");
+	ret = fi_getinfo(FI_VERSION(2, 0), NULL, NULL, 0, hints, &info);
+	fi_freeinfo(hints);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < POOL_CNT; i++) {
+		bufs[i] = calloc(pool_attr[i].cnt, sizeof(*bufs[i]));
+		if (!bufs[i])
+			return -FI_ENOMEM;
+	}
+
+	return ofi_bufpool_arena_create(&attr, &arena);
+}
+
+int main(int argc, char **argv)
+{
+	size_t chunk_cnt;
+	int i, ret;
+
+	ret = init();
+	if (ret) {
+		printf("cannot create a buffer pool arena: %d, skipping\n", ret);
+		ret = 77;
+		goto out;
+	}
+
+	ret = test_rounds() ? EXIT_FAILURE : EXIT_SUCCESS;
+	chunk_cnt = arena->chunk_cnt;
+	ofi_bufpool_arena_destroy(arena);
+	if (!ret && dereg_cnt != chunk_cnt) {
+		printf("%s:%d: check failed: dereg_cnt == chunk_cnt\n",
+		       __func__, __LINE__);
+		ret = EXIT_FAILURE;
+	}
+	printf("bufpool arena: %s\n", ret ? "FAIL" : "PASS");
+out:
+	for (i = 0; i < POOL_CNT; i++)
+		free(bufs[i]);
+	fi_freeinfo(info);
+	return ret;
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Measures ofi_bufpool alloc/free throughput against the number of
+ * threads, for a pool shared under a lock held by the caller and for a
+ * pool with per-thread magazines.  Each thread repeatedly allocates a
+ * burst of buffers, writes to them and frees them again.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <rdma/fabric.h>
+#include <ofi_mem.h>
+#include <ofi_lock.h>
+#include <ofi.h>
+
+static struct ofi_bufpool *pool;
+static ofi_mutex_t pool_lock;
+static pthread_barrier_t barrier;
+static size_t iters = 1000000;
+static size_t burst = 8;
+static size_t buf_size = 256;
+static bool use_mag;
+
+static void bench_free(void *buf)
+{
+	if (use_mag) {
+		ofi_buf_mag_free(buf);
+	} else {
+		ofi_mutex_lock(&pool_lock);
+		ofi_buf_free(buf);
+		ofi_mutex_unlock(&pool_lock);
+	}
+}
+
+static void *bench_thread(void *arg)
+{
+	void *ret = NULL;
+	void **bufs;
+	size_t i, j;
+
+	bufs = calloc(burst, sizeof(*bufs));
+	if (!bufs)
+		ret = (void *) (intptr_t) -FI_ENOMEM;
+
+	pthread_barrier_wait(&barrier);
+	for (i = 0; bufs && i < iters; i += burst) {
+		for (j = 0; j < burst; j++) {
+			if (use_mag) {
+				bufs[j] = ofi_buf_mag_alloc(pool);
+			} else {
+				ofi_mutex_lock(&pool_lock);
+				bufs[j] = ofi_buf_alloc(pool);
+				ofi_mutex_unlock(&pool_lock);
+			}
+			if (!bufs[j]) {
+				ret = (void *) (intptr_t) -FI_ENOMEM;
+				goto out;
+			}
+			*(size_t *) bufs[j] = i;
+		}
+
+		for (j = 0; j < burst; j++)
+			bench_free(bufs[j]);
+	}
+out:
+	pthread_barrier_wait(&barrier);
+
+	if (ret && bufs) {
+		while (j--)
+			bench_free(bufs[j]);
+	}
+	free(bufs);
+	return ret;
+}
+
+static int run(int thread_cnt, double *mops)
+{
+	pthread_t *threads;
+	uint64_t start, end;
+	void *ret = NULL, *thread_ret;
+	int i, err;
+
+	err = ofi_bufpool_create(&pool, buf_size, 16, 0, 0,
+				 use_mag ? OFI_BUFPOOL_MAGAZINE : 0);
+	if (err)
+		return err;
+
+	threads = calloc(thread_cnt, sizeof(*threads));
+	if (!threads) {
+		ofi_bufpool_destroy(pool);
+		return -FI_ENOMEM;
+	}
+
+	ofi_mutex_init(&pool_lock);
+	pthread_barrier_init(&barrier, NULL, thread_cnt + 1);
+	for (i = 0; i < thread_cnt; i++) {
+		err = pthread_create(&threads[i], NULL, bench_thread, NULL);
+		if (err) {
+			fprintf(stderr, "pthread_create: %s\n", strerror(err));
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	pthread_barrier_wait(&barrier);
+	start = ofi_gettime_ns();
+	pthread_barrier_wait(&barrier);
+	end = ofi_gettime_ns();
+
+	for (i = 0; i < thread_cnt; i++) {
+		pthread_join(threads[i], &thread_ret);
+		if (thread_ret)
+			ret = thread_ret;
+	}
+
+	pthread_barrier_destroy(&barrier);
+	ofi_mutex_destroy(&pool_lock);
+	ofi_bufpool_destroy(pool);
+	free(threads);
+
+	/* one alloc and one free per operation */
+	*mops = (double) iters * thread_cnt * 1000 / (end - start);
+	return (int) (intptr_t) ret;
+}
+
+static void usage(char *name)
+{
+	fprintf(stderr, "usage: %s [-t max_threads] [-n iterations] "
+		"[-b burst] [-S buf_size]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+	struct fi_info *info = NULL;
+	double locked, mag;
+	int max_threads = 8;
+	int op, i, ret;
+
+	while ((op = getopt(argc, argv, "t:n:b:S:h")) != -1) {
+		switch (op) {
+		case 't':
+			max_threads = atoi(optarg);
+			break;
+		case 'n':
+			iters = strtoul(optarg, NULL, 0);
+			break;
+		case 'b':
+			burst = strtoul(optarg, NULL, 0);
+			break;
+		case 'S':
+			buf_size = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (max_threads < 1 || !burst || buf_size < sizeof(size_t)) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	/* initializes the library, including page sizes used by pools */
+	(void) fi_getinfo(fi_version(), NULL, NULL, 0, NULL, &info);
+	fi_freeinfo(info);
+
+	printf("%-8s %16s %16s\n", "threads", "locked Mops/s", "magazine Mops/s");
+	for (i = 1; i <= max_threads;
+	     i = (i < max_threads && i * 2 > max_threads) ? max_threads : i * 2) {
+		use_mag = false;
+		ret = run(i, &locked);
+		if (ret)
+			goto err;
+
+		use_mag = true;
+		ret = run(i, &mag);
+		if (ret)
+			goto err;
+
+		printf("%-8d %16.2f %16.2f\n", i, locked, mag);
+	}
+	return EXIT_SUCCESS;
+
+err:
+	fprintf(stderr, "run failed: %s\n", fi_strerror(-ret));
+	return EXIT_FAILURE;
+}
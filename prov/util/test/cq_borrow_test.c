@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Tests the FI_CQ_BORROW_OPS extension of util CQs.  A small CQ is opened
+ * through the udp provider and completions are written to it directly,
+ * which lets the test control where entries sit in the ring buffer and
+ * when they overflow into the auxiliary queue.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rdma/fabric.h>
+#include <rdma/fi_domain.h>
+#include <rdma/fi_ext.h>
+#include <ofi_util.h>
+
+#include "util_test.h"
+
+#define CQ_SIZE 8
+
+static struct fi_info *info;
+static struct fid_fabric *fabric;
+static struct fid_domain *domain;
+static struct fid_cq *cq;
+static struct util_cq *ucq;
+static struct fi_ops_cq_borrow *ops;
+
+/* Completions carry their sequence number as the context */
+static uintptr_t next_write, next_read;
+
+static void write_comps(size_t cnt)
+{
+	while (cnt--)
+		(void) ofi_cq_write(ucq, (void *) next_write++, FI_MSG | FI_RECV,
+				    0, NULL, 0, 0);
+}
+
+static int check_span(struct fi_cq_tagged_entry *comp, ssize_t cnt)
+{
+	ssize_t i;
+
+	for (i = 0; i < cnt; i++)
+		CHECK((uintptr_t) comp[i].op_context == next_read + i);
+	return 0;
+}
+
+static int consume(ssize_t cnt)
+{
+	CHECK(!ops->release(cq, cnt));
+	next_read += cnt;
+	return 0;
+}
+
+static int test_borrow_release(void)
+{
+	struct fi_cq_tagged_entry *comp, entry;
+	ssize_t ret;
+
+	CHECK(ops->borrow(cq, &comp, NULL, CQ_SIZE) == -FI_EAGAIN);
+
+	write_comps(5);
+	ret = ops->borrow(cq, &comp, NULL, CQ_SIZE);
+	CHECK(ret == 5);
+	CHECK(!check_span(comp, ret));
+
+	/* borrowed entries are not handed out again */
+	CHECK(ops->borrow(cq, &comp, NULL, CQ_SIZE) == -FI_EBUSY);
+	CHECK(fi_cq_read(cq, &entry, 1) == -FI_EAGAIN);
+	CHECK(ops->release(cq, 6) == -FI_EINVAL);
+
+	/* partial release returns the rest */
+	CHECK(!consume(2));
+	ret = ops->borrow(cq, &comp, NULL, 2);
+	CHECK(ret == 2);
+	CHECK(!check_span(comp, ret));
+
+	/* releasing nothing keeps every entry */
+	CHECK(!ops->release(cq, 0));
+	ret = ops->borrow(cq, &comp, NULL, CQ_SIZE);
+	CHECK(ret == 3);
+	CHECK(!check_span(comp, ret));
+	CHECK(!consume(1));
+
+	/* regular reads continue after the consumed entries */
+	CHECK(fi_cq_read(cq, &entry, 1) == 1);
+	CHECK((uintptr_t) entry.op_context == next_read++);
+	CHECK(fi_cq_read(cq, &entry, 1) == 1);
+	CHECK((uintptr_t) entry.op_context == next_read++);
+	CHECK(ops->borrow(cq, &comp, NULL, CQ_SIZE) == -FI_EAGAIN);
+	return 0;
+}
+
+/* A span stops at the end of the ring buffer */
+static int test_wrap(void)
+{
+	struct fi_cq_tagged_entry *comp;
+	size_t to_end;
+	ssize_t ret;
+
+	to_end = ucq->cirq->size - ofi_cirque_rindex(ucq->cirq);
+	CHECK(to_end < ucq->cirq->size - 1);
+
+	write_comps(ucq->cirq->size - 1);
+	ret = ops->borrow(cq, &comp, NULL, CQ_SIZE);
+	CHECK(ret == (ssize_t) to_end);
+	CHECK(!check_span(comp, ret));
+	CHECK(!consume(ret));
+
+	ret = ops->borrow(cq, &comp, NULL, CQ_SIZE);
+	CHECK(ret == (ssize_t) (ucq->cirq->size - 1 - to_end));
+	CHECK(comp == &ucq->cirq->buf[0]);
+	CHECK(!check_span(comp, ret));
+	CHECK(!consume(ret));
+
+	CHECK(ops->borrow(cq, &comp, NULL, CQ_SIZE) == -FI_EAGAIN);
+	return 0;
+}
+
+/* Overflow entries are lent out one at a time, in order */
+static int test_overflow(void)
+{
+	struct fi_cq_tagged_entry *comp;
+	ssize_t ret;
+
+	write_comps(ucq->cirq->size + 3);
+	CHECK(!slist_empty(&ucq->aux_queue));
+
+	while (next_read < next_write) {
+		ret = ops->borrow(cq, &comp, NULL, CQ_SIZE);
+		CHECK(ret > 0);
+		CHECK(!check_span(comp, ret));
+		CHECK(!consume(ret));
+	}
+
+	CHECK(slist_empty(&ucq->aux_queue));
+	CHECK(ops->borrow(cq, &comp, NULL, CQ_SIZE) == -FI_EAGAIN);
+	return 0;
+}
+
+static int test_error(void)
+{
+	struct fi_cq_err_entry err_entry = {
+		.op_context = (void *) next_write++,
+		.err = FI_EIO,
+		.prov_errno = -FI_EIO,
+	};
+	struct fi_cq_tagged_entry *comp;
+	ssize_t ret;
+
+	CHECK(!ofi_cq_write_error(ucq, &err_entry));
+	write_comps(1);
+
+	CHECK(ops->borrow(cq, &comp, NULL, CQ_SIZE) == -FI_EAVAIL);
+	memset(&err_entry, 0, sizeof(err_entry));
+	CHECK(fi_cq_readerr(cq, &err_entry, 0) == 1);
+	CHECK(err_entry.err == FI_EIO);
+	CHECK((uintptr_t) err_entry.op_context == next_read++);
+
+	ret = ops->borrow(cq, &comp, NULL, CQ_SIZE);
+	CHECK(ret == 1);
+	CHECK(!check_span(comp, ret));
+	CHECK(!consume(ret));
+	return 0;
+}
+
+static int open_cq(void)
+{
+	struct fi_cq_attr attr = {
+		.size = CQ_SIZE,
+		.format = FI_CQ_FORMAT_TAGGED,
+	};
+	struct fi_info *hints;
+	int ret;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return -FI_ENOMEM;
+
+	hints->fabric_attr->prov_name = strdup("udp");
+	hints->ep_attr->type = FI_EP_DGRAM;
+	ret = fi_getinfo(FI_VERSION(2, 0), NULL, NULL, 0, hints, &info);
+	fi_freeinfo(hints);
+	if (ret)
+		return ret;
+
+	ret = fi_fabric(info->fabric_attr, &fabric, NULL);
+	if (ret)
+		return ret;
+
+	ret = fi_domain(fabric, info, &domain, NULL);
+	if (ret)
+		return ret;
+
+	ret = fi_cq_open(domain, &attr, &cq, NULL);
+	if (ret)
+		return ret;
+
+	ucq = container_of(cq, struct util_cq, cq_fid);
+	return fi_open_ops(&cq->fid, FI_CQ_BORROW_OPS, 0, (void **) &ops,
+			   NULL);
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+
+	ret = open_cq();
+	if (ret) {
+		printf("cannot open a udp CQ with borrow ops: %d, skipping\n",
+		       ret);
+		ret = 77;
+		goto out;
+	}
+
+	ret = test_borrow_release() || test_wrap() || test_overflow() ||
+	      test_error() ? EXIT_FAILURE : EXIT_SUCCESS;
+	printf("cq borrow/release: %s\n", ret ? "FAIL" : "PASS");
+out:
+	if (cq)
+		fi_close(&cq->fid);
+	if (domain)
+		fi_close(&domain->fid);
+	if (fabric)
+		fi_close(&fabric->fid);
+	fi_freeinfo(info);
+	return ret;
+}
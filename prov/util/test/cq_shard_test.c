@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Exercises a completion shard with several producer threads and one
+ * consumer.  The consumer only reads after ofi_cq_shard_isempty() reports
+ * entries, so a slot that has been claimed by a producer but not yet
+ * committed must not make the shard look non-empty.  Completions written
+ * by each producer must be read back in order.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <ofi_util.h>
+
+static struct util_cq_shard shard;
+static pthread_barrier_t barrier;
+static size_t producers = 4;
+static size_t iters = 100000;
+static size_t qsize = 64;
+
+static void *producer(void *arg)
+{
+	struct util_cq_shard_comp *entry;
+	uintptr_t id = (uintptr_t) arg;
+	int64_t pos;
+	size_t i;
+
+	pthread_barrier_wait(&barrier);
+	for (i = 0; i < iters; i++) {
+		while (util_cq_shardq_next(shard.queue, &entry, &pos))
+			sched_yield();
+
+		/* widen the window between claiming and committing a slot */
+		if (!(i % 16))
+			sched_yield();
+
+		entry->comp.op_context = (void *) id;
+		entry->comp.data = i;
+		util_cq_shardq_commit(entry, pos);
+	}
+	return NULL;
+}
+
+static int check_claimed_slot(void)
+{
+	struct util_cq_shard_comp *entry;
+	int64_t pos;
+
+	if (!ofi_cq_shard_isempty(&shard)) {
+		printf("new shard is not empty\n");
+		return -1;
+	}
+
+	if (util_cq_shardq_next(shard.queue, &entry, &pos)) {
+		printf("cannot claim a slot\n");
+		return -1;
+	}
+
+	if (!ofi_cq_shard_isempty(&shard)) {
+		printf("claimed, uncommitted slot reported as an entry\n");
+		return -1;
+	}
+
+	util_cq_shardq_commit(entry, pos);
+	if (ofi_cq_shard_isempty(&shard)) {
+		printf("committed entry not reported\n");
+		return -1;
+	}
+
+	if (util_cq_shardq_head(shard.queue, &entry, &pos)) {
+		printf("cannot read committed entry\n");
+		return -1;
+	}
+	util_cq_shardq_release(shard.queue, entry, pos);
+
+	if (!ofi_cq_shard_isempty(&shard)) {
+		printf("shard not empty after read\n");
+		return -1;
+	}
+	return 0;
+}
+
+static int consume(void)
+{
+	struct util_cq_shard_comp *entry;
+	uint64_t *next;
+	size_t total, id, spurious = 0;
+	int64_t pos;
+	int ret = 0;
+
+	next = calloc(producers, sizeof(*next));
+	if (!next)
+		return -1;
+
+	pthread_barrier_wait(&barrier);
+	for (total = 0; total < producers * iters; ) {
+		if (ofi_cq_shard_isempty(&shard)) {
+			sched_yield();
+			continue;
+		}
+
+		/* A single reader must find the entry that was reported */
+		if (util_cq_shardq_head(shard.queue, &entry, &pos)) {
+			spurious++;
+			continue;
+		}
+
+		id = (uintptr_t) entry->comp.op_context;
+		if (id >= producers || entry->comp.data != next[id]) {
+			printf("out of order: producer %zu got %" PRIu64
+			       " expected %" PRIu64 "\n", id,
+			       entry->comp.data, next[id]);
+			ret = -1;
+		} else {
+			next[id]++;
+		}
+		util_cq_shardq_release(shard.queue, entry, pos);
+		total++;
+	}
+
+	if (spurious) {
+		printf("%zu reads found no entry after a non-empty check\n",
+		       spurious);
+		ret = -1;
+	}
+	free(next);
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	pthread_t *threads;
+	size_t size, i;
+	int op, ret;
+
+	while ((op = getopt(argc, argv, "p:n:q:h")) != -1) {
+		switch (op) {
+		case 'p':
+			producers = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			iters = strtoul(optarg, NULL, 0);
+			break;
+		case 'q':
+			qsize = roundup_power_of_two(strtoul(optarg, NULL, 0));
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-p producers] [-n iters] "
+				"[-q queue size]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	size = sizeof(*shard.queue) +
+	       sizeof(struct util_cq_shardq_entry) * qsize;
+	if (ofi_memalign((void **) &shard.queue, OFI_CACHE_LINE_SIZE, size))
+		return EXIT_FAILURE;
+	memset(shard.queue, 0, size);
+	util_cq_shardq_init(shard.queue, qsize);
+	ofi_atomic_initialize32(&shard.overflow, 0);
+
+	threads = calloc(producers, sizeof(*threads));
+	if (!threads ||
+	    pthread_barrier_init(&barrier, NULL, (unsigned) producers + 1))
+		return EXIT_FAILURE;
+
+	ret = check_claimed_slot();
+	if (ret)
+		goto out;
+
+	for (i = 0; i < producers; i++) {
+		if (pthread_create(&threads[i], NULL, producer,
+				   (void *) (uintptr_t) i))
+			return EXIT_FAILURE;
+	}
+
+	ret = consume();
+	for (i = 0; i < producers; i++)
+		pthread_join(threads[i], NULL);
+
+	if (!ret && !ofi_cq_shard_isempty(&shard)) {
+		printf("shard not empty after all entries were read\n");
+		ret = -1;
+	}
+
+	printf("%zu producers x %zu completions: %s\n", producers, iters,
+	       ret ? "FAIL" : "PASS");
+out:
+	pthread_barrier_destroy(&barrier);
+	free(threads);
+	ofi_freealign(shard.queue);
+	return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
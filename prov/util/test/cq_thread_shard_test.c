@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Exercises a CQ opened with ofi_cq_init_sharded(), as used by providers
+ * that write completions from their own progress threads.  The CQ is
+ * opened on a FI_THREAD_DOMAIN domain, so it must still come up with a
+ * locked cirq.  Each worker thread selects its own shard, and must be
+ * the only writer of that shard, while the main thread writes to the
+ * shared shard 0.  Completions are then read back concurrently with the
+ * writers, in the order in which each thread wrote them.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <ofi_util.h>
+
+#define CQ_SIZE 1024
+#define FILL_CNT (CQ_SIZE / 4)
+
+static struct fi_info *info;
+static struct fid_fabric *fabric;
+static struct fid_domain *domain;
+static struct util_cq *cq;
+static pthread_barrier_t barrier;
+static size_t workers = 3;
+static size_t iters = 100000;
+
+struct worker {
+	pthread_t thread;
+	size_t shard;
+	size_t cnt;
+};
+
+static void write_comps(uintptr_t id, size_t cnt)
+{
+	size_t i;
+
+	for (i = 0; i < cnt; i++) {
+		while (ofi_cq_write(cq, (void *) id, FI_MSG | FI_RECV, 0, NULL,
+				    i, 0))
+			;
+	}
+}
+
+static void *worker_thread(void *arg)
+{
+	struct worker *worker = arg;
+
+	ofi_cq_set_thread_shard(worker->shard);
+	pthread_barrier_wait(&barrier);
+	write_comps(worker->shard, worker->cnt);
+	pthread_barrier_wait(&barrier);
+	return NULL;
+}
+
+/* Reads cnt completions from each writer, checking their order */
+static int read_comps(size_t cnt)
+{
+	struct fi_cq_data_entry comp[16];
+	uint64_t *next;
+	size_t total = 0, id;
+	ssize_t ret, i;
+	int err = 0;
+
+	next = calloc(workers + 1, sizeof(*next));
+	if (!next)
+		return -1;
+
+	while (total < cnt * (workers + 1)) {
+		ret = fi_cq_read(&cq->cq_fid, comp, 16);
+		if (ret == -FI_EAGAIN)
+			continue;
+		if (ret < 0) {
+			printf("fi_cq_read: %zd\n", ret);
+			err = -1;
+			break;
+		}
+
+		for (i = 0; i < ret; i++) {
+			id = (uintptr_t) comp[i].op_context;
+			if (id > workers || comp[i].data != next[id]) {
+				printf("out of order: writer %zu got %" PRIu64
+				       "\n", id, comp[i].data);
+				err = -1;
+			} else {
+				next[id]++;
+			}
+		}
+		total += ret;
+	}
+	free(next);
+	return err;
+}
+
+static int run_workers(struct worker *worker, size_t cnt, bool check_shards)
+{
+	size_t i;
+	int ret;
+
+	for (i = 0; i < workers; i++) {
+		worker[i].shard = i + 1;
+		worker[i].cnt = cnt;
+		if (pthread_create(&worker[i].thread, NULL, worker_thread,
+				   &worker[i]))
+			return -1;
+	}
+
+	pthread_barrier_wait(&barrier);
+	if (check_shards) {
+		write_comps(0, cnt);
+		pthread_barrier_wait(&barrier);
+
+		/* every thread must have filled exactly its own shard */
+		for (i = 0, ret = 0; i <= workers; i++) {
+			if (ofi_atomic_get64(&cq->shards[i].queue->write_pos) !=
+			    (int64_t) cnt) {
+				printf("shard %zu holds %" PRId64 " entries, "
+				       "expected %zu\n", i,
+				       ofi_atomic_get64(
+					&cq->shards[i].queue->write_pos), cnt);
+				ret = -1;
+			}
+		}
+		ret = read_comps(cnt) || ret;
+	} else {
+		write_comps(0, cnt);
+		ret = read_comps(cnt);
+		pthread_barrier_wait(&barrier);
+	}
+
+	for (i = 0; i < workers; i++)
+		pthread_join(worker[i].thread, NULL);
+	return ret;
+}
+
+static int open_cq(void)
+{
+	struct fi_cq_attr attr = {
+		.size = CQ_SIZE,
+		.format = FI_CQ_FORMAT_DATA,
+	};
+	struct util_domain *util_domain;
+	struct fi_info *hints;
+	int ret;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return -FI_ENOMEM;
+
+	hints->fabric_attr->prov_name = strdup("udp");
+	hints->ep_attr->type = FI_EP_DGRAM;
+	hints->domain_attr->threading = FI_THREAD_DOMAIN;
+	ret = fi_getinfo(FI_VERSION(2, 0), NULL, NULL, 0, hints, &info);
+	fi_freeinfo(hints);
+	if (ret)
+		return ret;
+
+	ret = fi_fabric(info->fabric_attr, &fabric, NULL);
+	if (ret)
+		return ret;
+
+	ret = fi_domain(fabric, info, &domain, NULL);
+	if (ret)
+		return ret;
+
+	cq = calloc(1, sizeof(*cq));
+	if (!cq)
+		return -FI_ENOMEM;
+
+	util_domain = container_of(domain, struct util_domain, domain_fid);
+	ret = ofi_cq_init_sharded(util_domain->prov, domain, &attr, cq,
+				  &ofi_cq_progress, workers + 1, NULL);
+	if (ret) {
+		free(cq);
+		cq = NULL;
+	}
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	struct worker *worker = NULL;
+	int op, ret;
+
+	while ((op = getopt(argc, argv, "w:n:h")) != -1) {
+		switch (op) {
+		case 'w':
+			workers = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			iters = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-w workers] [-n iters]\n",
+				argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	ret = open_cq();
+	if (ret) {
+		printf("cannot open a sharded udp CQ: %d, skipping\n", ret);
+		ret = 77;
+		goto out;
+	}
+
+	if (cq->cq_lock.lock_type != OFI_LOCK_MUTEX) {
+		printf("sharded CQ opened with lock type %d\n",
+		       cq->cq_lock.lock_type);
+		ret = EXIT_FAILURE;
+		goto out;
+	}
+
+	worker = calloc(workers, sizeof(*worker));
+	if (!worker ||
+	    pthread_barrier_init(&barrier, NULL, (unsigned) workers + 1)) {
+		ret = EXIT_FAILURE;
+		goto out;
+	}
+
+	ret = run_workers(worker, FILL_CNT, true) ||
+	      run_workers(worker, iters, false) ? EXIT_FAILURE : EXIT_SUCCESS;
+	pthread_barrier_destroy(&barrier);
+	printf("%zu workers x %zu completions: %s\n", workers, iters,
+	       ret ? "FAIL" : "PASS");
+out:
+	free(worker);
+	if (cq)
+		fi_close(&cq->cq_fid.fid);
+	if (domain)
+		fi_close(&domain->fid);
+	if (fabric)
+		fi_close(&fabric->fid);
+	fi_freeinfo(info);
+	return ret;
+}
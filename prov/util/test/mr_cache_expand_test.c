@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Tests how the MR cache widens registrations on a miss, with
+ * FI_MR_CACHE_GRANULARITY and FI_MR_CACHE_MERGE_MAX set.  A cache is
+ * opened over a stub monitor, and registered ranges are recorded.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <ofi_util.h>
+#include <ofi_mr.h>
+
+#include "util_test.h"
+
+#define GRAN		(64 * 1024)
+#define BUF_SIZE	(4 * GRAN)
+
+static struct ofi_mr_cache cache;
+static char *buf;
+static struct iovec last_reg;
+
+static int add_region(struct ofi_mr_cache *cache, struct ofi_mr_entry *entry)
+{
+	last_reg = entry->info.iov;
+	return 0;
+}
+
+static int reg(size_t off, size_t len)
+{
+	struct ofi_mr_info mr_info = {
+		.iov.iov_base = buf + off,
+		.iov.iov_len = len,
+		.iface = FI_HMEM_SYSTEM,
+	};
+	struct ofi_mr_entry *entry;
+
+	CHECK(!ofi_mr_cache_search(&cache, &mr_info, &entry));
+
+	/* only the entry covers the widened range */
+	CHECK(mr_info.iov.iov_base == buf + off && mr_info.iov.iov_len == len);
+	CHECK((char *) entry->info.iov.iov_base <= buf + off &&
+	      (char *) entry->info.iov.iov_base + entry->info.iov.iov_len >=
+	      buf + off + len);
+	ofi_mr_cache_delete(&cache, entry);
+	return 0;
+}
+
+static int test_round(void)
+{
+	CHECK(!reg(100, 100));
+	CHECK(last_reg.iov_base == buf && last_reg.iov_len == GRAN);
+	return 0;
+}
+
+/*
+ * The rounded range contains a cached region that is not merged into it.
+ * The region must be replaced, or it conflicts with the new entry on
+ * every retry.
+ */
+static int test_no_merge(void)
+{
+	cache_params.granularity = 0;
+	CHECK(!reg(GRAN + 100, 100));
+	CHECK(last_reg.iov_base == buf + GRAN + 100);
+
+	cache_params.granularity = GRAN;
+	cache_params.merge_max = 0;
+	CHECK(!reg(GRAN + 4096, 100));
+	CHECK(last_reg.iov_base == buf + GRAN && last_reg.iov_len == GRAN);
+	CHECK(cache.cached_cnt == 2);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+
+	/* a search that retries forever fails the test */
+	alarm(30);
+	if (posix_memalign((void **) &buf, GRAN, BUF_SIZE))
+		return EXIT_FAILURE;
+
+	ret = util_test_init();
+	if (!ret) {
+		cache_params.granularity = GRAN;
+		cache_params.merge_max = GRAN;
+		ret = util_test_cache_open(&cache, add_region);
+	}
+	if (ret) {
+		printf("cannot open an MR cache: %d, skipping\n", ret);
+		ret = 77;
+		goto out;
+	}
+
+	ret = test_round() || test_no_merge() ?
+	      EXIT_FAILURE : EXIT_SUCCESS;
+	printf("mr cache expand: %s\n", ret ? "FAIL" : "PASS");
+	ofi_mr_cache_cleanup(&cache);
+out:
+	util_test_fini();
+	free(buf);
+	return ret;
+}
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Tests the queued invalidation path of the MR cache, as used by the
+ * memhooks and userfaultfd monitors when FI_MR_CACHE_NOTIFY_QUEUE is set.
+ * A cache is opened over a stub monitor, so that the test decides when
+ * ranges are invalidated.  Registrations are counted to tell whether a
+ * search hit the cache.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <ofi_util.h>
+#include <ofi_mr.h>
+
+#include "util_test.h"
+
+#define QUEUE_SIZE	4
+#define BUF_SIZE	(64 * 1024)
+#define WRITER_CNT	2
+#define WRITER_LEN	4096
+#define WRITER_ITERS	20000
+
+static struct ofi_mr_cache cache;
+static char *buf;
+static ofi_atomic32_t reg_cnt;
+static ofi_atomic32_t pending_ready;
+static ofi_atomic32_t writer_errs;
+
+/* Entries hold the number of the registration that created them */
+static int add_region(struct ofi_mr_cache *cache, struct ofi_mr_entry *entry)
+{
+	*(int32_t *) entry->data = ofi_atomic_inc32(&reg_cnt);
+	return 0;
+}
+
+/* Invalidates a range the way a monitor does with queuing enabled */
+static void queue_notify(const void *addr, size_t len)
+{
+	pthread_rwlock_rdlock(&mm_list_rwlock);
+	ofi_monitor_queue_notify(&util_test_monitor, addr, len);
+	pthread_rwlock_unlock(&mm_list_rwlock);
+}
+
+/* Registers a range, and returns the number of its registration or 0 */
+static int32_t reg(char *addr, size_t len)
+{
+	struct ofi_mr_info mr_info = {
+		.iov.iov_base = addr,
+		.iov.iov_len = len,
+		.iface = FI_HMEM_SYSTEM,
+	};
+	struct ofi_mr_entry *entry;
+	int32_t id;
+
+	if (ofi_mr_cache_search(&cache, &mr_info, &entry))
+		return 0;
+
+	id = *(int32_t *) entry->data;
+	ofi_mr_cache_delete(&cache, entry);
+	return id;
+}
+
+/* Registers buf, and returns whether it was found in the cache */
+static int search(bool *hit)
+{
+	int32_t cnt = ofi_atomic_get32(&reg_cnt);
+
+	CHECK(reg(buf, BUF_SIZE));
+	*hit = cnt == ofi_atomic_get32(&reg_cnt);
+	return 0;
+}
+
+static int test_queued(void)
+{
+	size_t notify_cnt;
+	bool hit;
+
+	CHECK(!search(&hit));
+	CHECK(!hit);
+	CHECK(!search(&hit));
+	CHECK(hit);
+
+	/* the range is only queued, then applied before the next lookup */
+	notify_cnt = cache.notify_cnt;
+	queue_notify(buf + 4096, 4096);
+	CHECK(cache.notify_cnt == notify_cnt);
+	CHECK(cache.cached_cnt == 1);
+	CHECK(!search(&hit));
+	CHECK(!hit);
+	CHECK(cache.notify_cnt == notify_cnt + 1);
+	return 0;
+}
+
+/* Ranges in a batch are coalesced before they are applied */
+static int test_coalesce(void)
+{
+	size_t notify_cnt;
+	bool hit;
+
+	notify_cnt = cache.notify_cnt;
+	queue_notify(buf + 8192, 4096);
+	queue_notify(buf, 4096);
+	queue_notify(buf + 4096, 4096);
+	CHECK(!search(&hit));
+	CHECK(!hit);
+	CHECK(cache.notify_cnt == notify_cnt + 1);
+	return 0;
+}
+
+/* A full queue falls back to notifying the cache synchronously */
+static int test_full(void)
+{
+	static char other[QUEUE_SIZE];
+	size_t notify_cnt, i;
+	bool hit;
+
+	notify_cnt = cache.notify_cnt;
+	for (i = 0; i < QUEUE_SIZE; i++)
+		queue_notify(&other[i], 1);
+	CHECK(cache.notify_cnt == notify_cnt);
+	CHECK(cache.cached_cnt == 1);
+
+	queue_notify(buf, 1);
+	CHECK(cache.notify_cnt == notify_cnt + 1);
+	CHECK(cache.cached_cnt == 0);
+
+	CHECK(!search(&hit));
+	CHECK(!hit);
+	CHECK(!search(&hit));
+	CHECK(hit);
+	return 0;
+}
+
+/*
+ * Mimics the userfaultfd handler, which raises the pending count of the
+ * monitor before it reads an event, and only queues the range after the
+ * thread that unmapped the memory has resumed.
+ */
+static void *uffd_thread(void *arg)
+{
+	ofi_atomic_inc32(&util_test_monitor.pending);
+	ofi_atomic_set32(&pending_ready, 1);
+	usleep(100000);
+	queue_notify(buf, BUF_SIZE);
+	ofi_atomic_dec32(&util_test_monitor.pending);
+	return NULL;
+}
+
+static int test_pending(void)
+{
+	pthread_t thread;
+	bool hit;
+
+	CHECK(!pthread_create(&thread, NULL, uffd_thread, NULL));
+	while (!ofi_atomic_get32(&pending_ready))
+		sched_yield();
+
+	/* the search must wait for the event to be queued */
+	CHECK(!search(&hit));
+	pthread_join(thread, NULL);
+	CHECK(!hit);
+	CHECK(!ofi_atomic_get32(&util_test_monitor.pending));
+	return 0;
+}
+
+/*
+ * Each writer invalidates its own range, and its next search must miss.
+ * A slot reserved by the other writer, but not yet committed, must not
+ * hide the committed range from that search.
+ */
+static void *writer_thread(void *arg)
+{
+	char *addr = buf + (uintptr_t) arg * 2 * WRITER_LEN;
+	int32_t id, next;
+	int i;
+
+	for (i = 0; i < WRITER_ITERS; i++) {
+		id = reg(addr, WRITER_LEN);
+		queue_notify(addr, WRITER_LEN);
+		next = reg(addr, WRITER_LEN);
+		if (!id || !next || id == next) {
+			ofi_atomic_inc32(&writer_errs);
+			break;
+		}
+	}
+	return NULL;
+}
+
+static int test_writers(void)
+{
+	pthread_t thread[WRITER_CNT];
+	uintptr_t i;
+
+	for (i = 0; i < WRITER_CNT; i++)
+		CHECK(!pthread_create(&thread[i], NULL, writer_thread,
+				      (void *) i));
+	for (i = 0; i < WRITER_CNT; i++)
+		pthread_join(thread[i], NULL);
+
+	CHECK(!ofi_atomic_get32(&writer_errs));
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+
+	ofi_atomic_initialize32(&reg_cnt, 0);
+	ofi_atomic_initialize32(&pending_ready, 0);
+	ofi_atomic_initialize32(&writer_errs, 0);
+	buf = malloc(BUF_SIZE);
+	if (!buf)
+		return EXIT_FAILURE;
+
+	ret = util_test_init();
+	if (!ret) {
+		cache_params.notify_queue_size = QUEUE_SIZE;
+		cache.entry_data_size = sizeof(int32_t);
+		ret = util_test_cache_open(&cache, add_region);
+	}
+	if (ret) {
+		printf("cannot open an MR cache: %d, skipping\n", ret);
+		ret = 77;
+		goto out;
+	}
+
+	ret = test_queued() || test_coalesce() || test_full() ||
+	      test_pending() || test_writers() ? EXIT_FAILURE : EXIT_SUCCESS;
+	printf("mr cache notify queue: %s\n", ret ? "FAIL" : "PASS");
+	ofi_mr_cache_cleanup(&cache);
+out:
+	util_test_fini();
+	free(buf);
+	return ret;
+}
@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Tests the software triggered operations and deferred work of util
+ * providers.  A tcp rdm endpoint sends to itself over the loopback
+ * interface.  Deferred counter work is queued on counters of its domain to
+ * check threshold order, chaining, cancel, flush, counter close and the
+ * validation of deferred work.  A triggered send must only start once its
+ * threshold is reached.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ofi_util.h>
+#include <rdma/fi_trigger.h>
+
+#include "util_test.h"
+
+#define CNTR_CNT	3
+#define MSG_SIZE	64
+#define POLL_CNT	100
+
+static struct fi_info *info;
+static struct fid_fabric *fabric;
+static struct fid_domain *domain;
+static struct fid_av *av;
+static struct fid_cq *cq;
+static struct fid_ep *ep;
+static struct fid_cntr *cntrs[CNTR_CNT];
+static struct util_domain *util_domain;
+static fi_addr_t self_addr;
+
+static struct fi_op_cntr cntr_ops[4];
+static struct fi_deferred_work works[4];
+
+static int queue_cntr_work(int i, struct fid_cntr *trigger, uint64_t threshold,
+			   enum fi_op_type op_type, struct fid_cntr *cntr,
+			   uint64_t value)
+{
+	cntr_ops[i].cntr = cntr;
+	cntr_ops[i].value = value;
+	memset(&works[i], 0, sizeof(works[i]));
+	works[i].threshold = threshold;
+	works[i].triggering_cntr = trigger;
+	works[i].op_type = op_type;
+	works[i].op.cntr = &cntr_ops[i];
+	return fi_control(&domain->fid, FI_QUEUE_WORK, &works[i]);
+}
+
+static int reset_cntrs(void)
+{
+	int i;
+
+	for (i = 0; i < CNTR_CNT; i++) {
+		CHECK(!fi_cntr_set(cntrs[i], 0));
+		CHECK(!fi_cntr_seterr(cntrs[i], 0));
+	}
+	return 0;
+}
+
+/* Requests start in threshold order, and in queue order for equal ones */
+static int test_order(void)
+{
+	CHECK(!reset_cntrs());
+	CHECK(!queue_cntr_work(0, cntrs[0], 2, FI_OP_CNTR_SET, cntrs[1], 5));
+	CHECK(!queue_cntr_work(1, cntrs[0], 2, FI_OP_CNTR_SET, cntrs[1], 7));
+	CHECK(!queue_cntr_work(2, cntrs[0], 1, FI_OP_CNTR_SET, cntrs[1], 3));
+	CHECK(ofi_atomic_get32(&util_domain->trigger_cnt) == 3);
+
+	CHECK(fi_cntr_read(cntrs[1]) == 0);
+	CHECK(!fi_cntr_add(cntrs[0], 1));
+	CHECK(fi_cntr_read(cntrs[0]) == 1);
+	CHECK(fi_cntr_read(cntrs[1]) == 3);
+
+	/* errors count toward the threshold */
+	CHECK(!fi_cntr_adderr(cntrs[0], 1));
+	CHECK(fi_cntr_read(cntrs[0]) == 1);
+	CHECK(fi_cntr_read(cntrs[1]) == 7);
+	CHECK(!ofi_atomic_get32(&util_domain->trigger_cnt));
+	return 0;
+}
+
+/* Work started by a request is issued in the same progress call */
+static int test_chain(void)
+{
+	CHECK(!reset_cntrs());
+	CHECK(!queue_cntr_work(0, cntrs[1], 1, FI_OP_CNTR_ADD, cntrs[2], 1));
+	CHECK(!queue_cntr_work(1, cntrs[0], 1, FI_OP_CNTR_ADD, cntrs[1], 1));
+
+	CHECK(!fi_cntr_add(cntrs[0], 1));
+	CHECK(fi_cntr_read(cntrs[0]) == 1);
+	CHECK(!ofi_atomic_get32(&util_domain->trigger_cnt));
+	CHECK(fi_cntr_read(cntrs[1]) == 1);
+	CHECK(fi_cntr_read(cntrs[2]) == 1);
+	return 0;
+}
+
+/* Work whose threshold was already reached starts when it is queued */
+static int test_immediate(void)
+{
+	CHECK(!reset_cntrs());
+	CHECK(!fi_cntr_add(cntrs[0], 4));
+	CHECK(!queue_cntr_work(0, cntrs[0], 4, FI_OP_CNTR_ADD, cntrs[1], 2));
+	CHECK(!ofi_atomic_get32(&util_domain->trigger_cnt));
+	CHECK(fi_cntr_read(cntrs[1]) == 2);
+	return 0;
+}
+
+static int test_cancel(void)
+{
+	CHECK(!reset_cntrs());
+	CHECK(!queue_cntr_work(0, cntrs[0], 1, FI_OP_CNTR_ADD, cntrs[1], 1));
+	CHECK(!queue_cntr_work(1, cntrs[0], 1, FI_OP_CNTR_ADD, cntrs[2], 1));
+	CHECK(!fi_control(&domain->fid, FI_CANCEL_WORK, &works[0]));
+	CHECK(fi_control(&domain->fid, FI_CANCEL_WORK, &works[0]) ==
+	      -FI_ENOENT);
+
+	CHECK(!fi_cntr_add(cntrs[0], 1));
+	CHECK(fi_cntr_read(cntrs[0]) == 1);
+	CHECK(fi_cntr_read(cntrs[1]) == 0);
+	CHECK(fi_cntr_read(cntrs[2]) == 1);
+	return 0;
+}
+
+/* Flushing by counter only drops the work queued on that counter */
+static int test_flush(void)
+{
+	struct fi_deferred_work flush = { 0 };
+
+	CHECK(!reset_cntrs());
+	CHECK(!queue_cntr_work(0, cntrs[0], 1, FI_OP_CNTR_ADD, cntrs[2], 1));
+	CHECK(!queue_cntr_work(1, cntrs[0], 2, FI_OP_CNTR_ADD, cntrs[2], 1));
+	CHECK(!queue_cntr_work(2, cntrs[1], 1, FI_OP_CNTR_ADD, cntrs[2], 1));
+
+	flush.triggering_cntr = cntrs[0];
+	CHECK(!fi_control(&domain->fid, FI_FLUSH_WORK, &flush));
+	CHECK(ofi_atomic_get32(&util_domain->trigger_cnt) == 1);
+	CHECK(!fi_cntr_add(cntrs[0], 2));
+	CHECK(!fi_cntr_add(cntrs[1], 1));
+	CHECK(fi_cntr_read(cntrs[1]) == 1);
+	CHECK(fi_cntr_read(cntrs[2]) == 1);
+
+	CHECK(!queue_cntr_work(0, cntrs[0], 10, FI_OP_CNTR_ADD, cntrs[2], 1));
+	CHECK(!queue_cntr_work(1, cntrs[1], 10, FI_OP_CNTR_ADD, cntrs[2], 1));
+	CHECK(!fi_control(&domain->fid, FI_FLUSH_WORK, NULL));
+	CHECK(!ofi_atomic_get32(&util_domain->trigger_cnt));
+	return 0;
+}
+
+/* Closing a counter releases the work that it would have triggered */
+static int test_cntr_close(void)
+{
+	struct fi_cntr_attr attr = { .wait_obj = FI_WAIT_NONE };
+	struct fid_cntr *cntr;
+
+	CHECK(!fi_cntr_open(domain, &attr, &cntr, NULL));
+	CHECK(!queue_cntr_work(0, cntr, 1, FI_OP_CNTR_ADD, cntrs[0], 1));
+	CHECK(!queue_cntr_work(1, cntr, 2, FI_OP_CNTR_ADD, cntrs[0], 1));
+	CHECK(ofi_atomic_get32(&util_domain->trigger_cnt) == 2);
+	CHECK(!fi_close(&cntr->fid));
+	CHECK(!ofi_atomic_get32(&util_domain->trigger_cnt));
+	CHECK(dlist_empty(&util_domain->trigger_cntrs));
+	return 0;
+}
+
+static int read_cq(struct fi_cq_entry *comp, int cnt)
+{
+	int i, n = 0;
+	ssize_t ret;
+
+	for (i = 0; i < POLL_CNT * 100 && n < cnt; i++) {
+		ret = fi_cq_read(cq, &comp[n], cnt - n);
+		if (ret > 0)
+			n += (int) ret;
+		else if (ret != -FI_EAGAIN)
+			return (int) ret;
+	}
+	return n;
+}
+
+/* A triggered send is held until its counter reaches the threshold */
+static int test_triggered_send(void)
+{
+	struct fi_triggered_context trigger_ctx = { 0 };
+	struct fi_context recv_ctx;
+	struct fi_cq_entry comp[2];
+	char send_buf[MSG_SIZE], recv_buf[MSG_SIZE];
+	struct iovec iov = { .iov_base = send_buf, .iov_len = MSG_SIZE };
+	struct fi_msg msg = {
+		.msg_iov = &iov,
+		.iov_count = 1,
+		.addr = self_addr,
+		.context = &trigger_ctx,
+	};
+	int i;
+
+	CHECK(!reset_cntrs());
+	memset(send_buf, 0xa5, sizeof(send_buf));
+	memset(recv_buf, 0, sizeof(recv_buf));
+	trigger_ctx.event_type = FI_TRIGGER_THRESHOLD;
+	trigger_ctx.trigger.threshold.cntr = cntrs[0];
+	trigger_ctx.trigger.threshold.threshold = 1;
+
+	CHECK(!fi_recv(ep, recv_buf, MSG_SIZE, NULL, self_addr, &recv_ctx));
+	CHECK(!fi_sendmsg(ep, &msg, FI_TRIGGER | FI_COMPLETION));
+
+	/* the send is copied, so the caller's descriptors may be reused */
+	memset(&iov, 0, sizeof(iov));
+	for (i = 0; i < POLL_CNT; i++)
+		CHECK(fi_cq_read(cq, comp, 1) == -FI_EAGAIN);
+	CHECK(ofi_atomic_get32(&util_domain->trigger_cnt) == 1);
+
+	CHECK(!fi_cntr_add(cntrs[0], 1));
+	CHECK(read_cq(comp, 2) == 2);
+	CHECK((comp[0].op_context == &trigger_ctx &&
+	       comp[1].op_context == &recv_ctx) ||
+	      (comp[0].op_context == &recv_ctx &&
+	       comp[1].op_context == &trigger_ctx));
+	CHECK(!memcmp(send_buf, recv_buf, MSG_SIZE));
+	return 0;
+}
+
+/* Deferred transfers may only complete through the endpoint's counters */
+static int test_invalid(void)
+{
+	struct fi_deferred_work work = { 0 };
+	struct fi_op_msg op_msg = { 0 };
+	char buf[MSG_SIZE];
+	struct iovec iov = { .iov_base = buf, .iov_len = MSG_SIZE };
+
+	op_msg.ep = ep;
+	op_msg.msg.msg_iov = &iov;
+	op_msg.msg.iov_count = 1;
+	op_msg.msg.addr = self_addr;
+	work.threshold = 1;
+	work.op_type = FI_OP_SEND;
+	work.op.msg = &op_msg;
+	work.completion_cntr = cntrs[1];
+
+	CHECK(fi_control(&domain->fid, FI_QUEUE_WORK, &work) == -FI_EINVAL);
+	work.triggering_cntr = cntrs[0];
+	CHECK(fi_control(&domain->fid, FI_QUEUE_WORK, &work) == -FI_ENOSYS);
+
+	work.op_type = FI_OP_CNTR_ADD;
+	work.op.cntr = &cntr_ops[0];
+	cntr_ops[0].cntr = cntrs[1];
+	CHECK(fi_control(&domain->fid, FI_QUEUE_WORK, &work) == -FI_EINVAL);
+	CHECK(!ofi_atomic_get32(&util_domain->trigger_cnt));
+	return 0;
+}
+
+static int open_ep(void)
+{
+	struct fi_cq_attr cq_attr = { .format = FI_CQ_FORMAT_CONTEXT };
+	struct fi_cntr_attr cntr_attr = { .wait_obj = FI_WAIT_NONE };
+	struct fi_av_attr av_attr = { 0 };
+	struct fi_info *hints;
+	char addr[64];
+	size_t addrlen = sizeof(addr);
+	int i, ret;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return -FI_ENOMEM;
+
+	hints->caps = FI_MSG | FI_TRIGGER;
+	hints->ep_attr->type = FI_EP_RDM;
+	hints->domain_attr->mr_mode = FI_MR_LOCAL | OFI_MR_BASIC_MAP;
+	hints->fabric_attr->prov_name = strdup("tcp");
+	ret = fi_getinfo(FI_VERSION(2, 0), "127.0.0.1", NULL, FI_SOURCE,
+			 hints, &info);
+	fi_freeinfo(hints);
+	if (ret)
+		return ret;
+
+	ret = fi_fabric(info->fabric_attr, &fabric, NULL);
+	if (ret)
+		return ret;
+
+	ret = fi_domain(fabric, info, &domain, NULL);
+	if (ret)
+		return ret;
+
+	util_domain = container_of(domain, struct util_domain, domain_fid);
+	for (i = 0; i < CNTR_CNT; i++) {
+		ret = fi_cntr_open(domain, &cntr_attr, &cntrs[i], NULL);
+		if (ret)
+			return ret;
+	}
+
+	ret = fi_av_open(domain, &av_attr, &av, NULL);
+	if (ret)
+		return ret;
+
+	ret = fi_cq_open(domain, &cq_attr, &cq, NULL);
+	if (ret)
+		return ret;
+
+	ret = fi_endpoint(domain, info, &ep, NULL);
+	if (ret)
+		return ret;
+
+	ret = fi_ep_bind(ep, &av->fid, 0) ? :
+	      fi_ep_bind(ep, &cq->fid, FI_TRANSMIT | FI_RECV) ? :
+	      fi_enable(ep) ? :
+	      fi_getname(&ep->fid, addr, &addrlen);
+	if (ret)
+		return ret;
+
+	return fi_av_insert(av, addr, 1, &self_addr, 0, NULL) == 1 ?
+	       0 : -FI_EINVAL;
+}
+
+static void close_ep(void)
+{
+	int i;
+
+	if (ep)
+		fi_close(&ep->fid);
+	if (cq)
+		fi_close(&cq->fid);
+	if (av)
+		fi_close(&av->fid);
+	for (i = 0; i < CNTR_CNT; i++) {
+		if (cntrs[i])
+			fi_close(&cntrs[i]->fid);
+	}
+	if (domain)
+		fi_close(&domain->fid);
+	if (fabric)
+		fi_close(&fabric->fid);
+	fi_freeinfo(info);
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+
+	ret = open_ep();
+	if (ret) {
+		printf("cannot open a tcp rdm endpoint: %d, skipping\n", ret);
+		ret = 77;
+		goto out;
+	}
+
+	ret = test_order() || test_chain() || test_immediate() ||
+	      test_cancel() || test_flush() || test_cntr_close() ||
+	      test_invalid() || test_triggered_send() ?
+	      EXIT_FAILURE : EXIT_SUCCESS;
+	printf("triggered operations: %s\n", ret ? "FAIL" : "PASS");
+out:
+	close_ep();
+	return ret;
+}
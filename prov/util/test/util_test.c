@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Fixtures shared by the unit tests of internal util interfaces */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <ofi_util.h>
+#include <ofi_mr.h>
+
+#include "util_test.h"
+
+struct ofi_mem_monitor util_test_monitor;
+
+static struct fi_info *info;
+static struct ofi_mem_monitor *monitors[OFI_HMEM_MAX];
+
+static int stub_start(struct ofi_mem_monitor *monitor)
+{
+	return 0;
+}
+
+static void stub_stop(struct ofi_mem_monitor *monitor)
+{
+}
+
+static int stub_subscribe(struct ofi_mem_monitor *monitor, const void *addr,
+			  size_t len, union ofi_mr_hmem_info *hmem_info)
+{
+	return 0;
+}
+
+static void stub_unsubscribe(struct ofi_mem_monitor *monitor,
+			     const void *addr, size_t len,
+			     union ofi_mr_hmem_info *hmem_info)
+{
+}
+
+static bool stub_valid(struct ofi_mem_monitor *monitor,
+		       const struct ofi_mr_info *info,
+		       struct ofi_mr_entry *entry)
+{
+	return true;
+}
+
+static void delete_region(struct ofi_mr_cache *cache,
+			  struct ofi_mr_entry *entry)
+{
+}
+
+/* Initializes the library, including its memory monitors */
+int util_test_init(void)
+{
+	struct fi_info *hints;
+	int ret;
+
+	hints = fi_allocinfo();
+	if (!hints)
+		return -FI_ENOMEM;
+
+	hints->fabric_attr->prov_name = strdup("udp");
+	ret = fi_getinfo(FI_VERSION(2, 0), NULL, NULL, 0, hints, &info);
+	fi_freeinfo(hints);
+	if (ret)
+		return ret;
+
+	ofi_monitor_init(&util_test_monitor);
+	util_test_monitor.iface = FI_HMEM_SYSTEM;
+	util_test_monitor.start = stub_start;
+	util_test_monitor.stop = stub_stop;
+	util_test_monitor.subscribe = stub_subscribe;
+	util_test_monitor.unsubscribe = stub_unsubscribe;
+	util_test_monitor.valid = stub_valid;
+	util_test_monitor.name = "stub";
+	monitors[FI_HMEM_SYSTEM] = &util_test_monitor;
+	return 0;
+}
+
+void util_test_fini(void)
+{
+	fi_freeinfo(info);
+	info = NULL;
+}
+
+int util_test_cache_open(struct ofi_mr_cache *cache,
+			 int (*add_region)(struct ofi_mr_cache *cache,
+					   struct ofi_mr_entry *entry))
+{
+	cache->add_region = add_region;
+	cache->delete_region = delete_region;
+	return ofi_mr_cache_init(NULL, monitors, cache);
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Helpers shared by the unit tests of internal util interfaces */
+
+#ifndef _UTIL_TEST_H_
+#define _UTIL_TEST_H_
+
+#include <stdio.h>
+
+#include <ofi_mr.h>
+
+/* Fails the calling test function, which returns an int, if cond is false */
+#define CHECK(cond)							\
+	do {								\
+		if (!(cond)) {						\
+			printf("%s:%d: check failed: %s\n", __func__,	\
+			       __LINE__, #cond);			\
+			return -1;					\
+		}							\
+	} while (0)
+
+/*
+ * MR caches over a stub memory monitor, util_test_monitor, which leaves it
+ * to the test to invalidate ranges.  util_test_init() initializes the
+ * library through the udp provider, which resets cache_params, so they are
+ * set between util_test_init() and util_test_cache_open().  Defined in
+ * util_test.c.
+ */
+extern struct ofi_mem_monitor util_test_monitor;
+
+int util_test_init(void);
+void util_test_fini(void);
+int util_test_cache_open(struct ofi_mr_cache *cache,
+			 int (*add_region)(struct ofi_mr_cache *cache,
+					   struct ofi_mr_entry *entry));
+
+#endif /* _UTIL_TEST_H_ */
@@ -86,6 +86,8 @@ struct ofi_common_locks common_locks = {
 };
 
 size_t ofi_universe_size = 1024;
+size_t ofi_cq_shards;
+size_t ofi_wait_spin = 20;
 int ofi_av_remove_cleanup;
 char *ofi_offload_coll_prov_name = NULL;
 
@@ -1184,8 +1186,74 @@ int ofi_bsock_flush_sync(struct ofi_bsock *bsock)
 	return ofi_bsock_tosend(bsock) ? -FI_EAGAIN : 0;
 }
 
+/* Number of samples of each send type needed to adjust the threshold */
+#define OFI_ZEROCOPY_TUNE_SAMPLES	8
+/* One out of this many zero copy eligible sends is copied to time it */
+#define OFI_ZEROCOPY_TUNE_PROBE		16
+#define OFI_ZEROCOPY_TUNE_MAX		(1 << 24)
+/* Maximum number of notifications reaped from the error queue per call */
+#define OFI_ZEROCOPY_DONE_BATCH		32
+
+static bool
+ofi_bsock_use_zerocopy(struct ofi_bsock *bsock, size_t len, uint64_t *start)
+{
+	*start = 0;
+	if (len <= bsock->zerocopy_size)
+		return false;
+
+	if (!bsock->zc_tune.enabled)
+		return true;
+
+	*start = ofi_gettime_ns();
+	return ++bsock->zc_tune.eligible % OFI_ZEROCOPY_TUNE_PROBE;
+}
+
+static void ofi_bsock_tune_zerocopy(struct ofi_zerocopy_tune *tune,
+				    size_t *zerocopy_size)
+{
+	if (tune->copy_cnt < OFI_ZEROCOPY_TUNE_SAMPLES ||
+	    tune->zc_cnt < OFI_ZEROCOPY_TUNE_SAMPLES)
+		return;
+
+	/* compare the cost per byte of each type of send */
+	if (tune->zc_ns * tune->copy_bytes > tune->copy_ns * tune->zc_bytes) {
+		if (*zerocopy_size < OFI_ZEROCOPY_TUNE_MAX)
+			*zerocopy_size = MAX(*zerocopy_size * 2,
+					     (size_t) OFI_ZEROCOPY_SIZE);
+	} else {
+		*zerocopy_size = MAX(*zerocopy_size / 2, tune->min_size);
+	}
+
+	tune->copy_cnt = tune->zc_cnt = 0;
+	tune->copy_ns = tune->copy_bytes = 0;
+	tune->zc_ns = tune->zc_bytes = 0;
+}
+
+static void ofi_bsock_sample_send(struct ofi_bsock *bsock, bool zerocopy,
+				  uint64_t start, size_t len)
+{
+	struct ofi_zerocopy_tune *tune = &bsock->zc_tune;
+	uint64_t ns;
+
+	if (!start)
+		return;
+
+	ns = ofi_gettime_ns() - start;
+	if (zerocopy) {
+		tune->zc_ns += ns;
+		tune->zc_bytes += len;
+		tune->zc_cnt++;
+	} else {
+		tune->copy_ns += ns;
+		tune->copy_bytes += len;
+		tune->copy_cnt++;
+	}
+	ofi_bsock_tune_zerocopy(tune, &bsock->zerocopy_size);
+}
+
 int ofi_bsock_send(struct ofi_bsock *bsock, const void *buf, size_t *len)
 {
+	uint64_t start;
 	size_t avail;
 	ssize_t ret;
 	int err;
@@ -1206,11 +1274,12 @@ int ofi_bsock_send(struct ofi_bsock *bsock, const void *buf, size_t *len)
 	}
 
 	assert(!ofi_bsock_tosend(bsock));
-	if (*len > bsock->zerocopy_size) {
+	if (ofi_bsock_use_zerocopy(bsock, *len, &start)) {
 		ret = bsock->sockapi->send(bsock->sockapi, bsock->sock, buf, *len,
 					   MSG_NOSIGNAL | OFI_ZEROCOPY,
 					   &bsock->tx_sockctx);
 		if (ret >= 0) {
+			ofi_bsock_sample_send(bsock, true, start, ret);
 			bsock->async_index++;
 			*len = ret;
 			return -OFI_EINPROGRESS_ASYNC;
@@ -1218,6 +1287,8 @@ int ofi_bsock_send(struct ofi_bsock *bsock, const void *buf, size_t *len)
 	} else {
 		ret = bsock->sockapi->send(bsock->sockapi, bsock->sock, buf, *len,
 					   MSG_NOSIGNAL, &bsock->tx_sockctx);
+		if (ret > 0)
+			ofi_bsock_sample_send(bsock, false, start, ret);
 	}
 	if (ret < 0) {
 		if (ret == -OFI_EINPROGRESS_URING)
@@ -1239,6 +1310,7 @@ int ofi_bsock_send(struct ofi_bsock *bsock, const void *buf, size_t *len)
 int ofi_bsock_sendv(struct ofi_bsock *bsock, const struct iovec *iov,
 		    size_t cnt, size_t *len)
 {
+	uint64_t start;
 	size_t avail;
 	ssize_t ret;
 	int err;
@@ -1266,11 +1338,12 @@ int ofi_bsock_sendv(struct ofi_bsock *bsock, const struct iovec *iov,
 
 	assert(!ofi_bsock_tosend(bsock));
 
-	if (*len > bsock->zerocopy_size) {
+	if (ofi_bsock_use_zerocopy(bsock, *len, &start)) {
 		ret = bsock->sockapi->sendv(bsock->sockapi, bsock->sock, iov, cnt,
 					    MSG_NOSIGNAL | OFI_ZEROCOPY,
 					    &bsock->tx_sockctx);
 		if (ret >= 0) {
+			ofi_bsock_sample_send(bsock, true, start, ret);
 			bsock->async_index++;
 			*len = ret;
 			return -OFI_EINPROGRESS_ASYNC;
@@ -1278,6 +1351,8 @@ int ofi_bsock_sendv(struct ofi_bsock *bsock, const struct iovec *iov,
 	} else {
 		ret = bsock->sockapi->sendv(bsock->sockapi, bsock->sock, iov, cnt,
 					    MSG_NOSIGNAL, &bsock->tx_sockctx);
+		if (ret > 0)
+			ofi_bsock_sample_send(bsock, false, start, ret);
 	}
 	if (ret < 0) {
 		if (ret == -OFI_EINPROGRESS_URING)
@@ -1425,8 +1500,9 @@ void ofi_bsock_prefetch_done(struct ofi_bsock *bsock, size_t len)
 }
 
 #ifdef MSG_ZEROCOPY
-int ofi_bsock_async_done(const struct fi_provider *prov,
-			 struct ofi_bsock *bsock)
+/* Returns 1 if a notification was reaped, 0 if the error queue is empty */
+static int ofi_bsock_reap_zerocopy(const struct fi_provider *prov,
+				   struct ofi_bsock *bsock)
 {
 	struct msghdr msg = {};
 	struct sock_extended_err *serr;
@@ -1435,20 +1511,6 @@ int ofi_bsock_async_done(const struct fi_provider *prov,
 	uint8_t ctrl[CMSG_SPACE(sizeof(*serr) * 2)];
 	int ret;
 
-	int val = 0;
-	socklen_t len = sizeof(val);
-	ret = getsockopt(bsock->sock, SOL_SOCKET, SO_ERROR, &val, &len);
-	if (ret < 0) {
-		FI_WARN(prov, FI_LOG_EP_DATA,
-			"Error reading socket error (%s)\n", strerror(errno));
-		return -errno;
-	}
-	if (val != 0) {
-		FI_WARN(prov, FI_LOG_EP_DATA,
-			"Socket error (%s)\n", strerror(val));
-		return -val;
-	}
-
 	msg.msg_control = &ctrl;
 	msg.msg_controllen = sizeof(ctrl);
 	ret = recvmsg(bsock->sock, &msg, MSG_ERRQUEUE);
@@ -1477,7 +1539,9 @@ int ofi_bsock_async_done(const struct fi_provider *prov,
 		return -FI_EINVAL;
 	}
 
-	bsock->done_index = serr->ee_data;
+	/* each notification completes the range [ee_info, ee_data] */
+	if (ofi_val32_gt(serr->ee_data, bsock->done_index))
+		bsock->done_index = serr->ee_data;
 	if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
 		FI_WARN(prov, FI_LOG_EP_DATA,
 			"Zerocopy data was copied\n");
@@ -1486,7 +1550,43 @@ int ofi_bsock_async_done(const struct fi_provider *prov,
 			bsock->zerocopy_size = SIZE_MAX;
 		}
 	}
-	return 0;
+	return 1;
+}
+
+int ofi_bsock_async_done(const struct fi_provider *prov,
+			 struct ofi_bsock *bsock)
+{
+	uint64_t start = 0;
+	int i, ret;
+
+	int val = 0;
+	socklen_t len = sizeof(val);
+	ret = getsockopt(bsock->sock, SOL_SOCKET, SO_ERROR, &val, &len);
+	if (ret < 0) {
+		FI_WARN(prov, FI_LOG_EP_DATA,
+			"Error reading socket error (%s)\n", strerror(errno));
+		return -errno;
+	}
+	if (val != 0) {
+		FI_WARN(prov, FI_LOG_EP_DATA,
+			"Socket error (%s)\n", strerror(val));
+		return -val;
+	}
+
+	if (bsock->zc_tune.enabled)
+		start = ofi_gettime_ns();
+
+	/* Reap notifications in batches to reduce the number of wakeups */
+	for (i = 0; i < OFI_ZEROCOPY_DONE_BATCH; i++) {
+		ret = ofi_bsock_reap_zerocopy(prov, bsock);
+		if (ret <= 0)
+			break;
+	}
+
+	/* Charge the time spent reaping notifications to zero copy sends */
+	if (start)
+		bsock->zc_tune.zc_ns += ofi_gettime_ns() - start;
+	return ret < 0 ? ret : 0;
 }
 #else
 int ofi_bsock_async_done(const struct fi_provider *prov,
@@ -66,6 +66,22 @@ struct ofi_prov {
 	void			*dlhandle;
 	bool			hidden;
 	bool			preferred;
+	bool			lazy;
+	uint64_t		ini_ns;
+};
+
+/*
+ * A provider registration that is deferred until the provider is first
+ * needed.  Built-in providers are registered through ini, and DL providers
+ * by opening lib.  Deferred registrations run in the order in which they
+ * would have run at fi_ini.
+ */
+struct ofi_lazy_prov {
+	struct ofi_lazy_prov	*next;
+	struct ofi_prov		*prov;
+	struct fi_provider	*(*ini)(void);
+	char			*lib;
+	bool			lib_known;
 };
 
 enum ofi_prov_order {
@@ -79,8 +95,10 @@ struct ofi_info_match {
 };
 
 static struct ofi_prov *prov_head, *prov_tail;
+static struct ofi_lazy_prov *lazy_head, *lazy_tail;
 static enum ofi_prov_order prov_order = OFI_PROV_ORDER_VERSION;
 static bool prov_preferred = false;
+static int prov_lazy;
 int ofi_init = 0;
 extern struct ofi_common_locks common_locks;
 
@@ -369,7 +387,7 @@ static bool ofi_have_name_filter(const struct fi_info *hints)
 	return false;
 }
 
-static bool ofi_getinfo_filter(const struct fi_provider *provider)
+static bool ofi_getinfo_filter(const char *name, bool core)
 {
 	/* Positive filters only apply to core providers.  They must be
 	 * explicitly enabled by the filter.  Other providers (i.e. utility)
@@ -377,10 +395,10 @@ static bool ofi_getinfo_filter(const struct fi_provider *provider)
 	 * over any enabled core filter.  Negative filters may be used
 	 * to disable any provider.
 	 */
-	if (!prov_filter.negated && !ofi_is_core_prov(provider))
+	if (!prov_filter.negated && !core)
 		return false;
 
-	return ofi_apply_prov_init_filter(&prov_filter, provider->name);
+	return ofi_apply_prov_init_filter(&prov_filter, name);
 }
 
 static void ofi_filter_info(const struct fi_info *hints, struct fi_info **info)
@@ -424,6 +442,8 @@ static struct ofi_prov *ofi_getprov(const char *prov_name, size_t len)
 	return NULL;
 }
 
+static void ofi_load_lazy_prov(struct ofi_prov *prov);
+
 static struct fi_provider *ofi_get_hook(const char *name)
 {
 	struct ofi_prov *prov;
@@ -440,6 +460,11 @@ static struct fi_provider *ofi_get_hook(const char *name)
 			try_name = NULL;
 	}
 
+	if (prov && prov->lazy) {
+		ofi_load_lazy_prov(prov);
+		prov = ofi_getprov(prov->prov_name, strlen(prov->prov_name));
+	}
+
 	if (prov) {
 		if (prov->provider && ofi_is_hook_prov(prov->provider)) {
 			provider = prov->provider;
@@ -480,7 +505,7 @@ static void ofi_ordered_provs_init(void)
 		 * doesn't matter
 		 */
 		"ofi_hook_perf", "ofi_hook_trace", "ofi_hook_profile",
-		"ofi_hook_monitor", "ofi_hook_debug",
+		"ofi_hook_monitor", "ofi_hook_record", "ofi_hook_debug",
 		"ofi_hook_noop", "ofi_hook_hmem", "ofi_hook_dmabuf_peer_mem",
 
 		/* So do the offload providers. */
@@ -512,7 +537,8 @@ static void ofi_set_prov_type(struct fi_provider *provider)
 		ofi_prov_ctx(provider)->type = OFI_PROV_CORE;
 }
 
-static void ofi_register_provider(struct fi_provider *provider, void *dlhandle)
+static void ofi_register_provider(struct fi_provider *provider, void *dlhandle,
+				  uint64_t ini_ns)
 {
 	struct ofi_prov *prov = NULL;
 	bool hidden = false;
@@ -524,8 +550,9 @@ static void ofi_register_provider(struct fi_provider *provider, void *dlhandle)
 	}
 
 	FI_INFO(&core_prov, FI_LOG_CORE,
-	       "registering provider: %s (%d.%d)\n", provider->name,
-	       FI_MAJOR(provider->version), FI_MINOR(provider->version));
+	       "registering provider: %s (%d.%d), initialized in %" PRIu64
+	       " us\n", provider->name, FI_MAJOR(provider->version),
+	       FI_MINOR(provider->version), ini_ns / 1000);
 
 	if (!provider->fabric) {
 		FI_WARN(&core_prov, FI_LOG_CORE,
@@ -549,7 +576,7 @@ static void ofi_register_provider(struct fi_provider *provider, void *dlhandle)
 
 	ofi_set_prov_type(provider);
 
-	if (ofi_getinfo_filter(provider)) {
+	if (ofi_getinfo_filter(provider->name, ofi_is_core_prov(provider))) {
 		FI_INFO(&core_prov, FI_LOG_CORE,
 			"\"%s\" filtered by provider include/exclude "
 			"list, skipping\n", provider->name);
@@ -585,12 +612,93 @@ static void ofi_register_provider(struct fi_provider *provider, void *dlhandle)
 
 	if (hidden)
 		prov->hidden = true;
+	prov->ini_ns = ini_ns;
 	return;
 
 cleanup:
 	ofi_cleanup_prov(provider, dlhandle);
 }
 
+static void ofi_reg_builtin_prov(struct fi_provider *(*ini)(void))
+{
+	struct fi_provider *provider;
+	uint64_t start;
+
+	start = ofi_gettime_ns();
+	provider = ini();
+	ofi_register_provider(provider, NULL, ofi_gettime_ns() - start);
+}
+
+/*
+ * Until its ini function runs, a deferred provider is only known by name.
+ * The type of the provider is derived from the name, following the naming
+ * conventions that ofi_set_prov_type() relies on.
+ */
+static bool ofi_is_core_name(const char *name)
+{
+	return !ofi_has_util_prefix(name) && !ofi_has_offload_prefix(name) &&
+	       !ofi_is_lnx(name);
+}
+
+static bool ofi_is_hook_name(const char *name)
+{
+	return !strncasecmp(name, "ofi_hook_", strlen("ofi_hook_"));
+}
+
+/*
+ * Record a provider registration to run once the provider is needed.
+ * Providers that already have a registered provider with the same name
+ * are not deferred, so that a deferred provider is always represented
+ * by a placeholder entry.
+ */
+static int ofi_defer_prov(const char *name, struct fi_provider *(*ini)(void),
+			  const char *lib, bool lib_known)
+{
+	struct ofi_lazy_prov *entry;
+	struct ofi_prov *prov;
+
+	prov = ofi_getprov(name, strlen(name));
+	if (prov && prov->provider)
+		return -FI_EALREADY;
+
+	entry = calloc(1, sizeof(*entry));
+	if (!entry)
+		return -FI_ENOMEM;
+
+	if (lib) {
+		entry->lib = strdup(lib);
+		if (!entry->lib)
+			goto err;
+	}
+
+	if (!prov) {
+		prov = ofi_alloc_prov(name);
+		if (!prov)
+			goto err;
+		ofi_insert_prov(prov);
+	}
+
+	if (!prov->lazy) {
+		prov->lazy = true;
+		prov->hidden = ofi_getinfo_filter(name, ofi_is_core_name(name));
+	}
+
+	entry->prov = prov;
+	entry->ini = ini;
+	entry->lib_known = lib_known;
+	if (lazy_tail)
+		lazy_tail->next = entry;
+	else
+		lazy_head = entry;
+	lazy_tail = entry;
+	return 0;
+
+err:
+	free(entry->lib);
+	free(entry);
+	return -FI_ENOMEM;
+}
+
 #ifdef HAVE_LIBDL
 static int lib_filter(const struct dirent *entry)
 {
@@ -663,9 +771,13 @@ static void ofi_reg_dl_prov(const char *lib, bool lib_known_to_exist)
 {
 	void *dlhandle;
 	struct fi_provider* (*inif)(void);
+	struct fi_provider *provider;
+	uint64_t start;
 
 	FI_DBG(&core_prov, FI_LOG_CORE, "opening provider lib %s\n", lib);
 
+	start = ofi_gettime_ns();
+
 	dlhandle = dlopen(lib, RTLD_NOW);
 	if (dlhandle == NULL) {
 		if (lib_known_to_exist) {
@@ -683,8 +795,43 @@ static void ofi_reg_dl_prov(const char *lib, bool lib_known_to_exist)
 		FI_WARN(&core_prov, FI_LOG_CORE, "dlsym: %s\n", dlerror());
 		dlclose(dlhandle);
 	} else {
-		ofi_register_provider((inif)(), dlhandle);
+		provider = (inif)();
+		ofi_register_provider(provider, dlhandle,
+				      ofi_gettime_ns() - start);
+	}
+}
+
+/*
+ * Defer a library found in a provider directory.  The provider name is
+ * derived from the lib<name>-fi.so naming convention, and only libraries
+ * that match a known provider name are deferred.
+ */
+static int ofi_defer_dl_prov(const char *file, const char *lib)
+{
+	const char *prefixes[] = { "", OFI_UTIL_PREFIX, OFI_OFFLOAD_PREFIX };
+	size_t sfx = sizeof("-" FI_LIB_SUFFIX) - 1;
+	size_t len = strlen(file);
+	struct ofi_prov *prov;
+	char name[64];
+	int i, ret;
+
+	if (strncmp(file, "lib", 3) || len <= sfx + 3 ||
+	    strcmp(&file[len - sfx], "-" FI_LIB_SUFFIX))
+		return -FI_ENODATA;
+
+	len -= sfx + 3;
+	for (i = 0; i < ARRAY_SIZE(prefixes); i++) {
+		ret = snprintf(name, sizeof(name), "%s%.*s", prefixes[i],
+			       (int) len, &file[3]);
+		if (ret < 0 || ret >= sizeof(name))
+			return -FI_ENODATA;
+
+		prov = ofi_getprov(name, ret);
+		if (prov)
+			return ofi_defer_prov(name, NULL, lib, true);
 	}
+
+	return -FI_ENODATA;
 }
 
 static void ofi_ini_dir(const char *dir)
@@ -703,7 +850,8 @@ static void ofi_ini_dir(const char *dir)
 			       "asprintf failed to allocate memory\n");
 			goto libdl_done;
 		}
-		ofi_reg_dl_prov(lib, true);
+		if (!prov_lazy || ofi_defer_dl_prov(liblist[n]->d_name, lib))
+			ofi_reg_dl_prov(lib, true);
 
 		free(liblist[n]);
 		free(lib);
@@ -744,7 +892,9 @@ static void ofi_find_prov_libs(void)
 			continue;
 		}
 
-		ofi_reg_dl_prov(lib, false);
+		if (!prov_lazy ||
+		    ofi_defer_prov(prov->prov_name, NULL, lib, false))
+			ofi_reg_dl_prov(lib, false);
 		free(lib);
 	}
 }
@@ -862,6 +1012,210 @@ static void ofi_load_dl_prov(void)
 
 #endif
 
+static void ofi_run_lazy(struct ofi_lazy_prov *entry)
+{
+	if (entry->prov->lazy) {
+		entry->prov->lazy = false;
+		entry->prov->hidden = false;
+	}
+
+	if (entry->ini)
+		ofi_reg_builtin_prov(entry->ini);
+#ifdef HAVE_LIBDL
+	else
+		ofi_reg_dl_prov(entry->lib, entry->lib_known);
+#endif
+	free(entry->lib);
+	free(entry);
+}
+
+/* Run all deferred registrations of a provider.  Caller holds ini_lock. */
+static void ofi_load_lazy(struct ofi_prov *prov)
+{
+	struct ofi_lazy_prov *entry, *prev, *next;
+	uint64_t start;
+
+	if (!prov->lazy)
+		return;
+
+	start = ofi_gettime_ns();
+	for (prev = NULL, entry = lazy_head; entry; entry = next) {
+		next = entry->next;
+		if (entry->prov != prov) {
+			prev = entry;
+			continue;
+		}
+
+		if (prev)
+			prev->next = next;
+		else
+			lazy_head = next;
+		if (lazy_tail == entry)
+			lazy_tail = prev;
+		ofi_run_lazy(entry);
+	}
+
+	FI_INFO(&core_prov, FI_LOG_CORE,
+		"loaded deferred provider %s in %" PRIu64 " us\n",
+		prov->prov_name, (ofi_gettime_ns() - start) / 1000);
+}
+
+static void ofi_load_lazy_prov(struct ofi_prov *prov)
+{
+	if (!prov->lazy)
+		return;
+
+	pthread_mutex_lock(&common_locks.ini_lock);
+	ofi_load_lazy(prov);
+	pthread_mutex_unlock(&common_locks.ini_lock);
+}
+
+/* Run all deferred registrations, in the order in which fi_ini would. */
+void ofi_ini_lazy_provs(void)
+{
+	struct ofi_lazy_prov *entry;
+
+	pthread_mutex_lock(&common_locks.ini_lock);
+	while (lazy_head) {
+		entry = lazy_head;
+		lazy_head = entry->next;
+		ofi_run_lazy(entry);
+	}
+	lazy_tail = NULL;
+	pthread_mutex_unlock(&common_locks.ini_lock);
+}
+
+/*
+ * Determine whether fi_getinfo() may need a deferred provider.  Core
+ * providers are needed only if they are named, or if no provider is
+ * named at all.  Utility providers may layer over any named core
+ * provider.  Hooks are loaded when they are installed.
+ */
+static bool ofi_lazy_needed(struct ofi_prov *prov, char **prov_vec,
+			    size_t count, uint64_t flags)
+{
+	bool named = false;
+	size_t i;
+
+	if (ofi_is_hook_name(prov->prov_name))
+		return false;
+
+	if (ofi_has_offload_prefix(prov->prov_name) &&
+	    !(flags & OFI_OFFLOAD_PROV_ONLY))
+		return false;
+
+	if (!ofi_is_core_name(prov->prov_name) && (flags & OFI_CORE_PROV_ONLY))
+		return false;
+
+	if (prov->hidden && !(flags & OFI_GETINFO_HIDDEN))
+		return false;
+
+	for (i = 0; i < count; i++) {
+		if (prov_vec[i][0] == '^') {
+			if (!strcasecmp(&prov_vec[i][1], prov->prov_name))
+				return false;
+			continue;
+		}
+
+		if (!strcasecmp(prov_vec[i], prov->prov_name))
+			return true;
+		named = true;
+	}
+
+	return !named || !ofi_is_core_name(prov->prov_name);
+}
+
+static void ofi_load_lazy_provs(char **prov_vec, size_t count,
+				uint64_t flags)
+{
+	struct ofi_prov *prov;
+
+	if (!lazy_head)
+		return;
+
+	pthread_mutex_lock(&common_locks.ini_lock);
+	for (prov = prov_head; prov; prov = prov->next) {
+		if (prov->lazy && ofi_lazy_needed(prov, prov_vec, count, flags))
+			ofi_load_lazy(prov);
+	}
+	pthread_mutex_unlock(&common_locks.ini_lock);
+}
+
+/*
+ * Built-in providers, in registration order.  XXX_INIT expands to the
+ * provider's ini call, or to NULL if the provider is not built in, so it
+ * is wrapped into a function to allow deferring the call.
+ */
+#define OFI_BUILTIN_INI(NAME)					\
+static struct fi_provider *ofi_##NAME##_ini(void)		\
+{								\
+	return NAME##_INIT;					\
+}
+
+OFI_BUILTIN_INI(PSM3)
+OFI_BUILTIN_INI(PSM2)
+OFI_BUILTIN_INI(CXI)
+OFI_BUILTIN_INI(USNIC)
+OFI_BUILTIN_INI(SHM)
+OFI_BUILTIN_INI(SM2)
+OFI_BUILTIN_INI(RXM)
+OFI_BUILTIN_INI(VERBS)
+OFI_BUILTIN_INI(MRAIL)
+OFI_BUILTIN_INI(RXD)
+OFI_BUILTIN_INI(EFA)
+OFI_BUILTIN_INI(OPX)
+OFI_BUILTIN_INI(UCX)
+OFI_BUILTIN_INI(UDP)
+OFI_BUILTIN_INI(SOCKETS)
+OFI_BUILTIN_INI(TCP)
+OFI_BUILTIN_INI(LNX)
+OFI_BUILTIN_INI(HOOK_PERF)
+OFI_BUILTIN_INI(HOOK_TRACE)
+OFI_BUILTIN_INI(HOOK_PROFILE)
+OFI_BUILTIN_INI(HOOK_MONITOR)
+OFI_BUILTIN_INI(HOOK_RECORD)
+OFI_BUILTIN_INI(HOOK_DEBUG)
+OFI_BUILTIN_INI(HOOK_HMEM)
+OFI_BUILTIN_INI(HOOK_DMABUF_PEER_MEM)
+OFI_BUILTIN_INI(HOOK_NOOP)
+OFI_BUILTIN_INI(COLL)
+
+static const struct {
+	const char *name;
+	struct fi_provider *(*ini)(void);
+} ofi_builtin_provs[] = {
+	{ "psm3", ofi_PSM3_ini },
+	{ "psm2", ofi_PSM2_ini },
+	{ "cxi", ofi_CXI_ini },
+	{ "usnic", ofi_USNIC_ini },
+	{ "shm", ofi_SHM_ini },
+	{ "sm2", ofi_SM2_ini },
+
+	{ "ofi_rxm", ofi_RXM_ini },
+	{ "verbs", ofi_VERBS_ini },
+	{ "ofi_mrail", ofi_MRAIL_ini },
+	{ "ofi_rxd", ofi_RXD_ini },
+	{ "efa", ofi_EFA_ini },
+	{ "opx", ofi_OPX_ini },
+	{ "ucx", ofi_UCX_ini },
+	{ "udp", ofi_UDP_ini },
+	{ "sockets", ofi_SOCKETS_ini },
+	{ "tcp", ofi_TCP_ini },
+
+	{ OFI_LNX, ofi_LNX_ini },
+	{ "ofi_hook_perf", ofi_HOOK_PERF_ini },
+	{ "ofi_hook_trace", ofi_HOOK_TRACE_ini },
+	{ "ofi_hook_profile", ofi_HOOK_PROFILE_ini },
+	{ "ofi_hook_monitor", ofi_HOOK_MONITOR_ini },
+	{ "ofi_hook_record", ofi_HOOK_RECORD_ini },
+	{ "ofi_hook_debug", ofi_HOOK_DEBUG_ini },
+	{ "ofi_hook_hmem", ofi_HOOK_HMEM_ini },
+	{ "ofi_hook_dmabuf_peer_mem", ofi_HOOK_DMABUF_PEER_MEM_ini },
+	{ "ofi_hook_noop", ofi_HOOK_NOOP_ini },
+
+	{ OFI_OFFLOAD_PREFIX "coll", ofi_COLL_ini },
+};
+
 static char **hooks;
 static size_t hook_cnt;
 
@@ -922,13 +1276,18 @@ static void ofi_hook_fini(void)
 
 void fi_ini(void)
 {
+	struct ofi_prov *prov;
 	char *param_val = NULL;
+	uint64_t start, core_ns;
+	int i, inited, deferred;
 
 	pthread_mutex_lock(&common_locks.ini_lock);
 
 	if (ofi_init)
 		goto unlock;
 
+	start = ofi_gettime_ns();
+
 	ofi_ordered_provs_init();
 	fi_param_init();
 	fi_log_init();
@@ -959,6 +1318,25 @@ void fi_ini(void)
 			"(default: provider specific)");
 	fi_param_get_size_t(NULL, "universe_size", &ofi_universe_size);
 
+	fi_param_define(NULL, "cq_shards", FI_PARAM_SIZE_T,
+			"Number of per-thread completion sub-queues used by "
+			"thread safe CQs of util based providers.  Writers "
+			"post to their own sub-queue without taking the CQ "
+			"lock, and readers steal from the other sub-queues "
+			"once their own is empty. (default: 0, disabled)");
+	fi_param_get_size_t(NULL, "cq_shards", &ofi_cq_shards);
+
+	fi_param_define(NULL, "wait_spin", FI_PARAM_SIZE_T,
+			"Maximum time in microseconds that blocking CQ and "
+			"counter reads of util based providers poll for "
+			"completions before they block.  The actual time "
+			"adapts to how long recent reads had to wait. "
+			"(default: 20, or 0 on a single CPU)");
+	/* Polling only delays the peer on a single CPU */
+	if (ofi_sysconf(_SC_NPROCESSORS_ONLN) <= 1)
+		ofi_wait_spin = 0;
+	fi_param_get_size_t(NULL, "wait_spin", &ofi_wait_spin);
+
 	fi_param_define(NULL, "av_remove_cleanup", FI_PARAM_BOOL,
 			"When true, release any underlying resources, such as "
 			"hidden connections when removing an entry from an "
@@ -976,40 +1354,39 @@ void fi_ini(void)
 	fi_param_get_str(NULL, "offload_coll_provider",
 			    &ofi_offload_coll_prov_name);
 
+	fi_param_define(NULL, "provider_lazy", FI_PARAM_BOOL,
+			"Defer loading and initializing providers until they "
+			"are requested by fi_getinfo or fi_fabric.  Only the "
+			"providers named by FI_PROVIDER or the fi_getinfo "
+			"hints are then initialized. (default: false)");
+	fi_param_get_bool(NULL, "provider_lazy", &prov_lazy);
+
+	ofi_getinfo_cache_init();
+	core_ns = ofi_gettime_ns() - start;
+
 	ofi_load_dl_prov();
 
-	ofi_register_provider(PSM3_INIT, NULL);
-	ofi_register_provider(PSM2_INIT, NULL);
-	ofi_register_provider(CXI_INIT, NULL);
-	ofi_register_provider(USNIC_INIT, NULL);
-	ofi_register_provider(SHM_INIT, NULL);
-	ofi_register_provider(SM2_INIT, NULL);
-
-	ofi_register_provider(RXM_INIT, NULL);
-	ofi_register_provider(VERBS_INIT, NULL);
-	ofi_register_provider(MRAIL_INIT, NULL);
-	ofi_register_provider(RXD_INIT, NULL);
-	ofi_register_provider(EFA_INIT, NULL);
-	ofi_register_provider(OPX_INIT, NULL);
-	ofi_register_provider(UCX_INIT, NULL);
-	ofi_register_provider(UDP_INIT, NULL);
-	ofi_register_provider(SOCKETS_INIT, NULL);
-	ofi_register_provider(TCP_INIT, NULL);
-
-	ofi_register_provider(LNX_INIT, NULL);
-	ofi_register_provider(HOOK_PERF_INIT, NULL);
-	ofi_register_provider(HOOK_TRACE_INIT, NULL);
-	ofi_register_provider(HOOK_PROFILE_INIT, NULL);
-	ofi_register_provider(HOOK_MONITOR_INIT, NULL);
-	ofi_register_provider(HOOK_DEBUG_INIT, NULL);
-	ofi_register_provider(HOOK_HMEM_INIT, NULL);
-	ofi_register_provider(HOOK_DMABUF_PEER_MEM_INIT, NULL);
-	ofi_register_provider(HOOK_NOOP_INIT, NULL);
-
-	ofi_register_provider(COLL_INIT, NULL);
+	for (i = 0; i < ARRAY_SIZE(ofi_builtin_provs); i++) {
+		if (!prov_lazy || ofi_defer_prov(ofi_builtin_provs[i].name,
+						 ofi_builtin_provs[i].ini,
+						 NULL, false))
+			ofi_reg_builtin_prov(ofi_builtin_provs[i].ini);
+	}
 
 	pthread_atfork(NULL, NULL, ofi_memhooks_atfork_handler);
 
+	for (prov = prov_head, inited = deferred = 0; prov; prov = prov->next) {
+		if (prov->provider)
+			inited++;
+		else if (prov->lazy)
+			deferred++;
+	}
+	FI_INFO(&core_prov, FI_LOG_CORE,
+		"initialized in %" PRIu64 " us (core %" PRIu64 " us), "
+		"%d providers registered, %d deferred\n",
+		(ofi_gettime_ns() - start) / 1000, core_ns / 1000,
+		inited, deferred);
+
 	ofi_init = 1;
 
 unlock:
@@ -1018,6 +1395,7 @@ unlock:
 
 FI_DESTRUCTOR(fi_fini(void))
 {
+	struct ofi_lazy_prov *lazy;
 	struct ofi_prov *prov;
 
 	pthread_mutex_lock(&common_locks.ini_lock);
@@ -1025,6 +1403,14 @@ FI_DESTRUCTOR(fi_fini(void))
 	if (!ofi_init)
 		goto unlock;
 
+	while (lazy_head) {
+		lazy = lazy_head;
+		lazy_head = lazy->next;
+		free(lazy->lib);
+		free(lazy);
+	}
+	lazy_tail = NULL;
+
 	while (prov_head) {
 		prov = prov_head;
 		prov_head = prov->next;
@@ -1032,6 +1418,7 @@ FI_DESTRUCTOR(fi_fini(void))
 	}
 
 	ofi_free_filter(&prov_filter);
+	ofi_getinfo_cache_fini();
 	ofi_shm_p2p_cleanup();
 	ofi_monitors_cleanup();
 	ofi_hmem_cleanup();
@@ -1336,6 +1723,7 @@ int DEFAULT_SYMVER_PRE(fi_getinfo)(uint32_t version, const char *node,
 	}
 
 	if (flags == FI_PROV_ATTR_ONLY) {
+		ofi_ini_lazy_provs();
 		return ofi_getprovinfo(info);
 	}
 
@@ -1348,6 +1736,8 @@ int DEFAULT_SYMVER_PRE(fi_getinfo)(uint32_t version, const char *node,
 		       hints->fabric_attr->prov_name);
 	}
 
+	ofi_load_lazy_provs(prov_vec, count, flags);
+
 	*info = tail = NULL;
 	for (prov = prov_head; prov; prov = prov->next) {
 		if (!prov->provider || !prov->provider->getinfo)
@@ -1374,8 +1764,8 @@ int DEFAULT_SYMVER_PRE(fi_getinfo)(uint32_t version, const char *node,
 		}
 
 		cur = NULL;
-		ret = prov->provider->getinfo(version, node, service, flags,
-					      hints, &cur);
+		ret = ofi_getinfo_cache(prov->provider, version, node, service,
+					flags, hints, &cur);
 		if (ret) {
 			level = ((hints && hints->fabric_attr &&
 				  hints->fabric_attr->prov_name &&
@@ -1579,6 +1969,10 @@ int DEFAULT_SYMVER_PRE(fi_fabric)(struct fi_fabric_attr *attr,
 		return -FI_EINVAL;
 
 	prov = ofi_getprov(top_name, strlen(top_name));
+	if (prov && prov->lazy) {
+		ofi_load_lazy_prov(prov);
+		prov = ofi_getprov(top_name, strlen(top_name));
+	}
 	if (!prov || !prov->provider || !prov->provider->fabric)
 		return -FI_ENODEV;
 
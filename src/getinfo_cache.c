@@ -0,0 +1,892 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Persistent fi_getinfo result cache.
+ *
+ * The results of each provider's getinfo call are stored in a directory
+ * shared by the processes on a node, in one file per provider and query.
+ * A query is keyed by the provider name and version, and by the arguments
+ * of the call.  Each file also records a fingerprint of the environment
+ * that the results were generated in: the library version, the FI_*
+ * environment variables, the configuration file, and the network
+ * interfaces.  Files with a different fingerprint are ignored and
+ * replaced, which invalidates the cache when the environment changes.
+ * Structures are stored in their in-memory form, so files also record the
+ * layout of the structures and the library version that wrote them.
+ *
+ * The first process to miss in the cache takes an exclusive flock on the
+ * query's lock file, calls the provider, and publishes the results by
+ * renaming a temporary file into place.  Other processes wait for the
+ * results to appear instead of probing the system themselves.  The lock is
+ * released by the kernel if its holder exits.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+#include "ofi.h"
+#include "ofi_mem.h"
+#include "ofi_net.h"
+#include "fasthash.h"
+
+#ifndef _WIN32
+
+#define OFI_INFO_CACHE_MAGIC	0x454843414e49464fULL	/* "OFINACHE" */
+#define OFI_INFO_CACHE_VERSION	2
+#define OFI_INFO_CACHE_WAIT	10000	/* ms */
+#define OFI_INFO_CACHE_PROVS	"tcp,udp,sockets,ofi_rxm,ofi_rxd"
+#define OFI_INFO_CACHE_NULL	UINT64_MAX
+#define OFI_INFO_CACHE_STR_LEN	16384
+
+struct ofi_info_cache_hdr {
+	uint64_t	magic;
+	uint32_t	version;
+	int32_t		ret;
+	uint64_t	layout;
+	uint64_t	fingerprint;
+	uint64_t	key;
+	uint64_t	size;
+	uint64_t	checksum;
+};
+
+struct ofi_info_cache_buf {
+	uint8_t		*data;
+	size_t		len;
+	size_t		size;
+	size_t		off;
+};
+
+static char *info_cache_path;
+static uint64_t info_cache_layout;
+static uint64_t info_cache_fingerprint;
+static struct ofi_filter info_cache_filter;
+
+static int info_cache_put(struct ofi_info_cache_buf *buf, const void *data,
+			  size_t len)
+{
+	void *new_data;
+	size_t size;
+
+	if (buf->len + len > buf->size) {
+		size = MAX(buf->size * 2, buf->len + len);
+		new_data = realloc(buf->data, size);
+		if (!new_data)
+			return -FI_ENOMEM;
+		buf->data = new_data;
+		buf->size = size;
+	}
+	memcpy(buf->data + buf->len, data, len);
+	buf->len += len;
+	return 0;
+}
+
+static int info_cache_put_blob(struct ofi_info_cache_buf *buf,
+			       const void *data, size_t len)
+{
+	uint64_t blob_len = data ? len : OFI_INFO_CACHE_NULL;
+	int ret;
+
+	ret = info_cache_put(buf, &blob_len, sizeof(blob_len));
+	if (ret || !data)
+		return ret;
+	return info_cache_put(buf, data, len);
+}
+
+static int info_cache_put_str(struct ofi_info_cache_buf *buf, const char *str)
+{
+	return info_cache_put_blob(buf, str, str ? strlen(str) + 1 : 0);
+}
+
+/* Records whether an optional structure, stored field by field, follows */
+static int info_cache_put_present(struct ofi_info_cache_buf *buf,
+				  const void *ptr)
+{
+	uint64_t present = ptr != NULL;
+
+	return info_cache_put(buf, &present, sizeof(present));
+}
+
+static int info_cache_get(struct ofi_info_cache_buf *buf, void *data,
+			  size_t len)
+{
+	if (len > buf->len - buf->off)
+		return -FI_EINVAL;
+	memcpy(data, buf->data + buf->off, len);
+	buf->off += len;
+	return 0;
+}
+
+static int info_cache_get_blob(struct ofi_info_cache_buf *buf, void **data,
+			       size_t *len)
+{
+	uint64_t blob_len;
+	int ret;
+
+	*data = NULL;
+	if (len)
+		*len = 0;
+	ret = info_cache_get(buf, &blob_len, sizeof(blob_len));
+	if (ret || blob_len == OFI_INFO_CACHE_NULL || !blob_len)
+		return ret;
+
+	if (blob_len > buf->len - buf->off)
+		return -FI_EINVAL;
+
+	*data = mem_dup(buf->data + buf->off, blob_len);
+	if (!*data)
+		return -FI_ENOMEM;
+	buf->off += blob_len;
+	if (len)
+		*len = blob_len;
+	return 0;
+}
+
+static int info_cache_get_str(struct ofi_info_cache_buf *buf, char **str)
+{
+	size_t len = 0;
+	int ret;
+
+	ret = info_cache_get_blob(buf, (void **) str, &len);
+	if (ret || !*str)
+		return ret;
+
+	if (!len || (*str)[len - 1] != '\0') {
+		free(*str);
+		*str = NULL;
+		return -FI_EINVAL;
+	}
+	return 0;
+}
+
+static int info_cache_get_present(struct ofi_info_cache_buf *buf,
+				  bool *present)
+{
+	uint64_t val;
+	int ret;
+
+	ret = info_cache_get(buf, &val, sizeof(val));
+	if (ret)
+		return ret;
+	if (val > 1)
+		return -FI_EINVAL;
+	*present = val;
+	return 0;
+}
+
+/* Reads a blob holding an attribute structure of the given size */
+static int info_cache_get_attr(struct ofi_info_cache_buf *buf, void **attr,
+			       size_t size)
+{
+	size_t len = 0;
+	int ret;
+
+	ret = info_cache_get_blob(buf, attr, &len);
+	if (ret || !*attr)
+		return ret;
+
+	if (len != size) {
+		free(*attr);
+		*attr = NULL;
+		return -FI_EINVAL;
+	}
+	return 0;
+}
+
+/*
+ * Only results that are plain data can be cached.  Provider specific
+ * NIC attributes and open handles cannot be restored by another process.
+ */
+static bool info_cache_supported(const struct fi_info *info)
+{
+	for (; info; info = info->next) {
+		if (info->handle || (info->nic && info->nic->prov_attr) ||
+		    (info->domain_attr && info->domain_attr->domain) ||
+		    (info->fabric_attr && info->fabric_attr->fabric))
+			return false;
+	}
+	return true;
+}
+
+static int info_cache_put_nic(struct ofi_info_cache_buf *buf,
+			      const struct fid_nic *nic)
+{
+	struct fi_device_attr *dev = nic->device_attr;
+	struct fi_link_attr link;
+	int ret;
+
+	ret = info_cache_put_present(buf, dev);
+	if (!ret && dev) {
+		ret = info_cache_put_str(buf, dev->name) ?:
+		      info_cache_put_str(buf, dev->device_id) ?:
+		      info_cache_put_str(buf, dev->device_version) ?:
+		      info_cache_put_str(buf, dev->vendor_id) ?:
+		      info_cache_put_str(buf, dev->driver) ?:
+		      info_cache_put_str(buf, dev->firmware);
+	}
+	if (ret)
+		return ret;
+
+	ret = info_cache_put_blob(buf, nic->bus_attr, sizeof(*nic->bus_attr));
+	if (ret || !nic->link_attr)
+		return ret ? ret : info_cache_put_blob(buf, NULL, 0);
+
+	link = *nic->link_attr;
+	link.address = NULL;
+	link.network_type = NULL;
+	return info_cache_put_blob(buf, &link, sizeof(link)) ?:
+	       info_cache_put_str(buf, nic->link_attr->address) ?:
+	       info_cache_put_str(buf, nic->link_attr->network_type);
+}
+
+static int info_cache_put_info(struct ofi_info_cache_buf *buf,
+			       const struct fi_info *info)
+{
+	struct fi_info tmp = *info;
+	struct fi_ep_attr ep_attr;
+	struct fi_domain_attr domain_attr;
+	struct fi_fabric_attr fabric_attr;
+	int ret;
+
+	tmp.next = NULL;
+	tmp.src_addr = NULL;
+	tmp.dest_addr = NULL;
+	tmp.handle = NULL;
+	tmp.tx_attr = NULL;
+	tmp.rx_attr = NULL;
+	tmp.ep_attr = NULL;
+	tmp.domain_attr = NULL;
+	tmp.fabric_attr = NULL;
+	tmp.nic = NULL;
+
+	ret = info_cache_put(buf, &tmp, sizeof(tmp)) ?:
+	      info_cache_put_blob(buf, info->src_addr, info->src_addrlen) ?:
+	      info_cache_put_blob(buf, info->dest_addr, info->dest_addrlen) ?:
+	      info_cache_put_blob(buf, info->tx_attr, sizeof(*info->tx_attr)) ?:
+	      info_cache_put_blob(buf, info->rx_attr, sizeof(*info->rx_attr));
+	if (ret)
+		return ret;
+
+	if (info->ep_attr) {
+		ep_attr = *info->ep_attr;
+		ep_attr.auth_key = NULL;
+		ret = info_cache_put_blob(buf, &ep_attr, sizeof(ep_attr)) ?:
+		      info_cache_put_blob(buf, info->ep_attr->auth_key,
+					  info->ep_attr->auth_key_size);
+	} else {
+		ret = info_cache_put_blob(buf, NULL, 0);
+	}
+	if (ret)
+		return ret;
+
+	if (info->domain_attr) {
+		domain_attr = *info->domain_attr;
+		domain_attr.name = NULL;
+		domain_attr.auth_key = NULL;
+		ret = info_cache_put_blob(buf, &domain_attr,
+					  sizeof(domain_attr)) ?:
+		      info_cache_put_str(buf, info->domain_attr->name) ?:
+		      info_cache_put_blob(buf, info->domain_attr->auth_key,
+					  info->domain_attr->auth_key_size);
+	} else {
+		ret = info_cache_put_blob(buf, NULL, 0);
+	}
+	if (ret)
+		return ret;
+
+	if (info->fabric_attr) {
+		fabric_attr = *info->fabric_attr;
+		fabric_attr.name = NULL;
+		fabric_attr.prov_name = NULL;
+		ret = info_cache_put_blob(buf, &fabric_attr,
+					  sizeof(fabric_attr)) ?:
+		      info_cache_put_str(buf, info->fabric_attr->name) ?:
+		      info_cache_put_str(buf, info->fabric_attr->prov_name);
+	} else {
+		ret = info_cache_put_blob(buf, NULL, 0);
+	}
+	if (ret)
+		return ret;
+
+	ret = info_cache_put_present(buf, info->nic);
+	if (ret || !info->nic)
+		return ret;
+	return info_cache_put_nic(buf, info->nic);
+}
+
+static int info_cache_get_nic(struct ofi_info_cache_buf *buf,
+			      struct fid_nic **nic)
+{
+	struct fi_device_attr *dev;
+	bool present;
+	int ret;
+
+	*nic = ofi_nic_dup(NULL);
+	if (!*nic)
+		return -FI_ENOMEM;
+
+	dev = (*nic)->device_attr;
+	ret = info_cache_get_present(buf, &present);
+	if (ret)
+		return ret;
+	if (present) {
+		ret = info_cache_get_str(buf, &dev->name) ?:
+		      info_cache_get_str(buf, &dev->device_id) ?:
+		      info_cache_get_str(buf, &dev->device_version) ?:
+		      info_cache_get_str(buf, &dev->vendor_id) ?:
+		      info_cache_get_str(buf, &dev->driver) ?:
+		      info_cache_get_str(buf, &dev->firmware);
+		if (ret)
+			return ret;
+	} else {
+		free(dev);
+		(*nic)->device_attr = NULL;
+	}
+
+	free((*nic)->bus_attr);
+	free((*nic)->link_attr);
+	(*nic)->link_attr = NULL;
+	ret = info_cache_get_attr(buf, (void **) &(*nic)->bus_attr,
+				  sizeof(*(*nic)->bus_attr)) ?:
+	      info_cache_get_attr(buf, (void **) &(*nic)->link_attr,
+				  sizeof(*(*nic)->link_attr));
+	if (ret || !(*nic)->link_attr)
+		return ret;
+
+	return info_cache_get_str(buf, &(*nic)->link_attr->address) ?:
+	       info_cache_get_str(buf, &(*nic)->link_attr->network_type);
+}
+
+static int info_cache_get_info(struct ofi_info_cache_buf *buf,
+			       struct fi_info **info)
+{
+	struct fi_info *cur;
+	bool present;
+	int ret;
+
+	cur = calloc(1, sizeof(*cur));
+	if (!cur)
+		return -FI_ENOMEM;
+
+	ret = info_cache_get(buf, cur, sizeof(*cur));
+	if (ret) {
+		free(cur);
+		return ret;
+	}
+
+	/* pointers were cleared when stored */
+	*info = cur;
+	ret = info_cache_get_blob(buf, &cur->src_addr, NULL) ?:
+	      info_cache_get_blob(buf, &cur->dest_addr, NULL) ?:
+	      info_cache_get_attr(buf, (void **) &cur->tx_attr,
+				  sizeof(*cur->tx_attr)) ?:
+	      info_cache_get_attr(buf, (void **) &cur->rx_attr,
+				  sizeof(*cur->rx_attr)) ?:
+	      info_cache_get_attr(buf, (void **) &cur->ep_attr,
+				  sizeof(*cur->ep_attr));
+	if (ret)
+		return ret;
+
+	if (cur->ep_attr) {
+		ret = info_cache_get_blob(buf, (void **) &cur->ep_attr->auth_key,
+					  NULL);
+		if (ret)
+			return ret;
+	}
+
+	ret = info_cache_get_attr(buf, (void **) &cur->domain_attr,
+				  sizeof(*cur->domain_attr));
+	if (!ret && cur->domain_attr) {
+		ret = info_cache_get_str(buf, &cur->domain_attr->name) ?:
+		      info_cache_get_blob(buf,
+					  (void **) &cur->domain_attr->auth_key,
+					  NULL);
+	}
+	if (ret)
+		return ret;
+
+	ret = info_cache_get_attr(buf, (void **) &cur->fabric_attr,
+				  sizeof(*cur->fabric_attr));
+	if (!ret && cur->fabric_attr) {
+		ret = info_cache_get_str(buf, &cur->fabric_attr->name) ?:
+		      info_cache_get_str(buf, &cur->fabric_attr->prov_name);
+	}
+	if (ret)
+		return ret;
+
+	ret = info_cache_get_present(buf, &present);
+	if (ret || !present)
+		return ret;
+
+	return info_cache_get_nic(buf, &cur->nic);
+}
+
+static uint64_t info_cache_hash_str(const char *str, uint64_t hash)
+{
+	return str ? fasthash64(str, strlen(str) + 1, hash) :
+		     fasthash64(&hash, sizeof(hash), hash);
+}
+
+static uint64_t info_cache_hash_addr(const struct sockaddr *addr,
+				     uint64_t hash)
+{
+	if (!addr)
+		return hash;
+
+	switch (addr->sa_family) {
+	case AF_INET:
+		return fasthash64(&ofi_sin_addr(addr), sizeof(struct in_addr),
+				  hash);
+	case AF_INET6:
+		return fasthash64(&ofi_sin6_addr(addr),
+				  sizeof(struct in6_addr), hash);
+	default:
+		return fasthash64(&addr->sa_family, sizeof(addr->sa_family),
+				  hash);
+	}
+}
+
+static int info_cache_env_cmp(const void *a, const void *b)
+{
+	return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+/*
+ * The order of the environment can differ between processes.  Logging
+ * settings do not change the results and are skipped.
+ */
+static bool info_cache_env_var(const char *var)
+{
+	return !strncmp(var, "FI_", 3) && strncmp(var, "FI_LOG_", 7);
+}
+
+/* The order of the environment can differ between processes */
+static uint64_t info_cache_hash_env(uint64_t hash)
+{
+	extern char **environ;
+	char **vars;
+	size_t i, cnt = 0;
+
+	for (i = 0; environ[i]; i++) {
+		if (info_cache_env_var(environ[i]))
+			cnt++;
+	}
+
+	vars = calloc(cnt + 1, sizeof(*vars));
+	if (!vars)
+		return 0;
+
+	for (i = 0, cnt = 0; environ[i]; i++) {
+		if (info_cache_env_var(environ[i]))
+			vars[cnt++] = environ[i];
+	}
+	qsort(vars, cnt, sizeof(*vars), info_cache_env_cmp);
+
+	for (i = 0; i < cnt; i++)
+		hash = info_cache_hash_str(vars[i], hash);
+	free(vars);
+	return hash;
+}
+
+static uint64_t info_cache_hash_ifaddrs(uint64_t hash)
+{
+	struct ifaddrs *ifaddrs, *ifa;
+
+	if (ofi_getifaddrs(&ifaddrs))
+		return 0;
+
+	for (ifa = ifaddrs; ifa; ifa = ifa->ifa_next) {
+		hash = info_cache_hash_str(ifa->ifa_name, hash);
+		hash = fasthash64(&ifa->ifa_flags, sizeof(ifa->ifa_flags),
+				  hash);
+		hash = info_cache_hash_addr(ifa->ifa_addr, hash);
+		hash = info_cache_hash_addr(ifa->ifa_netmask, hash);
+	}
+	freeifaddrs(ifaddrs);
+	return hash;
+}
+
+/*
+ * Identifies the layout of the stored structures, which changes with the
+ * library version and can differ between builds of the same version.
+ */
+static uint64_t info_cache_get_layout(void)
+{
+	const uint64_t sizes[] = {
+		sizeof(struct ofi_info_cache_hdr),
+		sizeof(struct fi_info),
+		sizeof(struct fi_tx_attr),
+		sizeof(struct fi_rx_attr),
+		sizeof(struct fi_ep_attr),
+		sizeof(struct fi_domain_attr),
+		sizeof(struct fi_fabric_attr),
+		sizeof(struct fi_device_attr),
+		sizeof(struct fi_bus_attr),
+		sizeof(struct fi_link_attr),
+	};
+
+	return fasthash64(sizes, sizeof(sizes),
+			  info_cache_hash_str(PACKAGE_VERSION, 0));
+}
+
+/* A fingerprint of 0 means that it could not be computed */
+static uint64_t info_cache_get_fingerprint(void)
+{
+	uint64_t hash;
+
+	hash = info_cache_hash_str(PACKAGE_VERSION, 0);
+	hash = ofi_sysconfig_hash(hash);
+	hash = info_cache_hash_env(hash);
+	return hash ? info_cache_hash_ifaddrs(hash) : 0;
+}
+
+/*
+ * Hints are hashed through their string form, which skips structure
+ * padding, together with the address and key bytes.
+ */
+static uint64_t
+info_cache_get_key(const struct fi_provider *prov, uint32_t version,
+		   const char *node, const char *service, uint64_t flags,
+		   const struct fi_info *hints)
+{
+	char *str;
+	uint64_t key;
+
+	key = info_cache_hash_str(prov->name, prov->version);
+	key = fasthash64(&version, sizeof(version), key);
+	key = info_cache_hash_str(node, key);
+	key = info_cache_hash_str(service, key);
+	key = fasthash64(&flags, sizeof(flags), key);
+	if (!hints)
+		return key;
+
+	str = malloc(OFI_INFO_CACHE_STR_LEN);
+	if (!str)
+		return 0;
+
+	fi_tostr_r(str, OFI_INFO_CACHE_STR_LEN, hints, FI_TYPE_INFO);
+	key = info_cache_hash_str(str, key);
+	free(str);
+
+	if (hints->src_addr)
+		key = fasthash64(hints->src_addr, hints->src_addrlen, key);
+	if (hints->dest_addr)
+		key = fasthash64(hints->dest_addr, hints->dest_addrlen, key);
+	if (hints->ep_attr && hints->ep_attr->auth_key)
+		key = fasthash64(hints->ep_attr->auth_key,
+				 hints->ep_attr->auth_key_size, key);
+	if (hints->domain_attr && hints->domain_attr->auth_key)
+		key = fasthash64(hints->domain_attr->auth_key,
+				 hints->domain_attr->auth_key_size, key);
+	return key;
+}
+
+static int info_cache_read(int fd, struct ofi_info_cache_buf *buf)
+{
+	ssize_t ret;
+
+	while (buf->off < buf->len) {
+		ret = read(fd, buf->data + buf->off, buf->len - buf->off);
+		if (ret <= 0)
+			return ret ? -errno : -FI_EINVAL;
+		buf->off += ret;
+	}
+	buf->off = 0;
+	return 0;
+}
+
+static int info_cache_load(const char *path, uint64_t key, int *prov_ret,
+			   struct fi_info **info)
+{
+	struct ofi_info_cache_buf buf = { 0 };
+	struct ofi_info_cache_hdr hdr;
+	struct fi_info *head = NULL, **tail = &head;
+	struct stat st;
+	int fd, ret;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -errno;
+
+	if (fstat(fd, &st) || st.st_size < sizeof(hdr)) {
+		ret = -FI_EINVAL;
+		goto close;
+	}
+
+	buf.len = st.st_size;
+	buf.data = malloc(buf.len);
+	if (!buf.data) {
+		ret = -FI_ENOMEM;
+		goto close;
+	}
+
+	ret = info_cache_read(fd, &buf) ?:
+	      info_cache_get(&buf, &hdr, sizeof(hdr));
+	if (ret)
+		goto free;
+
+	if (hdr.magic != OFI_INFO_CACHE_MAGIC ||
+	    hdr.version != OFI_INFO_CACHE_VERSION ||
+	    hdr.layout != info_cache_layout ||
+	    hdr.fingerprint != info_cache_fingerprint || hdr.key != key ||
+	    hdr.size != buf.len - buf.off ||
+	    hdr.checksum != fasthash64(buf.data + buf.off, hdr.size, 0)) {
+		ret = -FI_EINVAL;
+		goto free;
+	}
+
+	while (buf.off < buf.len) {
+		ret = info_cache_get_info(&buf, tail);
+		if (ret) {
+			fi_freeinfo(head);
+			goto free;
+		}
+		tail = &(*tail)->next;
+	}
+
+	*prov_ret = hdr.ret;
+	*info = head;
+free:
+	free(buf.data);
+close:
+	close(fd);
+	return ret;
+}
+
+static void info_cache_store(const char *path, uint64_t key, int prov_ret,
+			     const struct fi_info *info)
+{
+	struct ofi_info_cache_buf buf = { 0 };
+	struct ofi_info_cache_hdr hdr = {
+		.magic = OFI_INFO_CACHE_MAGIC,
+		.version = OFI_INFO_CACHE_VERSION,
+		.ret = prov_ret,
+		.layout = info_cache_layout,
+		.fingerprint = info_cache_fingerprint,
+		.key = key,
+	};
+	char tmp_path[PATH_MAX];
+	size_t off;
+	ssize_t len;
+	int fd, ret;
+
+	ret = info_cache_put(&buf, &hdr, sizeof(hdr));
+	for (; !ret && info; info = info->next)
+		ret = info_cache_put_info(&buf, info);
+	if (ret)
+		goto free;
+
+	hdr.size = buf.len - sizeof(hdr);
+	hdr.checksum = fasthash64(buf.data + sizeof(hdr), hdr.size, 0);
+	memcpy(buf.data, &hdr, sizeof(hdr));
+
+	if (snprintf(tmp_path, sizeof(tmp_path), "%s.%d.tmp", path,
+		     getpid()) >= sizeof(tmp_path))
+		goto free;
+
+	fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fd < 0)
+		goto free;
+
+	for (off = 0; off < buf.len; off += len) {
+		len = write(fd, buf.data + off, buf.len - off);
+		if (len <= 0)
+			break;
+	}
+	close(fd);
+
+	/* readers either see the previous file or the complete new one */
+	if (off != buf.len || rename(tmp_path, path)) {
+		FI_INFO(&core_prov, FI_LOG_CORE,
+			"unable to store getinfo cache file %s\n", path);
+		unlink(tmp_path);
+	}
+free:
+	free(buf.data);
+}
+
+/*
+ * Returns the fd holding the lock, -FI_EAGAIN if another process holds it,
+ * or another error if the lock cannot be used.
+ */
+static int info_cache_lock(const char *lock_path)
+{
+	int fd, ret;
+
+	fd = open(lock_path, O_RDWR | O_CREAT, 0600);
+	if (fd < 0)
+		return -errno;
+
+	if (flock(fd, LOCK_EX | LOCK_NB)) {
+		ret = errno == EWOULDBLOCK ? -FI_EAGAIN : -errno;
+		close(fd);
+		return ret;
+	}
+	return fd;
+}
+
+/* Closing the fd drops the lock, and the lock file is left in place */
+static void info_cache_unlock(int fd)
+{
+	close(fd);
+}
+
+/*
+ * Returns the results of the provider's getinfo call, from the cache when
+ * possible.  Only successful calls, and calls that found no matching
+ * interface, are cached.
+ */
+int ofi_getinfo_cache(const struct fi_provider *prov, uint32_t version,
+		      const char *node, const char *service, uint64_t flags,
+		      const struct fi_info *hints, struct fi_info **info)
+{
+	char path[PATH_MAX], lock_path[PATH_MAX];
+	uint64_t key, start;
+	int ret, prov_ret, fd;
+
+	if (!info_cache_path ||
+	    ofi_apply_filter(&info_cache_filter, prov->name) ||
+	    (hints && !info_cache_supported(hints)))
+		goto getinfo;
+
+	key = info_cache_get_key(prov, version, node, service, flags, hints);
+	if (!key ||
+	    snprintf(path, sizeof(path), "%s/%s_%016" PRIx64, info_cache_path,
+		     prov->name, key) >= sizeof(path) ||
+	    snprintf(lock_path, sizeof(lock_path), "%s.lock",
+		     path) >= sizeof(lock_path))
+		goto getinfo;
+
+	if (!info_cache_load(path, key, &prov_ret, info))
+		goto hit;
+
+	start = ofi_gettime_ms();
+	while ((fd = info_cache_lock(lock_path)) == -FI_EAGAIN) {
+		usleep(1000);
+		if (!info_cache_load(path, key, &prov_ret, info))
+			goto hit;
+
+		if (ofi_gettime_ms() - start > OFI_INFO_CACHE_WAIT)
+			goto getinfo;
+	}
+	if (fd < 0)
+		goto getinfo;
+
+	/* the results may have been stored while we waited for the lock */
+	if (!info_cache_load(path, key, &prov_ret, info)) {
+		info_cache_unlock(fd);
+		goto hit;
+	}
+
+	ret = prov->getinfo(version, node, service, flags, hints, info);
+	if ((!ret && info_cache_supported(*info)) || ret == -FI_ENODATA)
+		info_cache_store(path, key, ret, ret ? NULL : *info);
+	info_cache_unlock(fd);
+	return ret;
+
+hit:
+	FI_DBG(&core_prov, FI_LOG_CORE, "using cached %s getinfo results\n",
+	       prov->name);
+	return prov_ret;
+
+getinfo:
+	return prov->getinfo(version, node, service, flags, hints, info);
+}
+
+void ofi_getinfo_cache_init(void)
+{
+	char *provs = OFI_INFO_CACHE_PROVS;
+
+	fi_param_define(NULL, "getinfo_cache", FI_PARAM_STRING,
+			"Directory in which the results of provider getinfo "
+			"calls are stored and shared between the processes "
+			"of a node.  This should be a node local directory "
+			"that is only writable by the job's user. "
+			"(default: unset, disabled)");
+	fi_param_define(NULL, "getinfo_cache_provs", FI_PARAM_STRING,
+			"Providers whose getinfo results are cached, in the "
+			"format of FI_PROVIDER.  Only providers whose getinfo "
+			"call has no side effects may be listed. "
+			"(default: " OFI_INFO_CACHE_PROVS ")");
+
+	fi_param_get_str(NULL, "getinfo_cache", &info_cache_path);
+	if (!info_cache_path)
+		return;
+
+	fi_param_get_str(NULL, "getinfo_cache_provs", &provs);
+	info_cache_layout = info_cache_get_layout();
+	info_cache_fingerprint = info_cache_get_fingerprint();
+	if (!info_cache_fingerprint ||
+	    (mkdir(info_cache_path, 0700) && errno != EEXIST)) {
+		FI_WARN(&core_prov, FI_LOG_CORE,
+			"unable to use getinfo cache %s, disabling\n",
+			info_cache_path);
+		info_cache_path = NULL;
+		return;
+	}
+
+	ofi_create_filter(&info_cache_filter, provs);
+	FI_INFO(&core_prov, FI_LOG_CORE, "getinfo cache %s, fingerprint %"
+		PRIx64 "\n", info_cache_path, info_cache_fingerprint);
+}
+
+void ofi_getinfo_cache_fini(void)
+{
+	ofi_free_filter(&info_cache_filter);
+	info_cache_path = NULL;
+}
+
+#else /* _WIN32 */
+
+int ofi_getinfo_cache(const struct fi_provider *prov, uint32_t version,
+		      const char *node, const char *service, uint64_t flags,
+		      const struct fi_info *hints, struct fi_info **info)
+{
+	return prov->getinfo(version, node, service, flags, hints, info);
+}
+
+void ofi_getinfo_cache_init(void)
+{
+}
+
+void ofi_getinfo_cache_fini(void)
+{
+}
+
+#endif /* _WIN32 */
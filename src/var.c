@@ -41,6 +41,7 @@
 
 #include "ofi.h"
 #include "ofi_list.h"
+#include "fasthash.h"
 
 #ifdef SYSCONFDIR
 #define DEFAULT_CONF_FILE_PATH SYSCONFDIR "/libfabric.conf"
@@ -51,6 +52,7 @@
 #define MAX_CONF_LINE_LENGTH 2048
 
 extern void fi_ini(void);
+extern void ofi_ini_lazy_provs(void);
 int ofi_prefer_sysconfig = 0;
 
 struct fi_param_entry {
@@ -102,6 +104,7 @@ int DEFAULT_SYMVER_PRE(fi_getparams)(struct fi_param **params, int *count)
 	char *tmp;
 
 	fi_ini();
+	ofi_ini_lazy_provs();
 
 	for (entry = param_list.next, cnt = 0; entry != &param_list;
 	     entry = entry->next)
@@ -339,6 +342,17 @@ void ofi_dump_sysconfig(void)
 	}
 }
 
+uint64_t ofi_sysconfig_hash(uint64_t hash)
+{
+	struct ofi_conf_entry *conf;
+
+	dlist_foreach_container(&conf_list, struct ofi_conf_entry, conf, entry) {
+		hash = fasthash64(conf->name, strlen(conf->name) + 1, hash);
+		hash = fasthash64(conf->value, strlen(conf->value) + 1, hash);
+	}
+	return hash;
+}
+
 __attribute__((visibility ("default"),EXTERNALLY_VISIBLE))
 int DEFAULT_SYMVER_PRE(fi_param_get)(struct fi_provider *provider,
 		const char *param_name, void *value)
@@ -84,6 +84,12 @@ enum {
 	PP_OPT_VERIFY_DATA = 1 << 3,
 };
 
+enum pp_output_fmt {
+	PP_OUTPUT_TEXT = 0,
+	PP_OUTPUT_JSON,
+	PP_OUTPUT_CSV,
+};
+
 struct pp_opts {
 	uint16_t src_port;
 	uint16_t dst_port;
@@ -93,6 +99,7 @@ struct pp_opts {
 	int transfer_size;
 	int sizes_enabled;
 	int options;
+	enum pp_output_fmt output_fmt;
 };
 
 #define PP_SIZE_MAX_POWER_TWO 22
@@ -116,6 +123,22 @@ struct pp_opts {
 #define PP_MSG_SYNC_Q "q"
 #define PP_MSG_SYNC_A "a"
 
+/*
+ * Log-bucketed latency histogram: values below 2^PP_HIST_SUB_BITS are exact,
+ * larger ones land in one of PP_HIST_SUB_CNT sub-buckets per power of two.
+ */
+#define PP_HIST_SUB_BITS 5
+#define PP_HIST_SUB_CNT (1 << PP_HIST_SUB_BITS)
+#define PP_HIST_BUCKETS ((64 - PP_HIST_SUB_BITS + 1) * PP_HIST_SUB_CNT)
+
+struct pp_hist {
+	uint64_t count;
+	uint64_t min;
+	uint64_t max;
+	uint64_t last;
+	uint64_t bucket[PP_HIST_BUCKETS];
+};
+
 #define PP_PRINTERR(call, retv)                                                \
 	fprintf(stderr, "%s(): %s:%-4d, ret=%d (%s)\n", call, __FILE__,        \
 		__LINE__, (int)retv, fi_strerror((int) -retv))
@@ -190,6 +213,7 @@ struct ct_pingpong {
 
 	int timeout_sec;
 	uint64_t start, end;
+	struct pp_hist lat_hist;
 
 	struct fi_av_attr av_attr;
 	struct fi_eq_attr eq_attr;
@@ -222,6 +246,81 @@ static uint64_t pp_gettime_us(void)
 	return now.tv_sec * 1000000 + now.tv_usec;
 }
 
+static uint64_t pp_gettime_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static void pp_hist_reset(struct pp_hist *hist)
+{
+	memset(hist, 0, sizeof(*hist));
+	hist->min = UINT64_MAX;
+}
+
+static int pp_hist_index(uint64_t val)
+{
+	int shift = -PP_HIST_SUB_BITS;
+	uint64_t top;
+
+	if (val < PP_HIST_SUB_CNT)
+		return (int) val;
+
+	for (top = val; top > 1; top >>= 1)
+		shift++;
+
+	return (shift + 1) * PP_HIST_SUB_CNT +
+	       (int) ((val >> shift) - PP_HIST_SUB_CNT);
+}
+
+/* Midpoint of the range of values counted by a bucket */
+static uint64_t pp_hist_value(int index)
+{
+	int shift;
+
+	if (index < PP_HIST_SUB_CNT)
+		return index;
+
+	shift = index / PP_HIST_SUB_CNT - 1;
+	return ((uint64_t) (index % PP_HIST_SUB_CNT + PP_HIST_SUB_CNT) << shift) +
+	       ((1ULL << shift) >> 1);
+}
+
+static void pp_hist_record(struct pp_hist *hist, uint64_t val)
+{
+	hist->bucket[pp_hist_index(val)]++;
+	hist->count++;
+	if (val < hist->min)
+		hist->min = val;
+	if (val > hist->max)
+		hist->max = val;
+}
+
+/* Smallest recorded value that at least pct percent of samples are <= to */
+static uint64_t pp_hist_percentile(const struct pp_hist *hist, double pct)
+{
+	uint64_t rank, seen = 0;
+	double exact;
+	int i;
+
+	if (!hist->count)
+		return 0;
+
+	exact = pct * hist->count / 100;
+	rank = (uint64_t) exact;
+	if (rank < exact || !rank)
+		rank++;
+
+	for (i = 0; i < PP_HIST_BUCKETS; i++) {
+		seen += hist->bucket[i];
+		if (seen >= rank)
+			return MIN(MAX(pp_hist_value(i), hist->min), hist->max);
+	}
+	return hist->max;
+}
+
 static long parse_ulong(char *str, long max)
 {
 	long ret;
@@ -848,6 +947,8 @@ static inline void pp_start(struct ct_pingpong *ct)
 {
 	PP_DEBUG("Starting test chrono\n");
 	ct->opts.options |= PP_OPT_ACTIVE;
+	pp_hist_reset(&ct->lat_hist);
+	ct->lat_hist.last = pp_gettime_ns();
 	ct->start = pp_gettime_us();
 }
 
@@ -858,6 +959,15 @@ static inline void pp_stop(struct ct_pingpong *ct)
 	PP_DEBUG("Stopped test chrono\n");
 }
 
+/* Record half of the round trip that ended with the current iteration */
+static inline void pp_lat_sample(struct ct_pingpong *ct)
+{
+	uint64_t now = pp_gettime_ns();
+
+	pp_hist_record(&ct->lat_hist, (now - ct->lat_hist.last) / 2);
+	ct->lat_hist.last = now;
+}
+
 static inline int pp_check_opts(struct ct_pingpong *ct, uint64_t flags)
 {
 	return (ct->opts.options & flags) == flags;
@@ -1059,18 +1169,96 @@ static char *cnt_str(char *str, size_t size, uint64_t cnt)
 	return str;
 }
 
-static void show_perf(char *name, int tsize, int sent, int acked,
-	       uint64_t start, uint64_t end, int xfers_per_iter)
+static const struct {
+	const char *name;
+	double pct;
+} pp_lat_pcts[] = {
+	{ "p50", 50 },
+	{ "p90", 90 },
+	{ "p99", 99 },
+	{ "p99.9", 99.9 },
+};
+
+static void show_perf_json(struct ct_pingpong *ct, int tsize, int sent,
+			   int acked, int64_t elapsed, uint64_t bytes,
+			   float usec_per_xfer)
+{
+	const struct pp_hist *hist = &ct->lat_hist;
+	int i;
+
+	printf("{\"bytes\": %d, \"sent\": %d, \"acked\": %d, "
+	       "\"total_bytes\": %" PRIu64 ", \"time_sec\": %f, "
+	       "\"mb_per_sec\": %f, \"usec_per_xfer\": %f, "
+	       "\"mxfers_per_sec\": %f", tsize, sent, acked, bytes,
+	       elapsed / 1000000.0, bytes / (1.0 * elapsed), usec_per_xfer,
+	       1.0 / usec_per_xfer);
+
+	if (hist->count) {
+		printf(", \"latency_usec\": {\"count\": %" PRIu64
+		       ", \"min\": %.3f", hist->count, hist->min / 1000.0);
+		for (i = 0; i < ARRAY_SIZE(pp_lat_pcts); i++)
+			printf(", \"%s\": %.3f", pp_lat_pcts[i].name,
+			       pp_hist_percentile(hist, pp_lat_pcts[i].pct) /
+			       1000.0);
+		printf(", \"max\": %.3f}", hist->max / 1000.0);
+	}
+	printf("}\n");
+}
+
+static void show_perf_csv(struct ct_pingpong *ct, int tsize, int sent,
+			  int acked, int64_t elapsed, uint64_t bytes,
+			  float usec_per_xfer)
 {
 	static int header = 1;
+	const struct pp_hist *hist = &ct->lat_hist;
+	int i;
+
+	if (header) {
+		printf("bytes,sent,acked,total_bytes,time_sec,mb_per_sec,"
+		       "usec_per_xfer,mxfers_per_sec,lat_count,lat_min_usec");
+		for (i = 0; i < ARRAY_SIZE(pp_lat_pcts); i++)
+			printf(",lat_%s_usec", pp_lat_pcts[i].name);
+		printf(",lat_max_usec\n");
+		header = 0;
+	}
+
+	printf("%d,%d,%d,%" PRIu64 ",%f,%f,%f,%f,%" PRIu64 ",%.3f", tsize,
+	       sent, acked, bytes, elapsed / 1000000.0,
+	       bytes / (1.0 * elapsed), usec_per_xfer, 1.0 / usec_per_xfer,
+	       hist->count, hist->count ? hist->min / 1000.0 : 0);
+	for (i = 0; i < ARRAY_SIZE(pp_lat_pcts); i++)
+		printf(",%.3f", pp_hist_percentile(hist, pp_lat_pcts[i].pct) /
+		       1000.0);
+	printf(",%.3f\n", hist->max / 1000.0);
+}
+
+static void show_perf(struct ct_pingpong *ct, char *name, int tsize, int sent,
+		      int acked, uint64_t start, uint64_t end,
+		      int xfers_per_iter)
+{
+	static int header = 1;
+	const struct pp_hist *hist = &ct->lat_hist;
 	char str[PP_STR_LEN];
 	int64_t elapsed = end - start;
 	uint64_t bytes = (uint64_t)sent * tsize * xfers_per_iter;
 	float usec_per_xfer;
+	int i;
 
 	if (sent == 0)
 		return;
 
+	usec_per_xfer = ((float)elapsed / sent / xfers_per_iter);
+
+	if (ct->opts.output_fmt == PP_OUTPUT_JSON) {
+		show_perf_json(ct, tsize, sent, acked, elapsed, bytes,
+			       usec_per_xfer);
+		return;
+	} else if (ct->opts.output_fmt == PP_OUTPUT_CSV) {
+		show_perf_csv(ct, tsize, sent, acked, elapsed, bytes,
+			      usec_per_xfer);
+		return;
+	}
+
 	if (name) {
 		if (header) {
 			printf("%-50s%-8s%-8s%-9s%-8s%8s %10s%13s%13s\n",
@@ -1101,9 +1289,17 @@ static void show_perf(char *name, int tsize, int sent, int acked,
 
 	printf("%-8s", size_str(str, bytes));
 
-	usec_per_xfer = ((float)elapsed / sent / xfers_per_iter);
 	printf("%8.2fs%10.2f%11.2f%11.2f\n", elapsed / 1000000.0,
 	       bytes / (1.0 * elapsed), usec_per_xfer, 1.0 / usec_per_xfer);
+
+	if (!hist->count)
+		return;
+
+	printf("%8s usec/xfer min %.2f", "", hist->min / 1000.0);
+	for (i = 0; i < ARRAY_SIZE(pp_lat_pcts); i++)
+		printf(" %s %.2f", pp_lat_pcts[i].name,
+		       pp_hist_percentile(hist, pp_lat_pcts[i].pct) / 1000.0);
+	printf(" max %.2f\n", hist->max / 1000.0);
 }
 
 /*******************************************************************************
@@ -2019,6 +2215,8 @@ static void pp_pingpong_usage(struct ct_pingpong *ct, char *name, char *desc)
 
 	fprintf(stderr, " %-20s %s\n", "-m <transmit mode>",
 		"transmit mode type: msg|tagged (msg)");
+	fprintf(stderr, " %-20s %s\n", "-j <format>",
+		"result format: text|json|csv (text)");
 
 	fprintf(stderr, " %-20s %s\n", "-h", "display this help output");
 	fprintf(stderr, " %-20s %s\n", "-v", "enable debugging output");
@@ -2109,6 +2307,20 @@ static void pp_parse_opts(struct ct_pingpong *ct, int op, char *optarg)
 		}
 		break;
 
+	/* Output format */
+	case 'j':
+		if (!strcasecmp("json", optarg)) {
+			ct->opts.output_fmt = PP_OUTPUT_JSON;
+		} else if (!strcasecmp("csv", optarg)) {
+			ct->opts.output_fmt = PP_OUTPUT_CSV;
+		} else if (!strcasecmp("text", optarg)) {
+			ct->opts.output_fmt = PP_OUTPUT_TEXT;
+		} else {
+			fprintf(stderr, "Unknown output format : %s\n", optarg);
+			exit(EXIT_FAILURE);
+		}
+		break;
+
 	/* Debug */
 	case 'v':
 		pp_debug = 1;
@@ -2153,6 +2365,8 @@ static int pingpong(struct ct_pingpong *ct)
 			ret = pp_rx(ct, ct->ep, ct->opts.transfer_size);
 			if (ret)
 				return ret;
+
+			pp_lat_sample(ct);
 		}
 	} else {
 		for (i = 0; i < ct->opts.iterations; i++) {
@@ -2169,6 +2383,8 @@ static int pingpong(struct ct_pingpong *ct)
 				ret = pp_tx(ct, ct->ep, ct->opts.transfer_size);
 			if (ret)
 				return ret;
+
+			pp_lat_sample(ct);
 		}
 	}
 	pp_stop(ct);
@@ -2178,7 +2394,7 @@ static int pingpong(struct ct_pingpong *ct)
 		return ret;
 
 	PP_DEBUG("Results:\n");
-	show_perf(NULL, ct->opts.transfer_size, ct->opts.iterations,
+	show_perf(ct, NULL, ct->opts.transfer_size, ct->opts.iterations,
 		  ct->cnt_ack_msg, ct->start, ct->end, 2);
 
 	return 0;
@@ -2333,7 +2549,7 @@ int main(int argc, char **argv)
 
 	ofi_osd_init();
 
-	while ((op = getopt(argc, argv, "hvd:p:f:e:I:S:s:B:P:cm:6")) != -1) {
+	while ((op = getopt(argc, argv, "hvd:p:f:e:I:S:s:B:P:cm:j:6")) != -1) {
 		switch (op) {
 		default:
 			pp_parse_opts(&ct, op, optarg);
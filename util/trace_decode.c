@@ -0,0 +1,479 @@
+/*
+ * Copyright (c) 2026 The libfabric contributors. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <config.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <rdma/fabric.h>
+#include <prov/hook/trace/include/hook_trace.h>
+
+static const char *td_op_names[] = {
+	TRACE_OPS(OFI_STR)
+};
+
+struct td_event {
+	uint64_t ns;
+	uint32_t pid;
+	uint32_t thread;
+	struct trace_record rec;
+};
+
+struct td_stat {
+	size_t posted;
+	size_t bytes;
+	size_t completed;
+	size_t errors;
+	uint64_t *lat;
+	size_t lat_cnt;
+	size_t lat_size;
+};
+
+struct td_slot {
+	uint64_t context;
+	uint32_t pid;
+	bool used;
+	ssize_t post;
+};
+
+static struct td_event *events;
+static size_t event_cnt, event_size;
+static ssize_t *match;
+static char *json_path;
+static bool summary;
+
+static const char *td_op_name(uint16_t op)
+{
+	if (op >= trace_op_size)
+		return "unknown";
+
+	/* skip the trace_op_ prefix */
+	return td_op_names[op] + strlen("trace_op_");
+}
+
+static bool td_is_comp(uint16_t op)
+{
+	return op == trace_op_cq_comp || op == trace_op_cq_err;
+}
+
+static int td_add_event(struct td_event *event)
+{
+	struct td_event *new_events;
+
+	if (event_cnt == event_size) {
+		event_size = event_size ? event_size * 2 : 4096;
+		new_events = realloc(events, event_size * sizeof(*events));
+		if (!new_events)
+			return -FI_ENOMEM;
+		events = new_events;
+	}
+	events[event_cnt++] = *event;
+	return 0;
+}
+
+static int td_load_file(const char *path)
+{
+	struct trace_header hdr;
+	struct trace_record *rec;
+	struct td_event event;
+	uint64_t start, cnt, i;
+	double ns_per_tick;
+	FILE *file;
+	int ret = 0;
+
+	file = fopen(path, "r");
+	if (!file) {
+		fprintf(stderr, "Could not open %s: %s\n", path,
+			strerror(errno));
+		return -errno;
+	}
+
+	if (fread(&hdr, sizeof(hdr), 1, file) != 1 ||
+	    hdr.magic != TRACE_MAGIC || hdr.version != TRACE_VERSION ||
+	    hdr.record_size != sizeof(*rec) || !hdr.ring_size) {
+		fprintf(stderr, "%s is not a trace file\n", path);
+		ret = -FI_EINVAL;
+		goto out;
+	}
+
+	rec = malloc(hdr.ring_size * sizeof(*rec));
+	if (!rec) {
+		ret = -FI_ENOMEM;
+		goto out;
+	}
+
+	if (fread(rec, sizeof(*rec), hdr.ring_size, file) != hdr.ring_size) {
+		fprintf(stderr, "%s is truncated\n", path);
+		ret = -FI_EINVAL;
+		goto free_rec;
+	}
+
+	if (hdr.sync_ticks > hdr.base_ticks && hdr.sync_ns > hdr.base_ns)
+		ns_per_tick = (double) (hdr.sync_ns - hdr.base_ns) /
+			      (hdr.sync_ticks - hdr.base_ticks);
+	else
+		ns_per_tick = 1.0;
+
+	/* the oldest records have been overwritten once the ring wrapped */
+	cnt = MIN(hdr.head, hdr.ring_size);
+	start = hdr.head - cnt;
+	if (hdr.head > hdr.ring_size)
+		fprintf(stderr, "%s: %" PRIu64 " oldest records were "
+			"overwritten\n", path, hdr.head - hdr.ring_size);
+
+	for (i = start; i < hdr.head; i++) {
+		event.rec = rec[i & (hdr.ring_size - 1)];
+		event.pid = hdr.pid;
+		event.thread = hdr.thread;
+		event.ns = hdr.base_ns + (int64_t) (ns_per_tick * (double)
+			   (int64_t) (event.rec.ticks - hdr.base_ticks));
+		ret = td_add_event(&event);
+		if (ret)
+			break;
+	}
+free_rec:
+	free(rec);
+out:
+	fclose(file);
+	return ret;
+}
+
+static int td_load(const char *path)
+{
+	char file_path[PATH_MAX];
+	struct dirent *entry;
+	struct stat st;
+	size_t len;
+	DIR *dir;
+	int ret = 0;
+
+	if (stat(path, &st)) {
+		fprintf(stderr, "Could not stat %s\n", path);
+		return -errno;
+	}
+
+	if (!S_ISDIR(st.st_mode))
+		return td_load_file(path);
+
+	dir = opendir(path);
+	if (!dir)
+		return -errno;
+
+	while ((entry = readdir(dir))) {
+		len = strlen(entry->d_name);
+		if (len < 6 || strcmp(entry->d_name + len - 6, ".trace"))
+			continue;
+
+		snprintf(file_path, sizeof(file_path), "%s/%s", path,
+			 entry->d_name);
+		ret = td_load_file(file_path);
+		if (ret)
+			break;
+	}
+	closedir(dir);
+	return ret;
+}
+
+static int td_cmp_event(const void *a, const void *b)
+{
+	const struct td_event *ea = a, *eb = b;
+
+	if (ea->ns != eb->ns)
+		return ea->ns < eb->ns ? -1 : 1;
+	return 0;
+}
+
+/*
+ * Pair each completion with the most recent operation posted with the same
+ * context by the same process.  match[i] is the index of the completion of
+ * the operation at i, or -1.
+ */
+static int td_match(void)
+{
+	struct td_slot *slots, *slot;
+	size_t size, i, idx;
+
+	if (!event_cnt)
+		return 0;
+
+	match = malloc(event_cnt * sizeof(*match));
+	size = roundup_power_of_two(event_cnt * 2 + 1);
+	slots = calloc(size, sizeof(*slots));
+	if (!match || !slots) {
+		free(slots);
+		return -FI_ENOMEM;
+	}
+
+	for (i = 0; i < event_cnt; i++) {
+		match[i] = -1;
+		if (!events[i].rec.context)
+			continue;
+
+		idx = (events[i].rec.context ^ events[i].pid) *
+		      0x9e3779b97f4a7c15ULL;
+		for (idx &= size - 1; ; idx = (idx + 1) & (size - 1)) {
+			slot = &slots[idx];
+			if (!slot->used ||
+			    (slot->context == events[i].rec.context &&
+			     slot->pid == events[i].pid))
+				break;
+		}
+
+		if (!slot->used) {
+			slot->used = true;
+			slot->context = events[i].rec.context;
+			slot->pid = events[i].pid;
+			slot->post = -1;
+		}
+
+		if (!td_is_comp(events[i].rec.op)) {
+			slot->post = i;
+		} else if (slot->post >= 0) {
+			match[slot->post] = i;
+			slot->post = -1;
+		}
+	}
+
+	free(slots);
+	return 0;
+}
+
+static void td_write_json(FILE *out)
+{
+	struct trace_record *rec;
+	uint64_t base;
+	size_t i;
+	bool first = true;
+
+	base = event_cnt ? events[0].ns : 0;
+	fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	for (i = 0; i < event_cnt; i++) {
+		rec = &events[i].rec;
+		fprintf(out, "%s{\"name\":\"%s\",\"cat\":\"%s\",",
+			first ? "" : ",\n", td_op_name(rec->op),
+			td_is_comp(rec->op) ? "completion" : "operation");
+		first = false;
+
+		if (match[i] >= 0) {
+			fprintf(out, "\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,",
+				(events[i].ns - base) / 1000.0,
+				(events[match[i]].ns - events[i].ns) /
+				1000.0);
+		} else {
+			fprintf(out, "\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,",
+				(events[i].ns - base) / 1000.0);
+		}
+
+		fprintf(out, "\"pid\":%u,\"tid\":%u,\"args\":{"
+			"\"fid\":\"0x%" PRIx64 "\",\"context\":\"0x%" PRIx64
+			"\",\"len\":%" PRIu64 ",\"tag\":\"0x%" PRIx64 "\","
+			"\"flags\":\"0x%" PRIx64 "\"",
+			events[i].pid, events[i].thread, rec->fid,
+			rec->context, rec->len, rec->tag, rec->flags);
+		if (rec->addr != FI_ADDR_NOTAVAIL)
+			fprintf(out, ",\"addr\":%" PRIu64, rec->addr);
+		if (rec->op == trace_op_cq_err)
+			fprintf(out, ",\"err\":%d", rec->err);
+		fprintf(out, "}}");
+	}
+	fprintf(out, "\n]}\n");
+}
+
+static int td_cmp_lat(const void *a, const void *b)
+{
+	uint64_t la = *(const uint64_t *) a, lb = *(const uint64_t *) b;
+
+	return la < lb ? -1 : la > lb;
+}
+
+static int td_add_lat(struct td_stat *stat, uint64_t lat)
+{
+	uint64_t *new_lat;
+
+	if (stat->lat_cnt == stat->lat_size) {
+		stat->lat_size = stat->lat_size ? stat->lat_size * 2 : 256;
+		new_lat = realloc(stat->lat, stat->lat_size * sizeof(*new_lat));
+		if (!new_lat)
+			return -FI_ENOMEM;
+		stat->lat = new_lat;
+	}
+	stat->lat[stat->lat_cnt++] = lat;
+	return 0;
+}
+
+static int td_write_summary(FILE *out)
+{
+	struct td_stat stats[trace_op_size] = {0};
+	struct td_stat *stat;
+	struct trace_record *rec;
+	uint64_t sum;
+	size_t i, j;
+	int ret = 0;
+
+	for (i = 0; i < event_cnt; i++) {
+		rec = &events[i].rec;
+		if (rec->op >= trace_op_size)
+			continue;
+
+		stat = &stats[rec->op];
+		stat->posted++;
+		stat->bytes += rec->len;
+		if (rec->op == trace_op_cq_err)
+			stat->errors++;
+		if (match[i] < 0)
+			continue;
+
+		stat->completed++;
+		if (events[match[i]].rec.op == trace_op_cq_err)
+			stat->errors++;
+		ret = td_add_lat(stat, events[match[i]].ns - events[i].ns);
+		if (ret)
+			goto free_lat;
+	}
+
+	fprintf(out, "%-20s %10s %14s %10s %8s %10s %10s %10s %10s %10s\n",
+		"operation", "count", "bytes", "completed", "errors",
+		"min(us)", "avg(us)", "p50(us)", "p99(us)", "max(us)");
+	for (i = 0; i < trace_op_size; i++) {
+		stat = &stats[i];
+		if (!stat->posted)
+			continue;
+
+		fprintf(out, "%-20s %10zu %14zu %10zu %8zu", td_op_name(i),
+			stat->posted, stat->bytes, stat->completed,
+			stat->errors);
+		if (!stat->lat_cnt) {
+			fprintf(out, " %10s %10s %10s %10s %10s\n",
+				"-", "-", "-", "-", "-");
+			continue;
+		}
+
+		qsort(stat->lat, stat->lat_cnt, sizeof(*stat->lat), td_cmp_lat);
+		for (j = 0, sum = 0; j < stat->lat_cnt; j++)
+			sum += stat->lat[j];
+		fprintf(out, " %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+			stat->lat[0] / 1000.0,
+			sum / 1000.0 / stat->lat_cnt,
+			stat->lat[stat->lat_cnt / 2] / 1000.0,
+			stat->lat[stat->lat_cnt * 99 / 100] / 1000.0,
+			stat->lat[stat->lat_cnt - 1] / 1000.0);
+	}
+free_lat:
+	for (i = 0; i < trace_op_size; i++)
+		free(stats[i].lat);
+	return ret;
+}
+
+static void td_usage(char *name)
+{
+	fprintf(stderr, "Decoder for ofi_hook_trace binary trace files\n\n");
+
+	fprintf(stderr, "Usage:\n");
+	fprintf(stderr, "  %s [OPTIONS] <target>...\t"
+			"decode trace files or folders of trace files\n",
+		name);
+
+	fprintf(stderr, "\nOptions:\n");
+	fprintf(stderr, " %-20s %s\n", "-o <outpath>",
+		"Chrome trace JSON output file (stdout if unset)");
+	fprintf(stderr, " %-20s %s\n", "-s",
+		"print summary tables, JSON is only written with -o");
+	fprintf(stderr, " %-20s %s\n", "-h", "display this help output");
+}
+
+int main(int argc, char **argv)
+{
+	FILE *out;
+	int op, ret;
+
+	while ((op = getopt(argc, argv, "ho:s")) != -1) {
+		switch (op) {
+		case 'o':
+			json_path = optarg;
+			break;
+		case 's':
+			summary = true;
+			break;
+		case '?':
+		case 'h':
+		default:
+			td_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind == argc) {
+		fprintf(stderr, "No target path specified!\n");
+		td_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	for (; optind < argc; optind++) {
+		ret = td_load(argv[optind]);
+		if (ret)
+			goto out;
+	}
+
+	qsort(events, event_cnt, sizeof(*events), td_cmp_event);
+	ret = td_match();
+	if (ret)
+		goto out;
+
+	if (json_path || !summary) {
+		out = json_path ? fopen(json_path, "w") : stdout;
+		if (!out) {
+			fprintf(stderr, "Could not open %s: %s\n", json_path,
+				strerror(errno));
+			ret = -errno;
+			goto out;
+		}
+		td_write_json(out);
+		if (json_path)
+			fclose(out);
+	}
+
+	if (summary)
+		ret = td_write_summary(stdout);
+out:
+	free(match);
+	free(events);
+	return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}